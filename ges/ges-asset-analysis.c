@@ -0,0 +1,599 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Content analysis of media files, used by GESUriClipAsset.
+ *
+ * A file is decoded once, its first video and first audio streams being
+ * analysed in their own streaming threads:
+ *   - Video frames are scaled down to a tiny grayscale picture and the
+ *     distance between the luma histograms of consecutive frames is used to
+ *     detect scene changes.
+ *   - Audio is resampled to 48kHz and K-weighted as described in
+ *     ITU-R BS.1770, the mean square is accumulated per 100ms block along
+ *     with the sample peak. The per second loudness and the gated
+ *     (EBU R128) integrated loudness are computed from those blocks at the
+ *     end.
+ *
+ * Results are kept in a GstStructure whose fields are named after the metas
+ * set on the asset, and saved in the user cache directory keyed by the uri,
+ * size and modification time of the file, so a file is never analysed
+ * twice.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#include <math.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "ges-internal.h"
+#include "ges-meta-container.h"
+#include "ges-gerror.h"
+
+/* Bump whenever the results change for a given file */
+#define ANALYSIS_VERSION 1
+
+#define ANALYSIS_RATE 48000
+#define BLOCKS_PER_SECOND 10
+#define BLOCK_FRAMES (ANALYSIS_RATE / BLOCKS_PER_SECOND)
+
+/* Loudness of silence, also used as the absolute gate */
+#define SILENCE_LUFS -70.0
+
+#define THUMB_WIDTH 64
+#define THUMB_HEIGHT 36
+#define HISTOGRAM_BINS 32
+/* Part of the pixels that need to have moved to another histogram bin */
+#define SCENE_CHANGE_THRESHOLD 0.4
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define ANALYSIS_AUDIO_FORMAT "F32LE"
+#else
+#define ANALYSIS_AUDIO_FORMAT "F32BE"
+#endif
+
+typedef struct
+{
+  gdouble b0, b1, b2, a1, a2;
+} Biquad;
+
+/* K-weighting filter at 48kHz as specified by ITU-R BS.1770: a high shelf
+ * modeling the head followed by a high pass (RLB weighting) */
+static const Biquad k_weighting[2] = {
+  {1.53512485958697, -2.69169618940638, 1.19839281085285,
+      -1.69065929318241, 0.73248077421585},
+  {1.0, -2.0, 1.0, -1.99004745483398, 0.99007225036621}
+};
+
+typedef struct
+{
+  /* Video, only touched from the video streaming thread */
+  gboolean have_histogram;
+  guint histogram[HISTOGRAM_BINS];
+  GArray *scene_changes;        /* GstClockTime */
+
+  /* Audio, only touched from the audio streaming thread */
+  gint channels;
+  gdouble *filter_state;        /* 2 biquads * 2 states per channel */
+  guint block_frames;
+  gdouble block_energy;
+  gfloat block_peak;
+  GArray *energies;             /* gdouble, mean square of each block */
+  GByteArray *peaks;            /* peak of each block, 255 being full scale */
+
+  gboolean have_video;
+  gboolean have_audio;
+} Analysis;
+
+static void
+_analysis_free (Analysis * analysis)
+{
+  g_array_unref (analysis->scene_changes);
+  g_array_unref (analysis->energies);
+  g_byte_array_unref (analysis->peaks);
+  g_free (analysis->filter_state);
+}
+
+static inline gdouble
+_to_lufs (gdouble energy)
+{
+  if (energy <= 0)
+    return SILENCE_LUFS;
+
+  return MAX (-0.691 + 10 * log10 (energy), SILENCE_LUFS);
+}
+
+/*****************************************************
+ *                   Scene changes                   *
+ *****************************************************/
+static void
+_video_handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    Analysis * analysis)
+{
+  GstMapInfo map;
+  gsize i, size;
+  gdouble distance = 0;
+  guint histogram[HISTOGRAM_BINS] = { 0, };
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return;
+
+  /* GRAY8 rows of THUMB_WIDTH pixels are not padded */
+  size = MIN (map.size, THUMB_WIDTH * THUMB_HEIGHT);
+  for (i = 0; i < size; i++)
+    histogram[map.data[i] * HISTOGRAM_BINS / 256]++;
+  gst_buffer_unmap (buffer, &map);
+
+  if (size == 0)
+    return;
+
+  if (analysis->have_histogram) {
+    for (i = 0; i < HISTOGRAM_BINS; i++)
+      distance += ABS ((gint) histogram[i] - (gint) analysis->histogram[i]);
+
+    distance /= 2 * size;
+    if (distance > SCENE_CHANGE_THRESHOLD &&
+        GST_BUFFER_PTS_IS_VALID (buffer)) {
+      GST_LOG ("Scene change at %" GST_TIME_FORMAT " (distance %f)",
+          GST_TIME_ARGS (GST_BUFFER_PTS (buffer)), distance);
+      g_array_append_val (analysis->scene_changes, GST_BUFFER_PTS (buffer));
+    }
+  }
+
+  memcpy (analysis->histogram, histogram, sizeof (histogram));
+  analysis->have_histogram = TRUE;
+}
+
+/*****************************************************
+ *              Loudness and peaks                   *
+ *****************************************************/
+static void
+_push_block (Analysis * analysis)
+{
+  gdouble energy;
+  guint8 peak;
+
+  if (analysis->block_frames == 0)
+    return;
+
+  energy = analysis->block_energy / analysis->block_frames;
+  peak = (guint8) (CLAMP (analysis->block_peak, 0, 1) * 255 + 0.5);
+
+  g_array_append_val (analysis->energies, energy);
+  g_byte_array_append (analysis->peaks, &peak, 1);
+
+  analysis->block_frames = 0;
+  analysis->block_energy = 0;
+  analysis->block_peak = 0;
+}
+
+static inline gdouble
+_filter (const Biquad * f, gdouble * state, gdouble x)
+{
+  /* Transposed direct form II */
+  gdouble y = f->b0 * x + state[0];
+
+  state[0] = f->b1 * x - f->a1 * y + state[1];
+  state[1] = f->b2 * x - f->a2 * y;
+
+  return y;
+}
+
+static void
+_audio_handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    Analysis * analysis)
+{
+  GstMapInfo map;
+  const gfloat *data;
+  gint c, channels = 0;
+  gsize i, n_frames;
+  GstCaps *caps = gst_pad_get_current_caps (pad);
+
+  if (caps) {
+    gst_structure_get_int (gst_caps_get_structure (caps, 0), "channels",
+        &channels);
+    gst_caps_unref (caps);
+  }
+
+  if (channels <= 0)
+    return;
+
+  if (channels != analysis->channels) {
+    GST_DEBUG ("Analysing %d audio channels", channels);
+
+    _push_block (analysis);
+    g_free (analysis->filter_state);
+    analysis->filter_state = g_new0 (gdouble, 4 * channels);
+    analysis->channels = channels;
+  }
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return;
+
+  data = (const gfloat *) map.data;
+  n_frames = map.size / (sizeof (gfloat) * channels);
+  for (i = 0; i < n_frames; i++) {
+    for (c = 0; c < channels; c++) {
+      gdouble *state = &analysis->filter_state[4 * c];
+      gfloat x = data[i * channels + c];
+      gdouble y;
+
+      y = _filter (&k_weighting[1], state + 2, _filter (&k_weighting[0],
+              state, x));
+
+      /* All channels are weighted 1.0, which is what BS.1770 specifies for
+       * mono, stereo and the front channels */
+      analysis->block_energy += y * y;
+      analysis->block_peak = MAX (analysis->block_peak, fabsf (x));
+    }
+
+    if (++analysis->block_frames == BLOCK_FRAMES)
+      _push_block (analysis);
+  }
+
+  gst_buffer_unmap (buffer, &map);
+}
+
+/* EBU R128 integrated loudness: 400ms blocks overlapping by 75%, gated at
+ * SILENCE_LUFS and then 10 LU under the loudness of the remaining blocks */
+static gdouble
+_integrated_loudness (GArray * energies)
+{
+  guint i, j, n_blocks;
+  gdouble *gated, sum, threshold;
+  guint n_gated = 0, n_relative = 0;
+
+  if (energies->len < 4)
+    return SILENCE_LUFS;
+
+  n_blocks = energies->len - 3;
+  gated = g_new (gdouble, n_blocks);
+  for (i = 0; i < n_blocks; i++) {
+    gdouble energy = 0;
+
+    for (j = 0; j < 4; j++)
+      energy += g_array_index (energies, gdouble, i + j);
+    energy /= 4;
+
+    if (_to_lufs (energy) > SILENCE_LUFS)
+      gated[n_gated++] = energy;
+  }
+
+  sum = 0;
+  for (i = 0; i < n_gated; i++)
+    sum += gated[i];
+  threshold = n_gated ? _to_lufs (sum / n_gated) - 10 : SILENCE_LUFS;
+
+  sum = 0;
+  for (i = 0; i < n_gated; i++) {
+    if (_to_lufs (gated[i]) > threshold) {
+      sum += gated[i];
+      n_relative++;
+    }
+  }
+  g_free (gated);
+
+  return n_relative ? _to_lufs (sum / n_relative) : SILENCE_LUFS;
+}
+
+/*****************************************************
+ *                     Decoding                      *
+ *****************************************************/
+static GstElement *
+_make_branch (GstElement * pipeline, const gchar * description,
+    GCallback handoff, Analysis * analysis)
+{
+  GstElement *bin, *sink;
+  GError *error = NULL;
+
+  bin = gst_parse_bin_from_description (description, TRUE, &error);
+  if (bin == NULL) {
+    GST_WARNING ("Could not create analysis branch: %s", error->message);
+    g_clear_error (&error);
+
+    return NULL;
+  }
+
+  sink = gst_bin_get_by_name (GST_BIN (bin), "sink");
+  g_object_set (sink, "signal-handoffs", TRUE, "sync", FALSE, NULL);
+  g_signal_connect (sink, "handoff", handoff, analysis);
+  gst_object_unref (sink);
+
+  gst_bin_add (GST_BIN (pipeline), bin);
+  gst_element_sync_state_with_parent (bin);
+
+  return bin;
+}
+
+static void
+_decoder_pad_added_cb (GstElement * decodebin, GstPad * pad,
+    Analysis * analysis)
+{
+  GstPad *sinkpad;
+  const gchar *name;
+  GstElement *branch = NULL;
+  GstCaps *caps = gst_pad_query_caps (pad, NULL);
+  GstElement *pipeline = GST_ELEMENT (gst_element_get_parent (decodebin));
+
+  name = gst_caps_is_empty (caps) ? "" :
+      gst_structure_get_name (gst_caps_get_structure (caps, 0));
+
+  /* The queues make sure conversion and analysis of each stream happen in
+   * their own thread */
+  if (!analysis->have_video && g_str_has_prefix (name, "video/")) {
+    branch = _make_branch (pipeline, "queue ! videoconvert ! videoscale "
+        "! video/x-raw,format=GRAY8,width=" G_STRINGIFY (THUMB_WIDTH)
+        ",height=" G_STRINGIFY (THUMB_HEIGHT) ",pixel-aspect-ratio=1/1 "
+        "! fakesink name=sink", G_CALLBACK (_video_handoff_cb), analysis);
+    analysis->have_video = branch != NULL;
+  } else if (!analysis->have_audio && g_str_has_prefix (name, "audio/")) {
+    branch = _make_branch (pipeline, "queue ! audioconvert ! audioresample "
+        "! audio/x-raw,format=" ANALYSIS_AUDIO_FORMAT ",layout=interleaved,"
+        "rate=" G_STRINGIFY (ANALYSIS_RATE) " ! fakesink name=sink",
+        G_CALLBACK (_audio_handoff_cb), analysis);
+    analysis->have_audio = branch != NULL;
+  }
+
+  if (branch == NULL) {
+    branch = gst_element_factory_make ("fakesink", NULL);
+    g_object_set (branch, "sync", FALSE, NULL);
+    gst_bin_add (GST_BIN (pipeline), branch);
+    gst_element_sync_state_with_parent (branch);
+  }
+
+  sinkpad = gst_element_get_static_pad (branch, "sink");
+  if (gst_pad_link (pad, sinkpad) != GST_PAD_LINK_OK)
+    GST_WARNING ("Could not link %" GST_PTR_FORMAT, pad);
+
+  gst_object_unref (sinkpad);
+  gst_object_unref (pipeline);
+  gst_caps_unref (caps);
+}
+
+static gboolean
+_decode (const gchar * uri, Analysis * analysis, GCancellable * cancellable,
+    GError ** error)
+{
+  GstBus *bus;
+  GstMessage *msg;
+  gboolean done = FALSE, res = FALSE;
+  GstElement *pipeline, *decodebin;
+
+  decodebin = gst_element_factory_make ("uridecodebin", NULL);
+  if (decodebin == NULL) {
+    g_set_error (error, GES_ERROR, GES_ERROR_ASSET_ANALYSIS,
+        "Missing uridecodebin to analyse %s", uri);
+
+    return FALSE;
+  }
+
+  pipeline = gst_pipeline_new ("asset-analysis");
+  g_object_set (decodebin, "uri", uri, NULL);
+  gst_bin_add (GST_BIN (pipeline), decodebin);
+  g_signal_connect (decodebin, "pad-added",
+      G_CALLBACK (_decoder_pad_added_cb), analysis);
+
+  bus = gst_element_get_bus (pipeline);
+  if (gst_element_set_state (pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE) {
+    g_set_error (error, GES_ERROR, GES_ERROR_ASSET_ANALYSIS,
+        "Could not decode %s", uri);
+    done = TRUE;
+  }
+
+  while (!done) {
+    if (g_cancellable_set_error_if_cancelled (cancellable, error))
+      break;
+
+    msg = gst_bus_timed_pop_filtered (bus, 100 * GST_MSECOND,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+    if (msg == NULL)
+      continue;
+
+    if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+      GError *err = NULL;
+
+      gst_message_parse_error (msg, &err, NULL);
+      g_set_error (error, GES_ERROR, GES_ERROR_ASSET_ANALYSIS,
+          "Could not decode %s: %s", uri, err->message);
+      g_error_free (err);
+    } else {
+      res = TRUE;
+    }
+
+    gst_message_unref (msg);
+    done = TRUE;
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return res;
+}
+
+static GstStructure *
+_analyse (const gchar * uri, GCancellable * cancellable, GError ** error)
+{
+  guint i, j;
+  GstBuffer *peaks;
+  GstStructure *results;
+  Analysis analysis = { 0, };
+
+  analysis.scene_changes = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  analysis.energies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  analysis.peaks = g_byte_array_new ();
+
+  if (!_decode (uri, &analysis, cancellable, error)) {
+    _analysis_free (&analysis);
+
+    return NULL;
+  }
+  _push_block (&analysis);
+
+  results = gst_structure_new ("ges-asset-analysis",
+      "version", G_TYPE_INT, ANALYSIS_VERSION, NULL);
+
+  if (analysis.have_video) {
+    GValue array = { 0 };
+    GValue item = { 0 };
+
+    g_value_init (&array, GST_TYPE_ARRAY);
+    g_value_init (&item, G_TYPE_UINT64);
+    for (i = 0; i < analysis.scene_changes->len; i++) {
+      g_value_set_uint64 (&item, g_array_index (analysis.scene_changes,
+              GstClockTime, i));
+      gst_value_array_append_value (&array, &item);
+    }
+    gst_structure_take_value (results, GES_META_ANALYSIS_SCENE_CHANGES,
+        &array);
+    g_value_unset (&item);
+  }
+
+  if (analysis.have_audio) {
+    GValue array = { 0 };
+    GValue item = { 0 };
+
+    g_value_init (&array, GST_TYPE_ARRAY);
+    g_value_init (&item, G_TYPE_DOUBLE);
+    for (i = 0; i < analysis.energies->len; i += BLOCKS_PER_SECOND) {
+      gdouble energy = 0;
+      guint n = MIN (BLOCKS_PER_SECOND, analysis.energies->len - i);
+
+      for (j = 0; j < n; j++)
+        energy += g_array_index (analysis.energies, gdouble, i + j);
+
+      g_value_set_double (&item, _to_lufs (energy / n));
+      gst_value_array_append_value (&array, &item);
+    }
+    gst_structure_take_value (results, GES_META_ANALYSIS_LOUDNESS, &array);
+    g_value_unset (&item);
+
+    gst_structure_set (results, GES_META_ANALYSIS_INTEGRATED_LOUDNESS,
+        G_TYPE_DOUBLE, _integrated_loudness (analysis.energies), NULL);
+
+    peaks = gst_buffer_new_wrapped (g_memdup (analysis.peaks->data,
+            analysis.peaks->len), analysis.peaks->len);
+    gst_structure_set (results, GES_META_ANALYSIS_WAVEFORM_PEAKS,
+        GST_TYPE_BUFFER, peaks, NULL);
+    gst_buffer_unref (peaks);
+  }
+
+  _analysis_free (&analysis);
+
+  return results;
+}
+
+/*****************************************************
+ *                    Disk cache                     *
+ *****************************************************/
+static GstStructure *
+_load (const gchar * location)
+{
+  gint version;
+  gchar *contents;
+  GstStructure *results;
+
+  if (!g_file_get_contents (location, &contents, NULL, NULL))
+    return NULL;
+
+  results = gst_structure_from_string (contents, NULL);
+  g_free (contents);
+
+  if (results && (!gst_structure_get_int (results, "version", &version) ||
+          version != ANALYSIS_VERSION)) {
+    gst_structure_free (results);
+    results = NULL;
+  }
+
+  return results;
+}
+
+static void
+_save (const gchar * location, const GstStructure * results)
+{
+  gchar *contents, *dir;
+  GError *error = NULL;
+
+  dir = g_path_get_dirname (location);
+  g_mkdir_with_parents (dir, 0755);
+  g_free (dir);
+
+  contents = gst_structure_to_string (results);
+  if (!g_file_set_contents (location, contents, -1, &error)) {
+    GST_WARNING ("Could not save analysis results in %s: %s", location,
+        error->message);
+    g_error_free (error);
+  }
+  g_free (contents);
+}
+
+/*****************************************************
+ *                   Internal API                    *
+ *****************************************************/
+
+/* Returns the analysis results for @uri from the disk cache, or analyses the
+ * file, blocking until it is done. Safe to call from any thread. */
+GstStructure *
+ges_asset_analysis_run (const gchar * uri, GCancellable * cancellable,
+    GError ** error)
+{
+  gchar *location;
+  GstStructure *results;
+
+  location = ges_get_media_cache_location (uri, "analysis",
+      G_STRINGIFY (ANALYSIS_VERSION));
+  results = _load (location);
+  if (results) {
+    GST_DEBUG ("Using cached analysis of %s from %s", uri, location);
+    g_free (location);
+
+    return results;
+  }
+
+  GST_DEBUG ("Analysing %s", uri);
+  results = _analyse (uri, cancellable, error);
+  if (results)
+    _save (location, results);
+  g_free (location);
+
+  return results;
+}
+
+static gboolean
+_set_meta_foreach (GQuark field_id, const GValue * value,
+    GESMetaContainer * container)
+{
+  if (field_id != g_quark_from_static_string ("version"))
+    ges_meta_container_set_meta (container, g_quark_to_string (field_id),
+        value);
+
+  return TRUE;
+}
+
+/* Sets @results as metas of @container, must be called from the thread
+ * @container is used in */
+void
+ges_asset_analysis_apply (const GstStructure * results,
+    GESMetaContainer * container)
+{
+  gst_structure_foreach (results, (GstStructureForeachFunc) _set_meta_foreach,
+      container);
+}
@@ -117,6 +117,12 @@ struct _GESAssetPrivate
 
   /* The error that accured when a asset has been initialized with error */
   GError *error;
+
+  /* The extractables using this asset, mapped to a GWeakRef on them so
+   * they can be safely referenced even while being destroyed. Protected by
+   * extractables_lock */
+  GHashTable *extractables;
+  guint extractables_prune_size;
 };
 
 /* Internal structure to help avoid full loading
@@ -130,6 +136,11 @@ typedef struct
 
 /* Also protect all the entries in the cache */
 static GMutex asset_cache_lock;
+/* Minimum number of entries before destroyed extractables are looked for */
+#define MIN_EXTRACTABLES_PRUNE_SIZE 64
+/* Protects the extractables of all the assets, they can be destroyed from
+ * any thread */
+static GMutex extractables_lock;
 /* We are mapping entries by types and ID, such as:
  *
  * {
@@ -335,6 +346,13 @@ ges_asset_set_property (GObject * object, guint property_id,
   }
 }
 
+static void
+_weak_ref_free (GWeakRef * ref)
+{
+  g_weak_ref_clear (ref);
+  g_slice_free (GWeakRef, ref);
+}
+
 static void
 ges_asset_finalize (GObject * object)
 {
@@ -349,6 +367,10 @@ ges_asset_finalize (GObject * object)
   if (priv->error)
     g_error_free (priv->error);
 
+  /* Extractables hold a reference on their asset so they are all gone,
+   * only the weak references are left */
+  g_hash_table_unref (priv->extractables);
+
   G_OBJECT_CLASS (ges_asset_parent_class)->finalize (object);
 }
 
@@ -388,10 +410,67 @@ ges_asset_init (GESAsset * self)
 
   self->priv->state = ASSET_INITIALIZING;
   self->priv->proxied_asset_id = NULL;
+  self->priv->extractables = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, NULL, (GDestroyNotify) _weak_ref_free);
+  self->priv->extractables_prune_size = MIN_EXTRACTABLES_PRUNE_SIZE;
 }
 
 /* Internal methods */
 
+/* Called by ges_extractable_set_asset so we know which objects use us.
+ *
+ * Destroyed extractables are not notified to us, so their entries are only
+ * dropped once the table has doubled since the last time it was pruned */
+void
+ges_asset_add_extractable (GESAsset * asset, GESExtractable * extractable)
+{
+  GWeakRef *ref;
+  GHashTableIter iter;
+  GList *alive = NULL;
+  GESAssetPrivate *priv = asset->priv;
+
+  g_mutex_lock (&extractables_lock);
+  ref = g_hash_table_lookup (priv->extractables, extractable);
+  if (ref) {
+    /* A destroyed extractable might have been at the same address */
+    g_weak_ref_set (ref, extractable);
+    g_mutex_unlock (&extractables_lock);
+
+    return;
+  }
+
+  if (g_hash_table_size (priv->extractables) >= priv->extractables_prune_size) {
+    g_hash_table_iter_init (&iter, priv->extractables);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & ref)) {
+      GObject *object = g_weak_ref_get (ref);
+
+      if (object)
+        alive = g_list_prepend (alive, object);
+      else
+        g_hash_table_iter_remove (&iter);
+    }
+    priv->extractables_prune_size =
+        MAX (MIN_EXTRACTABLES_PRUNE_SIZE,
+        2 * g_hash_table_size (priv->extractables));
+  }
+
+  ref = g_slice_new0 (GWeakRef);
+  g_weak_ref_init (ref, extractable);
+  g_hash_table_insert (priv->extractables, extractable, ref);
+  g_mutex_unlock (&extractables_lock);
+
+  /* Might be the last references, drop them outside of the lock */
+  g_list_free_full (alive, g_object_unref);
+}
+
+void
+ges_asset_remove_extractable (GESAsset * asset, GESExtractable * extractable)
+{
+  g_mutex_lock (&extractables_lock);
+  g_hash_table_remove (asset->priv->extractables, extractable);
+  g_mutex_unlock (&extractables_lock);
+}
+
 /* Find the type that implemented the GESExtractable interface */
 static inline const gchar *
 _extractable_type_name (GType type)
@@ -1027,3 +1106,95 @@ ges_list_assets (GType filter)
 
   return ret;
 }
+
+/**
+ * ges_asset_list_extractables:
+ * @self: The #GESAsset to list the users of
+ *
+ * Lists the #GESExtractable-s that are currently using @self, meaning the
+ * objects that have been extracted from it or on which it has been set
+ * with #ges_extractable_set_asset, and that are still alive.
+ *
+ * Returns: (transfer full) (element-type GESExtractable): The list of
+ * #GESExtractable using @self
+ */
+GList *
+ges_asset_list_extractables (GESAsset * self)
+{
+  GList *ret = NULL;
+  GHashTableIter iter;
+  gpointer ref;
+
+  g_return_val_if_fail (GES_IS_ASSET (self), NULL);
+
+  g_mutex_lock (&extractables_lock);
+  g_hash_table_iter_init (&iter, self->priv->extractables);
+  while (g_hash_table_iter_next (&iter, NULL, &ref)) {
+    GObject *extractable = g_weak_ref_get (ref);
+
+    /* Destroyed, or being destroyed in another thread */
+    if (extractable == NULL) {
+      g_hash_table_iter_remove (&iter);
+      continue;
+    }
+
+    ret = g_list_prepend (ret, extractable);
+  }
+  g_mutex_unlock (&extractables_lock);
+
+  return ret;
+}
+
+/**
+ * ges_asset_move_extractables:
+ * @self: The #GESAsset currently used
+ * @new_asset: The #GESAsset to use instead of @self
+ *
+ * Sets @new_asset on all the #GESExtractable-s currently using @self, for
+ * example to relink media that has been moved or to replace an asset with
+ * a proxy. Both assets must have the same extractable type. Extractables
+ * that do not support changing their asset are left untouched.
+ *
+ * Returns: The number of #GESExtractable-s that now use @new_asset
+ */
+guint
+ges_asset_move_extractables (GESAsset * self, GESAsset * new_asset)
+{
+  GList *extractables, *tmp;
+  guint n_moved = 0;
+
+  g_return_val_if_fail (GES_IS_ASSET (self), 0);
+  g_return_val_if_fail (GES_IS_ASSET (new_asset), 0);
+
+  if (self == new_asset)
+    return 0;
+
+  if (self->priv->extractable_type != new_asset->priv->extractable_type) {
+    GST_WARNING_OBJECT (self, "Can not move extractables of type %s to an "
+        "asset of type %s", g_type_name (self->priv->extractable_type),
+        g_type_name (new_asset->priv->extractable_type));
+
+    return 0;
+  }
+
+  /* ges_extractable_set_asset modifies our set of extractables */
+  extractables = ges_asset_list_extractables (self);
+  for (tmp = extractables; tmp; tmp = tmp->next) {
+    GESExtractable *extractable = tmp->data;
+
+    if (!GES_EXTRACTABLE_GET_INTERFACE (extractable)->can_update_asset) {
+      GST_WARNING_OBJECT (extractable, "Can not update asset, not moving it");
+      continue;
+    }
+
+    ges_extractable_set_asset (extractable, new_asset);
+    if (ges_extractable_get_asset (extractable) == new_asset)
+      n_moved++;
+  }
+  g_list_free_full (extractables, g_object_unref);
+
+  GST_DEBUG_OBJECT (self, "Moved %u extractables to %" GST_PTR_FORMAT,
+      n_moved, new_asset);
+
+  return n_moved;
+}
@@ -98,6 +98,9 @@ GESAsset * ges_asset_request_finish  (GAsyncResult *res,
 GESExtractable * ges_asset_extract   (GESAsset * self,
                                       GError **error);
 GList * ges_list_assets              (GType filter);
+GList * ges_asset_list_extractables  (GESAsset * self);
+guint ges_asset_move_extractables    (GESAsset * self,
+                                      GESAsset * new_asset);
 
 G_END_DECLS
 #endif /* _GES_ASSET */
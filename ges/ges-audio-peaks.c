@@ -0,0 +1,477 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Multi-resolution waveform peaks of audio streams.
+ *
+ * The stream is decoded once in a thread of a shared pool, the minimum and
+ * maximum sample of all channels is computed for every BASE_SAMPLES_PER_PEAK
+ * frames, and each following level merges two peaks of the previous one.
+ *
+ * Levels are laid out in a single block of memory, which is exactly what is
+ * saved in the user cache directory:
+ *
+ *   PeaksHeader | PeaksLevel[n_levels] | GESAudioPeak[] of each level
+ *
+ * Cached files are mapped in memory and the peaks handed to the user as
+ * GBytes pointing inside that block, so they are never copied.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#include <string.h>
+
+#include "ges-internal.h"
+#include "ges-uri-asset.h"
+
+/* "GESP" in native endianness, files saved on a machine of another
+ * endianness are ignored */
+#define PEAKS_MAGIC 0x47455350
+#define PEAKS_VERSION 1
+
+#define BASE_SAMPLES_PER_PEAK 256
+#define MAX_LEVELS 16
+
+/* Most decoders are multithreaded already */
+#define MAX_PEAKS_THREADS 2
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define PEAKS_AUDIO_FORMAT "F32LE"
+#else
+#define PEAKS_AUDIO_FORMAT "F32BE"
+#endif
+
+typedef struct
+{
+  guint32 magic;
+  guint32 version;
+  guint32 rate;
+  guint32 n_levels;
+} PeaksHeader;
+
+typedef struct
+{
+  guint32 samples_per_peak;
+  guint32 n_peaks;
+  guint64 offset;               /* From the start of the header */
+} PeaksLevel;
+
+typedef struct
+{
+  gchar *uri;
+  gchar *stream_id;
+
+  GESAudioPeaksReadyFunc func;
+  gpointer user_data;
+  GDestroyNotify notify;
+
+  GBytes *peaks;
+} PeaksJob;
+
+typedef struct
+{
+  gint rate;
+  gboolean linked;
+
+  /* Increased for each decoded buffer */
+  volatile gint progress;
+
+  /* Peak being accumulated */
+  guint frames;
+  gfloat min, max;
+
+  GArray *level0;               /* GESAudioPeak */
+} PeaksBuilder;
+
+static GThreadPool *peaks_pool = NULL;
+
+static inline gint16
+_to_int16 (gfloat sample)
+{
+  return (gint16) (CLAMP (sample, -1.0f, 1.0f) * G_MAXINT16);
+}
+
+static void
+_push_peak (PeaksBuilder * builder)
+{
+  GESAudioPeak peak;
+
+  if (builder->frames == 0)
+    return;
+
+  peak.min = _to_int16 (builder->min);
+  peak.max = _to_int16 (builder->max);
+  g_array_append_val (builder->level0, peak);
+
+  builder->frames = 0;
+}
+
+static void
+_handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    PeaksBuilder * builder)
+{
+  GstMapInfo map;
+  const gfloat *data;
+  gint c, channels = 0;
+  gsize i, n_frames;
+  GstCaps *caps = gst_pad_get_current_caps (pad);
+
+  if (caps) {
+    GstStructure *structure = gst_caps_get_structure (caps, 0);
+
+    gst_structure_get_int (structure, "channels", &channels);
+    if (builder->rate == 0)
+      gst_structure_get_int (structure, "rate", &builder->rate);
+    gst_caps_unref (caps);
+  }
+
+  g_atomic_int_inc (&builder->progress);
+  if (channels <= 0 || !gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return;
+
+  data = (const gfloat *) map.data;
+  n_frames = map.size / (sizeof (gfloat) * channels);
+  for (i = 0; i < n_frames; i++) {
+    if (builder->frames == 0) {
+      builder->min = G_MAXFLOAT;
+      builder->max = -G_MAXFLOAT;
+    }
+
+    for (c = 0; c < channels; c++) {
+      gfloat sample = data[i * channels + c];
+
+      builder->min = MIN (builder->min, sample);
+      builder->max = MAX (builder->max, sample);
+    }
+
+    if (++builder->frames == BASE_SAMPLES_PER_PEAK)
+      _push_peak (builder);
+  }
+
+  gst_buffer_unmap (buffer, &map);
+}
+
+typedef struct
+{
+  PeaksBuilder *builder;
+  const gchar *stream_id;
+} PadAddedData;
+
+static void
+_decoder_pad_added_cb (GstElement * decodebin, GstPad * pad,
+    PadAddedData * data)
+{
+  GstPad *sinkpad;
+  GstElement *sink = NULL;
+  gchar *stream_id = gst_pad_get_stream_id (pad);
+  GstCaps *caps = gst_pad_query_caps (pad, NULL);
+  GstElement *pipeline = GST_ELEMENT (gst_element_get_parent (decodebin));
+
+  if (!data->builder->linked && !gst_caps_is_empty (caps) &&
+      g_str_has_prefix (gst_structure_get_name (gst_caps_get_structure (caps,
+                  0)), "audio/") && (stream_id == NULL
+          || !g_strcmp0 (stream_id, data->stream_id))) {
+    sink = gst_parse_bin_from_description ("audioconvert ! audio/x-raw,"
+        "format=" PEAKS_AUDIO_FORMAT ",layout=interleaved "
+        "! fakesink name=sink signal-handoffs=true sync=false", TRUE, NULL);
+
+    if (sink) {
+      GstElement *fakesink = gst_bin_get_by_name (GST_BIN (sink), "sink");
+
+      g_signal_connect (fakesink, "handoff", G_CALLBACK (_handoff_cb),
+          data->builder);
+      gst_object_unref (fakesink);
+      data->builder->linked = TRUE;
+    }
+  }
+
+  if (sink == NULL) {
+    sink = gst_element_factory_make ("fakesink", NULL);
+    g_object_set (sink, "sync", FALSE, NULL);
+  }
+
+  gst_bin_add (GST_BIN (pipeline), sink);
+  gst_element_sync_state_with_parent (sink);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  if (gst_pad_link (pad, sinkpad) != GST_PAD_LINK_OK)
+    GST_WARNING ("Could not link %" GST_PTR_FORMAT, pad);
+
+  gst_object_unref (sinkpad);
+  gst_object_unref (pipeline);
+  gst_caps_unref (caps);
+  g_free (stream_id);
+}
+
+static gboolean
+_decode (PeaksJob * job, PeaksBuilder * builder)
+{
+  gboolean res = FALSE;
+  GstElement *pipeline, *decodebin;
+  PadAddedData data = { builder, job->stream_id };
+
+  decodebin = gst_element_factory_make ("uridecodebin", NULL);
+  if (decodebin == NULL) {
+    GST_ERROR ("Missing uridecodebin to compute peaks of %s", job->uri);
+
+    return FALSE;
+  }
+
+  pipeline = gst_pipeline_new ("audio-peaks");
+  g_object_set (decodebin, "uri", job->uri, NULL);
+  gst_bin_add (GST_BIN (pipeline), decodebin);
+  g_signal_connect (decodebin, "pad-added",
+      G_CALLBACK (_decoder_pad_added_cb), &data);
+
+  if (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE) {
+    res = ges_wait_for_eos (pipeline, &builder->progress,
+        GES_MEDIA_STALL_TIMEOUT);
+    if (!res)
+      GST_WARNING ("Could not decode %s", job->uri);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return res && builder->linked && builder->rate > 0;
+}
+
+/* Builds the pyramid in the layout it is saved in */
+static GBytes *
+_build (PeaksJob * job)
+{
+  guint i, j, n_levels;
+  gsize size, offset;
+  guint8 *data;
+  PeaksHeader *header;
+  PeaksLevel *levels;
+  GESAudioPeak *prev, *peaks;
+  PeaksBuilder builder = { 0, };
+
+  builder.level0 = g_array_new (FALSE, FALSE, sizeof (GESAudioPeak));
+  if (!_decode (job, &builder)) {
+    g_array_unref (builder.level0);
+
+    return NULL;
+  }
+  _push_peak (&builder);
+
+  n_levels = 1;
+  size = builder.level0->len;
+  for (i = builder.level0->len; i > 1 && n_levels < MAX_LEVELS; n_levels++) {
+    i = (i + 1) / 2;
+    size += i;
+  }
+
+  offset = sizeof (PeaksHeader) + n_levels * sizeof (PeaksLevel);
+  data = g_malloc (offset + size * sizeof (GESAudioPeak));
+
+  header = (PeaksHeader *) data;
+  header->magic = PEAKS_MAGIC;
+  header->version = PEAKS_VERSION;
+  header->rate = builder.rate;
+  header->n_levels = n_levels;
+
+  levels = (PeaksLevel *) (data + sizeof (PeaksHeader));
+  levels[0].samples_per_peak = BASE_SAMPLES_PER_PEAK;
+  levels[0].n_peaks = builder.level0->len;
+  levels[0].offset = offset;
+  memcpy (data + offset, builder.level0->data,
+      builder.level0->len * sizeof (GESAudioPeak));
+
+  for (i = 1; i < n_levels; i++) {
+    prev = (GESAudioPeak *) (data + levels[i - 1].offset);
+
+    levels[i].samples_per_peak = levels[i - 1].samples_per_peak * 2;
+    levels[i].n_peaks = (levels[i - 1].n_peaks + 1) / 2;
+    levels[i].offset = levels[i - 1].offset +
+        levels[i - 1].n_peaks * sizeof (GESAudioPeak);
+
+    peaks = (GESAudioPeak *) (data + levels[i].offset);
+    for (j = 0; j < levels[i].n_peaks; j++) {
+      peaks[j] = prev[2 * j];
+      if (2 * j + 1 < levels[i - 1].n_peaks) {
+        peaks[j].min = MIN (peaks[j].min, prev[2 * j + 1].min);
+        peaks[j].max = MAX (peaks[j].max, prev[2 * j + 1].max);
+      }
+    }
+  }
+
+  g_array_unref (builder.level0);
+
+  return g_bytes_new_take (data, offset + size * sizeof (GESAudioPeak));
+}
+
+static const PeaksHeader *
+_get_header (GBytes * bytes, const PeaksLevel ** levels)
+{
+  guint i;
+  gsize size;
+  const PeaksHeader *header = g_bytes_get_data (bytes, &size);
+
+  if (size < sizeof (PeaksHeader) || header->magic != PEAKS_MAGIC ||
+      header->version != PEAKS_VERSION || header->rate == 0 ||
+      header->n_levels == 0 || header->n_levels > MAX_LEVELS ||
+      size < sizeof (PeaksHeader) + header->n_levels * sizeof (PeaksLevel))
+    return NULL;
+
+  *levels = (const PeaksLevel *) (header + 1);
+  for (i = 0; i < header->n_levels; i++) {
+    if ((*levels)[i].offset > size || (*levels)[i].n_peaks >
+        (size - (*levels)[i].offset) / sizeof (GESAudioPeak))
+      return NULL;
+  }
+
+  return header;
+}
+
+static GBytes *
+_load (const gchar * location)
+{
+  GBytes *bytes;
+  const PeaksLevel *levels;
+
+  bytes = ges_media_cache_load (location);
+  if (bytes && _get_header (bytes, &levels) == NULL) {
+    GST_INFO ("Ignoring invalid peaks file %s", location);
+    g_bytes_unref (bytes);
+
+    return NULL;
+  }
+
+  return bytes;
+}
+
+static void
+_job_free (PeaksJob * job)
+{
+  if (job->notify)
+    job->notify (job->user_data);
+  if (job->peaks)
+    g_bytes_unref (job->peaks);
+
+  g_free (job->uri);
+  g_free (job->stream_id);
+  g_slice_free (PeaksJob, job);
+}
+
+static gboolean
+_job_done (PeaksJob * job)
+{
+  job->func (job->peaks, job->user_data);
+
+  return FALSE;
+}
+
+static void
+_run_job (PeaksJob * job, gpointer unused)
+{
+  gchar *location, *extra;
+
+  extra = g_strdup_printf ("%s\n%d\n%d", job->stream_id, PEAKS_VERSION,
+      BASE_SAMPLES_PER_PEAK);
+  location = ges_get_media_cache_location (job->uri, "peaks", extra);
+  g_free (extra);
+
+  job->peaks = _load (location);
+  if (job->peaks) {
+    GST_DEBUG ("Using cached peaks of %s from %s", job->uri, location);
+  } else {
+    GST_DEBUG ("Computing peaks of %s (%s)", job->uri, job->stream_id);
+
+    job->peaks = _build (job);
+    if (job->peaks)
+      ges_media_cache_save (location, job->peaks);
+  }
+  g_free (location);
+
+  g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, (GSourceFunc) _job_done, job,
+      (GDestroyNotify) _job_free);
+}
+
+/*****************************************************
+ *                   Internal API                    *
+ *****************************************************/
+void
+ges_audio_peaks_init (void)
+{
+  if (peaks_pool)
+    return;
+
+  peaks_pool = g_thread_pool_new ((GFunc) _run_job, NULL, MAX_PEAKS_THREADS,
+      FALSE, NULL);
+}
+
+/* Gets the peaks of the stream @stream_id of @uri from the disk cache, or
+ * computes them, in a background thread. @func is called from the default
+ * main context with the peaks, or %NULL if they could not be computed */
+void
+ges_audio_peaks_request (const gchar * uri, const gchar * stream_id,
+    GESAudioPeaksReadyFunc func, gpointer user_data, GDestroyNotify notify)
+{
+  PeaksJob *job = g_slice_new0 (PeaksJob);
+
+  job->uri = g_strdup (uri);
+  job->stream_id = g_strdup (stream_id);
+  job->func = func;
+  job->user_data = user_data;
+  job->notify = notify;
+
+  g_thread_pool_push (peaks_pool, job, NULL);
+}
+
+/* Returns the GESAudioPeak-s of @peaks between @start and @stop at the
+ * lowest resolution that still has at least one peak per
+ * @samples_per_pixel samples, pointing to the memory of @peaks */
+GBytes *
+ges_audio_peaks_get_range (GBytes * peaks, GstClockTime start,
+    GstClockTime stop, guint samples_per_pixel, guint * samples_per_peak)
+{
+  guint i;
+  guint64 first, last;
+  const PeaksHeader *header;
+  const PeaksLevel *levels, *level;
+
+  header = _get_header (peaks, &levels);
+  g_return_val_if_fail (header, NULL);
+
+  level = &levels[0];
+  for (i = 1; i < header->n_levels; i++) {
+    if (levels[i].samples_per_peak > samples_per_pixel)
+      break;
+
+    level = &levels[i];
+  }
+
+  first = gst_util_uint64_scale (start, header->rate,
+      GST_SECOND * (guint64) level->samples_per_peak);
+  last = GST_CLOCK_TIME_IS_VALID (stop) ?
+      gst_util_uint64_scale_ceil (stop, header->rate,
+      GST_SECOND * (guint64) level->samples_per_peak) : level->n_peaks;
+
+  first = MIN (first, level->n_peaks);
+  last = CLAMP (last, first, level->n_peaks);
+
+  if (samples_per_peak)
+    *samples_per_peak = level->samples_per_peak;
+
+  return g_bytes_new_from_bytes (peaks, level->offset +
+      first * sizeof (GESAudioPeak), (last - first) * sizeof (GESAudioPeak));
+}
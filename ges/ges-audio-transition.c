@@ -26,24 +26,27 @@
 #include "ges-internal.h"
 #include "ges-track-element.h"
 #include "ges-audio-transition.h"
-
-#include <gst/controller/gstdirectcontrolbinding.h>
+#include "gstaudiofade.h"
 
 G_DEFINE_TYPE (GESAudioTransition, ges_audio_transition, GES_TYPE_TRANSITION);
 
 struct _GESAudioTransitionPrivate
 {
-  /* these enable volume interpolation. Unlike video, both inputs are adjusted
-   * simultaneously */
-  GstControlSource *a_control_source;
+  /* Unlike video, both inputs are adjusted simultaneously, one is faded out
+   * while the other is faded in */
+  GstElement *a_fade;
 
-  GstControlSource *b_control_source;
+  GstElement *b_fade;
 
+  GESAudioFadeCurve fade_curve;
+  gdouble *custom_values;
+  guint n_custom_values;
 };
 
 enum
 {
   PROP_0,
+  PROP_FADE_CURVE,
 };
 
 
@@ -89,6 +92,16 @@ ges_audio_transition_class_init (GESAudioTransitionClass * klass)
 
   toclass->create_element = ges_audio_transition_create_element;
 
+  /**
+   * GESAudioTransition:fade-curve:
+   *
+   * The shape of the gain curves used for the crossfade.
+   */
+  g_object_class_install_property (object_class, PROP_FADE_CURVE,
+      g_param_spec_enum ("fade-curve", "Fade curve",
+          "The shape of the gain curves used for the crossfade",
+          GES_TYPE_AUDIO_FADE_CURVE, GES_AUDIO_FADE_CURVE_LINEAR,
+          G_PARAM_READWRITE));
 }
 
 static void
@@ -97,6 +110,8 @@ ges_audio_transition_init (GESAudioTransition * self)
 
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
       GES_TYPE_AUDIO_TRANSITION, GESAudioTransitionPrivate);
+
+  self->priv->fade_curve = GES_AUDIO_FADE_CURVE_LINEAR;
 }
 
 static void
@@ -106,16 +121,14 @@ ges_audio_transition_dispose (GObject * object)
 
   self = GES_AUDIO_TRANSITION (object);
 
-  if (self->priv->a_control_source) {
-    if (self->priv->a_control_source)
-      gst_object_unref (self->priv->a_control_source);
-    self->priv->a_control_source = NULL;
+  if (self->priv->a_fade) {
+    gst_object_unref (self->priv->a_fade);
+    self->priv->a_fade = NULL;
   }
 
-  if (self->priv->b_control_source) {
-    if (self->priv->b_control_source)
-      gst_object_unref (self->priv->b_control_source);
-    self->priv->b_control_source = NULL;
+  if (self->priv->b_fade) {
+    gst_object_unref (self->priv->b_fade);
+    self->priv->b_fade = NULL;
   }
 
   g_signal_handlers_disconnect_by_func (GES_TRACK_ELEMENT (self),
@@ -127,6 +140,8 @@ ges_audio_transition_dispose (GObject * object)
 static void
 ges_audio_transition_finalize (GObject * object)
 {
+  g_free (GES_AUDIO_TRANSITION (object)->priv->custom_values);
+
   G_OBJECT_CLASS (ges_audio_transition_parent_class)->finalize (object);
 }
 
@@ -134,39 +149,67 @@ static void
 ges_audio_transition_get_property (GObject * object,
     guint property_id, GValue * value, GParamSpec * pspec)
 {
+  GESAudioTransition *self = GES_AUDIO_TRANSITION (object);
+
   switch (property_id) {
+    case PROP_FADE_CURVE:
+      g_value_set_enum (value, self->priv->fade_curve);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
 }
 
+static void
+_update_fade_curves (GESAudioTransition * self)
+{
+  GstElement *fades[] = { self->priv->a_fade, self->priv->b_fade };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (fades); i++) {
+    if (fades[i] == NULL)
+      continue;
+
+    gst_audio_fade_set_custom_curve (GST_AUDIO_FADE (fades[i]),
+        self->priv->custom_values, self->priv->n_custom_values);
+    g_object_set (fades[i], "curve", self->priv->fade_curve, NULL);
+  }
+}
+
 static void
 ges_audio_transition_set_property (GObject * object,
     guint property_id, const GValue * value, GParamSpec * pspec)
 {
+  GESAudioTransition *self = GES_AUDIO_TRANSITION (object);
+
   switch (property_id) {
+    case PROP_FADE_CURVE:
+      self->priv->fade_curve = g_value_get_enum (value);
+      _update_fade_curves (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
 }
 
-static GObject *
-link_element_to_mixer_with_volume (GstBin * bin, GstElement * element,
-    GstElement * mixer)
+static GstElement *
+link_element_to_mixer_with_fade (GstBin * bin, GstElement * element,
+    GstElement * mixer, gboolean fade_in)
 {
-  GstElement *volume = gst_element_factory_make ("volume", NULL);
+  GstElement *fade = g_object_new (GST_TYPE_AUDIO_FADE, "fade-in", fade_in,
+      NULL);
   GstElement *resample = gst_element_factory_make ("audioresample", NULL);
 
-  gst_bin_add (bin, volume);
+  gst_bin_add (bin, fade);
   gst_bin_add (bin, resample);
 
-  if (!fast_element_link (element, volume) ||
-      !fast_element_link (volume, resample) ||
+  if (!fast_element_link (element, fade) ||
+      !fast_element_link (fade, resample) ||
       !gst_element_link_pads_full (resample, "src", mixer, "sink_%u",
           GST_PAD_LINK_CHECK_NOTHING))
-    GST_ERROR_OBJECT (bin, "Error linking volume to mixer");
+    GST_ERROR_OBJECT (bin, "Error linking fade to mixer");
 
-  return G_OBJECT (volume);
+  return gst_object_ref (fade);
 }
 
 static GstElement *
@@ -174,12 +217,9 @@ ges_audio_transition_create_element (GESTrackElement * track_element)
 {
   GESAudioTransition *self;
   GstElement *topbin, *iconva, *iconvb, *oconv;
-  GObject *atarget, *btarget = NULL;
-  const gchar *propname = "volume";
   GstElement *mixer = NULL;
   GstPad *sinka_target, *sinkb_target, *src_target, *sinka, *sinkb, *src;
   guint64 duration;
-  GstControlSource *acontrol_source, *bcontrol_source;
 
   self = GES_AUDIO_TRANSITION (track_element);
 
@@ -195,10 +235,12 @@ ges_audio_transition_create_element (GESTrackElement * track_element)
   mixer = gst_element_factory_make ("adder", NULL);
   gst_bin_add (GST_BIN (topbin), mixer);
 
-  atarget = link_element_to_mixer_with_volume (GST_BIN (topbin), iconva, mixer);
-  btarget = link_element_to_mixer_with_volume (GST_BIN (topbin), iconvb, mixer);
-
-  g_assert (atarget && btarget);
+  /* The fades apply gains precomputed from the curve, no controller needs
+   * to be evaluated while streaming */
+  self->priv->a_fade = link_element_to_mixer_with_fade (GST_BIN (topbin),
+      iconva, mixer, FALSE);
+  self->priv->b_fade = link_element_to_mixer_with_fade (GST_BIN (topbin),
+      iconvb, mixer, TRUE);
 
   fast_element_link (mixer, oconv);
 
@@ -214,20 +256,11 @@ ges_audio_transition_create_element (GESTrackElement * track_element)
   gst_element_add_pad (topbin, sinka);
   gst_element_add_pad (topbin, sinkb);
 
-  /* set up interpolation */
-
   gst_object_unref (sinka_target);
   gst_object_unref (sinkb_target);
   gst_object_unref (src_target);
 
-  acontrol_source = gst_interpolation_control_source_new ();
-  g_object_set (acontrol_source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
-
-  bcontrol_source = gst_interpolation_control_source_new ();
-  g_object_set (bcontrol_source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
-
-  self->priv->a_control_source = acontrol_source;
-  self->priv->b_control_source = bcontrol_source;
+  _update_fade_curves (self);
 
   duration =
       ges_timeline_element_get_duration (GES_TIMELINE_ELEMENT (track_element));
@@ -236,16 +269,6 @@ ges_audio_transition_create_element (GESTrackElement * track_element)
   g_signal_connect (track_element, "notify::duration",
       G_CALLBACK (duration_changed_cb), NULL);
 
-  gst_object_add_control_binding (GST_OBJECT (atarget),
-      gst_direct_control_binding_new (GST_OBJECT (atarget), propname,
-          acontrol_source));
-  gst_object_add_control_binding (GST_OBJECT (btarget),
-      gst_direct_control_binding_new (GST_OBJECT (btarget), propname,
-          bcontrol_source));
-
-  self->priv->a_control_source = acontrol_source;
-  self->priv->b_control_source = bcontrol_source;
-
   return topbin;
 }
 
@@ -253,33 +276,16 @@ static void
 ges_audio_transition_duration_changed (GESTrackElement * track_element,
     guint64 duration)
 {
-  GESAudioTransition *self;
-  GstElement *gnlobj = ges_track_element_get_gnlobject (track_element);
-  GstTimedValueControlSource *ta, *tb;
-
-  self = GES_AUDIO_TRANSITION (track_element);
-
-  GST_INFO ("updating controller: gnlobj (%p)", gnlobj);
+  GESAudioTransition *self = GES_AUDIO_TRANSITION (track_element);
 
-  if (G_UNLIKELY ((!self->priv->a_control_source ||
-              !self->priv->b_control_source)))
+  if (G_UNLIKELY (!self->priv->a_fade || !self->priv->b_fade))
     return;
 
-  GST_INFO ("setting values on controller");
-  ta = GST_TIMED_VALUE_CONTROL_SOURCE (self->priv->a_control_source);
-  tb = GST_TIMED_VALUE_CONTROL_SOURCE (self->priv->b_control_source);
-
-  gst_timed_value_control_source_unset_all (ta);
-  gst_timed_value_control_source_unset_all (tb);
-  /* The volume property goes from 0 to 10, so we want to interpolate between
-   * 0 and 0.1 */
-  gst_timed_value_control_source_set (ta, 0, 0.1);
-  gst_timed_value_control_source_set (ta, duration, 0.0);
-
-  gst_timed_value_control_source_set (tb, 0, 0.0);
-  gst_timed_value_control_source_set (tb, duration, 0.1);
+  GST_INFO ("setting fades duration to %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (duration));
 
-  GST_INFO ("done updating controller");
+  g_object_set (self->priv->a_fade, "duration", duration, NULL);
+  g_object_set (self->priv->b_fade, "duration", duration, NULL);
 }
 
 /**
@@ -295,3 +301,28 @@ ges_audio_transition_new (void)
   return g_object_new (GES_TYPE_AUDIO_TRANSITION, "track-type",
       GES_TRACK_TYPE_AUDIO, NULL);
 }
+
+/**
+ * ges_audio_transition_set_custom_fade_curve:
+ * @self: The #GESAudioTransition
+ * @values: (array length=n_values): The gains of the input being faded in,
+ * between 0.0 and 1.0, evenly spread over the duration of the transition
+ * @n_values: The number of gains in @values, at least 2
+ *
+ * Sets the curve used when #GESAudioTransition:fade-curve is
+ * #GES_AUDIO_FADE_CURVE_CUSTOM. The input being faded out follows the same
+ * curve, reversed.
+ */
+void
+ges_audio_transition_set_custom_fade_curve (GESAudioTransition * self,
+    const gdouble * values, guint n_values)
+{
+  g_return_if_fail (GES_IS_AUDIO_TRANSITION (self));
+  g_return_if_fail (values != NULL && n_values >= 2);
+
+  g_free (self->priv->custom_values);
+  self->priv->custom_values = g_memdup (values, n_values * sizeof (gdouble));
+  self->priv->n_custom_values = n_values;
+
+  _update_fade_curves (self);
+}
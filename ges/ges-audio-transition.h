@@ -71,6 +71,9 @@ struct _GESAudioTransitionClass {
 GType ges_audio_transition_get_type (void);
 
 GESAudioTransition* ges_audio_transition_new (void);
+void ges_audio_transition_set_custom_fade_curve (GESAudioTransition *self,
+                                                 const gdouble *values,
+                                                 guint n_values);
 
 G_END_DECLS
 
@@ -33,6 +33,8 @@ G_DEFINE_ABSTRACT_TYPE (GESBaseXmlFormatter, ges_base_xml_formatter,
 
 
 static gboolean _loading_done_cb (GESFormatter * self);
+static void _build_clips (GESFormatter * self);
+static void _index_clips (GESFormatter * self);
 
 typedef struct PendingEffects
 {
@@ -51,17 +53,31 @@ typedef struct PendingBinding
   gchar *binding_type;
 } PendingBinding;
 
+typedef struct PendingMarker
+{
+  GstClockTime position;
+  gchar *metadatas;
+} PendingMarker;
+
+/* The intermediate representation of a clip, filled while parsing. The
+ * GESClip is only built once all the assets have been loaded */
 typedef struct PendingClip
 {
   gchar *id;
   guint layer_prio;
   GstClockTime start;
   GstClockTime inpoint;
+  /* Set once the asset is loaded, stays %NULL if it can not be */
   GESAsset *asset;
   GstClockTime duration;
   GESTrackType track_types;
   GESLayer *layer;
 
+  /* Built from a worker thread */
+  GESClip *clip;
+  /* Set once it has been built, or tried to be */
+  gboolean loaded;
+
   GstStructure *properties;
   gchar *metadatas;
 
@@ -69,10 +85,33 @@ typedef struct PendingClip
 
   GList *pending_bindings;
 
+  GList *pending_markers;
+
   /* TODO Implement asset effect management
    * PendingTrackElements *track_elements; */
 } PendingClip;
 
+/* A slice of the clips of a layer, built by a worker thread */
+typedef struct BuildTask
+{
+  GPtrArray *clips;
+  guint first;
+  guint last;
+} BuildTask;
+
+/* Clips are built by tasks of at most that many clips of the same layer */
+#define BUILD_TASK_SIZE 256
+
+/* The clips of a layer when loading lazily */
+typedef struct LazyLayer
+{
+  /* PendingClip sorted by start */
+  GPtrArray *clips;
+  /* Of the longest clip, GST_CLOCK_TIME_NONE if a duration is unknown */
+  GstClockTime max_duration;
+  guint n_left;
+} LazyLayer;
+
 typedef struct LayerEntry
 {
   GESLayer *layer;
@@ -86,20 +125,22 @@ typedef struct PendingAsset
   GstStructure *properties;
 } PendingAsset;
 
+static void _free_pending_clip (PendingClip * pend);
+
 struct _GESBaseXmlFormatterPrivate
 {
   GMarkupParseContext *parsecontext;
   gboolean check_only;
 
-  /* Asset.id -> PendingClip */
+  /* All the PendingClip in document order, owns them */
+  GPtrArray *pending_clips;
+
+  /* Asset.id -> GPtrArray of the PendingClip waiting for the asset */
   GHashTable *assetid_pendingclips;
 
   /* Clip.ID -> Pending */
   GHashTable *clipid_pendings;
 
-  /* Clip.ID -> Clip */
-  GHashTable *clips;
-
   /* ID -> track */
   GHashTable *tracks;
 
@@ -112,9 +153,15 @@ struct _GESBaseXmlFormatterPrivate
   /* current track element */
   GESTrackElement *current_track_element;
 
-  GESClip *current_clip;
   PendingClip *current_pending_clip;
 
+  /* Not reffed, the LayerEntry holds a reference */
+  GESLayer *current_layer;
+
+  /* GESLayer -> LazyLayer, the clips the timeline did not need yet */
+  GHashTable *lazy_layers;
+  guint n_lazy_clips;
+
   gboolean timeline_auto_transition;
 };
 
@@ -125,6 +172,13 @@ _free_layer_entry (LayerEntry * entry)
   g_slice_free (LayerEntry, entry);
 }
 
+static void
+_free_lazy_layer (LazyLayer * llayer)
+{
+  g_ptr_array_unref (llayer->clips);
+  g_slice_free (LazyLayer, llayer);
+}
+
 /*
 enum
 {
@@ -325,10 +379,11 @@ _dispose (GObject * object)
 
   g_clear_pointer (&priv->assetid_pendingclips,
       (GDestroyNotify) g_hash_table_unref);
-  g_clear_pointer (&priv->clips, (GDestroyNotify) g_hash_table_unref);
   g_clear_pointer (&priv->clipid_pendings, (GDestroyNotify) g_hash_table_unref);
+  g_clear_pointer (&priv->pending_clips, (GDestroyNotify) g_ptr_array_unref);
   g_clear_pointer (&priv->tracks, (GDestroyNotify) g_hash_table_unref);
   g_clear_pointer (&priv->layers, (GDestroyNotify) g_hash_table_unref);
+  g_clear_pointer (&priv->lazy_layers, (GDestroyNotify) g_hash_table_unref);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
@@ -358,19 +413,21 @@ ges_base_xml_formatter_init (GESBaseXmlFormatter * self)
   priv->parsecontext = NULL;
   priv->pending_assets = NULL;
 
-  /* The PendingClip are owned by the assetid_pendingclips table */
+  /* The PendingClip are owned by the pending_clips array */
+  priv->pending_clips =
+      g_ptr_array_new_with_free_func ((GDestroyNotify) _free_pending_clip);
   priv->assetid_pendingclips = g_hash_table_new_full (g_str_hash,
-      g_str_equal, g_free, NULL);
+      g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
   priv->clipid_pendings = g_hash_table_new_full (g_str_hash,
       g_str_equal, g_free, NULL);
-  priv->clips = g_hash_table_new_full (g_str_hash,
-      g_str_equal, g_free, gst_object_unref);
   priv->tracks = g_hash_table_new_full (g_str_hash,
       g_str_equal, g_free, gst_object_unref);
   priv->layers = g_hash_table_new_full (g_direct_hash,
       g_direct_equal, NULL, (GDestroyNotify) _free_layer_entry);
+  priv->lazy_layers = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, NULL, (GDestroyNotify) _free_lazy_layer);
+  priv->n_lazy_clips = 0;
   priv->current_track_element = NULL;
-  priv->current_clip = NULL;
   priv->current_pending_clip = NULL;
   priv->timeline_auto_transition = FALSE;
 }
@@ -423,6 +480,11 @@ _loading_done (GESFormatter * self)
     g_markup_parse_context_free (priv->parsecontext);
   priv->parsecontext = NULL;
 
+  if (ges_project_get_lazy_loading (self->project))
+    _index_clips (self);
+  else
+    _build_clips (self);
+
   ges_timeline_set_auto_transition (self->timeline,
       priv->timeline_auto_transition);
 
@@ -461,35 +523,6 @@ set_property_foreach (GQuark field_id, const GValue * value, GObject * object)
   g_object_set_property (object, g_quark_to_string (field_id), value);
 }
 
-static inline GESClip *
-_add_object_to_layer (GESBaseXmlFormatterPrivate * priv, const gchar * id,
-    GESLayer * layer, GESAsset * asset, GstClockTime start,
-    GstClockTime inpoint, GstClockTime duration,
-    GESTrackType track_types, const gchar * metadatas,
-    GstStructure * properties)
-{
-  GESClip *clip = ges_layer_add_asset (layer,
-      asset, start, inpoint, duration, track_types);
-
-  if (clip == NULL) {
-    GST_WARNING_OBJECT (clip, "Could not add object from asset: %s",
-        ges_asset_get_id (asset));
-
-    return NULL;
-  }
-
-  if (metadatas)
-    ges_meta_container_add_metas_from_string (GES_META_CONTAINER (clip),
-        metadatas);
-
-  if (properties)
-    gst_structure_foreach (properties,
-        (GstStructureForeachFunc) set_property_foreach, clip);
-
-  g_hash_table_insert (priv->clips, g_strdup (id), gst_object_ref (clip));
-  return clip;
-}
-
 static void
 _add_track_element (GESFormatter * self, GESClip * clip,
     GESTrackElement * trackelement, const gchar * track_id,
@@ -516,9 +549,11 @@ _add_track_element (GESFormatter * self, GESClip * clip,
 static void
 _free_pending_binding (PendingBinding * pend)
 {
+  gst_object_unref (pend->source);
   g_free (pend->propname);
   g_free (pend->binding_type);
   g_free (pend->track_id);
+  g_slice_free (PendingBinding, pend);
 }
 
 static void
@@ -535,15 +570,28 @@ _free_pending_effect (PendingEffects * pend)
 }
 
 static void
-_free_pending_clip (GESBaseXmlFormatterPrivate * priv, PendingClip * pend)
+_free_pending_marker (PendingMarker * pmarker)
+{
+  g_free (pmarker->metadatas);
+  g_slice_free (PendingMarker, pmarker);
+}
+
+static void
+_free_pending_clip (PendingClip * pend)
 {
   gst_object_unref (pend->layer);
+  if (pend->asset)
+    gst_object_unref (pend->asset);
+  if (pend->clip)
+    gst_object_unref (pend->clip);
   if (pend->properties)
     gst_structure_free (pend->properties);
+  g_free (pend->metadatas);
   g_list_free_full (pend->effects, (GDestroyNotify) _free_pending_effect);
   g_list_free_full (pend->pending_bindings,
       (GDestroyNotify) _free_pending_binding);
-  g_hash_table_remove (priv->clipid_pendings, pend->id);
+  g_list_free_full (pend->pending_markers,
+      (GDestroyNotify) _free_pending_marker);
   g_free (pend->id);
   g_slice_free (PendingClip, pend);
 }
@@ -576,12 +624,494 @@ _add_pending_bindings (GESBaseXmlFormatterPrivate * priv, GList * bindings,
   }
 }
 
+static GESMarker *
+_add_marker (GESMarkerList * markers, GstClockTime position,
+    const gchar * metadatas)
+{
+  GESMarker *marker = ges_marker_list_add (markers, position);
+
+  if (marker && metadatas)
+    ges_meta_container_add_metas_from_string (GES_META_CONTAINER (marker),
+        metadatas);
+
+  return marker;
+}
+
+static void
+_add_pending_markers (GList * markers, GESClip * clip)
+{
+  GList *tmp;
+
+  for (tmp = markers; tmp; tmp = tmp->next) {
+    PendingMarker *pmarker = tmp->data;
+
+    _add_marker (ges_clip_get_marker_list (clip), pmarker->position,
+        pmarker->metadatas);
+  }
+}
+
+/* Returns the clips waiting for the asset @id to be loaded */
+static GPtrArray *
+_get_clips_waiting_for (GESBaseXmlFormatterPrivate * priv, const gchar * id)
+{
+  GPtrArray *clips = g_hash_table_lookup (priv->assetid_pendingclips, id);
+
+  if (clips == NULL) {
+    clips = g_ptr_array_new ();
+    g_hash_table_insert (priv->assetid_pendingclips, g_strdup (id), clips);
+  }
+
+  return clips;
+}
+
+/* Runs in a worker thread, @pend->clip is not reachable from anywhere else
+ * until it is added to its layer */
+static void
+_build_clip (PendingClip * pend)
+{
+  GESClip *clip = GES_CLIP (ges_asset_extract (pend->asset, NULL));
+
+  if (clip == NULL) {
+    GST_WARNING ("Could not create clip from asset: %s",
+        ges_asset_get_id (pend->asset));
+
+    return;
+  }
+
+  _set_start0 (GES_TIMELINE_ELEMENT (clip), pend->start);
+  _set_inpoint0 (GES_TIMELINE_ELEMENT (clip), pend->inpoint);
+  if (pend->track_types != GES_TRACK_TYPE_UNKNOWN)
+    ges_clip_set_supported_formats (clip, pend->track_types);
+  if (GST_CLOCK_TIME_IS_VALID (pend->duration))
+    _set_duration0 (GES_TIMELINE_ELEMENT (clip), pend->duration);
+
+  if (pend->metadatas)
+    ges_meta_container_add_metas_from_string (GES_META_CONTAINER (clip),
+        pend->metadatas);
+
+  if (pend->properties)
+    gst_structure_foreach (pend->properties,
+        (GstStructureForeachFunc) set_property_foreach, clip);
+
+  _add_pending_markers (pend->pending_markers, clip);
+
+  pend->clip = gst_object_ref_sink (clip);
+}
+
+static void
+_run_build_task (BuildTask * task, gpointer unused)
+{
+  guint i;
+
+  for (i = task->first; i < task->last; i++)
+    _build_clip (g_ptr_array_index (task->clips, i));
+
+  g_slice_free (BuildTask, task);
+}
+
+/* Adding the clips in decreasing start order makes the layer insert each of
+ * them at the head of its sorted list of clips */
+static gint
+_compare_pending_clips_reverse (PendingClip ** a, PendingClip ** b)
+{
+  return element_start_compare (GES_TIMELINE_ELEMENT ((*b)->clip),
+      GES_TIMELINE_ELEMENT ((*a)->clip));
+}
+
+static void
+_attach_clip (GESFormatter * self, PendingClip * pend)
+{
+  GList *tmp;
+  GESBaseXmlFormatterPrivate *priv = _GET_PRIV (self);
+
+  /* The layer takes our reference */
+  if (!_ges_layer_add_clip_full (pend->layer, gst_object_ref (pend->clip),
+          FALSE)) {
+    GST_WARNING_OBJECT (self, "Could not add clip %s to its layer", pend->id);
+    gst_object_unref (pend->clip);
+
+    return;
+  }
+
+  _add_pending_bindings (priv, pend->pending_bindings, pend->clip);
+
+  GST_DEBUG_OBJECT (self, "Adding %i effect to new object",
+      g_list_length (pend->effects));
+  for (tmp = pend->effects; tmp; tmp = tmp->next) {
+    PendingEffects *peffect = (PendingEffects *) tmp->data;
+
+    /* We keep a ref as _free_pending_effect unrefs it */
+    _add_track_element (self, pend->clip,
+        gst_object_ref (peffect->trackelement), peffect->track_id,
+        peffect->children_properties, peffect->properties);
+  }
+}
+
+/* Once its clip has been added to its layer, only what is needed to index
+ * a PendingClip is kept */
+static void
+_pending_clip_loaded (PendingClip * pend)
+{
+  pend->loaded = TRUE;
+
+  if (pend->clip) {
+    gst_object_unref (pend->clip);
+    pend->clip = NULL;
+  }
+  if (pend->properties) {
+    gst_structure_free (pend->properties);
+    pend->properties = NULL;
+  }
+  g_free (pend->metadatas);
+  pend->metadatas = NULL;
+  g_list_free_full (pend->effects, (GDestroyNotify) _free_pending_effect);
+  pend->effects = NULL;
+  g_list_free_full (pend->pending_bindings,
+      (GDestroyNotify) _free_pending_binding);
+  pend->pending_bindings = NULL;
+  g_list_free_full (pend->pending_markers,
+      (GDestroyNotify) _free_pending_marker);
+  pend->pending_markers = NULL;
+}
+
+/* Builds the clips of @layer_clips, GESLayer -> GPtrArray of PendingClip,
+ * from worker threads, and then adds them to their layers in one go */
+static void
+_build_layer_clips (GESFormatter * self, GHashTable * layer_clips)
+{
+  guint i, n_clips = 0;
+  GPtrArray *clips;
+  GThreadPool *pool = NULL;
+  GHashTableIter iter;
+  BuildTask *task;
+
+  g_hash_table_iter_init (&iter, layer_clips);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & clips))
+    n_clips += clips->len;
+
+  GST_DEBUG_OBJECT (self, "Building %u clips in %u layers", n_clips,
+      g_hash_table_size (layer_clips));
+
+  /* Not worth starting threads when a single task is needed */
+  if (n_clips > BUILD_TASK_SIZE)
+    pool = g_thread_pool_new ((GFunc) _run_build_task, NULL,
+        g_get_num_processors (), FALSE, NULL);
+
+  g_hash_table_iter_init (&iter, layer_clips);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & clips)) {
+    for (i = 0; i < clips->len; i += BUILD_TASK_SIZE) {
+      task = g_slice_new (BuildTask);
+      task->clips = clips;
+      task->first = i;
+      task->last = MIN (i + BUILD_TASK_SIZE, clips->len);
+
+      if (pool)
+        g_thread_pool_push (pool, task, NULL);
+      else
+        _run_build_task (task, NULL);
+    }
+  }
+  /* Wait for all the clips to be built */
+  if (pool)
+    g_thread_pool_free (pool, FALSE, TRUE);
+
+  g_hash_table_iter_init (&iter, layer_clips);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & clips)) {
+    guint n_built = 0;
+
+    for (i = 0; i < clips->len; i++) {
+      PendingClip *pend = g_ptr_array_index (clips, i);
+
+      if (pend->clip)
+        g_ptr_array_index (clips, n_built++) = pend;
+      else
+        _pending_clip_loaded (pend);
+    }
+    g_ptr_array_set_size (clips, n_built);
+
+    /* Stable, so clips comparing equal end up in the same order as when
+     * they were added in document order */
+    g_ptr_array_sort (clips, (GCompareFunc) _compare_pending_clips_reverse);
+    for (i = 0; i < clips->len; i++) {
+      PendingClip *pend = g_ptr_array_index (clips, i);
+
+      _attach_clip (self, pend);
+      _pending_clip_loaded (pend);
+    }
+  }
+}
+
+/* Builds the clips of all the layers */
+static void
+_build_clips (GESFormatter * self)
+{
+  guint i;
+  GPtrArray *clips;
+  GHashTable *layer_clips;
+  GESBaseXmlFormatterPrivate *priv = _GET_PRIV (self);
+
+  if (priv->pending_clips->len == 0)
+    return;
+
+  layer_clips = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) g_ptr_array_unref);
+  for (i = 0; i < priv->pending_clips->len; i++) {
+    PendingClip *pend = g_ptr_array_index (priv->pending_clips, i);
+
+    /* Its asset could not be loaded */
+    if (pend->asset == NULL)
+      continue;
+
+    clips = g_hash_table_lookup (layer_clips, pend->layer);
+    if (clips == NULL) {
+      clips = g_ptr_array_new ();
+      g_hash_table_insert (layer_clips, pend->layer, clips);
+    }
+    g_ptr_array_add (clips, pend);
+  }
+
+  _build_layer_clips (self, layer_clips);
+  g_hash_table_unref (layer_clips);
+
+  g_hash_table_remove_all (priv->clipid_pendings);
+  g_ptr_array_set_size (priv->pending_clips, 0);
+}
+
+static gint
+_compare_pending_clips_start (PendingClip ** a, PendingClip ** b)
+{
+  if ((*a)->start < (*b)->start)
+    return -1;
+
+  return (*a)->start > (*b)->start;
+}
+
+static GstClockTime
+_pending_clip_end (PendingClip * pend)
+{
+  if (GST_CLOCK_TIME_IS_VALID (pend->duration))
+    return pend->start + pend->duration;
+
+  /* The clip will get the duration of its media */
+  if (GES_IS_URI_CLIP_ASSET (pend->asset))
+    return pend->start +
+        ges_uri_clip_asset_get_duration (GES_URI_CLIP_ASSET (pend->asset));
+
+  return pend->start;
+}
+
+static gboolean
+_pending_clip_has_meta (PendingClip * pend, const gchar * meta_item)
+{
+  GList *tmp;
+  gboolean ret = FALSE;
+  GstStructure *metas;
+
+  if (pend->metadatas) {
+    metas = gst_structure_from_string (pend->metadatas, NULL);
+    if (metas) {
+      ret = gst_structure_has_field (metas, meta_item);
+      gst_structure_free (metas);
+    }
+  }
+
+  for (tmp = pend->effects; tmp && !ret; tmp = tmp->next) {
+    PendingEffects *peffect = tmp->data;
+
+    ret = ges_meta_container_get_meta (GES_META_CONTAINER
+        (peffect->trackelement), meta_item) != NULL;
+  }
+
+  return ret;
+}
+
+/* The end of the clips of @llayer that have not been loaded yet */
+static GstClockTime
+_lazy_layer_unloaded_end (LazyLayer * llayer)
+{
+  guint i;
+  GstClockTime end = 0;
+
+  for (i = llayer->clips->len; i > 0; i--) {
+    PendingClip *pend = g_ptr_array_index (llayer->clips, i - 1);
+
+    /* The clips starting before can not end later */
+    if (GST_CLOCK_TIME_IS_VALID (llayer->max_duration) &&
+        pend->start + llayer->max_duration <= end)
+      break;
+
+    if (!pend->loaded)
+      end = MAX (end, _pending_clip_end (pend));
+  }
+
+  return end;
+}
+
+/* Takes the clips of @llayer overlapping [@start, @stop) that have not been
+ * loaded yet, extracted from @asset and having @meta_item set if not %NULL */
+static GPtrArray *
+_lazy_layer_take_range (LazyLayer * llayer, GstClockTime start,
+    GstClockTime stop, GESAsset * asset, const gchar * meta_item)
+{
+  guint first = 0, last = llayer->clips->len;
+  GstClockTime from = 0;
+  GPtrArray *clips = g_ptr_array_new ();
+
+  /* Clips starting before that end before @start */
+  if (GST_CLOCK_TIME_IS_VALID (llayer->max_duration) &&
+      start > llayer->max_duration)
+    from = start - llayer->max_duration;
+
+  while (first < last) {
+    guint middle = first + (last - first) / 2;
+    PendingClip *pend = g_ptr_array_index (llayer->clips, middle);
+
+    if (pend->start < from)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+
+  for (; first < llayer->clips->len; first++) {
+    PendingClip *pend = g_ptr_array_index (llayer->clips, first);
+
+    if (pend->start >= stop)
+      break;
+
+    if (pend->loaded)
+      continue;
+
+    if (pend->start < start && GST_CLOCK_TIME_IS_VALID (pend->duration) &&
+        pend->start + pend->duration <= start)
+      continue;
+
+    if (asset && pend->asset != asset)
+      continue;
+
+    if (meta_item && !_pending_clip_has_meta (pend, meta_item))
+      continue;
+
+    /* Never taken again, even if it can not be built */
+    pend->loaded = TRUE;
+    llayer->n_left--;
+    g_ptr_array_add (clips, pend);
+  }
+
+  return clips;
+}
+
+/* The GESTimelineLoadRangeFunc of the timelines we loaded lazily */
+static gboolean
+_load_range (GESTimeline * timeline, GESLayer * layer, GstClockTime start,
+    GstClockTime stop, GESAsset * asset, const gchar * meta_item,
+    GstClockTime * unloaded_end, GESFormatter * self)
+{
+  GESLayer *key;
+  GPtrArray *clips;
+  LazyLayer *llayer;
+  GHashTableIter iter;
+  GHashTable *layer_clips;
+  GESBaseXmlFormatterPrivate *priv = _GET_PRIV (self);
+
+  layer_clips = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) g_ptr_array_unref);
+  g_hash_table_iter_init (&iter, priv->lazy_layers);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & key,
+          (gpointer *) & llayer)) {
+    if (layer && key != layer)
+      continue;
+
+    /* Nobody will need the clips of a layer removed from the timeline */
+    if (ges_layer_get_timeline (key) != timeline) {
+      GST_DEBUG_OBJECT (self, "Dropping the %u clips of removed layer %"
+          GST_PTR_FORMAT, llayer->n_left, key);
+      priv->n_lazy_clips -= llayer->n_left;
+      g_hash_table_iter_remove (&iter);
+      continue;
+    }
+
+    clips = _lazy_layer_take_range (llayer, start, stop, asset, meta_item);
+    priv->n_lazy_clips -= clips->len;
+    if (llayer->n_left == 0)
+      g_hash_table_iter_remove (&iter);
+
+    if (clips->len)
+      g_hash_table_insert (layer_clips, key, clips);
+    else
+      g_ptr_array_unref (clips);
+  }
+
+  if (g_hash_table_size (layer_clips))
+    _build_layer_clips (self, layer_clips);
+  g_hash_table_unref (layer_clips);
+
+  *unloaded_end = 0;
+  g_hash_table_iter_init (&iter, priv->lazy_layers);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & llayer))
+    *unloaded_end = MAX (*unloaded_end, _lazy_layer_unloaded_end (llayer));
+
+  return priv->n_lazy_clips > 0;
+}
+
+/* Indexes the clips of each layer by start, so that the timeline can build
+ * them once it needs them */
+static void
+_index_clips (GESFormatter * self)
+{
+  guint i;
+  LazyLayer *llayer;
+  GHashTableIter iter;
+  GstClockTime unloaded_end = 0;
+  GESBaseXmlFormatterPrivate *priv = _GET_PRIV (self);
+
+  g_hash_table_remove_all (priv->clipid_pendings);
+  for (i = 0; i < priv->pending_clips->len; i++) {
+    PendingClip *pend = g_ptr_array_index (priv->pending_clips, i);
+
+    /* Its asset could not be loaded */
+    if (pend->asset == NULL)
+      continue;
+
+    llayer = g_hash_table_lookup (priv->lazy_layers, pend->layer);
+    if (llayer == NULL) {
+      llayer = g_slice_new0 (LazyLayer);
+      llayer->clips = g_ptr_array_new ();
+      g_hash_table_insert (priv->lazy_layers, pend->layer, llayer);
+    }
+
+    g_ptr_array_add (llayer->clips, pend);
+    if (!GST_CLOCK_TIME_IS_VALID (pend->duration))
+      llayer->max_duration = GST_CLOCK_TIME_NONE;
+    else if (GST_CLOCK_TIME_IS_VALID (llayer->max_duration))
+      llayer->max_duration = MAX (llayer->max_duration, pend->duration);
+    llayer->n_left++;
+    priv->n_lazy_clips++;
+  }
+
+  g_hash_table_iter_init (&iter, priv->lazy_layers);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & llayer)) {
+    g_ptr_array_sort (llayer->clips,
+        (GCompareFunc) _compare_pending_clips_start);
+    unloaded_end = MAX (unloaded_end, _lazy_layer_unloaded_end (llayer));
+  }
+
+  GST_INFO_OBJECT (self, "%u clips will be built once needed",
+      priv->n_lazy_clips);
+
+  /* The timeline keeps us alive until all the clips have been loaded */
+  if (priv->n_lazy_clips)
+    timeline_set_lazy_loader (self->timeline,
+        (GESTimelineLoadRangeFunc) _load_range, unloaded_end,
+        g_object_ref (self), g_object_unref);
+}
+
 static void
 new_asset_cb (GESAsset * source, GAsyncResult * res, PendingAsset * passet)
 {
+  guint i;
+  GPtrArray *pendings;
   GError *error = NULL;
   gchar *possible_id = NULL;
-  GList *tmp, *pendings = NULL;
   GESFormatter *self = passet->formatter;
   const gchar *id = ges_asset_get_id (source);
   GESBaseXmlFormatterPrivate *priv = _GET_PRIV (self);
@@ -606,10 +1136,8 @@ new_asset_cb (GESAsset * source, GAsyncResult * res, PendingAsset * passet)
           "- Error: %s", g_type_name (G_OBJECT_TYPE (source)), id,
           error->message);
 
-      pendings = g_hash_table_lookup (priv->assetid_pendingclips, id);
-      for (tmp = pendings; tmp; tmp = tmp->next)
-        _free_pending_clip (priv, (PendingClip *) tmp->data);
-
+      /* The clips that were waiting for it will not be built */
+      g_hash_table_remove (priv->assetid_pendingclips, id);
       _free_pending_asset (priv, passet);
       goto done;
     }
@@ -622,46 +1150,25 @@ new_asset_cb (GESAsset * source, GAsyncResult * res, PendingAsset * passet)
         ges_asset_get_extractable_type (source), possible_id);
 
     pendings = g_hash_table_lookup (priv->assetid_pendingclips, id);
-    if (pendings) {
-      g_hash_table_remove (priv->assetid_pendingclips, id);
-      g_hash_table_insert (priv->assetid_pendingclips,
-          g_strdup (possible_id), pendings);
+    if (pendings && g_strcmp0 (id, possible_id)) {
+      GPtrArray *clips = _get_clips_waiting_for (priv, possible_id);
 
-      /* pendings should no be freed */
-      pendings = NULL;
+      for (i = 0; i < pendings->len; i++)
+        g_ptr_array_add (clips, g_ptr_array_index (pendings, i));
+      g_hash_table_remove (priv->assetid_pendingclips, id);
     }
     goto done;
   }
 
-  /* now that we have the GESAsset, we create the GESClips */
+  /* now that we have the GESAsset, the clips using it can be built */
   pendings = g_hash_table_lookup (priv->assetid_pendingclips, id);
-  GST_DEBUG_OBJECT (self, "Asset created with ID %s, now creating pending "
-      " Clips, nb pendings: %i", id, g_list_length (pendings));
-  for (tmp = pendings; tmp; tmp = tmp->next) {
-    GList *tmpeffect;
-    GESClip *clip;
-    PendingClip *pend = (PendingClip *) tmp->data;
-
-    clip =
-        _add_object_to_layer (priv, pend->id, pend->layer, asset,
-        pend->start, pend->inpoint, pend->duration, pend->track_types,
-        pend->metadatas, pend->properties);
-
-    if (clip == NULL)
-      continue;
-
-    _add_pending_bindings (priv, pend->pending_bindings, clip);
-
-    GST_DEBUG_OBJECT (self, "Adding %i effect to new object",
-        g_list_length (pend->effects));
-    for (tmpeffect = pend->effects; tmpeffect; tmpeffect = tmpeffect->next) {
-      PendingEffects *peffect = (PendingEffects *) tmpeffect->data;
-
-      /* We keep a ref as _free_pending_effect unrefs it */
-      _add_track_element (self, clip, gst_object_ref (peffect->trackelement),
-          peffect->track_id, peffect->children_properties, peffect->properties);
-    }
-    _free_pending_clip (priv, pend);
+  if (pendings) {
+    GST_DEBUG_OBJECT (self, "Asset created with ID %s, nb pending clips: %i",
+        id, pendings->len);
+    for (i = 0; i < pendings->len; i++)
+      ((PendingClip *) g_ptr_array_index (pendings, i))->asset =
+          gst_object_ref (asset);
+    g_hash_table_remove (priv->assetid_pendingclips, id);
   }
 
   /* And now add to the project */
@@ -675,11 +1182,7 @@ done:
     gst_object_unref (asset);
   if (possible_id)
     g_free (possible_id);
-
-  if (pendings) {
-    g_hash_table_remove (priv->assetid_pendingclips, id);
-    g_list_free (pendings);
-  }
+  g_clear_error (&error);
 
   if (g_hash_table_size (priv->assetid_pendingclips) == 0 &&
       priv->pending_assets == NULL)
@@ -763,19 +1266,22 @@ ges_base_xml_formatter_add_clip (GESBaseXmlFormatter * self,
     const gchar * metadatas, GError ** error)
 {
   GESAsset *asset;
-  GESClip *nclip;
   LayerEntry *entry;
+  PendingClip *pclip;
   GESBaseXmlFormatterPrivate *priv = _GET_PRIV (self);
 
   if (priv->check_only)
     return;
 
+  priv->current_pending_clip = NULL;
   entry = g_hash_table_lookup (priv->layers, GINT_TO_POINTER (layer_prio));
   if (entry == NULL) {
     g_set_error (error, GES_ERROR, GES_ERROR_FORMATTER_MALFORMED_INPUT_FILE,
         "We got a Clip in a layer"
         " that does not exist, something is wrong either in the project file or"
         " in %s", g_type_name (G_OBJECT_TYPE (self)));
+
+    return;
   }
 
   /* We do not want the properties that are passed to layer-add_asset to be reset */
@@ -786,8 +1292,6 @@ ges_base_xml_formatter_add_clip (GESBaseXmlFormatter * self,
   asset = ges_asset_request (type, asset_id, NULL);
   if (asset == NULL) {
     gchar *real_id;
-    PendingClip *pclip;
-    GList *pendings;
 
     real_id = ges_extractable_type_check_id (type, asset_id, error);
     if (real_id == NULL) {
@@ -800,40 +1304,31 @@ ges_base_xml_formatter_add_clip (GESBaseXmlFormatter * self,
       return;
     }
 
-    pendings = g_hash_table_lookup (priv->assetid_pendingclips, asset_id);
+    GST_DEBUG_OBJECT (self, "Clip %s waiting for asset %s", id, real_id);
 
     pclip = g_slice_new0 (PendingClip);
-    GST_DEBUG_OBJECT (self, "Adding pending %p for %s, currently: %i",
-        pclip, asset_id, g_list_length (pendings));
-
-    pclip->id = g_strdup (id);
-    pclip->track_types = track_types;
-    pclip->duration = duration;
-    pclip->inpoint = inpoint;
-    pclip->start = start;
-    pclip->layer = gst_object_ref (entry->layer);
-
-    pclip->properties = properties ? gst_structure_copy (properties) : NULL;
-    pclip->metadatas = g_strdup (metadatas);
-
-    /* Add the new pending object to the hashtable */
-    g_hash_table_insert (priv->assetid_pendingclips, real_id,
-        g_list_append (pendings, pclip));
-    g_hash_table_insert (priv->clipid_pendings, g_strdup (id), pclip);
-
-    priv->current_clip = NULL;
-    priv->current_pending_clip = pclip;
-
-    return;
+    g_ptr_array_add (_get_clips_waiting_for (priv, real_id), pclip);
+    g_free (real_id);
+  } else {
+    pclip = g_slice_new0 (PendingClip);
+    pclip->asset = asset;
   }
 
-  nclip = _add_object_to_layer (priv, id, entry->layer,
-      asset, start, inpoint, duration, track_types, metadatas, properties);
+  /* The clip itself is built once the whole project has been parsed */
+  pclip->id = g_strdup (id);
+  pclip->track_types = track_types;
+  pclip->duration = duration;
+  pclip->inpoint = inpoint;
+  pclip->start = start;
+  pclip->layer = gst_object_ref (entry->layer);
 
-  if (!nclip)
-    return;
+  pclip->properties = properties ? gst_structure_copy (properties) : NULL;
+  pclip->metadatas = g_strdup (metadatas);
+
+  g_ptr_array_add (priv->pending_clips, pclip);
+  g_hash_table_insert (priv->clipid_pendings, g_strdup (id), pclip);
 
-  priv->current_clip = nclip;
+  priv->current_pending_clip = pclip;
 }
 
 void
@@ -915,6 +1410,8 @@ ges_base_xml_formatter_add_layer (GESBaseXmlFormatter * self,
   entry->auto_trans = auto_transition;
 
   g_hash_table_insert (priv->layers, GINT_TO_POINTER (priority), entry);
+  priv->current_layer = layer;
+  priv->current_pending_clip = NULL;
 }
 
 void
@@ -956,6 +1453,42 @@ ges_base_xml_formatter_add_track (GESBaseXmlFormatter * self,
         metadatas);
 }
 
+void
+ges_base_xml_formatter_add_marker (GESBaseXmlFormatter * self,
+    GType owner_type, GstClockTime position, const gchar * metadatas,
+    GError ** error)
+{
+  GESMarkerList *markers = NULL;
+  GESBaseXmlFormatterPrivate *priv = _GET_PRIV (self);
+
+  if (priv->check_only)
+    return;
+
+  if (owner_type == GES_TYPE_TIMELINE) {
+    markers = ges_timeline_get_marker_list (GES_FORMATTER (self)->timeline);
+  } else if (owner_type == GES_TYPE_LAYER && priv->current_layer) {
+    markers = ges_layer_get_marker_list (priv->current_layer);
+  } else if (owner_type == GES_TYPE_CLIP && priv->current_pending_clip) {
+    PendingMarker *pmarker = g_slice_new0 (PendingMarker);
+
+    pmarker->position = position;
+    pmarker->metadatas = g_strdup (metadatas);
+    priv->current_pending_clip->pending_markers =
+        g_list_append (priv->current_pending_clip->pending_markers, pmarker);
+
+    return;
+  }
+
+  if (markers == NULL) {
+    g_set_error (error, GES_ERROR, GES_ERROR_FORMATTER_MALFORMED_INPUT_FILE,
+        "We got a marker of a %s that does not exist", g_type_name (owner_type));
+
+    return;
+  }
+
+  _add_marker (markers, position, metadatas);
+}
+
 void
 ges_base_xml_formatter_add_control_binding (GESBaseXmlFormatter * self,
     const gchar * binding_type, const gchar * source_type,
@@ -963,12 +1496,9 @@ ges_base_xml_formatter_add_control_binding (GESBaseXmlFormatter * self,
     GSList * timed_values)
 {
   GESBaseXmlFormatterPrivate *priv = _GET_PRIV (self);
-  GESTrackElement *element = NULL;
+  GESTrackElement *element;
 
-  if (track_id[0] != '-' && priv->current_clip)
-    element = _get_element_by_track_id (priv, track_id, priv->current_clip);
-
-  else if (track_id[0] != '-' && priv->current_pending_clip) {
+  if (track_id[0] != '-' && priv->current_pending_clip) {
     PendingBinding *pbinding;
 
     pbinding = g_slice_new0 (PendingBinding);
@@ -984,10 +1514,7 @@ ges_base_xml_formatter_add_control_binding (GESBaseXmlFormatter * self,
     return;
   }
 
-  else {
-    element = priv->current_track_element;
-  }
-
+  element = priv->current_track_element;
   if (element == NULL) {
     GST_WARNING ("No current track element to which we can append a binding");
     return;
@@ -1046,35 +1573,30 @@ ges_base_xml_formatter_add_track_element (GESBaseXmlFormatter * self,
 
   trackelement = GES_TRACK_ELEMENT (ges_asset_extract (asset, NULL));
   if (trackelement) {
-    GESClip *clip;
+    PendingEffects *peffect;
+    PendingClip *pend = g_hash_table_lookup (priv->clipid_pendings,
+        timeline_obj_id);
+
     if (metadatas)
       ges_meta_container_add_metas_from_string (GES_META_CONTAINER
           (trackelement), metadatas);
 
-    clip = g_hash_table_lookup (priv->clips, timeline_obj_id);
-    if (clip) {
-      _add_track_element (GES_FORMATTER (self), clip, trackelement, track_id,
-          children_properties, properties);
-    } else {
-      PendingEffects *peffect;
-      PendingClip *pend = g_hash_table_lookup (priv->clipid_pendings,
-          timeline_obj_id);
-      if (pend == NULL) {
-        GST_WARNING_OBJECT (self, "No Clip with id: %s can not "
-            "add TrackElement", timeline_obj_id);
-        goto out;
-      }
+    if (pend == NULL) {
+      GST_WARNING_OBJECT (self, "No Clip with id: %s can not "
+          "add TrackElement", timeline_obj_id);
+      gst_object_unref (trackelement);
+      goto out;
+    }
 
-      peffect = g_slice_new0 (PendingEffects);
+    peffect = g_slice_new0 (PendingEffects);
 
-      peffect->trackelement = trackelement;
-      peffect->track_id = g_strdup (track_id);
-      peffect->properties = properties ? gst_structure_copy (properties) : NULL;
-      peffect->children_properties = children_properties ?
-          gst_structure_copy (children_properties) : NULL;
+    peffect->trackelement = trackelement;
+    peffect->track_id = g_strdup (track_id);
+    peffect->properties = properties ? gst_structure_copy (properties) : NULL;
+    peffect->children_properties = children_properties ?
+        gst_structure_copy (children_properties) : NULL;
 
-      pend->effects = g_list_append (pend->effects, peffect);
-    }
+    pend->effects = g_list_append (pend->effects, peffect);
     priv->current_track_element = trackelement;
   }
 
@@ -44,6 +44,10 @@ static gboolean _roll_start (GESTimelineElement * element, GstClockTime start);
 static gboolean _roll_end (GESTimelineElement * element, GstClockTime end);
 static gboolean _trim (GESTimelineElement * element, GstClockTime start);
 static void _compute_height (GESContainer * container);
+static GESClip *_split (GESClip * clip, guint64 position);
+static GESClip *_split_new_clip (GESClip * clip, guint64 position,
+    guint64 stop);
+static void _split_children (GESClip * clip, GESClip * new_object);
 
 G_DEFINE_ABSTRACT_TYPE (GESClip, ges_clip, GES_TYPE_CONTAINER);
 
@@ -63,6 +67,8 @@ struct _GESClipPrivate
 
   /* The formats supported by this Clip */
   GESTrackType supportedformats;
+
+  GESMarkerList *markers;       /* Created on demand */
 };
 
 typedef struct _CheckTrack
@@ -656,6 +662,16 @@ ges_clip_set_property (GObject * object, guint property_id,
   }
 }
 
+static void
+ges_clip_dispose (GObject * object)
+{
+  GESClip *clip = GES_CLIP (object);
+
+  g_clear_object (&clip->priv->markers);
+
+  G_OBJECT_CLASS (ges_clip_parent_class)->dispose (object);
+}
+
 static void
 ges_clip_class_init (GESClipClass * klass)
 {
@@ -667,6 +683,7 @@ ges_clip_class_init (GESClipClass * klass)
 
   object_class->get_property = ges_clip_get_property;
   object_class->set_property = ges_clip_set_property;
+  object_class->dispose = ges_clip_dispose;
   klass->create_track_elements = ges_clip_create_track_elements_func;
   klass->create_track_element = NULL;
 
@@ -1158,19 +1175,108 @@ ges_clip_set_top_effect_priority (GESClip * clip,
 GESClip *
 ges_clip_split (GESClip * clip, guint64 position)
 {
+  g_return_val_if_fail (GES_IS_CLIP (clip), NULL);
+  g_return_val_if_fail (clip->priv->layer, NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), NULL);
+
+  return _split (clip, position);
+}
+
+static gint
+_compare_positions (const guint64 * a, const guint64 * b)
+{
+  if (*a < *b)
+    return -1;
+
+  return *a > *b;
+}
+
+/**
+ * ges_clip_split_many:
+ * @clip: the #GESClip to split
+ * @positions: (array length=n_positions): the positions at which to split
+ * @n_positions: the number of elements in @positions
+ *
+ * Splits @clip at all @positions at once, the same way ges_clip_split would,
+ * but the priorities and transitions of the layer are only updated once
+ * instead of once per created clip. @positions do not need to be sorted,
+ * positions that are duplicated or outside of @clip are ignored.
+ *
+ * Returns: (transfer container) (element-type GESClip): The newly created
+ * #GESClip-s sorted by start, @clip itself is kept as the first piece and is
+ * not part of the list. The list has to be freed with g_list_free
+ */
+GList *
+ges_clip_split_many (GESClip * clip, const guint64 * positions,
+    guint n_positions)
+{
+  guint i;
   GList *tmp;
+  GArray *sorted;
   GESClip *new_object;
-  GstClockTime start, inpoint, duration;
+  GList *pieces = NULL;
+  GESTimeline *timeline;
+  guint64 stop = _END (clip);
 
   g_return_val_if_fail (GES_IS_CLIP (clip), NULL);
   g_return_val_if_fail (clip->priv->layer, NULL);
-  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), NULL);
+  g_return_val_if_fail (positions || n_positions == 0, NULL);
+
+  sorted = g_array_sized_new (FALSE, FALSE, sizeof (guint64), n_positions);
+  g_array_append_vals (sorted, positions, n_positions);
+  g_array_sort (sorted, (GCompareFunc) _compare_positions);
+
+  for (i = sorted->len; i > 0; i--) {
+    guint64 position = g_array_index (sorted, guint64, i - 1);
+
+    if (i > 1 && g_array_index (sorted, guint64, i - 2) == position)
+      continue;
+
+    if (!GST_CLOCK_TIME_IS_VALID (position))
+      continue;
+
+    new_object = _split_new_clip (clip, position, stop);
+    if (new_object) {
+      pieces = g_list_prepend (pieces, new_object);
+      stop = position;
+    }
+  }
+  g_array_free (sorted, TRUE);
+
+  if (pieces == NULL)
+    return NULL;
+
+  timeline = clip->priv->layer->timeline;
+  if (timeline)
+    timeline_freeze_transitions (timeline);
+
+  /* We do not want the timeline to create again TrackElement-s */
+  for (tmp = pieces; tmp; tmp = tmp->next)
+    ges_clip_set_moving_from_layer (tmp->data, TRUE);
+  _ges_layer_add_clips (clip->priv->layer, pieces);
+  for (tmp = pieces; tmp; tmp = tmp->next)
+    ges_clip_set_moving_from_layer (tmp->data, FALSE);
+
+  /* Always cut the tail of @clip, so it keeps being the piece that starts
+   * before all remaining positions and its bindings are split properly */
+  for (tmp = g_list_last (pieces); tmp; tmp = tmp->prev)
+    _split_children (clip, tmp->data);
 
-  duration = _DURATION (clip);
-  start = _START (clip);
-  inpoint = _INPOINT (clip);
+  if (timeline)
+    timeline_thaw_transitions (timeline, clip->priv->layer);
+
+  return pieces;
+}
+
+/* Creates the clip going from @position to @stop in @clip, without its
+ * children and without adding it to the layer */
+static GESClip *
+_split_new_clip (GESClip * clip, guint64 position, guint64 stop)
+{
+  GESClip *new_object;
+  GstClockTime start = _START (clip);
 
-  if (position >= start + duration || position <= start) {
+  if (position >= stop || position <= start) {
     GST_WARNING_OBJECT (clip, "Can not split %" GST_TIME_FORMAT
         " out of boundaries", GST_TIME_ARGS (position));
     return NULL;
@@ -1187,14 +1293,21 @@ ges_clip_split (GESClip * clip, guint64 position)
   /* Set new timing properties on the Clip */
   _set_start0 (GES_TIMELINE_ELEMENT (new_object), position);
   _set_inpoint0 (GES_TIMELINE_ELEMENT (new_object),
-      _INPOINT (clip) + duration - (duration + start - position));
-  _set_duration0 (GES_TIMELINE_ELEMENT (new_object),
-      duration + start - position);
+      _INPOINT (clip) + position - start);
+  _set_duration0 (GES_TIMELINE_ELEMENT (new_object), stop - position);
 
-  /* We do not want the timeline to create again TrackElement-s */
-  ges_clip_set_moving_from_layer (new_object, TRUE);
-  ges_layer_add_clip (clip->priv->layer, new_object);
-  ges_clip_set_moving_from_layer (new_object, FALSE);
+  return new_object;
+}
+
+/* Gives to @new_object, which is in the layer already, copies of the
+ * children of @clip, and makes @clip end where @new_object starts. @clip
+ * must not have children after the end of @new_object */
+static void
+_split_children (GESClip * clip, GESClip * new_object)
+{
+  GList *tmp;
+  GstClockTime start = _START (clip), inpoint = _INPOINT (clip);
+  GstClockTime position = _START (new_object);
 
   for (tmp = GES_CONTAINER_CHILDREN (clip); tmp; tmp = tmp->next) {
     GESTrackElement *new_trackelement, *trackelement =
@@ -1211,9 +1324,9 @@ ges_clip_split (GESClip * clip, guint64 position)
     /* Set 'new' track element timing propeties */
     _set_start0 (GES_TIMELINE_ELEMENT (new_trackelement), position);
     _set_inpoint0 (GES_TIMELINE_ELEMENT (new_trackelement),
-        inpoint + duration - (duration + start - position));
+        inpoint + position - start);
     _set_duration0 (GES_TIMELINE_ELEMENT (new_trackelement),
-        duration + start - position);
+        _DURATION (new_object));
 
     ges_container_add (GES_CONTAINER (new_object),
         GES_TIMELINE_ELEMENT (new_trackelement));
@@ -1224,7 +1337,23 @@ ges_clip_split (GESClip * clip, guint64 position)
         position - start + inpoint);
   }
 
-  _set_duration0 (GES_TIMELINE_ELEMENT (clip), position - _START (clip));
+  _set_duration0 (GES_TIMELINE_ELEMENT (clip), position - start);
+}
+
+static GESClip *
+_split (GESClip * clip, guint64 position)
+{
+  GESClip *new_object = _split_new_clip (clip, position, _END (clip));
+
+  if (new_object == NULL)
+    return NULL;
+
+  /* We do not want the timeline to create again TrackElement-s */
+  ges_clip_set_moving_from_layer (new_object, TRUE);
+  _ges_layer_add_clip_full (clip->priv->layer, new_object, TRUE);
+  ges_clip_set_moving_from_layer (new_object, FALSE);
+
+  _split_children (clip, new_object);
 
   return new_object;
 }
@@ -1260,6 +1389,26 @@ ges_clip_get_supported_formats (GESClip * clip)
   return clip->priv->supportedformats;
 }
 
+/**
+ * ges_clip_get_marker_list:
+ * @clip: the #GESClip
+ *
+ * Gets the markers of @clip, positioned relatively to the start of @clip so
+ * that they move along with it.
+ *
+ * Returns: (transfer none): The #GESMarkerList of @clip
+ */
+GESMarkerList *
+ges_clip_get_marker_list (GESClip * clip)
+{
+  g_return_val_if_fail (GES_IS_CLIP (clip), NULL);
+
+  if (clip->priv->markers == NULL)
+    clip->priv->markers = ges_marker_list_new ();
+
+  return clip->priv->markers;
+}
+
 gboolean
 _ripple (GESTimelineElement * element, GstClockTime start)
 {
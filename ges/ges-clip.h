@@ -166,6 +166,13 @@ gboolean ges_clip_set_top_effect_priority   (GESClip *clip, GESBaseEffect *effec
  *                   Editing                        *
  ****************************************************/
 GESClip* ges_clip_split  (GESClip *clip, guint64  position);
+GList*   ges_clip_split_many (GESClip *clip, const guint64 *positions,
+                              guint n_positions);
+
+/****************************************************
+ *                   Markers                        *
+ ****************************************************/
+GESMarkerList * ges_clip_get_marker_list    (GESClip *clip);
 
 G_END_DECLS
 #endif /* _GES_CLIP */
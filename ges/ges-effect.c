@@ -203,9 +203,10 @@ ges_effect_create_element (GESTrackElement * object)
         self->priv->bin_description, " ! videoconvert name=post_video_convert",
         NULL);
   } else if (track->type == GES_TRACK_TYPE_AUDIO) {
+    /* The mixer does not convert its inputs */
     bin_desc =
         g_strconcat ("audioconvert ! audioresample !",
-        self->priv->bin_description, NULL);
+        self->priv->bin_description, " ! audioconvert ! audioresample", NULL);
   } else {
     GST_DEBUG ("Track type not supported");
     return NULL;
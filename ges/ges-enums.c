@@ -84,6 +84,7 @@ register_ges_pipeline_flags (GType * id)
     {C_ENUM (GES_PIPELINE_MODE_RENDER), "GES_PIPELINE_MODE_RENDER", "render"},
     {C_ENUM (GES_PIPELINE_MODE_SMART_RENDER), "GES_PIPELINE_MODE_SMART_RENDER",
         "smart_render"},
+    {C_ENUM (GES_PIPELINE_MODE_SCRUB), "GES_PIPELINE_MODE_SCRUB", "scrub"},
     {0, NULL, NULL}
   };
 
@@ -678,3 +679,29 @@ ges_meta_flag_get_type (void)
   g_once (&once, (GThreadFunc) register_ges_meta_flag, &id);
   return id;
 }
+
+static void
+register_ges_audio_fade_curve (GType * id)
+{
+  static const GEnumValue values[] = {
+    {C_ENUM (GES_AUDIO_FADE_CURVE_LINEAR), "GES_AUDIO_FADE_CURVE_LINEAR",
+        "linear"},
+    {C_ENUM (GES_AUDIO_FADE_CURVE_EQUAL_POWER),
+        "GES_AUDIO_FADE_CURVE_EQUAL_POWER", "equal-power"},
+    {C_ENUM (GES_AUDIO_FADE_CURVE_CUSTOM), "GES_AUDIO_FADE_CURVE_CUSTOM",
+        "custom"},
+    {0, NULL, NULL}
+  };
+
+  *id = g_enum_register_static ("GESAudioFadeCurve", values);
+}
+
+GType
+ges_audio_fade_curve_get_type (void)
+{
+  static GType id;
+  static GOnce once = G_ONCE_INIT;
+
+  g_once (&once, (GThreadFunc) register_ges_audio_fade_curve, &id);
+  return id;
+}
@@ -330,6 +330,9 @@ GType ges_video_test_pattern_get_type (void);
  * @GES_PIPELINE_MODE_PREVIEW: output audio/video to soundcard/screen (default)
  * @GES_PIPELINE_MODE_RENDER: render timeline (forces decoding)
  * @GES_PIPELINE_MODE_SMART_RENDER: render timeline (tries to avoid decoding/reencoding)
+ * @GES_PIPELINE_MODE_SCRUB: keep recently displayed video frames around for
+ * scrubbing with ges_pipeline_scrub_to(), to be used together with
+ * #GES_PIPELINE_MODE_PREVIEW_VIDEO
  *
  * The various modes the #GESPipeline can be configured to.
  */
@@ -338,7 +341,8 @@ typedef enum {
   GES_PIPELINE_MODE_PREVIEW_VIDEO	= 1 << 1,
   GES_PIPELINE_MODE_PREVIEW		= GES_PIPELINE_MODE_PREVIEW_AUDIO | GES_PIPELINE_MODE_PREVIEW_VIDEO,
   GES_PIPELINE_MODE_RENDER		= 1 << 2,
-  GES_PIPELINE_MODE_SMART_RENDER	= 1 << 3
+  GES_PIPELINE_MODE_SMART_RENDER	= 1 << 3,
+  GES_PIPELINE_MODE_SCRUB		= 1 << 4
 } GESPipelineFlags;
 
 #define GES_TYPE_PIPELINE_FLAGS\
@@ -406,6 +410,27 @@ typedef enum {
 GType ges_edge_get_type (void);
 
 
+/**
+ * GESAudioFadeCurve:
+ * @GES_AUDIO_FADE_CURVE_LINEAR: The gain changes linearly, the overall level
+ *   dips in the middle of a crossfade between uncorrelated sources.
+ * @GES_AUDIO_FADE_CURVE_EQUAL_POWER: The gains follow sine and cosine
+ *   curves, keeping the overall power constant during the crossfade.
+ * @GES_AUDIO_FADE_CURVE_CUSTOM: The gains are computed from a user provided
+ *   curve, see ges_audio_transition_set_custom_fade_curve().
+ *
+ * The shape of the gain curves used when fading audio.
+ */
+typedef enum {
+    GES_AUDIO_FADE_CURVE_LINEAR,
+    GES_AUDIO_FADE_CURVE_EQUAL_POWER,
+    GES_AUDIO_FADE_CURVE_CUSTOM
+} GESAudioFadeCurve;
+
+#define GES_TYPE_AUDIO_FADE_CURVE ges_audio_fade_curve_get_type()
+
+GType ges_audio_fade_curve_get_type (void);
+
 const gchar * ges_track_type_name (GESTrackType type);
 G_END_DECLS
 
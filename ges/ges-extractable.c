@@ -28,6 +28,7 @@
 #include "ges-internal.h"
 #include "ges-extractable.h"
 #include "ges-uri-clip.h"
+#include "ges-layer.h"
 
 static GQuark ges_asset_key;
 
@@ -102,6 +103,7 @@ ges_extractable_get_asset (GESExtractable * self)
 void
 ges_extractable_set_asset (GESExtractable * self, GESAsset * asset)
 {
+  GESAsset *old_asset;
   GESExtractableInterface *iface;
 
   g_return_if_fail (GES_IS_EXTRACTABLE (self));
@@ -109,19 +111,38 @@ ges_extractable_set_asset (GESExtractable * self, GESAsset * asset)
   iface = GES_EXTRACTABLE_GET_INTERFACE (self);
   GST_DEBUG_OBJECT (self, "Setting asset to %" GST_PTR_FORMAT, asset);
 
-  if (iface->can_update_asset == FALSE &&
-      g_object_get_qdata (G_OBJECT (self), ges_asset_key)) {
+  old_asset = g_object_get_qdata (G_OBJECT (self), ges_asset_key);
+  if (iface->can_update_asset == FALSE && old_asset) {
     GST_WARNING_OBJECT (self, "Can not reset asset on object");
 
     return;
   }
 
+  /* Keep the reverse index of the assets up to date, before the qdata
+   * drops its reference on @old_asset */
+  if (old_asset != asset) {
+    if (old_asset)
+      ges_asset_remove_extractable (old_asset, self);
+    ges_asset_add_extractable (asset, self);
+  }
+
   g_object_set_qdata_full (G_OBJECT (self), ges_asset_key,
       gst_object_ref (asset), gst_object_unref);
 
   /* Let classes that implement the interface know that a asset has been set */
   if (iface->set_asset)
     iface->set_asset (self, asset);
+
+  /* The timeline indexes its clips by asset */
+  if (GES_IS_CLIP (self)) {
+    GESLayer *layer = ges_clip_get_layer (GES_CLIP (self));
+
+    if (layer) {
+      if (layer->timeline)
+        timeline_update_clip_asset (layer->timeline, GES_CLIP (self));
+      gst_object_unref (layer);
+    }
+  }
 }
 
 /**
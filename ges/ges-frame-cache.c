@@ -0,0 +1,466 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Cache of decoded still images shared by all the GESImageSource and
+ * GESMultiFileSource of the process.
+ *
+ * Each image file is decoded once, the decoded frame is kept in memory (in
+ * the format the decoder outputs it, conversion is done downstream by each
+ * source) and served to all the sources using that file as a refcounted
+ * buffer, so the pixels are never copied. A frame of a sequence and the same
+ * file used as a still image share the same cache entry.
+ *
+ * Frames are evicted in least recently used order when the cache gets
+ * bigger than its budget, which can be set in MiB with the
+ * GES_FRAME_CACHE_SIZE environment variable.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#include <stdlib.h>
+
+#include "ges-internal.h"
+
+#define DEFAULT_FRAME_CACHE_SIZE (G_GUINT64_CONSTANT (256) << 20)
+
+typedef struct
+{
+  gchar *uri;
+  GstSample *sample;
+  gsize size;
+} CachedFrame;
+
+static GMutex frame_cache_lock;
+static GHashTable *frame_cache;        /* {uri: GList link in frame_cache_lru} */
+static GQueue frame_cache_lru = G_QUEUE_INIT;   /* CachedFrame, most recent first */
+static guint64 frame_cache_size = 0;
+static guint64 frame_cache_max_size = DEFAULT_FRAME_CACHE_SIZE;
+
+#define LOCK_FRAME_CACHE   (g_mutex_lock (&frame_cache_lock))
+#define UNLOCK_FRAME_CACHE (g_mutex_unlock (&frame_cache_lock))
+
+static void
+_cached_frame_free (CachedFrame * frame)
+{
+  g_free (frame->uri);
+  gst_sample_unref (frame->sample);
+  g_slice_free (CachedFrame, frame);
+}
+
+/* Must be called with the lock taken */
+static void
+_enforce_max_size (void)
+{
+  while (frame_cache_size > frame_cache_max_size &&
+      frame_cache_lru.length > 1) {
+    CachedFrame *frame = g_queue_pop_tail (&frame_cache_lru);
+
+    GST_DEBUG ("Evicting %s from the frame cache", frame->uri);
+    g_hash_table_remove (frame_cache, frame->uri);
+    frame_cache_size -= frame->size;
+    _cached_frame_free (frame);
+  }
+}
+
+static GstSample *
+_lookup (const gchar * uri)
+{
+  GList *link;
+  GstSample *sample = NULL;
+
+  LOCK_FRAME_CACHE;
+  if ((link = g_hash_table_lookup (frame_cache, uri))) {
+    /* Most recently used goes first */
+    g_queue_unlink (&frame_cache_lru, link);
+    g_queue_push_head_link (&frame_cache_lru, link);
+
+    sample = gst_sample_ref (((CachedFrame *) link->data)->sample);
+  }
+  UNLOCK_FRAME_CACHE;
+
+  return sample;
+}
+
+static void
+_insert (const gchar * uri, GstSample * sample)
+{
+  CachedFrame *frame;
+
+  LOCK_FRAME_CACHE;
+  /* Another thread might have decoded it at the same time */
+  if (g_hash_table_lookup (frame_cache, uri)) {
+    UNLOCK_FRAME_CACHE;
+    return;
+  }
+
+  frame = g_slice_new (CachedFrame);
+  frame->uri = g_strdup (uri);
+  frame->sample = gst_sample_ref (sample);
+  frame->size = gst_buffer_get_size (gst_sample_get_buffer (sample));
+
+  g_queue_push_head (&frame_cache_lru, frame);
+  g_hash_table_insert (frame_cache, frame->uri, frame_cache_lru.head);
+  frame_cache_size += frame->size;
+
+  _enforce_max_size ();
+  UNLOCK_FRAME_CACHE;
+}
+
+static void
+_decoder_pad_added_cb (GstElement * decodebin, GstPad * pad,
+    GstElement * pipeline)
+{
+  GstPad *sinkpad;
+  GstElement *sink;
+  GstCaps *caps = gst_pad_query_caps (pad, NULL);
+  GstElement *appsink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+
+  sinkpad = gst_element_get_static_pad (appsink, "sink");
+  if (!gst_pad_is_linked (sinkpad) && !gst_caps_is_empty (caps) &&
+      g_str_has_prefix (gst_structure_get_name (gst_caps_get_structure (caps,
+                  0)), "video/")) {
+    gst_pad_link (pad, sinkpad);
+  } else {
+    /* Make sure other streams do not prevent prerolling */
+    sink = gst_element_factory_make ("fakesink", NULL);
+    gst_bin_add (GST_BIN (pipeline), sink);
+    gst_element_sync_state_with_parent (sink);
+    gst_object_unref (sinkpad);
+
+    sinkpad = gst_element_get_static_pad (sink, "sink");
+    gst_pad_link (pad, sinkpad);
+  }
+
+  gst_object_unref (sinkpad);
+  gst_object_unref (appsink);
+  gst_caps_unref (caps);
+}
+
+/* Decodes the first frame of @uri, blocking */
+static GstSample *
+_decode (const gchar * uri)
+{
+  GstBus *bus;
+  GstMessage *msg;
+  GstCaps *caps;
+  GstSample *sample = NULL;
+  GstElement *pipeline, *decodebin, *appsink;
+
+  pipeline = gst_pipeline_new ("frame-cache-decoder");
+  decodebin = gst_element_factory_make ("uridecodebin", NULL);
+  appsink = gst_element_factory_make ("appsink", "sink");
+  if (!decodebin || !appsink) {
+    GST_ERROR ("Missing elements to decode %s", uri);
+    gst_object_unref (pipeline);
+
+    return NULL;
+  }
+
+  caps = gst_caps_new_empty_simple ("video/x-raw");
+  g_object_set (appsink, "caps", caps, "sync", FALSE, NULL);
+  gst_caps_unref (caps);
+  g_object_set (decodebin, "uri", uri, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), decodebin, appsink, NULL);
+  g_signal_connect (decodebin, "pad-added",
+      G_CALLBACK (_decoder_pad_added_cb), pipeline);
+
+  bus = gst_element_get_bus (pipeline);
+  if (gst_element_set_state (pipeline, GST_STATE_PAUSED) !=
+      GST_STATE_CHANGE_FAILURE) {
+    /* A single frame, a decoder taking that long is stuck */
+    msg = gst_bus_timed_pop_filtered (bus, GES_MEDIA_STALL_TIMEOUT,
+        GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR);
+
+    if (msg && GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ASYNC_DONE)
+      g_signal_emit_by_name (appsink, "pull-preroll", &sample);
+    else
+      GST_WARNING ("Could not decode %s%s", uri, msg ? "" : ", timed out");
+
+    if (msg)
+      gst_message_unref (msg);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return sample;
+}
+
+/* Returns the decoded frame of the image at @uri, decoding it if it is not
+ * in the cache yet */
+GstSample *
+ges_frame_cache_get (const gchar * uri)
+{
+  GstSample *sample;
+
+  if ((sample = _lookup (uri))) {
+    GST_LOG ("Frame for %s found in cache", uri);
+
+    return sample;
+  }
+
+  GST_DEBUG ("Decoding %s", uri);
+  if ((sample = _decode (uri)))
+    _insert (uri, sample);
+
+  return sample;
+}
+
+/************************************************
+ *                                              *
+ *          Sources reading from the cache      *
+ *                                              *
+ ************************************************/
+typedef struct
+{
+  GMutex lock;
+
+  /* Still image if pattern == NULL */
+  gchar *uri;
+
+  gchar *pattern;
+  gint start;
+  gint stop;
+  gint fps_n;
+  gint fps_d;
+
+  gint index;
+  gboolean caps_set;
+} CacheSourceData;
+
+static void
+_cache_source_data_free (CacheSourceData * data)
+{
+  g_mutex_clear (&data->lock);
+  g_free (data->uri);
+  g_free (data->pattern);
+  g_slice_free (CacheSourceData, data);
+}
+
+static void
+_end_of_stream (GstElement * appsrc)
+{
+  GstFlowReturn ret;
+
+  g_signal_emit_by_name (appsrc, "end-of-stream", &ret);
+}
+
+static void
+_set_caps (GstElement * appsrc, CacheSourceData * data, GstSample * sample)
+{
+  GstCaps *caps;
+
+  if (data->caps_set)
+    return;
+
+  caps = gst_caps_copy (gst_sample_get_caps (sample));
+  if (data->pattern)
+    gst_caps_set_simple (caps, "framerate", GST_TYPE_FRACTION, data->fps_n,
+        data->fps_d, NULL);
+
+  g_object_set (appsrc, "caps", caps, NULL);
+  gst_caps_unref (caps);
+  data->caps_set = TRUE;
+}
+
+static void
+_image_need_data_cb (GstElement * appsrc, guint length, CacheSourceData * data)
+{
+  GstFlowReturn ret;
+  GstSample *sample;
+
+  g_mutex_lock (&data->lock);
+  if (data->index > 0 || !(sample = ges_frame_cache_get (data->uri))) {
+    g_mutex_unlock (&data->lock);
+    _end_of_stream (appsrc);
+
+    return;
+  }
+
+  _set_caps (appsrc, data, sample);
+  data->index++;
+  g_mutex_unlock (&data->lock);
+
+  /* imagefreeze takes care of repeating it */
+  g_signal_emit_by_name (appsrc, "push-buffer", gst_sample_get_buffer (sample),
+      &ret);
+  gst_sample_unref (sample);
+}
+
+static void
+_sequence_need_data_cb (GstElement * appsrc, guint length,
+    CacheSourceData * data)
+{
+  gint index;
+  GstFlowReturn ret;
+  GstBuffer *buffer;
+  GstSample *sample = NULL;
+  gchar *location, *uri = NULL;
+
+  g_mutex_lock (&data->lock);
+  index = data->index;
+
+  /* Same as multifilesrc, the sequence stops at the first missing file if
+   * no stop index was given */
+  if (data->stop < 0 || index <= data->stop) {
+    location = g_strdup_printf (data->pattern, index);
+    if (g_file_test (location, G_FILE_TEST_IS_REGULAR))
+      uri = gst_filename_to_uri (location, NULL);
+    g_free (location);
+  }
+
+  if (uri == NULL || !(sample = ges_frame_cache_get (uri))) {
+    g_mutex_unlock (&data->lock);
+    g_free (uri);
+    _end_of_stream (appsrc);
+
+    return;
+  }
+
+  _set_caps (appsrc, data, sample);
+  data->index++;
+  g_mutex_unlock (&data->lock);
+
+  /* Only the metadata is copied, the memory is shared with the cache */
+  buffer = gst_buffer_copy (gst_sample_get_buffer (sample));
+  GST_BUFFER_PTS (buffer) = gst_util_uint64_scale (index - data->start,
+      data->fps_d * GST_SECOND, data->fps_n);
+  GST_BUFFER_DURATION (buffer) = gst_util_uint64_scale (1,
+      data->fps_d * GST_SECOND, data->fps_n);
+  GST_BUFFER_OFFSET (buffer) = index - data->start;
+
+  g_signal_emit_by_name (appsrc, "push-buffer", buffer, &ret);
+  gst_buffer_unref (buffer);
+  gst_sample_unref (sample);
+  g_free (uri);
+}
+
+/* The image has to be pushed again each time the appsrc restarts or gets
+ * flushed, seeks are handled downstream by imagefreeze */
+static GstPadProbeReturn
+_image_reset_probe (GstPad * pad, GstPadProbeInfo * info,
+    CacheSourceData * data)
+{
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_STREAM_START:
+    case GST_EVENT_FLUSH_STOP:
+      g_mutex_lock (&data->lock);
+      data->index = 0;
+      g_mutex_unlock (&data->lock);
+      break;
+    default:
+      break;
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static gboolean
+_sequence_seek_data_cb (GstElement * appsrc, guint64 position,
+    CacheSourceData * data)
+{
+  g_mutex_lock (&data->lock);
+  data->index = data->start + gst_util_uint64_scale (position, data->fps_n,
+      data->fps_d * GST_SECOND);
+  g_mutex_unlock (&data->lock);
+
+  return TRUE;
+}
+
+static GstElement *
+_create_source (CacheSourceData * data)
+{
+  GstElement *appsrc = gst_element_factory_make ("appsrc", NULL);
+
+  if (appsrc == NULL) {
+    GST_ERROR ("appsrc is missing, can not create source");
+    _cache_source_data_free (data);
+
+    return NULL;
+  }
+
+  g_mutex_init (&data->lock);
+  gst_util_set_object_arg (G_OBJECT (appsrc), "format", "time");
+  g_object_set_data_full (G_OBJECT (appsrc), "ges-frame-cache-data", data,
+      (GDestroyNotify) _cache_source_data_free);
+
+  if (data->pattern) {
+    gst_util_set_object_arg (G_OBJECT (appsrc), "stream-type", "seekable");
+    g_signal_connect (appsrc, "need-data",
+        G_CALLBACK (_sequence_need_data_cb), data);
+    g_signal_connect (appsrc, "seek-data",
+        G_CALLBACK (_sequence_seek_data_cb), data);
+  } else {
+    GstPad *pad = gst_element_get_static_pad (appsrc, "src");
+
+    g_signal_connect (appsrc, "need-data", G_CALLBACK (_image_need_data_cb),
+        data);
+    gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM |
+        GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+        (GstPadProbeCallback) _image_reset_probe, data, NULL);
+    gst_object_unref (pad);
+  }
+
+  return appsrc;
+}
+
+/* Creates a source outputing the decoded image at @uri once */
+GstElement *
+ges_frame_cache_create_image_source (const gchar * uri)
+{
+  CacheSourceData *data = g_slice_new0 (CacheSourceData);
+
+  data->uri = g_strdup (uri);
+
+  return _create_source (data);
+}
+
+/* Creates a seekable source outputing the images at @pattern (a printf like
+ * pattern, see multifilesrc) from @start to @stop (or the first missing
+ * file if @stop is -1) at @fps_n/@fps_d */
+GstElement *
+ges_frame_cache_create_sequence_source (const gchar * pattern, gint start,
+    gint stop, gint fps_n, gint fps_d)
+{
+  CacheSourceData *data = g_slice_new0 (CacheSourceData);
+
+  data->pattern = g_strdup (pattern);
+  data->start = data->index = start;
+  data->stop = stop;
+  data->fps_n = fps_n;
+  data->fps_d = fps_d;
+
+  return _create_source (data);
+}
+
+void
+ges_frame_cache_init (void)
+{
+  const gchar *size = g_getenv ("GES_FRAME_CACHE_SIZE");
+
+  g_mutex_init (&frame_cache_lock);
+  frame_cache = g_hash_table_new (g_str_hash, g_str_equal);
+
+  if (size)
+    frame_cache_max_size = g_ascii_strtoull (size, NULL, 10) << 20;
+}
@@ -39,12 +39,16 @@ G_BEGIN_DECLS
  * @GES_ERROR_ASSET_WRONG_ID: The ID passed is malformed
  * @GES_ERROR_ASSET_LOADING: An error happened while loading the asset
  * @GES_ERROR_FORMATTER_MALFORMED_INPUT_FILE: The formatted files was malformed
+ * @GES_ERROR_RENDERING: An error happened while rendering
+ * @GES_ERROR_ASSET_ANALYSIS: An error happened while analysing an asset
  */
 typedef enum
 {
   GES_ERROR_ASSET_WRONG_ID,
   GES_ERROR_ASSET_LOADING,
   GES_ERROR_FORMATTER_MALFORMED_INPUT_FILE,
+  GES_ERROR_RENDERING,
+  GES_ERROR_ASSET_ANALYSIS,
 } GESError;
 
 G_END_DECLS
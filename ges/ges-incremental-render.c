@@ -0,0 +1,813 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Incremental rendering, see ges_pipeline_render_incremental.
+ *
+ * The output is split into segments rendered as standalone files, so each
+ * of them starts with a keyframe and can be replaced without touching its
+ * neighbours. Segments start and end at the edit points of the timeline
+ * (clip boundaries) and are split further when longer than the requested
+ * segment duration. Next to them we keep a manifest with, for each
+ * segment, its boundaries and a hash of everything that has an influence on
+ * its content. That hash does not depend on where the segment is in the
+ * timeline, so that segments moved by a ripple edit are found again.
+ *
+ * When rendering again, a segment is only encoded if no segment with the
+ * same hash exists in the previous manifest (or was already rendered). The
+ * segments are then concatenated into the output file by demuxing them one
+ * after the other and muxing their encoded streams again, none of them is
+ * decoded.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "ges-internal.h"
+#include "ges-gerror.h"
+#include "ges-pipeline.h"
+#include "ges-track.h"
+#include "ges-layer.h"
+
+#define MANIFEST_FILENAME "manifest"
+#define MANIFEST_GROUP "render"
+#define SEGMENT_PREFIX "segment-"
+#define SEGMENTS_DIR_SUFFIX ".segments"
+#define PARTIAL_FILE_SUFFIX ".part"
+
+typedef struct
+{
+  GstClockTime start;
+  GstClockTime stop;
+  guint64 hash;
+  gchar *location;              /* Relative to the segments directory */
+} Segment;
+
+static const struct
+{
+  const gchar *media_type;
+  const gchar *extension;
+} extensions[] = {
+  {"video/x-matroska", ".mkv"},
+  {"video/webm", ".webm"},
+  {"application/ogg", ".ogg"},
+  {"video/quicktime", ".mov"},
+  {"video/mpegts", ".ts"},
+  {"video/x-msvideo", ".avi"},
+  {NULL, NULL}
+};
+
+static const gchar *
+_get_extension (GstEncodingProfile * profile)
+{
+  guint i;
+  const gchar *media_type;
+  GstCaps *format = gst_encoding_profile_get_format (profile);
+
+  media_type = gst_structure_get_name (gst_caps_get_structure (format, 0));
+  for (i = 0; extensions[i].media_type; i++) {
+    if (!g_strcmp0 (media_type, extensions[i].media_type))
+      break;
+  }
+  gst_caps_unref (format);
+
+  return extensions[i].extension ? extensions[i].extension : "";
+}
+
+static void
+_checksum_add_profile (GChecksum * checksum, GstEncodingProfile * profile)
+{
+  gchar *str;
+  GstCaps *caps;
+  const gchar *preset = gst_encoding_profile_get_preset (profile);
+
+  caps = gst_encoding_profile_get_format (profile);
+  str = gst_caps_to_string (caps);
+  g_checksum_update (checksum, (const guchar *) str, strlen (str) + 1);
+  g_free (str);
+  gst_caps_unref (caps);
+
+  if ((caps = gst_encoding_profile_get_restriction (profile))) {
+    str = gst_caps_to_string (caps);
+    g_checksum_update (checksum, (const guchar *) str, strlen (str) + 1);
+    g_free (str);
+    gst_caps_unref (caps);
+  }
+
+  if (preset)
+    g_checksum_update (checksum, (const guchar *) preset, -1);
+}
+
+/* Hash of the encoding settings, any change in them invalidates all the
+ * segments */
+static guint64
+_compute_settings_hash (GstEncodingProfile * profile)
+{
+  guint64 res;
+  const GList *tmp;
+  GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+  _checksum_add_profile (checksum, profile);
+  if (GST_IS_ENCODING_CONTAINER_PROFILE (profile)) {
+    for (tmp = gst_encoding_container_profile_get_profiles
+        (GST_ENCODING_CONTAINER_PROFILE (profile)); tmp; tmp = tmp->next)
+      _checksum_add_profile (checksum, tmp->data);
+  }
+
+  res = _ges_checksum_get_uint64 (checksum);
+  g_checksum_free (checksum);
+
+  return res;
+}
+
+/* Duration of a frame of the video track, 0 if unknown */
+static GstClockTime
+_get_frame_duration (GESTimeline * timeline)
+{
+  GList *tmp;
+  GstClockTime frame_duration = 0;
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
+    gint fps_n, fps_d;
+    GstCaps *restriction = NULL;
+    GESTrack *track = tmp->data;
+
+    if (track->type != GES_TRACK_TYPE_VIDEO)
+      continue;
+
+    g_object_get (track, "restriction-caps", &restriction, NULL);
+    if (restriction == NULL)
+      continue;
+
+    if (!gst_caps_is_empty (restriction) &&
+        gst_structure_get_fraction (gst_caps_get_structure (restriction, 0),
+            "framerate", &fps_n, &fps_d) && fps_n > 0)
+      frame_duration = gst_util_uint64_scale (GST_SECOND, fps_d, fps_n);
+    gst_caps_unref (restriction);
+
+    break;
+  }
+
+  return frame_duration;
+}
+
+static GstClockTime
+_align_to_frame (GstClockTime time, GstClockTime frame_duration)
+{
+  if (frame_duration == 0)
+    return time;
+
+  return gst_util_uint64_scale_round (time, 1, frame_duration) *
+      frame_duration;
+}
+
+static gint
+_compare_times (const GstClockTime * a, const GstClockTime * b)
+{
+  if (*a < *b)
+    return -1;
+  if (*a > *b)
+    return 1;
+
+  return 0;
+}
+
+/* Returns the sorted boundaries of the segments: the edit points of
+ * @timeline, on video frames, with no more than @segment_duration between
+ * two of them */
+static GArray *
+_compute_boundaries (GESTimeline * timeline, GstClockTime duration,
+    GstClockTime segment_duration)
+{
+  guint i;
+  GList *tmp, *clips, *ctmp;
+  GstClockTime zero = 0, frame_duration = _get_frame_duration (timeline);
+  GArray *points = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  GArray *boundaries = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+
+  segment_duration = MAX (frame_duration, _align_to_frame (segment_duration,
+          frame_duration));
+  duration = _align_to_frame (duration, frame_duration);
+
+  for (tmp = timeline->layers; tmp; tmp = tmp->next) {
+    clips = ges_layer_get_clips (tmp->data);
+    for (ctmp = clips; ctmp; ctmp = ctmp->next) {
+      GstClockTime start = _align_to_frame (_START (ctmp->data),
+          frame_duration);
+      GstClockTime end = _align_to_frame (_END (ctmp->data), frame_duration);
+
+      g_array_append_val (points, start);
+      g_array_append_val (points, end);
+    }
+    g_list_free_full (clips, gst_object_unref);
+  }
+  g_array_sort (points, (GCompareFunc) _compare_times);
+
+  g_array_append_val (boundaries, zero);
+  for (i = 0; i <= points->len; i++) {
+    GstClockTime last = g_array_index (boundaries, GstClockTime,
+        boundaries->len - 1);
+    GstClockTime next = i < points->len ?
+        MIN (g_array_index (points, GstClockTime, i), duration) : duration;
+
+    if (next <= last)
+      continue;
+
+    /* Long spans are cut from their start so that the same cuts are found
+     * again when the span moves */
+    for (last += segment_duration; last < next; last += segment_duration)
+      g_array_append_val (boundaries, last);
+    g_array_append_val (boundaries, next);
+  }
+  g_array_free (points, TRUE);
+
+  return boundaries;
+}
+
+static void
+_segment_clear (Segment * segment)
+{
+  g_free (segment->location);
+}
+
+/* Returns the segments of the previous render, or an empty array if the
+ * encoding settings changed or there was no previous render */
+static GArray *
+_load_manifest (const gchar * manifest, guint64 settings_hash)
+{
+  guint i;
+  gsize n_groups;
+  GKeyFile *kf = g_key_file_new ();
+  gchar **groups = NULL;
+  GArray *segments = g_array_new (FALSE, TRUE, sizeof (Segment));
+
+  g_array_set_clear_func (segments, (GDestroyNotify) _segment_clear);
+  if (!g_key_file_load_from_file (kf, manifest, G_KEY_FILE_NONE, NULL))
+    goto done;
+
+  if (g_key_file_get_uint64 (kf, MANIFEST_GROUP, "settings", NULL) !=
+      settings_hash) {
+    GST_INFO ("Encoding settings changed, rendering everything again");
+    goto done;
+  }
+
+  groups = g_key_file_get_groups (kf, &n_groups);
+  for (i = 0; i < n_groups; i++) {
+    Segment segment;
+    GError *err = NULL;
+
+    if (!g_str_has_prefix (groups[i], SEGMENT_PREFIX))
+      continue;
+
+    segment.start = g_key_file_get_uint64 (kf, groups[i], "start", &err);
+    if (!err)
+      segment.stop = g_key_file_get_uint64 (kf, groups[i], "stop", &err);
+    if (!err)
+      segment.hash = g_key_file_get_uint64 (kf, groups[i], "hash", &err);
+    if (!err)
+      segment.location = g_key_file_get_string (kf, groups[i], "location",
+          &err);
+
+    if (err) {
+      GST_WARNING ("Malformed segment %s in %s: %s", groups[i], manifest,
+          err->message);
+      g_error_free (err);
+      continue;
+    }
+
+    g_array_append_val (segments, segment);
+  }
+
+done:
+  g_strfreev (groups);
+  g_key_file_free (kf);
+
+  return segments;
+}
+
+static gboolean
+_save_manifest (const gchar * manifest, guint64 settings_hash,
+    GArray * segments, GError ** error)
+{
+  guint i;
+  gsize len;
+  gchar *data;
+  gboolean res;
+  GKeyFile *kf = g_key_file_new ();
+
+  g_key_file_set_uint64 (kf, MANIFEST_GROUP, "settings", settings_hash);
+  g_key_file_set_integer (kf, MANIFEST_GROUP, "n-segments", segments->len);
+  for (i = 0; i < segments->len; i++) {
+    Segment *segment = &g_array_index (segments, Segment, i);
+    gchar *group = g_strdup_printf (SEGMENT_PREFIX "%05u", i);
+
+    g_key_file_set_uint64 (kf, group, "start", segment->start);
+    g_key_file_set_uint64 (kf, group, "stop", segment->stop);
+    g_key_file_set_uint64 (kf, group, "hash", segment->hash);
+    g_key_file_set_string (kf, group, "location", segment->location);
+    g_free (group);
+  }
+
+  data = g_key_file_to_data (kf, &len, NULL);
+  res = g_file_set_contents (manifest, data, len, error);
+  g_free (data);
+  g_key_file_free (kf);
+
+  return res;
+}
+
+static Segment *
+_find_segment (GArray * segments, guint64 hash)
+{
+  guint i;
+
+  for (i = 0; i < segments->len; i++) {
+    Segment *segment = &g_array_index (segments, Segment, i);
+
+    if (segment->hash == hash)
+      return segment;
+  }
+
+  return NULL;
+}
+
+static gboolean
+_render_segment (GESTimeline * timeline, GstEncodingProfile * profile,
+    const gchar * location, GstClockTime start, GstClockTime stop)
+{
+  gchar *partial, *uri;
+  GESPipeline *pipeline;
+  GESTimeline *copy;
+  gboolean res = FALSE;
+
+  partial = g_strconcat (location, PARTIAL_FILE_SUFFIX, NULL);
+  uri = gst_filename_to_uri (partial, NULL);
+
+  /* @timeline might already be used in another pipeline */
+  copy = gst_object_ref_sink (_ges_timeline_copy_range (timeline, start, stop));
+  pipeline = ges_pipeline_new ();
+  if (!ges_pipeline_set_timeline (pipeline, copy) ||
+      !ges_pipeline_set_render_settings (pipeline, uri, profile) ||
+      !ges_pipeline_set_mode (pipeline, GES_PIPELINE_MODE_RENDER)) {
+    GST_WARNING ("Could not setup rendering of %s", location);
+    goto done;
+  }
+
+  GST_INFO ("Rendering [%" GST_TIME_FORMAT " - %" GST_TIME_FORMAT "] to %s",
+      GST_TIME_ARGS (start), GST_TIME_ARGS (stop), location);
+
+  res = _ges_pipeline_render_range (pipeline, start, stop, NULL);
+  if (res && g_rename (partial, location) != 0) {
+    GST_WARNING ("Could not move %s to %s", partial, location);
+    res = FALSE;
+  }
+
+done:
+  gst_object_unref (pipeline);
+  gst_object_unref (copy);
+  if (!res)
+    g_unlink (partial);
+
+  g_free (partial);
+  g_free (uri);
+
+  return res;
+}
+
+/* Feeds the segments one after the other into an encodebin, which muxes
+ * their already encoded streams without encoding them again */
+typedef struct
+{
+  GstElement *pipeline;
+  GstElement *encodebin;
+  /* The encoded formats of the profile, where decoding the segments stops */
+  GstCaps *formats;
+  /* Media type -> encodebin sink pad */
+  GHashTable *sinkpads;
+  GArray *segments;
+  const gchar *directory;
+
+  GMutex lock;
+  /* The segment being fed and where it starts in the output */
+  guint current;
+  GstElement *source;
+  GstClockTime offset;
+  guint n_pads;
+  guint n_eos;
+  gboolean no_more_pads;
+} ConcatData;
+
+/* Call with the lock held */
+static void
+_concat_check_segment_done (ConcatData * data)
+{
+  if (!data->no_more_pads || data->n_eos < data->n_pads ||
+      data->current + 1 >= data->segments->len)
+    return;
+
+  gst_element_post_message (data->pipeline,
+      gst_message_new_application (GST_OBJECT (data->pipeline),
+          gst_structure_new_empty ("ges-concat-next-segment")));
+}
+
+static GstPadProbeReturn
+_concat_event_probe (GstPad * pad, GstPadProbeInfo * info, ConcatData * data)
+{
+  GstPadProbeReturn ret = GST_PAD_PROBE_OK;
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+  g_mutex_lock (&data->lock);
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_STREAM_START:
+      /* The streams go on in the next segments */
+      if (data->current > 0)
+        ret = GST_PAD_PROBE_DROP;
+      break;
+    case GST_EVENT_EOS:
+      if (data->current + 1 < data->segments->len)
+        ret = GST_PAD_PROBE_DROP;
+      data->n_eos++;
+      _concat_check_segment_done (data);
+      break;
+    default:
+      break;
+  }
+  g_mutex_unlock (&data->lock);
+
+  return ret;
+}
+
+static void
+_concat_pad_added_cb (GstElement * source, GstPad * pad, ConcatData * data)
+{
+  GstCaps *caps;
+  GstPad *sinkpad;
+  const gchar *media_type;
+
+  caps = gst_pad_query_caps (pad, NULL);
+  media_type = gst_structure_get_name (gst_caps_get_structure (caps, 0));
+
+  g_mutex_lock (&data->lock);
+  sinkpad = g_hash_table_lookup (data->sinkpads, media_type);
+  if (sinkpad == NULL && data->current == 0) {
+    g_signal_emit_by_name (data->encodebin, "request-pad", caps, &sinkpad);
+    if (sinkpad)
+      g_hash_table_insert (data->sinkpads, g_strdup (media_type), sinkpad);
+  }
+
+  if (sinkpad == NULL) {
+    GST_WARNING ("No stream to concatenate %" GST_PTR_FORMAT " to", caps);
+    goto done;
+  }
+
+  gst_pad_set_offset (pad, data->offset);
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      (GstPadProbeCallback) _concat_event_probe, data, NULL);
+  if (gst_pad_link (pad, sinkpad) != GST_PAD_LINK_OK) {
+    GST_WARNING ("Could not link %" GST_PTR_FORMAT " to %" GST_PTR_FORMAT,
+        pad, sinkpad);
+    goto done;
+  }
+  data->n_pads++;
+
+done:
+  g_mutex_unlock (&data->lock);
+  gst_caps_unref (caps);
+}
+
+static void
+_concat_no_more_pads_cb (GstElement * source, ConcatData * data)
+{
+  g_mutex_lock (&data->lock);
+  data->no_more_pads = TRUE;
+  _concat_check_segment_done (data);
+  g_mutex_unlock (&data->lock);
+}
+
+static gboolean
+_concat_add_source (ConcatData * data)
+{
+  gchar *path, *uri;
+  Segment *segment = &g_array_index (data->segments, Segment, data->current);
+
+  path = g_build_filename (data->directory, segment->location, NULL);
+  uri = gst_filename_to_uri (path, NULL);
+  g_free (path);
+
+  GST_DEBUG ("Concatenating %s at %" GST_TIME_FORMAT, uri,
+      GST_TIME_ARGS (data->offset));
+
+  data->source = gst_element_factory_make ("uridecodebin", NULL);
+  g_object_set (data->source, "uri", uri, "caps", data->formats, NULL);
+  g_free (uri);
+
+  g_signal_connect (data->source, "pad-added",
+      G_CALLBACK (_concat_pad_added_cb), data);
+  g_signal_connect (data->source, "no-more-pads",
+      G_CALLBACK (_concat_no_more_pads_cb), data);
+  gst_bin_add (GST_BIN (data->pipeline), data->source);
+
+  return gst_element_sync_state_with_parent (data->source);
+}
+
+/* Called from the thread waiting on the bus once all the streams of the
+ * current segment are done */
+static gboolean
+_concat_next_source (ConcatData * data)
+{
+  Segment *segment = &g_array_index (data->segments, Segment, data->current);
+
+  gst_element_set_state (data->source, GST_STATE_NULL);
+  gst_bin_remove (GST_BIN (data->pipeline), data->source);
+
+  g_mutex_lock (&data->lock);
+  data->offset += segment->stop - segment->start;
+  data->current++;
+  data->n_pads = data->n_eos = 0;
+  data->no_more_pads = FALSE;
+  g_mutex_unlock (&data->lock);
+
+  return _concat_add_source (data);
+}
+
+static GstCaps *
+_get_encoded_formats (GstEncodingProfile * profile)
+{
+  const GList *tmp;
+  GstCaps *formats;
+
+  if (!GST_IS_ENCODING_CONTAINER_PROFILE (profile))
+    return gst_encoding_profile_get_format (profile);
+
+  formats = gst_caps_new_empty ();
+  for (tmp = gst_encoding_container_profile_get_profiles
+      (GST_ENCODING_CONTAINER_PROFILE (profile)); tmp; tmp = tmp->next)
+    gst_caps_append (formats, gst_encoding_profile_get_format (tmp->data));
+
+  return formats;
+}
+
+/* Concatenates @segments into @location. Their streams are only demuxed and
+ * muxed again, one segment after the other, as they were all encoded with
+ * the same settings */
+static gboolean
+_concat_segments (GstEncodingProfile * profile, const gchar * location,
+    const gchar * directory, GArray * segments)
+{
+  GstBus *bus;
+  gchar *partial;
+  GstMessage *msg;
+  GstElement *sink;
+  ConcatData data = { NULL, };
+  gboolean done = FALSE, res = FALSE;
+
+  partial = g_strconcat (location, PARTIAL_FILE_SUFFIX, NULL);
+
+  data.pipeline = gst_pipeline_new ("ges-concat-segments");
+  data.encodebin = gst_element_factory_make ("encodebin", NULL);
+  sink = gst_element_factory_make ("filesink", NULL);
+  if (data.encodebin == NULL || sink == NULL) {
+    GST_WARNING ("Missing encodebin or filesink");
+    if (data.encodebin)
+      gst_object_unref (data.encodebin);
+    if (sink)
+      gst_object_unref (sink);
+    gst_object_unref (data.pipeline);
+    goto done;
+  }
+
+  g_object_set (data.encodebin, "profile", profile, NULL);
+  g_object_set (sink, "location", partial, NULL);
+  gst_bin_add_many (GST_BIN (data.pipeline), data.encodebin, sink, NULL);
+  gst_element_link (data.encodebin, sink);
+
+  g_mutex_init (&data.lock);
+  data.formats = _get_encoded_formats (profile);
+  data.sinkpads = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      gst_object_unref);
+  data.segments = segments;
+  data.directory = directory;
+
+  GST_INFO ("Concatenating %u segments to %s", segments->len, location);
+
+  bus = gst_element_get_bus (data.pipeline);
+  if (!_concat_add_source (&data) ||
+      gst_element_set_state (data.pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE)
+    done = TRUE;
+
+  while (!done) {
+    msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR | GST_MESSAGE_APPLICATION);
+
+    switch (GST_MESSAGE_TYPE (msg)) {
+      case GST_MESSAGE_EOS:
+        res = TRUE;
+        done = TRUE;
+        break;
+      case GST_MESSAGE_ERROR:{
+        GError *err = NULL;
+
+        gst_message_parse_error (msg, &err, NULL);
+        GST_WARNING ("Could not concatenate the segments: %s", err->message);
+        g_error_free (err);
+        done = TRUE;
+        break;
+      }
+      default:
+        if (gst_message_has_name (msg, "ges-concat-next-segment"))
+          done = !_concat_next_source (&data);
+        break;
+    }
+    gst_message_unref (msg);
+  }
+
+  gst_element_set_state (data.pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (data.pipeline);
+  g_hash_table_unref (data.sinkpads);
+  gst_caps_unref (data.formats);
+  g_mutex_clear (&data.lock);
+
+  if (res && g_rename (partial, location) != 0) {
+    GST_WARNING ("Could not move %s to %s", partial, location);
+    res = FALSE;
+  }
+
+done:
+  if (!res)
+    g_unlink (partial);
+  g_free (partial);
+
+  return res;
+}
+
+/* Removes the segment files that are not used anymore */
+static void
+_remove_stale_segments (const gchar * directory, GArray * segments)
+{
+  guint i;
+  GDir *dir;
+  const gchar *name;
+
+  if (!(dir = g_dir_open (directory, 0, NULL)))
+    return;
+
+  while ((name = g_dir_read_name (dir))) {
+    gboolean used = FALSE;
+
+    if (!g_str_has_prefix (name, SEGMENT_PREFIX))
+      continue;
+
+    for (i = 0; i < segments->len && !used; i++)
+      used = !g_strcmp0 (name, g_array_index (segments, Segment, i).location);
+
+    if (!used) {
+      gchar *path = g_build_filename (directory, name, NULL);
+
+      GST_DEBUG ("Removing stale segment %s", path);
+      g_unlink (path);
+      g_free (path);
+    }
+  }
+
+  g_dir_close (dir);
+}
+
+gboolean
+_ges_render_incremental (GESTimeline * timeline, const gchar * output_uri,
+    GstEncodingProfile * profile, GstClockTime segment_duration,
+    GError ** error)
+{
+  guint i, n_rendered = 0;
+  guint64 settings_hash;
+  GstClockTime duration;
+  const gchar *extension;
+  gchar *location, *directory = NULL, *manifest = NULL;
+  GArray *previous = NULL, *segments = NULL, *boundaries = NULL;
+  gboolean res = FALSE;
+
+  if (!(location = g_filename_from_uri (output_uri, NULL, NULL))) {
+    g_set_error (error, GES_ERROR, GES_ERROR_RENDERING,
+        "Incremental rendering only works with local files, not %s",
+        output_uri);
+
+    return FALSE;
+  }
+
+  duration = ges_timeline_get_duration (timeline);
+  if (duration == 0) {
+    g_set_error (error, GES_ERROR, GES_ERROR_RENDERING, "Timeline is empty");
+    goto done;
+  }
+
+  directory = g_strconcat (location, SEGMENTS_DIR_SUFFIX, NULL);
+  manifest = g_build_filename (directory, MANIFEST_FILENAME, NULL);
+  if (g_mkdir_with_parents (directory, 0755) != 0) {
+    g_set_error (error, GES_ERROR, GES_ERROR_RENDERING,
+        "Could not create directory %s", directory);
+    goto done;
+  }
+
+  settings_hash = _compute_settings_hash (profile);
+  extension = _get_extension (profile);
+  previous = _load_manifest (manifest, settings_hash);
+  boundaries = _compute_boundaries (timeline, duration, segment_duration);
+
+  segments = g_array_new (FALSE, TRUE, sizeof (Segment));
+  g_array_set_clear_func (segments, (GDestroyNotify) _segment_clear);
+
+  for (i = 1; i < boundaries->len; i++) {
+    Segment segment, *prev;
+    gchar *path;
+
+    segment.start = g_array_index (boundaries, GstClockTime, i - 1);
+    segment.stop = g_array_index (boundaries, GstClockTime, i);
+    segment.hash = _ges_timeline_get_segment_hash (timeline, segment.start,
+        segment.stop);
+
+    /* The same content might have been rendered somewhere else, before a
+     * ripple edit for example */
+    if (!(prev = _find_segment (segments, segment.hash)))
+      prev = _find_segment (previous, segment.hash);
+
+    if (prev) {
+      path = g_build_filename (directory, prev->location, NULL);
+      if (g_file_test (path, G_FILE_TEST_IS_REGULAR)) {
+        GST_DEBUG ("Segment [%" GST_TIME_FORMAT " - %" GST_TIME_FORMAT
+            "] did not change, keeping %s", GST_TIME_ARGS (segment.start),
+            GST_TIME_ARGS (segment.stop), path);
+        segment.location = g_strdup (prev->location);
+        g_array_append_val (segments, segment);
+        g_free (path);
+
+        continue;
+      }
+      g_free (path);
+    }
+
+    /* Name segments after their hash so we never overwrite a segment
+     * that is still in use */
+    segment.location = g_strdup_printf (SEGMENT_PREFIX "%016"
+        G_GINT64_MODIFIER "x%s", segment.hash, extension);
+    g_array_append_val (segments, segment);
+
+    path = g_build_filename (directory, segment.location, NULL);
+    if (!_render_segment (timeline, profile, path, segment.start,
+            segment.stop)) {
+      g_set_error (error, GES_ERROR, GES_ERROR_RENDERING,
+          "Could not render segment [%" GST_TIME_FORMAT " - %"
+          GST_TIME_FORMAT "]", GST_TIME_ARGS (segment.start),
+          GST_TIME_ARGS (segment.stop));
+      g_free (path);
+      goto done;
+    }
+    g_free (path);
+    n_rendered++;
+  }
+
+  if (!_save_manifest (manifest, settings_hash, segments, error))
+    goto done;
+
+  _remove_stale_segments (directory, segments);
+
+  GST_INFO ("Rendered %u segments out of %u", n_rendered, segments->len);
+  if (!_concat_segments (profile, location, directory, segments)) {
+    g_set_error (error, GES_ERROR, GES_ERROR_RENDERING,
+        "Could not concatenate the segments into %s", location);
+    goto done;
+  }
+
+  res = TRUE;
+
+done:
+  if (previous)
+    g_array_free (previous, TRUE);
+  if (segments)
+    g_array_free (segments, TRUE);
+  if (boundaries)
+    g_array_free (boundaries, TRUE);
+  g_free (manifest);
+  g_free (directory);
+  g_free (location);
+
+  return res;
+}
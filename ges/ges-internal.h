@@ -23,6 +23,7 @@
 
 #include <gst/gst.h>
 #include <gio/gio.h>
+#include <gst/pbutils/encoding-profile.h>
 
 #include "ges-timeline.h"
 #include "ges-track-element.h"
@@ -91,6 +92,68 @@ void
 timeline_remove_group          (GESTimeline *timeline,
                                 GESGroup *group);
 
+G_GNUC_INTERNAL void
+timeline_update_clip_asset     (GESTimeline *timeline,
+                                GESClip *clip);
+
+G_GNUC_INTERNAL void
+timeline_invalidate_clip_hash  (GESTimeline *timeline,
+                                GESClip *clip);
+
+G_GNUC_INTERNAL void
+timeline_freeze_transitions    (GESTimeline *timeline);
+
+G_GNUC_INTERNAL void
+timeline_thaw_transitions      (GESTimeline *timeline,
+                                GESLayer *layer);
+
+/* Builds the clips of a lazily loaded project overlapping [@start, @stop) in
+ * @layer, or in all the layers if %NULL, only keeping the ones extracted from
+ * @asset and having @meta_item set when not %NULL. Sets @unloaded_end to the
+ * end of the clips left. Returns %FALSE once all the clips have been built */
+typedef gboolean (*GESTimelineLoadRangeFunc) (GESTimeline *timeline,
+                                              GESLayer *layer,
+                                              GstClockTime start,
+                                              GstClockTime stop,
+                                              GESAsset *asset,
+                                              const gchar *meta_item,
+                                              GstClockTime *unloaded_end,
+                                              gpointer user_data);
+
+G_GNUC_INTERNAL void
+timeline_set_lazy_loader       (GESTimeline *timeline,
+                                GESTimelineLoadRangeFunc func,
+                                GstClockTime unloaded_end,
+                                gpointer user_data,
+                                GDestroyNotify destroy);
+
+G_GNUC_INTERNAL void
+timeline_load_range            (GESTimeline *timeline,
+                                GESLayer *layer,
+                                GstClockTime start,
+                                GstClockTime stop);
+
+G_GNUC_INTERNAL gboolean
+timeline_load_for_playback     (GESTimeline *timeline);
+
+G_GNUC_INTERNAL GstClockTime
+timeline_get_loaded_duration   (GESTimeline *timeline);
+
+/* Extra positions to snap to, @timecode must stay valid until removed and
+ * timeline_snap_point_moved be called whenever its value changes */
+G_GNUC_INTERNAL void
+timeline_add_snap_point        (GESTimeline *timeline,
+                                guint64 *timecode);
+
+G_GNUC_INTERNAL void
+timeline_remove_snap_point     (GESTimeline *timeline,
+                                guint64 *timecode);
+
+G_GNUC_INTERNAL void
+timeline_snap_point_moved      (GESTimeline *timeline,
+                                guint64 *timecode,
+                                guint64 old_position);
+
 G_GNUC_INTERNAL void
 ges_asset_cache_init (void);
 
@@ -116,6 +179,12 @@ G_GNUC_INTERNAL gboolean
 ges_asset_request_id_update (GESAsset *asset, gchar **proposed_id,
     GError *error);
 
+G_GNUC_INTERNAL void
+ges_asset_add_extractable (GESAsset *asset, GESExtractable *extractable);
+
+G_GNUC_INTERNAL void
+ges_asset_remove_extractable (GESAsset *asset, GESExtractable *extractable);
+
 /* GESExtractable internall methods
  *
  * FIXME Check if that should be public later
@@ -239,6 +308,12 @@ G_GNUC_INTERNAL void ges_base_xml_formatter_add_control_binding (GESBaseXmlForma
                                                                   const gchar *track_id,
                                                                   GSList * timed_values);
 
+G_GNUC_INTERNAL void ges_base_xml_formatter_add_marker          (GESBaseXmlFormatter * self,
+                                                                 GType owner_type,
+                                                                 GstClockTime position,
+                                                                 const gchar *metadatas,
+                                                                 GError **error);
+
 G_GNUC_INTERNAL void set_property_foreach                       (GQuark field_id,
                                                                  const GValue * value,
                                                                  GObject * object);;
@@ -252,6 +327,20 @@ G_GNUC_INTERNAL gint element_start_compare                (GESTimelineElement *
                                                            GESTimelineElement * b);
 G_GNUC_INTERNAL gint element_end_compare                  (GESTimelineElement * a,
                                                            GESTimelineElement * b);
+G_GNUC_INTERNAL gchar * ges_get_media_cache_location      (const gchar * uri,
+                                                           const gchar * subdir,
+                                                           const gchar * extra);
+G_GNUC_INTERNAL GBytes * ges_media_cache_load             (const gchar * location);
+G_GNUC_INTERNAL gboolean ges_media_cache_save             (const gchar * location,
+                                                           GBytes * data);
+
+/* How long media decoded in the background can go without producing any
+ * data before it is considered stuck */
+#define GES_MEDIA_STALL_TIMEOUT (30 * GST_SECOND)
+
+G_GNUC_INTERNAL gboolean ges_wait_for_eos                 (GstElement * pipeline,
+                                                           volatile gint * progress,
+                                                           GstClockTime stall_timeout);
 
 void
 ges_base_xml_formatter_set_timeline_properties(GESBaseXmlFormatter * self,
@@ -259,12 +348,45 @@ ges_base_xml_formatter_set_timeline_properties(GESBaseXmlFormatter * self,
 					       const gchar *properties,
 					       const gchar *metadatas);
 
+/****************************************************
+ *         GESTimelineElement content hash          *
+ ****************************************************/
+G_GNUC_INTERNAL guint64 _ges_timeline_element_get_content_hash      (GESTimelineElement *self,
+                                                                     gboolean *is_volatile);
+G_GNUC_INTERNAL guint64 _ges_timeline_element_get_media_hash        (GESTimelineElement *self);
+G_GNUC_INTERNAL void    _ges_timeline_element_invalidate_content_hash (GESTimelineElement *self);
+G_GNUC_INTERNAL void    _ges_layer_invalidate_content_hash          (GESLayer *layer);
+G_GNUC_INTERNAL guint64 _ges_layer_get_content_hash                 (GESLayer *layer,
+                                                                     gboolean *is_volatile);
+G_GNUC_INTERNAL guint64 _ges_timeline_get_range_hash                (GESTimeline *timeline,
+                                                                     GstClockTime start,
+                                                                     GstClockTime stop);
+G_GNUC_INTERNAL guint64 _ges_timeline_get_segment_hash              (GESTimeline *timeline,
+                                                                     GstClockTime start,
+                                                                     GstClockTime stop);
+G_GNUC_INTERNAL guint64 _ges_checksum_get_uint64                    (GChecksum *checksum);
+G_GNUC_INTERNAL void    _ges_checksum_update_hashes                 (GChecksum *checksum,
+                                                                     GArray *hashes);
+G_GNUC_INTERNAL void    _ges_checksum_update_value                  (GChecksum *checksum,
+                                                                     const gchar *name,
+                                                                     const GValue *value);
+
 /****************************************************
  *              GESContainer                        *
  ****************************************************/
 G_GNUC_INTERNAL void _ges_container_sort_children         (GESContainer *container);
 G_GNUC_INTERNAL void _ges_container_sort_children_by_end  (GESContainer *container);
 
+/****************************************************
+ *                  GESLayer                        *
+ ****************************************************/
+G_GNUC_INTERNAL gboolean _ges_layer_add_clip_full (GESLayer *layer,
+                                                   GESClip *clip,
+                                                   gboolean resync_priorities);
+G_GNUC_INTERNAL void     _ges_layer_add_clips     (GESLayer *layer,
+                                                   GList *clips);
+G_GNUC_INTERNAL GList *  _ges_layer_get_loaded_clips (GESLayer *layer);
+
 /****************************************************
  *                  GESClip                         *
  ****************************************************/
@@ -285,14 +407,82 @@ G_GNUC_INTERNAL guint32   _ges_track_element_get_layer_priority (GESTrackElement
 G_GNUC_INTERNAL void ges_track_element_copy_properties          (GESTimelineElement * element,
                                                                  GESTimelineElement * elementcopy);
 
+G_GNUC_INTERNAL gboolean ges_track_element_hash_children_properties (GESTrackElement *self,
+                                                                     GChecksum *checksum);
+
 G_GNUC_INTERNAL void ges_track_element_split_bindings (GESTrackElement *element,
 						       GESTrackElement *new_element,
 						       guint64 position);
+G_GNUC_INTERNAL void ges_track_element_copy_bindings  (GESTrackElement *element,
+                                                        GESTrackElement *new_element);
+
+G_GNUC_INTERNAL void ges_track_element_set_profiling  (GESTrackElement *self,
+                                                        gboolean profiling);
+G_GNUC_INTERNAL GstStructure * ges_track_element_get_profile (GESTrackElement *self);
 
 G_GNUC_INTERNAL GstElement *ges_source_create_topbin (const gchar * bin_name, GstElement * sub_element, ...);
 
 G_GNUC_INTERNAL void ges_track_set_caps (GESTrack *track, const GstCaps *caps);
+G_GNUC_INTERNAL GstElement * ges_track_add_cache_source    (GESTrack *track,
+                                                            const gchar *uri,
+                                                            GstClockTime start,
+                                                            GstClockTime duration);
+G_GNUC_INTERNAL void ges_track_remove_cache_source         (GESTrack *track,
+                                                            GstElement *source);
+
+
+/****************************************************
+ *                GESRenderCache                    *
+ ****************************************************/
+#define DEFAULT_RENDER_CACHE_MAX_SIZE (G_GUINT64_CONSTANT (2) << 30)
+
+typedef struct _GESRenderCache GESRenderCache;
+
+G_GNUC_INTERNAL GESRenderCache * ges_render_cache_new       (GESTimeline *timeline);
+G_GNUC_INTERNAL void         ges_render_cache_free          (GESRenderCache *cache);
+G_GNUC_INTERNAL const gchar *ges_render_cache_get_directory (GESRenderCache *cache);
+G_GNUC_INTERNAL void         ges_render_cache_set_directory (GESRenderCache *cache,
+                                                             const gchar *directory);
+G_GNUC_INTERNAL guint64      ges_render_cache_get_max_size  (GESRenderCache *cache);
+G_GNUC_INTERNAL void         ges_render_cache_set_max_size  (GESRenderCache *cache,
+                                                             guint64 max_size);
+G_GNUC_INTERNAL gboolean     ges_render_cache_add_region    (GESRenderCache *cache,
+                                                             GstClockTime start,
+                                                             GstClockTime duration);
+G_GNUC_INTERNAL gboolean     ges_render_cache_remove_region (GESRenderCache *cache,
+                                                             GstClockTime start,
+                                                             GstClockTime duration);
+G_GNUC_INTERNAL void         ges_render_cache_update        (GESRenderCache *cache);
+
+/****************************************************
+ *                GESMetaStore                      *
+ ****************************************************/
+typedef struct _GESMetaStore GESMetaStore;
+
+G_GNUC_INTERNAL GESMetaStore * ges_meta_store_new      (void);
+G_GNUC_INTERNAL void         ges_meta_store_free       (GESMetaStore *store);
+G_GNUC_INTERNAL GList *      ges_meta_store_find       (GESMetaStore *store,
+                                                        const gchar *meta_item,
+                                                        const GValue *value);
+G_GNUC_INTERNAL void         ges_meta_container_set_store (GESMetaContainer *container,
+                                                           GESMetaStore *store);
+G_GNUC_INTERNAL GESMetaStore * _ges_timeline_get_meta_store (GESTimeline *timeline);
 
+/****************************************************
+ *                  Rendering                       *
+ ****************************************************/
+G_GNUC_INTERNAL GESTimeline * _ges_timeline_copy_range    (GESTimeline *timeline,
+                                                           GstClockTime start,
+                                                           GstClockTime stop);
+G_GNUC_INTERNAL gboolean      _ges_pipeline_render_range  (GESPipeline *self,
+                                                           GstClockTime start,
+                                                           GstClockTime stop,
+                                                           volatile gint *cancelled);
+G_GNUC_INTERNAL gboolean      _ges_render_incremental     (GESTimeline *timeline,
+                                                           const gchar *output_uri,
+                                                           GstEncodingProfile *profile,
+                                                           GstClockTime segment_duration,
+                                                           GError **error);
 
 /*********************************************
  *  GESTrackElement subclasses contructores  *
@@ -316,4 +506,63 @@ typedef struct GESMultiFileURI
 
 G_GNUC_INTERNAL GESMultiFileURI * ges_multi_file_uri_new (const gchar * uri);
 
+/*****************************
+ *  Decoded frames cache API *
+ *****************************/
+G_GNUC_INTERNAL void         ges_frame_cache_init                   (void);
+G_GNUC_INTERNAL GstSample  * ges_frame_cache_get                    (const gchar * uri);
+G_GNUC_INTERNAL GstElement * ges_frame_cache_create_image_source    (const gchar * uri);
+G_GNUC_INTERNAL GstElement * ges_frame_cache_create_sequence_source (const gchar * pattern,
+                                                                     gint start,
+                                                                     gint stop,
+                                                                     gint fps_n,
+                                                                     gint fps_d);
+
+/*****************************
+ *     Asset analysis API    *
+ *****************************/
+G_GNUC_INTERNAL GstStructure * ges_asset_analysis_run   (const gchar * uri,
+                                                         GCancellable * cancellable,
+                                                         GError ** error);
+G_GNUC_INTERNAL void           ges_asset_analysis_apply (const GstStructure * results,
+                                                         GESMetaContainer * container);
+
+/*****************************
+ *      Audio peaks API      *
+ *****************************/
+typedef void (*GESAudioPeaksReadyFunc) (GBytes * peaks, gpointer user_data);
+
+G_GNUC_INTERNAL void     ges_audio_peaks_init      (void);
+G_GNUC_INTERNAL void     ges_audio_peaks_request   (const gchar * uri,
+                                                    const gchar * stream_id,
+                                                    GESAudioPeaksReadyFunc func,
+                                                    gpointer user_data,
+                                                    GDestroyNotify notify);
+G_GNUC_INTERNAL GBytes * ges_audio_peaks_get_range (GBytes * peaks,
+                                                    GstClockTime start,
+                                                    GstClockTime stop,
+                                                    guint samples_per_pixel,
+                                                    guint * samples_per_peak);
+
+/*****************************
+ *       Seek index API      *
+ *****************************/
+typedef void (*GESSeekIndexReadyFunc) (GBytes * index, gpointer user_data);
+
+G_GNUC_INTERNAL void     ges_seek_index_init    (void);
+G_GNUC_INTERNAL void     ges_seek_index_request (const gchar * uri,
+                                                 const gchar * stream_id,
+                                                 GESSeekIndexReadyFunc func,
+                                                 gpointer user_data,
+                                                 GDestroyNotify notify);
+G_GNUC_INTERNAL gboolean ges_seek_index_lookup  (GBytes * index,
+                                                 GstClockTime position,
+                                                 GstClockTime * keyframe,
+                                                 guint * n_skip_frames);
+
+/*****************************
+ *        Markers API        *
+ *****************************/
+G_GNUC_INTERNAL guint64 * ges_marker_get_timecode (GESMarker * marker);
+
 #endif /* __GES_INTERNAL_H__ */
@@ -52,6 +52,12 @@ struct _GESLayerPrivate
   guint32 priority;             /* The priority of the layer within the
                                  * containing timeline */
   gboolean auto_transition;
+
+  /* Cached content hash, only valid if !hash_dirty */
+  guint64 hash;
+  gboolean hash_dirty;
+
+  GESMarkerList *markers;       /* Created on demand */
 };
 
 typedef struct
@@ -125,6 +131,8 @@ ges_layer_dispose (GObject * object)
   while (priv->clips_start)
     ges_layer_remove_clip (layer, (GESClip *) priv->clips_start->data);
 
+  g_clear_object (&priv->markers);
+
   G_OBJECT_CLASS (ges_layer_parent_class)->dispose (object);
 }
 
@@ -209,6 +217,7 @@ ges_layer_init (GESLayer * self)
 
   self->priv->priority = 0;
   self->priv->auto_transition = FALSE;
+  self->priv->hash_dirty = TRUE;
   self->min_gnl_priority = MIN_GNL_PRIO;
   self->max_gnl_priority = LAYER_HEIGHT + MIN_GNL_PRIO;
 
@@ -300,6 +309,9 @@ ges_layer_get_duration (GESLayer * layer)
   GList *tmp;
   GstClockTime duration = 0;
 
+  if (layer->timeline)
+    timeline_load_range (layer->timeline, layer, 0, GST_CLOCK_TIME_NONE);
+
   for (tmp = layer->priv->clips_start; tmp; tmp = tmp->next) {
     duration = MAX (duration, _END (tmp->data));
   }
@@ -352,6 +364,7 @@ ges_layer_remove_clip (GESLayer * layer, GESClip * clip)
 
   /* Remove it from our list of controlled objects */
   layer->priv->clips_start = g_list_remove (layer->priv->clips_start, clip);
+  _ges_layer_invalidate_content_hash (layer);
 
   /* Remove our reference to the clip */
   gst_object_unref (clip);
@@ -380,6 +393,7 @@ ges_layer_set_priority (GESLayer * layer, guint priority)
     layer->max_gnl_priority = ((priority + 1) * LAYER_HEIGHT) + MIN_GNL_PRIO;
 
     ges_layer_resync_priorities (layer);
+    _ges_layer_invalidate_content_hash (layer);
   }
 
   g_object_notify (G_OBJECT (layer), "priority");
@@ -440,7 +454,8 @@ ges_layer_get_priority (GESLayer * layer)
  * ges_layer_get_clips:
  * @layer: a #GESLayer
  *
- * Get the clips this layer contains.
+ * Get the clips this layer contains. If @layer is part of a lazily loaded
+ * timeline, all its clips are loaded first, see ges_timeline_load_range().
  *
  * Returns: (transfer full) (element-type GESClip): a #GList of
  * clips. The user is responsible for
@@ -450,11 +465,20 @@ ges_layer_get_priority (GESLayer * layer)
 GList *
 ges_layer_get_clips (GESLayer * layer)
 {
-  GESLayerClass *klass;
-
   g_return_val_if_fail (GES_IS_LAYER (layer), NULL);
 
-  klass = GES_LAYER_GET_CLASS (layer);
+  if (layer->timeline)
+    timeline_load_range (layer->timeline, layer, 0, GST_CLOCK_TIME_NONE);
+
+  return _ges_layer_get_loaded_clips (layer);
+}
+
+/* Same as ges_layer_get_clips, without building the clips of a lazily
+ * loaded project that have not been needed yet */
+GList *
+_ges_layer_get_loaded_clips (GESLayer * layer)
+{
+  GESLayerClass *klass = GES_LAYER_GET_CLASS (layer);
 
   if (klass->get_objects) {
     return klass->get_objects (layer);
@@ -465,6 +489,26 @@ ges_layer_get_clips (GESLayer * layer)
       (GCompareFunc) element_start_compare);
 }
 
+/**
+ * ges_layer_get_marker_list:
+ * @layer: a #GESLayer
+ *
+ * Gets the markers of @layer, positioned in the time coordinates of the
+ * timeline.
+ *
+ * Returns: (transfer none): The #GESMarkerList of @layer
+ */
+GESMarkerList *
+ges_layer_get_marker_list (GESLayer * layer)
+{
+  g_return_val_if_fail (GES_IS_LAYER (layer), NULL);
+
+  if (layer->priv->markers == NULL)
+    layer->priv->markers = ges_marker_list_new ();
+
+  return layer->priv->markers;
+}
+
 /**
  * ges_layer_is_empty:
  * @layer: The #GESLayer to check
@@ -480,6 +524,9 @@ ges_layer_is_empty (GESLayer * layer)
 {
   g_return_val_if_fail (GES_IS_LAYER (layer), FALSE);
 
+  if (layer->timeline)
+    timeline_load_range (layer->timeline, layer, 0, GST_CLOCK_TIME_NONE);
+
   return (layer->priv->clips_start == NULL);
 }
 
@@ -503,14 +550,58 @@ ges_layer_is_empty (GESLayer * layer)
  */
 gboolean
 ges_layer_add_clip (GESLayer * layer, GESClip * clip)
+{
+  g_return_val_if_fail (GES_IS_LAYER (layer), FALSE);
+  g_return_val_if_fail (GES_IS_CLIP (clip), FALSE);
+
+  return _ges_layer_add_clip_full (layer, clip, TRUE);
+}
+
+/* Everything that needs to be done once @clip is in the clips_start list */
+static void
+_clip_inserted (GESLayer * layer, GESClip * clip, gboolean resync_priorities)
+{
+  _ges_layer_invalidate_content_hash (layer);
+
+  /* Inform the clip it's now in this layer */
+  ges_clip_set_layer (clip, layer);
+
+  GST_DEBUG ("current clip priority : %d, Height: %d", _PRIORITY (clip),
+      LAYER_HEIGHT);
+
+  /* Set the priority. */
+  if (_PRIORITY (clip) > LAYER_HEIGHT) {
+    GST_WARNING_OBJECT (layer,
+        "%p is out of the layer space, setting its priority to "
+        "%d, setting it to the maximum priority of the layer: %d", clip,
+        _PRIORITY (clip), LAYER_HEIGHT - 1);
+    _set_priority0 (GES_TIMELINE_ELEMENT (clip), LAYER_HEIGHT - 1);
+  }
+
+  /* If the clip has an acceptable priority, we just let it with its current
+   * priority */
+  if (resync_priorities)
+    ges_layer_resync_priorities (layer);
+  else
+    _set_priority0 (GES_TIMELINE_ELEMENT (clip), _PRIORITY (clip));
+  ges_timeline_element_set_timeline (GES_TIMELINE_ELEMENT (clip),
+      layer->timeline);
+
+  /* emit 'clip-added' */
+  g_signal_emit (layer, ges_layer_signals[OBJECT_ADDED], 0, clip);
+}
+
+/* When @resync_priorities is %FALSE only @clip priority is set, which is
+ * enough when the other clips of @layer are not being modified, and avoids
+ * going through all of them for each added clip */
+gboolean
+_ges_layer_add_clip_full (GESLayer * layer, GESClip * clip,
+    gboolean resync_priorities)
 {
   GESAsset *asset;
   GESLayerPrivate *priv;
   GESLayer *current_layer;
 
-  g_return_val_if_fail (GES_IS_LAYER (layer), FALSE);
-  g_return_val_if_fail (GES_IS_CLIP (clip), FALSE);
-
   GST_DEBUG_OBJECT (layer, "adding clip:%p", clip);
 
   priv = layer->priv;
@@ -563,32 +654,39 @@ ges_layer_add_clip (GESLayer * layer, GESClip * clip)
   /* Take a reference to the clip and store it stored by start/priority */
   priv->clips_start = g_list_insert_sorted (priv->clips_start, clip,
       (GCompareFunc) element_start_compare);
+  _clip_inserted (layer, clip, resync_priorities);
 
-  /* Inform the clip it's now in this layer */
-  ges_clip_set_layer (clip, layer);
+  return TRUE;
+}
 
-  GST_DEBUG ("current clip priority : %d, Height: %d", _PRIORITY (clip),
-      LAYER_HEIGHT);
+/* Adds all @clips, which must have their asset set, sorting the clips of
+ * @layer once for all of them. Only their own priorities are set, as with
+ * _ges_layer_add_clip_full without @resync_priorities */
+void
+_ges_layer_add_clips (GESLayer * layer, GList * clips)
+{
+  GList *tmp, *added = NULL;
 
-  /* Set the priority. */
-  if (_PRIORITY (clip) > LAYER_HEIGHT) {
-    GST_WARNING_OBJECT (layer,
-        "%p is out of the layer space, setting its priority to "
-        "%d, setting it to the maximum priority of the layer: %d", clip,
-        _PRIORITY (clip), LAYER_HEIGHT - 1);
-    _set_priority0 (GES_TIMELINE_ELEMENT (clip), LAYER_HEIGHT - 1);
-  }
+  for (tmp = clips; tmp; tmp = tmp->next) {
+    GESLayer *current_layer = ges_clip_get_layer (tmp->data);
 
-  /* If the clip has an acceptable priority, we just let it with its current
-   * priority */
-  ges_layer_resync_priorities (layer);
-  ges_timeline_element_set_timeline (GES_TIMELINE_ELEMENT (clip),
-      layer->timeline);
+    if (G_UNLIKELY (current_layer)) {
+      GST_WARNING ("Clip %p already belongs to another layer", tmp->data);
+      gst_object_unref (current_layer);
+      continue;
+    }
 
-  /* emit 'clip-added' */
-  g_signal_emit (layer, ges_layer_signals[OBJECT_ADDED], 0, clip);
+    added = g_list_prepend (added, gst_object_ref_sink (tmp->data));
+  }
+  added = g_list_reverse (added);
 
-  return TRUE;
+  layer->priv->clips_start = g_list_sort (g_list_concat
+      (layer->priv->clips_start, g_list_copy (added)),
+      (GCompareFunc) element_start_compare);
+
+  for (tmp = added; tmp; tmp = tmp->next)
+    _clip_inserted (layer, tmp->data, FALSE);
+  g_list_free (added);
 }
 
 /**
@@ -690,3 +788,65 @@ ges_layer_set_timeline (GESLayer * layer, GESTimeline * timeline)
 
   layer->timeline = timeline;
 }
+
+void
+_ges_layer_invalidate_content_hash (GESLayer * layer)
+{
+  layer->priv->hash_dirty = TRUE;
+}
+
+guint64
+_ges_layer_get_content_hash (GESLayer * layer, gboolean * is_volatile)
+{
+  GList *tmp;
+  GArray *hashes;
+  GChecksum *checksum;
+  gboolean volatile_hash = FALSE;
+  GESLayerPrivate *priv = layer->priv;
+
+  if (priv->hash_dirty) {
+    checksum = g_checksum_new (G_CHECKSUM_SHA1);
+    hashes = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+    g_checksum_update (checksum, (const guchar *) &priv->priority,
+        sizeof (priv->priority));
+    for (tmp = priv->clips_start; tmp; tmp = tmp->next) {
+      gboolean clip_volatile;
+      guint64 hash = _ges_timeline_element_get_content_hash (tmp->data,
+          &clip_volatile);
+
+      g_array_append_val (hashes, hash);
+      volatile_hash |= clip_volatile;
+    }
+    _ges_checksum_update_hashes (checksum, hashes);
+
+    priv->hash = _ges_checksum_get_uint64 (checksum);
+    priv->hash_dirty = volatile_hash;
+
+    g_array_free (hashes, TRUE);
+    g_checksum_free (checksum);
+  }
+
+  if (is_volatile)
+    *is_volatile = priv->hash_dirty;
+
+  return priv->hash;
+}
+
+/**
+ * ges_layer_get_content_hash:
+ * @layer: a #GESLayer
+ *
+ * Gets a hash of the content of @layer, that is its priority and the
+ * content hash of all the #GESClip-s it contains. See
+ * ges_timeline_element_get_content_hash().
+ *
+ * Returns: The content hash of @layer
+ */
+guint64
+ges_layer_get_content_hash (GESLayer * layer)
+{
+  g_return_val_if_fail (GES_IS_LAYER (layer), 0);
+
+  return _ges_layer_get_content_hash (layer, NULL);
+}
@@ -124,7 +124,9 @@ void ges_layer_set_auto_transition (GESLayer * layer,
 					     gboolean auto_transition);
 
 GList*   ges_layer_get_clips   (GESLayer * layer);
+GESMarkerList * ges_layer_get_marker_list (GESLayer * layer);
 GstClockTime ges_layer_get_duration (GESLayer *layer);
+guint64 ges_layer_get_content_hash (GESLayer *layer);
 
 G_END_DECLS
 
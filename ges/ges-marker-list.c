@@ -0,0 +1,479 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:ges-marker-list
+ * @short_description: Ordered list of markers on a timeline, layer or clip
+ *
+ * A #GESMarkerList holds #GESMarker-s sorted by position, so that adding,
+ * moving or removing a marker, getting the markers in a range or the one
+ * closest to a position are all done in logarithmic time.
+ *
+ * Every #GESTimeline, #GESLayer and #GESClip has its own list, see
+ * ges_timeline_get_marker_list(), ges_layer_get_marker_list() and
+ * ges_clip_get_marker_list(). Positions are expressed in the time
+ * coordinates of the timeline for the timeline and layer lists, and relative
+ * to the start of the clip for the clip lists. The markers of the timeline
+ * list are also positions objects snap to while being edited.
+ *
+ * Markers are #GESMetaContainer-s, which is where applications can store
+ * names, colors or comments; those are saved along with the positions in
+ * projects.
+ */
+
+#include "ges-internal.h"
+#include "ges-marker-list.h"
+#include "ges-meta-container.h"
+
+/* GESMarker */
+
+G_DEFINE_TYPE_WITH_CODE (GESMarker, ges_marker, G_TYPE_OBJECT,
+    G_IMPLEMENT_INTERFACE (GES_TYPE_META_CONTAINER, NULL));
+
+struct _GESMarkerPrivate
+{
+  guint64 position;
+
+  /* Not reffed, NULL when not in a list */
+  GESMarkerList *list;
+  GSequenceIter *iter;
+};
+
+enum
+{
+  MARKER_PROP_0,
+  MARKER_PROP_POSITION,
+  MARKER_PROP_LAST
+};
+
+static GParamSpec *marker_properties[MARKER_PROP_LAST];
+
+static void
+ges_marker_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GESMarker *marker = GES_MARKER (object);
+
+  switch (property_id) {
+    case MARKER_PROP_POSITION:
+      g_value_set_uint64 (value, marker->priv->position);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+}
+
+static void
+ges_marker_class_init (GESMarkerClass * klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (GESMarkerPrivate));
+
+  object_class->get_property = ges_marker_get_property;
+
+  /**
+   * GESMarker:position:
+   *
+   * The position of the marker, use ges_marker_list_move() to change it.
+   */
+  marker_properties[MARKER_PROP_POSITION] =
+      g_param_spec_uint64 ("position", "Position",
+      "The position of the marker", 0, G_MAXUINT64, 0, G_PARAM_READABLE);
+  g_object_class_install_property (object_class, MARKER_PROP_POSITION,
+      marker_properties[MARKER_PROP_POSITION]);
+}
+
+static void
+ges_marker_init (GESMarker * self)
+{
+  self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+      GES_TYPE_MARKER, GESMarkerPrivate);
+}
+
+/**
+ * ges_marker_get_position:
+ * @marker: a #GESMarker
+ *
+ * Returns: The position of @marker
+ */
+GstClockTime
+ges_marker_get_position (GESMarker * marker)
+{
+  g_return_val_if_fail (GES_IS_MARKER (marker), GST_CLOCK_TIME_NONE);
+
+  return marker->priv->position;
+}
+
+/* The address of the position, which stays valid as long as @marker is
+ * alive, so it can be used as a snap point */
+guint64 *
+ges_marker_get_timecode (GESMarker * marker)
+{
+  return &marker->priv->position;
+}
+
+/* GESMarkerList */
+
+G_DEFINE_TYPE (GESMarkerList, ges_marker_list, G_TYPE_OBJECT);
+
+struct _GESMarkerListPrivate
+{
+  GSequence *markers;           /* GESMarker sorted by position */
+};
+
+enum
+{
+  MARKER_ADDED,
+  MARKER_REMOVED,
+  MARKER_MOVED,
+  LAST_SIGNAL
+};
+
+static guint ges_marker_list_signals[LAST_SIGNAL] = { 0 };
+
+#define _POSITION(marker) (((GESMarker *) (marker))->priv->position)
+
+/* @key is a guint64 * when looking for a position, it goes before the
+ * markers at the same position so that searching it returns the first one of
+ * them */
+static gint
+_compare_markers (gconstpointer a, gconstpointer b, gpointer key)
+{
+  if (key && a == key)
+    return *(guint64 *) key <= _POSITION (b) ? -1 : 1;
+
+  if (key && b == key)
+    return _POSITION (a) < *(guint64 *) key ? -1 : 1;
+
+  if (_POSITION (a) < _POSITION (b))
+    return -1;
+
+  if (_POSITION (a) > _POSITION (b))
+    return 1;
+
+  return 0;
+}
+
+/* The first marker at or after @position */
+static GSequenceIter *
+_lower_bound (GESMarkerList * list, guint64 position)
+{
+  return g_sequence_search (list->priv->markers, &position, _compare_markers,
+      &position);
+}
+
+static void
+_unparent_marker (GESMarker * marker)
+{
+  marker->priv->list = NULL;
+  marker->priv->iter = NULL;
+  g_object_unref (marker);
+}
+
+static void
+ges_marker_list_dispose (GObject * object)
+{
+  GESMarkerList *list = GES_MARKER_LIST (object);
+
+  if (list->priv->markers) {
+    g_sequence_free (list->priv->markers);
+    list->priv->markers = NULL;
+  }
+
+  G_OBJECT_CLASS (ges_marker_list_parent_class)->dispose (object);
+}
+
+static void
+ges_marker_list_class_init (GESMarkerListClass * klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (GESMarkerListPrivate));
+
+  object_class->dispose = ges_marker_list_dispose;
+
+  /**
+   * GESMarkerList::marker-added:
+   * @list: the #GESMarkerList
+   * @marker: the #GESMarker that was added
+   */
+  ges_marker_list_signals[MARKER_ADDED] =
+      g_signal_new ("marker-added", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_FIRST, 0, NULL, NULL, g_cclosure_marshal_generic,
+      G_TYPE_NONE, 1, GES_TYPE_MARKER);
+
+  /**
+   * GESMarkerList::marker-removed:
+   * @list: the #GESMarkerList
+   * @marker: the #GESMarker that was removed
+   */
+  ges_marker_list_signals[MARKER_REMOVED] =
+      g_signal_new ("marker-removed", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_FIRST, 0, NULL, NULL, g_cclosure_marshal_generic,
+      G_TYPE_NONE, 1, GES_TYPE_MARKER);
+
+  /**
+   * GESMarkerList::marker-moved:
+   * @list: the #GESMarkerList
+   * @marker: the #GESMarker that was moved
+   * @old_position: the position @marker was at
+   */
+  ges_marker_list_signals[MARKER_MOVED] =
+      g_signal_new ("marker-moved", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_FIRST, 0, NULL, NULL, g_cclosure_marshal_generic,
+      G_TYPE_NONE, 2, GES_TYPE_MARKER, G_TYPE_UINT64);
+}
+
+static void
+ges_marker_list_init (GESMarkerList * self)
+{
+  self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+      GES_TYPE_MARKER_LIST, GESMarkerListPrivate);
+
+  self->priv->markers = g_sequence_new ((GDestroyNotify) _unparent_marker);
+}
+
+/**
+ * ges_marker_list_new:
+ *
+ * Creates a new empty #GESMarkerList, most of the time you will rather use
+ * the lists of timelines, layers and clips.
+ *
+ * Returns: (transfer full): A new #GESMarkerList
+ */
+GESMarkerList *
+ges_marker_list_new (void)
+{
+  return g_object_new (GES_TYPE_MARKER_LIST, NULL);
+}
+
+/**
+ * ges_marker_list_add:
+ * @list: a #GESMarkerList
+ * @position: the position of the new marker
+ *
+ * Adds a marker at @position. Several markers can be at the same position,
+ * in which case they are kept in the order they were added in.
+ *
+ * Returns: (transfer none): The new #GESMarker
+ */
+GESMarker *
+ges_marker_list_add (GESMarkerList * list, GstClockTime position)
+{
+  GESMarker *marker;
+
+  g_return_val_if_fail (GES_IS_MARKER_LIST (list), NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), NULL);
+
+  marker = g_object_new (GES_TYPE_MARKER, NULL);
+  marker->priv->position = position;
+  marker->priv->list = list;
+  marker->priv->iter = g_sequence_insert_sorted (list->priv->markers, marker,
+      _compare_markers, NULL);
+
+  GST_DEBUG_OBJECT (list, "Added marker at %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (position));
+
+  g_signal_emit (list, ges_marker_list_signals[MARKER_ADDED], 0, marker);
+
+  return marker;
+}
+
+/**
+ * ges_marker_list_remove:
+ * @list: a #GESMarkerList
+ * @marker: the #GESMarker to remove
+ *
+ * Removes @marker from @list, which drops the reference @list holds on it.
+ *
+ * Returns: %TRUE if @marker was removed, %FALSE if it was not in @list
+ */
+gboolean
+ges_marker_list_remove (GESMarkerList * list, GESMarker * marker)
+{
+  g_return_val_if_fail (GES_IS_MARKER_LIST (list), FALSE);
+  g_return_val_if_fail (GES_IS_MARKER (marker), FALSE);
+
+  if (marker->priv->list != list) {
+    GST_WARNING_OBJECT (list, "Marker %p is not in the list", marker);
+
+    return FALSE;
+  }
+
+  g_object_ref (marker);
+  g_sequence_remove (marker->priv->iter);
+  g_signal_emit (list, ges_marker_list_signals[MARKER_REMOVED], 0, marker);
+  g_object_unref (marker);
+
+  return TRUE;
+}
+
+/**
+ * ges_marker_list_move:
+ * @list: a #GESMarkerList
+ * @marker: a #GESMarker of @list
+ * @position: the new position of @marker
+ *
+ * Moves @marker to @position.
+ *
+ * Returns: %TRUE if @marker was moved, %FALSE otherwise
+ */
+gboolean
+ges_marker_list_move (GESMarkerList * list, GESMarker * marker,
+    GstClockTime position)
+{
+  guint64 old_position;
+
+  g_return_val_if_fail (GES_IS_MARKER_LIST (list), FALSE);
+  g_return_val_if_fail (GES_IS_MARKER (marker), FALSE);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), FALSE);
+
+  if (marker->priv->list != list) {
+    GST_WARNING_OBJECT (list, "Marker %p is not in the list", marker);
+
+    return FALSE;
+  }
+
+  old_position = marker->priv->position;
+  if (old_position == position)
+    return TRUE;
+
+  marker->priv->position = position;
+  g_sequence_sort_changed (marker->priv->iter, _compare_markers, NULL);
+
+  g_signal_emit (list, ges_marker_list_signals[MARKER_MOVED], 0, marker,
+      old_position);
+  g_object_notify_by_pspec (G_OBJECT (marker),
+      marker_properties[MARKER_PROP_POSITION]);
+
+  return TRUE;
+}
+
+/**
+ * ges_marker_list_size:
+ * @list: a #GESMarkerList
+ *
+ * Returns: The number of markers in @list
+ */
+guint
+ges_marker_list_size (GESMarkerList * list)
+{
+  g_return_val_if_fail (GES_IS_MARKER_LIST (list), 0);
+
+  return g_sequence_get_length (list->priv->markers);
+}
+
+static GList *
+_list_markers (GSequenceIter * iter, GSequenceIter * end)
+{
+  GList *ret = NULL;
+
+  for (; iter != end; iter = g_sequence_iter_next (iter))
+    ret = g_list_prepend (ret, g_object_ref (g_sequence_get (iter)));
+
+  return g_list_reverse (ret);
+}
+
+/**
+ * ges_marker_list_get_markers:
+ * @list: a #GESMarkerList
+ *
+ * Returns: (transfer full) (element-type GESMarker): The markers of @list
+ * sorted by position
+ */
+GList *
+ges_marker_list_get_markers (GESMarkerList * list)
+{
+  g_return_val_if_fail (GES_IS_MARKER_LIST (list), NULL);
+
+  return _list_markers (g_sequence_get_begin_iter (list->priv->markers),
+      g_sequence_get_end_iter (list->priv->markers));
+}
+
+/**
+ * ges_marker_list_get_range:
+ * @list: a #GESMarkerList
+ * @start: the start of the range
+ * @stop: the end of the range, or #GST_CLOCK_TIME_NONE
+ *
+ * Gets the markers positioned from @start included to @stop excluded.
+ *
+ * Returns: (transfer full) (element-type GESMarker): The markers in the
+ * range sorted by position
+ */
+GList *
+ges_marker_list_get_range (GESMarkerList * list, GstClockTime start,
+    GstClockTime stop)
+{
+  GSequenceIter *end;
+
+  g_return_val_if_fail (GES_IS_MARKER_LIST (list), NULL);
+
+  if (!GST_CLOCK_TIME_IS_VALID (start))
+    start = 0;
+
+  if (GST_CLOCK_TIME_IS_VALID (stop) && stop <= start)
+    return NULL;
+
+  if (GST_CLOCK_TIME_IS_VALID (stop))
+    end = _lower_bound (list, stop);
+  else
+    end = g_sequence_get_end_iter (list->priv->markers);
+
+  return _list_markers (_lower_bound (list, start), end);
+}
+
+/**
+ * ges_marker_list_get_nearest:
+ * @list: a #GESMarkerList
+ * @position: a position
+ *
+ * Gets the marker closest to @position, the earliest one if two of them
+ * are as close.
+ *
+ * Returns: (transfer none): The #GESMarker closest to @position, or %NULL if
+ * @list is empty
+ */
+GESMarker *
+ges_marker_list_get_nearest (GESMarkerList * list, GstClockTime position)
+{
+  GSequenceIter *iter;
+  GESMarker *next = NULL, *prev = NULL;
+
+  g_return_val_if_fail (GES_IS_MARKER_LIST (list), NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), NULL);
+
+  iter = _lower_bound (list, position);
+  if (!g_sequence_iter_is_end (iter))
+    next = g_sequence_get (iter);
+
+  if (!g_sequence_iter_is_begin (iter))
+    prev = g_sequence_get (g_sequence_iter_prev (iter));
+
+  if (prev == NULL)
+    return next;
+
+  if (next == NULL)
+    return prev;
+
+  return position - _POSITION (prev) <= _POSITION (next) - position ?
+      prev : next;
+}
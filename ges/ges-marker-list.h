@@ -0,0 +1,108 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef GES_MARKER_LIST_H
+#define GES_MARKER_LIST_H
+
+#include <glib-object.h>
+#include <gst/gst.h>
+#include <ges/ges-types.h>
+
+G_BEGIN_DECLS
+
+#define GES_TYPE_MARKER (ges_marker_get_type ())
+#define GES_MARKER(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), GES_TYPE_MARKER, GESMarker))
+#define GES_MARKER_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST ((klass), GES_TYPE_MARKER, GESMarkerClass))
+#define GES_IS_MARKER(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GES_TYPE_MARKER))
+#define GES_IS_MARKER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GES_TYPE_MARKER))
+#define GES_MARKER_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GES_TYPE_MARKER, GESMarkerClass))
+
+#define GES_TYPE_MARKER_LIST (ges_marker_list_get_type ())
+#define GES_MARKER_LIST(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), GES_TYPE_MARKER_LIST, GESMarkerList))
+#define GES_MARKER_LIST_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST ((klass), GES_TYPE_MARKER_LIST, GESMarkerListClass))
+#define GES_IS_MARKER_LIST(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GES_TYPE_MARKER_LIST))
+#define GES_IS_MARKER_LIST_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GES_TYPE_MARKER_LIST))
+#define GES_MARKER_LIST_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GES_TYPE_MARKER_LIST, GESMarkerListClass))
+
+typedef struct _GESMarkerPrivate GESMarkerPrivate;
+typedef struct _GESMarkerListPrivate GESMarkerListPrivate;
+
+/**
+ * GESMarker:
+ *
+ * A position in a #GESMarkerList, with metadatas attached.
+ */
+struct _GESMarker {
+  GObject parent;
+
+  /*< private >*/
+  GESMarkerPrivate *priv;
+
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+struct _GESMarkerClass {
+  GObjectClass parent_class;
+
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+/**
+ * GESMarkerList:
+ *
+ * A list of #GESMarker-s sorted by position.
+ */
+struct _GESMarkerList {
+  GObject parent;
+
+  /*< private >*/
+  GESMarkerListPrivate *priv;
+
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+struct _GESMarkerListClass {
+  GObjectClass parent_class;
+
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+GType ges_marker_get_type               (void);
+GstClockTime ges_marker_get_position    (GESMarker *marker);
+
+GType ges_marker_list_get_type          (void);
+GESMarkerList *ges_marker_list_new      (void);
+
+GESMarker *ges_marker_list_add          (GESMarkerList *list,
+                                         GstClockTime position);
+gboolean ges_marker_list_remove         (GESMarkerList *list,
+                                         GESMarker *marker);
+gboolean ges_marker_list_move           (GESMarkerList *list,
+                                         GESMarker *marker,
+                                         GstClockTime position);
+guint ges_marker_list_size              (GESMarkerList *list);
+GList *ges_marker_list_get_markers      (GESMarkerList *list);
+GList *ges_marker_list_get_range        (GESMarkerList *list,
+                                         GstClockTime start,
+                                         GstClockTime stop);
+GESMarker *ges_marker_list_get_nearest  (GESMarkerList *list,
+                                         GstClockTime position);
+
+G_END_DECLS
+#endif /* GES_MARKER_LIST_H */
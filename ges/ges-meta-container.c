@@ -2,6 +2,7 @@
 #include <gst/gst.h>
 
 #include "ges-meta-container.h"
+#include "ges-internal.h"
 
 /**
 * SECTION: ges-meta-container
@@ -30,12 +31,41 @@ typedef struct RegisteredMeta
   GESMetaFlag flags;
 } RegisteredMeta;
 
+/* Metas are stored as interned keys with a value of their own, so that the
+ * values can be referenced by the GESMetaStore of the timeline */
+typedef struct
+{
+  GQuark key;
+  GValue *value;
+} MetaItem;
+
 typedef struct ContainerData
 {
-  GstStructure *structure;
-  GHashTable *static_items;
+  GArray *items;                /* MetaItem, in the order they were set */
+  GHashTable *static_items;     /* Created on the first registration */
+  GESMetaContainer *container;
+  GESMetaStore *store;
 } ContainerData;
 
+/* The metas of all the containers of a timeline, stored by column: each meta
+ * key has a column referencing the value it has in each container. The
+ * values are owned by the containers.
+ *
+ * Lookups of the containers having some value for a key are done through an
+ * index of the column, built the first time the key is looked up and then
+ * kept up to date as values change. */
+typedef struct
+{
+  GHashTable *cells;            /* {GESMetaContainer: GValue *} */
+  GHashTable *index;            /* {GValue *: {GESMetaContainer}} or NULL */
+} MetaColumn;
+
+struct _GESMetaStore
+{
+  GHashTable *columns;          /* {GQuark: MetaColumn} */
+  GHashTable *containers;       /* {ContainerData}, all the attached ones */
+};
+
 static void
 ges_meta_container_default_init (GESMetaContainerInterface * iface)
 {
@@ -56,11 +86,242 @@ ges_meta_container_default_init (GESMetaContainerInterface * iface)
       G_TYPE_NONE, 2, G_TYPE_STRING, G_TYPE_VALUE);
 }
 
+/****************************************************
+ *                GESMetaStore                      *
+ ****************************************************/
+
+/* Values equal according to _value_equal must have the same hash */
+static guint
+_value_hash (const GValue * value)
+{
+  gchar *serialized;
+  guint hash;
+  gint64 i64;
+  gdouble d;
+
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value))) {
+    case G_TYPE_BOOLEAN:
+      return g_value_get_boolean (value);
+    case G_TYPE_INT:
+      return g_value_get_int (value);
+    case G_TYPE_UINT:
+      return g_value_get_uint (value);
+    case G_TYPE_ENUM:
+      return g_value_get_enum (value);
+    case G_TYPE_FLAGS:
+      return g_value_get_flags (value);
+    case G_TYPE_INT64:
+      i64 = g_value_get_int64 (value);
+      return g_int64_hash (&i64);
+    case G_TYPE_UINT64:
+      i64 = g_value_get_uint64 (value);
+      return g_int64_hash (&i64);
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      d = G_VALUE_HOLDS_FLOAT (value) ? g_value_get_float (value) :
+          g_value_get_double (value);
+      /* -0 == 0 */
+      return d == 0 ? 0 : g_double_hash (&d);
+    case G_TYPE_STRING:
+      return g_value_get_string (value) ?
+          g_str_hash (g_value_get_string (value)) : 0;
+    default:
+      serialized = gst_value_serialize (value);
+      hash = serialized ? g_str_hash (serialized) : 0;
+      g_free (serialized);
+
+      return hash;
+  }
+}
+
+static gboolean
+_value_equal (const GValue * a, const GValue * b)
+{
+  return G_VALUE_TYPE (a) == G_VALUE_TYPE (b) &&
+      gst_value_compare (a, b) == GST_VALUE_EQUAL;
+}
+
+static void
+_free_value (GValue * value)
+{
+  g_value_unset (value);
+  g_slice_free (GValue, value);
+}
+
+static GValue *
+_copy_value (const GValue * value)
+{
+  GValue *copy = g_slice_new0 (GValue);
+
+  g_value_init (copy, G_VALUE_TYPE (value));
+  g_value_copy (value, copy);
+
+  return copy;
+}
+
+static void
+_free_column (MetaColumn * column)
+{
+  g_hash_table_unref (column->cells);
+  if (column->index)
+    g_hash_table_unref (column->index);
+
+  g_slice_free (MetaColumn, column);
+}
+
+static void
+_column_index_add (MetaColumn * column, GESMetaContainer * container,
+    const GValue * value)
+{
+  GHashTable *containers = g_hash_table_lookup (column->index, value);
+
+  if (containers == NULL) {
+    containers = g_hash_table_new (g_direct_hash, g_direct_equal);
+    g_hash_table_insert (column->index, _copy_value (value), containers);
+  }
+
+  g_hash_table_add (containers, container);
+}
+
+static void
+_store_add (GESMetaStore * store, GESMetaContainer * container, GQuark key,
+    const GValue * value)
+{
+  MetaColumn *column = g_hash_table_lookup (store->columns,
+      GUINT_TO_POINTER (key));
+
+  if (column == NULL) {
+    column = g_slice_new0 (MetaColumn);
+    column->cells = g_hash_table_new (g_direct_hash, g_direct_equal);
+    g_hash_table_insert (store->columns, GUINT_TO_POINTER (key), column);
+  }
+
+  g_hash_table_insert (column->cells, container, (gpointer) value);
+  if (column->index)
+    _column_index_add (column, container, value);
+}
+
+static void
+_store_remove (GESMetaStore * store, GESMetaContainer * container, GQuark key,
+    const GValue * value)
+{
+  MetaColumn *column = g_hash_table_lookup (store->columns,
+      GUINT_TO_POINTER (key));
+
+  if (column == NULL || !g_hash_table_remove (column->cells, container))
+    return;
+
+  if (column->index) {
+    GHashTable *containers = g_hash_table_lookup (column->index, value);
+
+    if (containers) {
+      g_hash_table_remove (containers, container);
+      if (g_hash_table_size (containers) == 0)
+        g_hash_table_remove (column->index, value);
+    }
+  }
+
+  if (g_hash_table_size (column->cells) == 0)
+    g_hash_table_remove (store->columns, GUINT_TO_POINTER (key));
+}
+
+GESMetaStore *
+ges_meta_store_new (void)
+{
+  GESMetaStore *store = g_slice_new0 (GESMetaStore);
+
+  store->columns = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) _free_column);
+  store->containers = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  return store;
+}
+
+/* Containers still in @store are detached from it, whether they have
+ * metas or not */
+void
+ges_meta_store_free (GESMetaStore * store)
+{
+  GHashTableIter iter;
+  ContainerData *data;
+
+  g_hash_table_iter_init (&iter, store->containers);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & data, NULL))
+    data->store = NULL;
+
+  g_hash_table_unref (store->containers);
+  g_hash_table_unref (store->columns);
+  g_slice_free (GESMetaStore, store);
+}
+
+/* Returns: (transfer full): The containers of @store whose @meta_item is
+ * equal to @value, in no particular order */
+GList *
+ges_meta_store_find (GESMetaStore * store, const gchar * meta_item,
+    const GValue * value)
+{
+  GHashTableIter iter;
+  MetaColumn *column;
+  GHashTable *containers;
+  GList *tmp, *found;
+  GESMetaContainer *container;
+  const GValue *cell;
+  GQuark key = g_quark_try_string (meta_item);
+
+  /* Keys are interned when set, a new one can not be set anywhere */
+  if (key == 0)
+    return NULL;
+
+  column = g_hash_table_lookup (store->columns, GUINT_TO_POINTER (key));
+  if (column == NULL)
+    return NULL;
+
+  if (column->index == NULL) {
+    GST_DEBUG ("Indexing the values of %s", meta_item);
+
+    column->index = g_hash_table_new_full ((GHashFunc) _value_hash,
+        (GEqualFunc) _value_equal, (GDestroyNotify) _free_value,
+        (GDestroyNotify) g_hash_table_unref);
+    g_hash_table_iter_init (&iter, column->cells);
+    while (g_hash_table_iter_next (&iter, (gpointer *) & container,
+            (gpointer *) & cell))
+      _column_index_add (column, container, cell);
+  }
+
+  containers = g_hash_table_lookup (column->index, value);
+  if (containers == NULL)
+    return NULL;
+
+  found = g_hash_table_get_keys (containers);
+  for (tmp = found; tmp; tmp = tmp->next)
+    g_object_ref (tmp->data);
+
+  return found;
+}
+
+/****************************************************
+ *                  Containers                      *
+ ****************************************************/
+
 static void
 _free_meta_container_data (ContainerData * data)
 {
-  gst_structure_free (data->structure);
-  g_hash_table_unref (data->static_items);
+  guint i;
+
+  for (i = 0; i < data->items->len; i++) {
+    MetaItem *item = &g_array_index (data->items, MetaItem, i);
+
+    if (data->store)
+      _store_remove (data->store, data->container, item->key, item->value);
+    _free_value (item->value);
+  }
+  g_array_free (data->items, TRUE);
+
+  if (data->store)
+    g_hash_table_remove (data->store->containers, data);
+
+  if (data->static_items)
+    g_hash_table_unref (data->static_items);
 
   g_slice_free (ContainerData, data);
 }
@@ -74,42 +335,93 @@ _free_static_item (RegisteredMeta * item)
 static ContainerData *
 _create_container_data (GESMetaContainer * container)
 {
-  ContainerData *data = g_slice_new (ContainerData);
-  data->structure = gst_structure_new_empty ("metadatas");
-  data->static_items = g_hash_table_new_full (g_str_hash, g_str_equal,
-      g_free, (GDestroyNotify) (GDestroyNotify) _free_static_item);
+  ContainerData *data = g_slice_new0 (ContainerData);
+
+  data->items = g_array_new (FALSE, FALSE, sizeof (MetaItem));
+  data->container = container;
   g_object_set_qdata_full (G_OBJECT (container), ges_meta_key, data,
       (GDestroyNotify) _free_meta_container_data);
 
   return data;
 }
 
-static GstStructure *
-_meta_container_get_structure (GESMetaContainer * container)
+static ContainerData *
+_get_container_data (GESMetaContainer * container)
 {
-  ContainerData *data;
+  ContainerData *data = g_object_get_qdata (G_OBJECT (container),
+      ges_meta_key);
 
-  data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
   if (!data)
     data = _create_container_data (container);
 
-  return data->structure;
+  return data;
 }
 
-typedef struct
+static MetaItem *
+_find_item (ContainerData * data, GQuark key)
 {
-  GESMetaForeachFunc func;
-  const GESMetaContainer *container;
-  gpointer data;
-} MetadataForeachData;
+  guint i;
 
-static void
-structure_foreach_wrapper (GQuark field_id, const GValue * value,
-    gpointer user_data)
+  for (i = 0; i < data->items->len; i++) {
+    MetaItem *item = &g_array_index (data->items, MetaItem, i);
+
+    if (item->key == key)
+      return item;
+  }
+
+  return NULL;
+}
+
+static const GValue *
+_get_value (GESMetaContainer * container, const gchar * meta_item)
 {
-  MetadataForeachData *data = (MetadataForeachData *) user_data;
+  MetaItem *item;
+  GQuark key = g_quark_try_string (meta_item);
+  ContainerData *data = g_object_get_qdata (G_OBJECT (container),
+      ges_meta_key);
 
-  data->func (data->container, g_quark_to_string (field_id), value, data->data);
+  if (!data || !key)
+    return NULL;
+
+  item = _find_item (data, key);
+
+  return item ? item->value : NULL;
+}
+
+/* Makes the metas of @container part of @store, or of no store if @store
+ * is %NULL, they are then moved as they are set */
+void
+ges_meta_container_set_store (GESMetaContainer * container,
+    GESMetaStore * store)
+{
+  guint i;
+  ContainerData *data = g_object_get_qdata (G_OBJECT (container),
+      ges_meta_key);
+
+  if (data == NULL) {
+    if (store == NULL)
+      return;
+
+    data = _create_container_data (container);
+  }
+
+  if (data->store == store)
+    return;
+
+  for (i = 0; i < data->items->len; i++) {
+    MetaItem *item = &g_array_index (data->items, MetaItem, i);
+
+    if (data->store)
+      _store_remove (data->store, container, item->key, item->value);
+    if (store)
+      _store_add (store, container, item->key, item->value);
+  }
+
+  if (data->store)
+    g_hash_table_remove (data->store->containers, data);
+  if (store)
+    g_hash_table_add (store->containers, data);
+  data->store = store;
 }
 
 static gboolean
@@ -133,20 +445,22 @@ void
 ges_meta_container_foreach (GESMetaContainer * container,
     GESMetaForeachFunc func, gpointer user_data)
 {
-  GstStructure *structure;
-  MetadataForeachData foreach_data;
+  guint i;
+  ContainerData *data;
 
   g_return_if_fail (GES_IS_META_CONTAINER (container));
   g_return_if_fail (func != NULL);
 
-  structure = _meta_container_get_structure (container);
+  data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
+  if (!data)
+    return;
 
-  foreach_data.func = func;
-  foreach_data.container = container;
-  foreach_data.data = user_data;
+  /* @func might set metas, the array can be reallocated */
+  for (i = 0; i < data->items->len; i++) {
+    MetaItem *item = &g_array_index (data->items, MetaItem, i);
 
-  gst_structure_foreach (structure,
-      (GstStructureForeachFunc) structure_foreach_wrapper, &foreach_data);
+    func (container, g_quark_to_string (item->key), item->value, user_data);
+  }
 }
 
 /* _can_write_value should have been checked before calling */
@@ -157,9 +471,10 @@ _register_meta (GESMetaContainer * container, GESMetaFlag flags,
   ContainerData *data;
   RegisteredMeta *static_item;
 
-  data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
-  if (!data)
-    data = _create_container_data (container);
+  data = _get_container_data (container);
+  if (data->static_items == NULL)
+    data->static_items = g_hash_table_new_full (g_str_hash, g_str_equal,
+        g_free, (GDestroyNotify) _free_static_item);
   else if (g_hash_table_lookup (data->static_items, meta_item)) {
     GST_WARNING_OBJECT (container, "Static meta %s already registered",
         meta_item);
@@ -179,7 +494,10 @@ static gboolean
 _set_value (GESMetaContainer * container, const gchar * meta_item,
     const GValue * value)
 {
-  GstStructure *structure;
+  MetaItem *item;
+  GValue *old_value = NULL, *new_value;
+  ContainerData *data;
+  GQuark key;
   gchar *val = gst_value_serialize (value);
 
   if (val == NULL) {
@@ -190,13 +508,32 @@ _set_value (GESMetaContainer * container, const gchar * meta_item,
     return FALSE;
   }
 
-  structure = _meta_container_get_structure (container);
+  data = _get_container_data (container);
 
   GST_DEBUG_OBJECT (container, "Setting meta_item %s value: %s::%s",
       meta_item, G_VALUE_TYPE_NAME (value), val);
 
-  gst_structure_set_value (structure, meta_item, value);
-  g_signal_emit (container, _signals[NOTIFY_SIGNAL], 0, meta_item, value);
+  key = g_quark_from_string (meta_item);
+  item = _find_item (data, key);
+  if (item == NULL) {
+    MetaItem new_item = { key, NULL };
+
+    g_array_append_val (data->items, new_item);
+    item = &g_array_index (data->items, MetaItem, data->items->len - 1);
+  } else {
+    if (data->store)
+      _store_remove (data->store, container, key, item->value);
+    /* @value might be the current value */
+    old_value = item->value;
+  }
+
+  new_value = item->value = _copy_value (value);
+  if (data->store)
+    _store_add (data->store, container, key, new_value);
+  if (old_value)
+    _free_value (old_value);
+
+  g_signal_emit (container, _signals[NOTIFY_SIGNAL], 0, meta_item, new_value);
 
   g_free (val);
   return TRUE;
@@ -210,10 +547,8 @@ _can_write_value (GESMetaContainer * container, const gchar * item_name,
   RegisteredMeta *static_item = NULL;
 
   data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
-  if (!data) {
-    data = _create_container_data (container);
+  if (!data || !data->static_items)
     return TRUE;
-  }
 
   static_item = g_hash_table_lookup (data->static_items, item_name);
 
@@ -240,6 +575,7 @@ gboolean                                                                \
 ges_meta_container_set_ ## name (GESMetaContainer *container,      \
                            const gchar *meta_item, value_ctype value)   \
 {                                                                       \
+  gboolean ret;                                                         \
   GValue gval = { 0 };                                                  \
                                                                         \
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);      \
@@ -251,7 +587,10 @@ ges_meta_container_set_ ## name (GESMetaContainer *container,      \
   g_value_init (&gval, value_gtype);                                    \
   g_value_set_ ##setter_name (&gval, value);                            \
                                                                         \
-  return _set_value (container, meta_item, &gval);                      \
+  ret = _set_value (container, meta_item, &gval);                       \
+  g_value_unset (&gval);                                                \
+                                                                        \
+  return ret;                                                           \
 }
 
 /**
@@ -408,13 +747,25 @@ ges_meta_container_set_meta (GESMetaContainer * container,
 gchar *
 ges_meta_container_metas_to_string (GESMetaContainer * container)
 {
+  guint i;
+  gchar *ret;
+  ContainerData *data;
   GstStructure *structure;
 
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), NULL);
 
-  structure = _meta_container_get_structure (container);
+  structure = gst_structure_new_empty ("metadatas");
+  data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
+  for (i = 0; data && i < data->items->len; i++) {
+    MetaItem *item = &g_array_index (data->items, MetaItem, i);
+
+    gst_structure_id_set_value (structure, item->key, item->value);
+  }
+
+  ret = gst_structure_to_string (structure);
+  gst_structure_free (structure);
 
-  return gst_structure_to_string (structure);
+  return ret;
 }
 
 /**
@@ -656,7 +1007,7 @@ ges_meta_container_check_meta_registered (GESMetaContainer * container,
   RegisteredMeta *static_item;
 
   data = g_object_get_qdata (G_OBJECT (container), ges_meta_key);
-  if (!data)
+  if (!data || !data->static_items)
     return FALSE;
 
   static_item = g_hash_table_lookup (data->static_items, meta_item);
@@ -679,20 +1030,24 @@ ges_meta_container_check_meta_registered (GESMetaContainer * container,
 /* Copied from gsttaglist.c */
 /***** evil macros to get all the *_get_* functions right *****/
 
-#define CREATE_GETTER(name,type)                                         \
+#define CREATE_GETTER(name,type,value_gtype,getter_name)                 \
 gboolean                                                                 \
 ges_meta_container_get_ ## name (GESMetaContainer *container,    \
                            const gchar *meta_item, type value)       \
 {                                                                        \
-  GstStructure *structure;                                                     \
+  const GValue *gval;                                                    \
                                                                          \
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);   \
   g_return_val_if_fail (meta_item != NULL, FALSE);                   \
   g_return_val_if_fail (value != NULL, FALSE);                           \
                                                                          \
-  structure = _meta_container_get_structure (container);                    \
+  gval = _get_value (container, meta_item);                              \
+  if (!gval || G_VALUE_TYPE (gval) != value_gtype)                       \
+    return FALSE;                                                        \
+                                                                         \
+  *value = g_value_ ## getter_name (gval);                               \
                                                                          \
-  return gst_structure_get_ ## name (structure, meta_item, value);   \
+  return TRUE;                                                           \
 }
 
 /**
@@ -703,7 +1058,7 @@ ges_meta_container_get_ ## name (GESMetaContainer *container,    \
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (boolean, gboolean *);
+CREATE_GETTER (boolean, gboolean *, G_TYPE_BOOLEAN, get_boolean);
 /**
  * ges_meta_container_get_int:
  * @container: Target container
@@ -712,7 +1067,7 @@ CREATE_GETTER (boolean, gboolean *);
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (int, gint *);
+CREATE_GETTER (int, gint *, G_TYPE_INT, get_int);
 /**
  * ges_meta_container_get_uint:
  * @container: Target container
@@ -721,7 +1076,7 @@ CREATE_GETTER (int, gint *);
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (uint, guint *);
+CREATE_GETTER (uint, guint *, G_TYPE_UINT, get_uint);
 /**
  * ges_meta_container_get_double:
  * @container: Target container
@@ -730,7 +1085,7 @@ CREATE_GETTER (uint, guint *);
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (double, gdouble *);
+CREATE_GETTER (double, gdouble *, G_TYPE_DOUBLE, get_double);
 
 /**
  * ges_meta_container_get_int64:
@@ -744,16 +1099,13 @@ gboolean
 ges_meta_container_get_int64 (GESMetaContainer * container,
     const gchar * meta_item, gint64 * dest)
 {
-  GstStructure *structure;
   const GValue *value;
 
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
   g_return_val_if_fail (meta_item != NULL, FALSE);
   g_return_val_if_fail (dest != NULL, FALSE);
 
-  structure = _meta_container_get_structure (container);
-
-  value = gst_structure_get_value (structure, meta_item);
+  value = _get_value (container, meta_item);
   if (!value || G_VALUE_TYPE (value) != G_TYPE_INT64)
     return FALSE;
 
@@ -774,16 +1126,13 @@ gboolean
 ges_meta_container_get_uint64 (GESMetaContainer * container,
     const gchar * meta_item, guint64 * dest)
 {
-  GstStructure *structure;
   const GValue *value;
 
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
   g_return_val_if_fail (meta_item != NULL, FALSE);
   g_return_val_if_fail (dest != NULL, FALSE);
 
-  structure = _meta_container_get_structure (container);
-
-  value = gst_structure_get_value (structure, meta_item);
+  value = _get_value (container, meta_item);
   if (!value || G_VALUE_TYPE (value) != G_TYPE_UINT64)
     return FALSE;
 
@@ -804,16 +1153,13 @@ gboolean
 ges_meta_container_get_float (GESMetaContainer * container,
     const gchar * meta_item, gfloat * dest)
 {
-  GstStructure *structure;
   const GValue *value;
 
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
   g_return_val_if_fail (meta_item != NULL, FALSE);
   g_return_val_if_fail (dest != NULL, FALSE);
 
-  structure = _meta_container_get_structure (container);
-
-  value = gst_structure_get_value (structure, meta_item);
+  value = _get_value (container, meta_item);
   if (!value || G_VALUE_TYPE (value) != G_TYPE_FLOAT)
     return FALSE;
 
@@ -833,14 +1179,16 @@ const gchar *
 ges_meta_container_get_string (GESMetaContainer * container,
     const gchar * meta_item)
 {
-  GstStructure *structure;
+  const GValue *value;
 
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
   g_return_val_if_fail (meta_item != NULL, FALSE);
 
-  structure = _meta_container_get_structure (container);
+  value = _get_value (container, meta_item);
+  if (!value || G_VALUE_TYPE (value) != G_TYPE_STRING)
+    return NULL;
 
-  return gst_structure_get_string (structure, meta_item);
+  return g_value_get_string (value);
 }
 
 /**
@@ -856,14 +1204,10 @@ ges_meta_container_get_string (GESMetaContainer * container,
 const GValue *
 ges_meta_container_get_meta (GESMetaContainer * container, const gchar * key)
 {
-  GstStructure *structure;
-
   g_return_val_if_fail (GES_IS_META_CONTAINER (container), FALSE);
   g_return_val_if_fail (key != NULL, FALSE);
 
-  structure = _meta_container_get_structure (container);
-
-  return gst_structure_get_value (structure, key);
+  return _get_value (container, key);
 }
 
 /**
@@ -874,7 +1218,7 @@ ges_meta_container_get_meta (GESMetaContainer * container, const gchar * key)
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (date, GDate **);
+CREATE_GETTER (date, GDate **, G_TYPE_DATE, dup_boxed);
 
 /**
  * ges_meta_container_get_date_time:
@@ -884,4 +1228,4 @@ CREATE_GETTER (date, GDate **);
  * Gets the value of a given meta item, returns NULL if @meta_item
  * can not be found.
  */
-CREATE_GETTER (date_time, GstDateTime **);
+CREATE_GETTER (date_time, GstDateTime **, GST_TYPE_DATE_TIME, dup_boxed);
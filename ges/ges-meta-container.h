@@ -102,6 +102,42 @@ G_BEGIN_DECLS
  */
 #define GES_META_VOLUME_DEFAULT                       1.0
 
+/**
+ * GES_META_ANALYSIS_SCENE_CHANGES:
+ *
+ * The timestamps of the scene changes detected in the video stream of a
+ * #GESUriClipAsset by ges_uri_clip_asset_analyze_async() (#GstValueArray of
+ * #guint64)
+ */
+#define GES_META_ANALYSIS_SCENE_CHANGES               "analysis-scene-changes"
+
+/**
+ * GES_META_ANALYSIS_LOUDNESS:
+ *
+ * The loudness of each second of the audio stream of a #GESUriClipAsset in
+ * LUFS, as computed by ges_uri_clip_asset_analyze_async() (#GstValueArray of
+ * #gdouble)
+ */
+#define GES_META_ANALYSIS_LOUDNESS                    "analysis-loudness"
+
+/**
+ * GES_META_ANALYSIS_INTEGRATED_LOUDNESS:
+ *
+ * The EBU R128 integrated loudness of the audio stream of a
+ * #GESUriClipAsset in LUFS, as computed by
+ * ges_uri_clip_asset_analyze_async() (double)
+ */
+#define GES_META_ANALYSIS_INTEGRATED_LOUDNESS         "analysis-integrated-loudness"
+
+/**
+ * GES_META_ANALYSIS_WAVEFORM_PEAKS:
+ *
+ * The sample peaks of the audio stream of a #GESUriClipAsset, one byte per
+ * 100 milliseconds, 255 being full scale, as computed by
+ * ges_uri_clip_asset_analyze_async() (#GstBuffer)
+ */
+#define GES_META_ANALYSIS_WAVEFORM_PEAKS              "analysis-waveform-peaks"
+
 typedef struct _GESMetaContainer          GESMetaContainer;
 typedef struct _GESMetaContainerInterface GESMetaContainerInterface;
 
@@ -105,17 +105,6 @@ ges_multi_file_source_dispose (GObject * object)
   G_OBJECT_CLASS (ges_multi_file_source_parent_class)->dispose (object);
 }
 
-static void
-pad_added_cb (GstElement * decodebin, GstPad * pad, GstElement * bin)
-{
-  GstPad *srcpad;
-
-  srcpad = gst_ghost_pad_new ("src", pad);
-
-  gst_pad_set_active (srcpad, TRUE);
-  gst_element_add_pad (bin, srcpad);
-}
-
 /**
   * ges_multi_file_uri_new: (skip)
   *
@@ -165,52 +154,29 @@ static GstElement *
 ges_multi_file_source_create_source (GESTrackElement * track_element)
 {
   GESMultiFileSource *self;
-  GstElement *bin, *src, *decodebin;
-  GstCaps *disc_caps;
-  GstDiscovererStreamInfo *stream_info;
-  GValue fps = G_VALUE_INIT;
-  GstCaps *caps;
-  GESUriSourceAsset *asset;
+  GstElement *bin, *src;
+  GstPad *srcpad, *target;
   GESMultiFileURI *uri_data;
 
   self = (GESMultiFileSource *) track_element;
 
-  asset =
-      GES_URI_SOURCE_ASSET (ges_extractable_get_asset (GES_EXTRACTABLE (self)));
-
-  if (asset != NULL) {
-    stream_info = ges_uri_source_asset_get_stream_info (asset);
-    g_assert (stream_info);
-    disc_caps = gst_discoverer_stream_info_get_caps (stream_info);
-    caps = gst_caps_copy (disc_caps);
-    GST_DEBUG ("Got some nice caps %s", gst_caps_to_string (disc_caps));
-    gst_object_unref (stream_info);
-    gst_caps_unref (disc_caps);
-  } else {
-    caps = gst_caps_new_empty ();
-    GST_WARNING ("Could not extract asset.");
-  }
-
-  g_value_init (&fps, GST_TYPE_FRACTION);
-  gst_value_set_fraction (&fps, 25, 1);
-  gst_caps_set_value (caps, "framerate", &fps);
-
-  bin = GST_ELEMENT (gst_bin_new ("multi-image-bin"));
-  src = gst_element_factory_make ("multifilesrc", NULL);
-
+  /* Frames are decoded through the frame cache, so images used by several
+   * sources (or several times in the same sequence) are decoded only once */
   uri_data = ges_multi_file_uri_new (self->uri);
-  g_object_set (src, "start-index", uri_data->start, "stop-index",
-      uri_data->end, "caps", caps, "location", uri_data->location, NULL);
+  src = ges_frame_cache_create_sequence_source (uri_data->location,
+      uri_data->start, uri_data->end, 25, 1);
   g_free (uri_data);
 
-  decodebin = gst_element_factory_make ("decodebin", NULL);
+  if (src == NULL)
+    return NULL;
 
-  gst_bin_add_many (GST_BIN (bin), src, decodebin, NULL);
-  gst_element_link_pads_full (src, "src", decodebin, "sink",
-      GST_PAD_LINK_CHECK_NOTHING);
+  bin = GST_ELEMENT (gst_bin_new ("multi-image-bin"));
+  gst_bin_add (GST_BIN (bin), src);
 
-  g_signal_connect (G_OBJECT (decodebin), "pad-added",
-      G_CALLBACK (pad_added_cb), bin);
+  target = gst_element_get_static_pad (src, "src");
+  srcpad = gst_ghost_pad_new ("src", target);
+  gst_element_add_pad (bin, srcpad);
+  gst_object_unref (target);
 
   return bin;
 }
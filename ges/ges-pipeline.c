@@ -30,15 +30,27 @@
 #include <gst/gst.h>
 #include <gst/video/videooverlay.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "ges-internal.h"
 #include "ges-pipeline.h"
+#include "ges-gerror.h"
 #include "ges-screenshot.h"
 #include "ges-audio-track.h"
 #include "ges-video-track.h"
 
 #define DEFAULT_TIMELINE_MODE  GES_PIPELINE_MODE_PREVIEW
 
+/* Time we wait for messages on the bus before checking if rendering
+ * has been cancelled */
+#define RENDER_POLL_TIMEOUT (100 * GST_MSECOND)
+
+/* Number of video frames kept around in #GES_PIPELINE_MODE_SCRUB */
+#define DEFAULT_SCRUB_CACHE_SIZE 32
+
+/* No periodic statistics messages by default */
+#define DEFAULT_STATS_INTERVAL 0
+
 /* Structure corresponding to a timeline - sink link */
 
 typedef struct
@@ -50,8 +62,51 @@ typedef struct
   GstPad *encodebinpad;
   GstPad *blocked_pad;
   gulong probe_id;
+  gulong scrub_probe_id;
+  gulong stats_probe_id;
+  GstElement *encodebin_queue;  /* Input queue of the encodebin stream */
+
+  GESPipeline *pipeline;
+
+  /* Statistics, protected by the stats_lock */
+  guint64 frames;
+  GstClockTime first_buffer_time;
+  GstClockTime last_buffer_time;
+  GstClockTime position;
+  GstClockTime composite_time;
+  GstClockTime blocked_time;
+  gboolean blocked;             /* Last buffer was pushed into a full queue */
 } OutputChain;
 
+typedef struct
+{
+  GstPad *pad;
+  gulong id;
+} StatsProbe;
+
+/* An element of the encodebin we measure the processing time of */
+typedef struct
+{
+  GESPipeline *pipeline;
+  GstElement *element;
+  const gchar *name;            /* "convert", "encode" or "mux" */
+  GSList *probes;               /* StatsProbe */
+
+  /* Protected by the stats_lock */
+  GThread *thread;              /* Thread the last input buffer came from */
+  GstClockTime input_time;
+  guint64 buffers;
+  GstClockTime processing_time;
+} RenderStage;
+
+/* A composited video frame, kept around while scrubbing */
+typedef struct
+{
+  GstClockTime position;
+  GstClockTime duration;
+  GstSample *sample;
+} ScrubFrame;
+
 
 struct _GESPipelinePrivate
 {
@@ -67,6 +122,34 @@ struct _GESPipelinePrivate
   GList *chains;
 
   GstEncodingProfile *profile;
+  gchar *output_uri;
+
+  /* GES_PIPELINE_MODE_SCRUB, all protected by scrub_lock */
+  GMutex scrub_lock;
+  GQueue scrub_frames;          /* ScrubFrame, oldest first */
+  guint scrub_cache_size;
+  GThreadPool *scrub_pool;      /* Issues the seeks, one at a time */
+  GstClockTime scrub_target;    /* Latest requested position */
+  gint64 scrub_request_time;    /* Monotonic time it was requested at */
+  gboolean scrub_pending;       /* No seek was issued for scrub_target yet */
+  gboolean scrub_seeking;       /* A seek is in flight */
+  gboolean scrub_flushed;       /* The in flight seek flushed the pipeline */
+  GstClockTime scrub_seek_position;
+  GstClockTime scrub_frame_duration;
+
+  guint scrub_steps;
+  guint scrub_hits;
+  guint scrub_coalesced;
+  GstClockTime scrub_last_latency;
+  GstClockTime scrub_max_latency;
+  GstClockTime scrub_total_latency;
+
+  /* Render statistics, all protected by stats_lock */
+  GMutex stats_lock;
+  GstClockTime stats_interval;
+  GstClockID stats_clock_id;
+  GstClockTime stats_start;     /* Wall clock time of the first buffer */
+  GList *stats_stages;          /* RenderStage */
 };
 
 enum
@@ -76,10 +159,19 @@ enum
   PROP_VIDEO_SINK,
   PROP_TIMELINE,
   PROP_MODE,
+  PROP_SCRUB_CACHE_SIZE,
+  PROP_STATS_INTERVAL,
   PROP_LAST
 };
 
+enum
+{
+  SCRUB_FRAME,
+  LAST_SIGNAL
+};
+
 static GParamSpec *properties[PROP_LAST];
+static guint ges_pipeline_signals[LAST_SIGNAL] = { 0 };
 
 static GstStateChangeReturn ges_pipeline_change_state (GstElement *
     element, GstStateChange transition);
@@ -88,6 +180,16 @@ static OutputChain *get_output_chain_for_track (GESPipeline * self,
     GESTrack * track);
 static OutputChain *new_output_chain_for_track (GESPipeline * self,
     GESTrack * track);
+static void _scrub_seek_func (GESPipeline * self, gpointer unused);
+static void _scrub_reset (GESPipeline * self, gboolean reset_stats);
+static void _scrub_trim_frames (GESPipeline * self);
+static void _stats_reset (GESPipeline * self);
+static void _stats_discover_stages (GESPipeline * self);
+static void _stats_start_timer (GESPipeline * self);
+static void _stats_stop_timer (GESPipeline * self);
+static void _stats_clear_stages (GESPipeline * self);
+static void _timeline_commited_cb (GESTimeline * timeline,
+    GESPipeline * self);
 
 /****************************************************
  *    Video Overlay vmethods implementation         *
@@ -164,6 +266,16 @@ ges_pipeline_get_property (GObject * object, guint property_id,
     case PROP_MODE:
       g_value_set_flags (value, self->priv->mode);
       break;
+    case PROP_SCRUB_CACHE_SIZE:
+      g_mutex_lock (&self->priv->scrub_lock);
+      g_value_set_uint (value, self->priv->scrub_cache_size);
+      g_mutex_unlock (&self->priv->scrub_lock);
+      break;
+    case PROP_STATS_INTERVAL:
+      g_mutex_lock (&self->priv->stats_lock);
+      g_value_set_uint64 (value, self->priv->stats_interval);
+      g_mutex_unlock (&self->priv->stats_lock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -191,6 +303,20 @@ ges_pipeline_set_property (GObject * object, guint property_id,
     case PROP_MODE:
       ges_pipeline_set_mode (GES_PIPELINE (object), g_value_get_flags (value));
       break;
+    case PROP_SCRUB_CACHE_SIZE:
+      g_mutex_lock (&self->priv->scrub_lock);
+      self->priv->scrub_cache_size = g_value_get_uint (value);
+      _scrub_trim_frames (self);
+      g_mutex_unlock (&self->priv->scrub_lock);
+      break;
+    case PROP_STATS_INTERVAL:
+      _stats_stop_timer (self);
+      g_mutex_lock (&self->priv->stats_lock);
+      self->priv->stats_interval = g_value_get_uint64 (value);
+      g_mutex_unlock (&self->priv->stats_lock);
+      if (GST_STATE (self) == GST_STATE_PLAYING)
+        _stats_start_timer (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -223,9 +349,37 @@ ges_pipeline_dispose (GObject * object)
     self->priv->profile = NULL;
   }
 
+  g_free (self->priv->output_uri);
+  self->priv->output_uri = NULL;
+
+  if (self->priv->scrub_pool) {
+    g_thread_pool_free (self->priv->scrub_pool, TRUE, TRUE);
+    self->priv->scrub_pool = NULL;
+  }
+  _scrub_reset (self, FALSE);
+
+  _stats_stop_timer (self);
+  _stats_clear_stages (self);
+
+  /* The application can keep the timeline around */
+  if (self->priv->timeline)
+    g_signal_handlers_disconnect_by_func (self->priv->timeline,
+        _timeline_commited_cb, self);
+
   G_OBJECT_CLASS (ges_pipeline_parent_class)->dispose (object);
 }
 
+static void
+ges_pipeline_finalize (GObject * object)
+{
+  GESPipeline *self = GES_PIPELINE (object);
+
+  g_mutex_clear (&self->priv->scrub_lock);
+  g_mutex_clear (&self->priv->stats_lock);
+
+  G_OBJECT_CLASS (ges_pipeline_parent_class)->finalize (object);
+}
+
 static void
 ges_pipeline_class_init (GESPipelineClass * klass)
 {
@@ -235,6 +389,7 @@ ges_pipeline_class_init (GESPipelineClass * klass)
   g_type_class_add_private (klass, sizeof (GESPipelinePrivate));
 
   object_class->dispose = ges_pipeline_dispose;
+  object_class->finalize = ges_pipeline_finalize;
   object_class->get_property = ges_pipeline_get_property;
   object_class->set_property = ges_pipeline_set_property;
 
@@ -286,6 +441,51 @@ ges_pipeline_class_init (GESPipelineClass * klass)
   g_object_class_install_property (object_class, PROP_MODE,
       properties[PROP_MODE]);
 
+  /**
+   * GESPipeline:scrub-cache-size:
+   *
+   * Maximum number of composited video frames kept around in
+   * #GES_PIPELINE_MODE_SCRUB. See ges_pipeline_scrub_to() for more info.
+   */
+  properties[PROP_SCRUB_CACHE_SIZE] =
+      g_param_spec_uint ("scrub-cache-size", "Scrub cache size",
+      "Maximum number of video frames kept around while scrubbing", 1,
+      G_MAXUINT, DEFAULT_SCRUB_CACHE_SIZE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+  g_object_class_install_property (object_class, PROP_SCRUB_CACHE_SIZE,
+      properties[PROP_SCRUB_CACHE_SIZE]);
+
+  /**
+   * GESPipeline:stats-interval:
+   *
+   * Interval, in nanoseconds, at which an element message holding the
+   * structure returned by ges_pipeline_get_stats() is posted on the bus
+   * while the pipeline is PLAYING. 0 disables the messages.
+   */
+  properties[PROP_STATS_INTERVAL] =
+      g_param_spec_uint64 ("stats-interval", "Statistics interval",
+      "Interval at which render statistics are posted on the bus "
+      "(0 = disabled)", 0, G_MAXUINT64, DEFAULT_STATS_INTERVAL,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+  g_object_class_install_property (object_class, PROP_STATS_INTERVAL,
+      properties[PROP_STATS_INTERVAL]);
+
+  /**
+   * GESPipeline::scrub-frame:
+   * @pipeline: the #GESPipeline
+   * @sample: the #GstSample of the video frame at @position
+   * @position: the position that was scrubbed to
+   *
+   * Will be emitted in #GES_PIPELINE_MODE_SCRUB once the frame at the
+   * latest position passed to ges_pipeline_scrub_to() is available. It is
+   * emitted from the thread calling ges_pipeline_scrub_to() when the frame
+   * was cached, and from a streaming thread otherwise.
+   */
+  ges_pipeline_signals[SCRUB_FRAME] =
+      g_signal_new ("scrub-frame", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_marshal_generic,
+      G_TYPE_NONE, 2, GST_TYPE_SAMPLE, G_TYPE_UINT64);
+
   element_class->change_state = GST_DEBUG_FUNCPTR (ges_pipeline_change_state);
 
   /* TODO : Add state_change handlers
@@ -299,6 +499,18 @@ ges_pipeline_init (GESPipeline * self)
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
       GES_TYPE_PIPELINE, GESPipelinePrivate);
 
+  g_mutex_init (&self->priv->scrub_lock);
+  g_queue_init (&self->priv->scrub_frames);
+  self->priv->scrub_cache_size = DEFAULT_SCRUB_CACHE_SIZE;
+  self->priv->scrub_target = GST_CLOCK_TIME_NONE;
+  self->priv->scrub_frame_duration = GST_CLOCK_TIME_NONE;
+  self->priv->scrub_pool = g_thread_pool_new ((GFunc) _scrub_seek_func, NULL,
+      1, FALSE, NULL);
+
+  g_mutex_init (&self->priv->stats_lock);
+  self->priv->stats_interval = DEFAULT_STATS_INTERVAL;
+  self->priv->stats_start = GST_CLOCK_TIME_NONE;
+
   self->priv->playsink =
       gst_element_factory_make ("playsink", "internal-sinks");
   self->priv->encodebin =
@@ -428,6 +640,9 @@ ges_pipeline_change_state (GstElement * element, GstStateChange transition)
         ret = GST_STATE_CHANGE_FAILURE;
         goto done;
       }
+      /* Clips of a lazily loaded timeline nobody asked for yet */
+      if (timeline_load_for_playback (self->priv->timeline))
+        ges_timeline_commit (self->priv->timeline);
       if (self->priv->mode & (GES_PIPELINE_MODE_RENDER |
               GES_PIPELINE_MODE_SMART_RENDER))
         GST_DEBUG ("rendering => Updating pipeline caps");
@@ -437,6 +652,18 @@ ges_pipeline_change_state (GstElement * element, GstStateChange transition)
         goto done;
       }
       /* Set caps on all tracks according to profile if present */
+      _stats_reset (self);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      _scrub_reset (self, FALSE);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
+      /* encodebin is fully set up by now */
+      _stats_discover_stages (self);
+      _stats_start_timer (self);
+      break;
+    case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
+      _stats_stop_timer (self);
       break;
     default:
       break;
@@ -446,6 +673,15 @@ ges_pipeline_change_state (GstElement * element, GstStateChange transition)
       GST_ELEMENT_CLASS (ges_pipeline_parent_class)->change_state
       (element, transition);
 
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* No streaming thread is running anymore */
+      _stats_clear_stages (self);
+      break;
+    default:
+      break;
+  }
+
 done:
   return ret;
 }
@@ -457,6 +693,10 @@ new_output_chain_for_track (GESPipeline * self, GESTrack * track)
 
   chain = g_new0 (OutputChain, 1);
   chain->track = track;
+  chain->pipeline = self;
+  chain->first_buffer_time = GST_CLOCK_TIME_NONE;
+  chain->last_buffer_time = GST_CLOCK_TIME_NONE;
+  chain->position = GST_CLOCK_TIME_NONE;
 
   return chain;
 }
@@ -550,6 +790,721 @@ pad_blocked (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
   return GST_PAD_PROBE_OK;
 }
 
+/****************************************************
+ *                 Scrubbing                        *
+ ****************************************************/
+
+static void
+_scrub_frame_free (ScrubFrame * frame)
+{
+  gst_sample_unref (frame->sample);
+  g_slice_free (ScrubFrame, frame);
+}
+
+/* Must be called with the scrub_lock */
+static void
+_scrub_trim_frames (GESPipeline * self)
+{
+  GESPipelinePrivate *priv = self->priv;
+
+  while (g_queue_get_length (&priv->scrub_frames) > priv->scrub_cache_size)
+    _scrub_frame_free (g_queue_pop_head (&priv->scrub_frames));
+}
+
+static void
+_scrub_free_frames (GESPipeline * self)
+{
+  ScrubFrame *frame;
+
+  while ((frame = g_queue_pop_head (&self->priv->scrub_frames)))
+    _scrub_frame_free (frame);
+}
+
+static void
+_scrub_reset (GESPipeline * self, gboolean reset_stats)
+{
+  GESPipelinePrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->scrub_lock);
+  _scrub_free_frames (self);
+  priv->scrub_target = GST_CLOCK_TIME_NONE;
+  priv->scrub_pending = FALSE;
+  priv->scrub_seeking = FALSE;
+  priv->scrub_flushed = FALSE;
+
+  if (reset_stats) {
+    priv->scrub_steps = 0;
+    priv->scrub_hits = 0;
+    priv->scrub_coalesced = 0;
+    priv->scrub_last_latency = 0;
+    priv->scrub_max_latency = 0;
+    priv->scrub_total_latency = 0;
+  }
+  g_mutex_unlock (&priv->scrub_lock);
+}
+
+/* Must be called with the scrub_lock */
+static ScrubFrame *
+_scrub_find_frame (GESPipeline * self, GstClockTime position)
+{
+  GList *tmp;
+
+  for (tmp = self->priv->scrub_frames.tail; tmp; tmp = tmp->prev) {
+    ScrubFrame *frame = tmp->data;
+
+    if (position == frame->position || (position > frame->position &&
+            GST_CLOCK_TIME_IS_VALID (frame->duration) &&
+            position < frame->position + frame->duration))
+      return frame;
+  }
+
+  return NULL;
+}
+
+/* Must be called with the scrub_lock */
+static void
+_scrub_record_step (GESPipeline * self, gboolean cached)
+{
+  GESPipelinePrivate *priv = self->priv;
+  GstClockTime latency = (g_get_monotonic_time () - priv->scrub_request_time)
+      * GST_USECOND;
+
+  priv->scrub_steps++;
+  if (cached)
+    priv->scrub_hits++;
+
+  priv->scrub_last_latency = latency;
+  priv->scrub_max_latency = MAX (priv->scrub_max_latency, latency);
+  priv->scrub_total_latency += latency;
+}
+
+/* Must be called with the scrub_lock, hands the seek to scrub_target over
+ * to the scrub_pool so that neither the application nor the streaming
+ * threads ever wait for it */
+static void
+_scrub_start_seek (GESPipeline * self)
+{
+  GESPipelinePrivate *priv = self->priv;
+
+  priv->scrub_pending = FALSE;
+  priv->scrub_seeking = TRUE;
+  priv->scrub_flushed = FALSE;
+  priv->scrub_seek_position = priv->scrub_target;
+
+  g_thread_pool_push (priv->scrub_pool, self, NULL);
+}
+
+/* Must be called with the scrub_lock, once the in flight seek is over */
+static void
+_scrub_seek_done (GESPipeline * self)
+{
+  self->priv->scrub_seeking = FALSE;
+
+  /* Only seek to the latest position requested in the meantime */
+  if (self->priv->scrub_pending)
+    _scrub_start_seek (self);
+}
+
+static void
+_scrub_seek_func (GESPipeline * self, gpointer unused)
+{
+  GstClockTime position;
+
+  g_mutex_lock (&self->priv->scrub_lock);
+  position = self->priv->scrub_seek_position;
+  g_mutex_unlock (&self->priv->scrub_lock);
+
+  GST_DEBUG_OBJECT (self, "Scrubbing to %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (position));
+
+  if (!gst_element_seek (GST_ELEMENT (self), 1.0, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE,
+          GST_SEEK_TYPE_SET, position, GST_SEEK_TYPE_NONE, -1)) {
+    GST_WARNING_OBJECT (self, "Could not seek to %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (position));
+
+    g_mutex_lock (&self->priv->scrub_lock);
+    _scrub_seek_done (self);
+    g_mutex_unlock (&self->priv->scrub_lock);
+  }
+}
+
+/* Deep copies @buffer so that we do not keep buffers from upstream pools
+ * around */
+static GstSample *
+_scrub_copy_sample (GstPad * pad, GstBuffer * buffer)
+{
+  GstMapInfo map;
+  GstBuffer *copy;
+  GstCaps *caps;
+  GstSample *sample;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return NULL;
+
+  copy = gst_buffer_new_allocate (NULL, map.size, NULL);
+  gst_buffer_fill (copy, 0, map.data, map.size);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_copy_into (copy, buffer, GST_BUFFER_COPY_FLAGS |
+      GST_BUFFER_COPY_TIMESTAMPS | GST_BUFFER_COPY_META, 0, -1);
+
+  caps = gst_pad_get_current_caps (pad);
+  sample = gst_sample_new (copy, caps, NULL, NULL);
+  gst_buffer_unref (copy);
+  if (caps)
+    gst_caps_unref (caps);
+
+  return sample;
+}
+
+static GstPadProbeReturn
+_scrub_probe (GstPad * pad, GstPadProbeInfo * info, GESPipeline * self)
+{
+  GESPipelinePrivate *priv = self->priv;
+  GstSample *emit = NULL;
+  GstClockTime position = GST_CLOCK_TIME_NONE;
+
+  if (!(priv->mode & GES_PIPELINE_MODE_SCRUB))
+    return GST_PAD_PROBE_OK;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+    ScrubFrame *frame;
+
+    if (!GST_BUFFER_PTS_IS_VALID (buffer))
+      return GST_PAD_PROBE_OK;
+
+    g_mutex_lock (&priv->scrub_lock);
+    priv->scrub_frame_duration = GST_BUFFER_DURATION (buffer);
+
+    /* Only the frames scrubbed to are cached, not the ones played */
+    if (!priv->scrub_seeking || !priv->scrub_flushed) {
+      g_mutex_unlock (&priv->scrub_lock);
+
+      return GST_PAD_PROBE_OK;
+    }
+
+    frame = _scrub_find_frame (self, GST_BUFFER_PTS (buffer));
+    if (frame == NULL || frame->position != GST_BUFFER_PTS (buffer)) {
+      GstSample *sample;
+
+      /* Copying can take a while, do not hold the lock meanwhile */
+      g_mutex_unlock (&priv->scrub_lock);
+      sample = _scrub_copy_sample (pad, buffer);
+      g_mutex_lock (&priv->scrub_lock);
+
+      if (sample) {
+        frame = g_slice_new (ScrubFrame);
+        frame->position = GST_BUFFER_PTS (buffer);
+        frame->duration = GST_BUFFER_DURATION (buffer);
+        frame->sample = sample;
+        g_queue_push_tail (&priv->scrub_frames, frame);
+        _scrub_trim_frames (self);
+      } else {
+        frame = NULL;
+      }
+    }
+
+    /* First frame after the flush is the one we seeked to */
+    if (frame && !priv->scrub_pending &&
+        priv->scrub_seek_position == priv->scrub_target) {
+      _scrub_record_step (self, FALSE);
+      emit = gst_sample_ref (frame->sample);
+      position = priv->scrub_target;
+    }
+    _scrub_seek_done (self);
+    g_mutex_unlock (&priv->scrub_lock);
+  } else {
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+    g_mutex_lock (&priv->scrub_lock);
+    if (priv->scrub_seeking) {
+      if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP)
+        priv->scrub_flushed = TRUE;
+      else if (GST_EVENT_TYPE (event) == GST_EVENT_EOS && priv->scrub_flushed)
+        _scrub_seek_done (self);
+    }
+    g_mutex_unlock (&priv->scrub_lock);
+  }
+
+  if (emit) {
+    g_signal_emit (self, ges_pipeline_signals[SCRUB_FRAME], 0, emit,
+        position);
+    gst_sample_unref (emit);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/****************************************************
+ *                 Render statistics                *
+ ****************************************************/
+
+/* Returns how full @queue is, in percent of its most limiting maximum */
+static gdouble
+_stats_queue_level (GstElement * queue)
+{
+  guint buffers, max_buffers, bytes, max_bytes;
+  guint64 time, max_time;
+  gdouble level = 0;
+
+  g_object_get (queue, "current-level-buffers", &buffers,
+      "max-size-buffers", &max_buffers, "current-level-bytes", &bytes,
+      "max-size-bytes", &max_bytes, "current-level-time", &time,
+      "max-size-time", &max_time, NULL);
+
+  if (max_buffers)
+    level = MAX (level, 100.0 * buffers / max_buffers);
+  if (max_bytes)
+    level = MAX (level, 100.0 * bytes / max_bytes);
+  if (max_time)
+    level = MAX (level, 100.0 * time / max_time);
+
+  return MIN (level, 100.0);
+}
+
+/* encodebin starts each of its streams with a queue, it tells us whether
+ * the encoding side keeps up with the timeline */
+static GstElement *
+_stats_get_encodebin_queue (GstPad * encodebinpad)
+{
+  GstPad *target;
+  GstElement *queue;
+  GstElementFactory *factory;
+
+  if (!GST_IS_GHOST_PAD (encodebinpad))
+    return NULL;
+
+  target = gst_ghost_pad_get_target (GST_GHOST_PAD (encodebinpad));
+  if (target == NULL)
+    return NULL;
+
+  queue = gst_pad_get_parent_element (target);
+  gst_object_unref (target);
+  if (queue == NULL)
+    return NULL;
+
+  factory = gst_element_get_factory (queue);
+  if (factory == NULL || g_strcmp0 (GST_OBJECT_NAME (factory), "queue")) {
+    gst_object_unref (queue);
+
+    return NULL;
+  }
+
+  return queue;
+}
+
+static GstPadProbeReturn
+_stats_track_probe (GstPad * pad, GstPadProbeInfo * info, OutputChain * chain)
+{
+  GESPipelinePrivate *priv = chain->pipeline->priv;
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstClockTime now = gst_util_get_timestamp ();
+  gboolean blocked = FALSE;
+
+  /* Pushing into a full queue will block until the encoder catches up */
+  if (chain->encodebin_queue)
+    blocked = _stats_queue_level (chain->encodebin_queue) >= 100.0;
+
+  g_mutex_lock (&priv->stats_lock);
+  if (!GST_CLOCK_TIME_IS_VALID (priv->stats_start))
+    priv->stats_start = now;
+
+  /* The time between two buffers is spent decoding, conforming and mixing
+   * in the composition, unless we were waiting on the encoder */
+  if (chain->frames) {
+    if (chain->blocked)
+      chain->blocked_time += now - chain->last_buffer_time;
+    else
+      chain->composite_time += now - chain->last_buffer_time;
+  } else {
+    chain->first_buffer_time = now;
+  }
+
+  chain->frames++;
+  chain->last_buffer_time = now;
+  chain->blocked = blocked;
+  if (GST_BUFFER_PTS_IS_VALID (buffer)) {
+    chain->position = GST_BUFFER_PTS (buffer);
+    if (GST_BUFFER_DURATION_IS_VALID (buffer))
+      chain->position += GST_BUFFER_DURATION (buffer);
+  }
+  g_mutex_unlock (&priv->stats_lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+_stats_stage_sink_probe (GstPad * pad, GstPadProbeInfo * info,
+    RenderStage * stage)
+{
+  GESPipelinePrivate *priv = stage->pipeline->priv;
+
+  g_mutex_lock (&priv->stats_lock);
+  stage->thread = g_thread_self ();
+  stage->input_time = gst_util_get_timestamp ();
+  g_mutex_unlock (&priv->stats_lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Only outputs pushed from the thread the input came from are accounted,
+ * the element did not process anything else in between */
+static GstPadProbeReturn
+_stats_stage_src_probe (GstPad * pad, GstPadProbeInfo * info,
+    RenderStage * stage)
+{
+  GESPipelinePrivate *priv = stage->pipeline->priv;
+  GstClockTime now = gst_util_get_timestamp ();
+
+  g_mutex_lock (&priv->stats_lock);
+  if (stage->thread == g_thread_self () &&
+      GST_CLOCK_TIME_IS_VALID (stage->input_time)) {
+    stage->processing_time += now - stage->input_time;
+    stage->input_time = GST_CLOCK_TIME_NONE;
+  }
+  stage->buffers++;
+  g_mutex_unlock (&priv->stats_lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+_stats_stage_free (RenderStage * stage)
+{
+  GSList *tmp;
+
+  for (tmp = stage->probes; tmp; tmp = tmp->next) {
+    StatsProbe *probe = tmp->data;
+
+    gst_pad_remove_probe (probe->pad, probe->id);
+    gst_object_unref (probe->pad);
+    g_slice_free (StatsProbe, probe);
+  }
+  g_slist_free (stage->probes);
+  gst_object_unref (stage->element);
+
+  g_slice_free (RenderStage, stage);
+}
+
+/* Must be called with the stats_lock */
+static void
+_stats_add_stage (GESPipeline * self, GstElement * element, const gchar * name)
+{
+  GList *tmp;
+  RenderStage *stage = g_slice_new0 (RenderStage);
+
+  stage->pipeline = self;
+  stage->element = gst_object_ref (element);
+  stage->name = name;
+  stage->input_time = GST_CLOCK_TIME_NONE;
+
+  GST_OBJECT_LOCK (element);
+  for (tmp = element->pads; tmp; tmp = tmp->next) {
+    StatsProbe *probe = g_slice_new (StatsProbe);
+
+    probe->pad = gst_object_ref (tmp->data);
+    if (GST_PAD_DIRECTION (probe->pad) == GST_PAD_SINK)
+      probe->id = gst_pad_add_probe (probe->pad, GST_PAD_PROBE_TYPE_BUFFER,
+          (GstPadProbeCallback) _stats_stage_sink_probe, stage, NULL);
+    else
+      probe->id = gst_pad_add_probe (probe->pad, GST_PAD_PROBE_TYPE_BUFFER,
+          (GstPadProbeCallback) _stats_stage_src_probe, stage, NULL);
+    stage->probes = g_slist_prepend (stage->probes, probe);
+  }
+  GST_OBJECT_UNLOCK (element);
+
+  GST_DEBUG_OBJECT (self, "Measuring %s stage in %" GST_PTR_FORMAT, name,
+      element);
+
+  self->priv->stats_stages = g_list_prepend (self->priv->stats_stages, stage);
+}
+
+/* Must be called with the stats_lock */
+static gboolean
+_stats_has_stage (GESPipeline * self, GstElement * element)
+{
+  GList *tmp;
+
+  for (tmp = self->priv->stats_stages; tmp; tmp = tmp->next) {
+    if (((RenderStage *) tmp->data)->element == element)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+static const gchar *
+_stats_get_stage_name (GstElement * element)
+{
+  const gchar *klass;
+  GstElementFactory *factory = gst_element_get_factory (element);
+
+  if (factory == NULL)
+    return NULL;
+
+  klass = gst_element_factory_get_metadata (factory,
+      GST_ELEMENT_METADATA_KLASS);
+  if (klass == NULL)
+    return NULL;
+
+  if (strstr (klass, "Encoder"))
+    return "encode";
+  else if (strstr (klass, "Muxer"))
+    return "mux";
+  else if (strstr (klass, "Converter"))
+    return "convert";
+
+  return NULL;
+}
+
+/* Puts probes on the converters, encoders and muxer encodebin plugged */
+static void
+_stats_discover_stages (GESPipeline * self)
+{
+  GstIterator *it;
+  gboolean done = FALSE;
+  GValue item = { 0, };
+
+  if (!(self->priv->mode & (GES_PIPELINE_MODE_RENDER |
+              GES_PIPELINE_MODE_SMART_RENDER)) || !self->priv->encodebin)
+    return;
+
+  g_mutex_lock (&self->priv->stats_lock);
+  it = gst_bin_iterate_recurse (GST_BIN (self->priv->encodebin));
+  while (!done) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:
+      {
+        GstElement *element = g_value_get_object (&item);
+        const gchar *name = _stats_get_stage_name (element);
+
+        if (name && !_stats_has_stage (self, element))
+          _stats_add_stage (self, element, name);
+        g_value_reset (&item);
+      }
+        break;
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (it);
+        break;
+      case GST_ITERATOR_DONE:
+      case GST_ITERATOR_ERROR:
+        done = TRUE;
+        break;
+    }
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+  g_mutex_unlock (&self->priv->stats_lock);
+}
+
+static void
+_stats_clear_stages (GESPipeline * self)
+{
+  g_mutex_lock (&self->priv->stats_lock);
+  g_list_free_full (self->priv->stats_stages,
+      (GDestroyNotify) _stats_stage_free);
+  self->priv->stats_stages = NULL;
+  g_mutex_unlock (&self->priv->stats_lock);
+}
+
+static void
+_stats_reset (GESPipeline * self)
+{
+  GList *tmp;
+  GESPipelinePrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->stats_lock);
+  priv->stats_start = GST_CLOCK_TIME_NONE;
+
+  for (tmp = priv->chains; tmp; tmp = tmp->next) {
+    OutputChain *chain = tmp->data;
+
+    chain->frames = 0;
+    chain->first_buffer_time = GST_CLOCK_TIME_NONE;
+    chain->last_buffer_time = GST_CLOCK_TIME_NONE;
+    chain->position = GST_CLOCK_TIME_NONE;
+    chain->composite_time = 0;
+    chain->blocked_time = 0;
+    chain->blocked = FALSE;
+  }
+
+  for (tmp = priv->stats_stages; tmp; tmp = tmp->next) {
+    RenderStage *stage = tmp->data;
+
+    stage->thread = NULL;
+    stage->input_time = GST_CLOCK_TIME_NONE;
+    stage->buffers = 0;
+    stage->processing_time = 0;
+  }
+  g_mutex_unlock (&priv->stats_lock);
+}
+
+static GstStructure *
+_stats_collect (GESPipeline * self)
+{
+  GList *tmp;
+  GstStructure *stats, *item_stats;
+  GESPipelinePrivate *priv = self->priv;
+  GValue tracks = { 0, }, stages = { 0, }, item = { 0, };
+  GstClockTime now = gst_util_get_timestamp (), elapsed = 0;
+  GstClockTime position = GST_CLOCK_TIME_NONE, duration = GST_CLOCK_TIME_NONE;
+  GstClockTime eta = GST_CLOCK_TIME_NONE, composite_time = 0;
+  GstClockTime convert_time = 0, encode_time = 0, mux_time = 0;
+  gint64 query_duration;
+  gdouble progress = 0, speed = 0;
+
+  /* We can be called from the clock thread, ask the pipeline rather than
+   * risking to build the clips of a lazily loaded timeline from here */
+  if (gst_element_query_duration (GST_ELEMENT (self), GST_FORMAT_TIME,
+          &query_duration) && query_duration >= 0)
+    duration = query_duration;
+  else if (priv->timeline)
+    duration = timeline_get_loaded_duration (priv->timeline);
+
+  g_value_init (&tracks, GST_TYPE_ARRAY);
+  g_value_init (&stages, GST_TYPE_ARRAY);
+  g_value_init (&item, GST_TYPE_STRUCTURE);
+
+  g_mutex_lock (&priv->stats_lock);
+  for (tmp = priv->chains; tmp; tmp = tmp->next) {
+    OutputChain *chain = tmp->data;
+    gdouble fps = 0;
+
+    if (chain->frames > 1 &&
+        chain->last_buffer_time > chain->first_buffer_time)
+      fps = (chain->frames - 1) * (gdouble) GST_SECOND /
+          (chain->last_buffer_time - chain->first_buffer_time);
+
+    item_stats = gst_structure_new ("ges-track-stats",
+        "track-type", GES_TYPE_TRACK_TYPE, chain->track->type,
+        "frames", G_TYPE_UINT64, chain->frames,
+        "fps", G_TYPE_DOUBLE, fps,
+        "position", G_TYPE_UINT64, chain->position,
+        "composite-time", G_TYPE_UINT64, chain->composite_time,
+        "blocked-time", G_TYPE_UINT64, chain->blocked_time,
+        "queue-level", G_TYPE_DOUBLE, chain->encodebin_queue ?
+        _stats_queue_level (chain->encodebin_queue) : -1.0, NULL);
+    g_value_take_boxed (&item, item_stats);
+    gst_value_array_append_value (&tracks, &item);
+
+    /* The render is as far as its slowest track */
+    if (GST_CLOCK_TIME_IS_VALID (chain->position) &&
+        (!GST_CLOCK_TIME_IS_VALID (position) || chain->position < position))
+      position = chain->position;
+    composite_time += chain->composite_time;
+  }
+
+  for (tmp = priv->stats_stages; tmp; tmp = tmp->next) {
+    RenderStage *stage = tmp->data;
+
+    item_stats = gst_structure_new ("ges-stage-stats",
+        "stage", G_TYPE_STRING, stage->name,
+        "element", G_TYPE_STRING, GST_ELEMENT_NAME (stage->element),
+        "buffers", G_TYPE_UINT64, stage->buffers,
+        "processing-time", G_TYPE_UINT64, stage->processing_time, NULL);
+    g_value_take_boxed (&item, item_stats);
+    gst_value_array_append_value (&stages, &item);
+
+    if (!g_strcmp0 (stage->name, "convert"))
+      convert_time += stage->processing_time;
+    else if (!g_strcmp0 (stage->name, "encode"))
+      encode_time += stage->processing_time;
+    else
+      mux_time += stage->processing_time;
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (priv->stats_start))
+    elapsed = now - priv->stats_start;
+  g_mutex_unlock (&priv->stats_lock);
+  g_value_unset (&item);
+
+  if (GST_CLOCK_TIME_IS_VALID (position) && elapsed)
+    speed = (gdouble) position / elapsed;
+
+  if (GST_CLOCK_TIME_IS_VALID (position) &&
+      GST_CLOCK_TIME_IS_VALID (duration) && duration) {
+    position = MIN (position, duration);
+    progress = (gdouble) position / duration;
+    if (position && elapsed)
+      eta = gst_util_uint64_scale (elapsed, duration - position, position);
+  }
+
+  stats = gst_structure_new ("ges-render-stats",
+      "elapsed", G_TYPE_UINT64, elapsed,
+      "position", G_TYPE_UINT64, position,
+      "duration", G_TYPE_UINT64, duration,
+      "progress", G_TYPE_DOUBLE, progress,
+      "speed", G_TYPE_DOUBLE, speed,
+      "eta", G_TYPE_UINT64, eta,
+      "composite-time", G_TYPE_UINT64, composite_time,
+      "convert-time", G_TYPE_UINT64, convert_time,
+      "encode-time", G_TYPE_UINT64, encode_time,
+      "mux-time", G_TYPE_UINT64, mux_time, NULL);
+  gst_structure_take_value (stats, "tracks", &tracks);
+  gst_structure_take_value (stats, "stages", &stages);
+
+  return stats;
+}
+
+static gboolean
+_stats_clock_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    GESPipeline * self)
+{
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_element (GST_OBJECT (self), _stats_collect (self)));
+
+  return TRUE;
+}
+
+static void
+_stats_start_timer (GESPipeline * self)
+{
+  GstClock *clock;
+  GESPipelinePrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->stats_lock);
+  if (priv->stats_clock_id || !priv->stats_interval) {
+    g_mutex_unlock (&priv->stats_lock);
+
+    return;
+  }
+
+  /* Not the pipeline clock, messages keep coming when rendering faster
+   * than realtime */
+  clock = gst_system_clock_obtain ();
+  priv->stats_clock_id = gst_clock_new_periodic_id (clock,
+      gst_clock_get_time (clock) + priv->stats_interval, priv->stats_interval);
+  gst_clock_id_wait_async (priv->stats_clock_id,
+      (GstClockCallback) _stats_clock_cb, gst_object_ref (self),
+      gst_object_unref);
+  gst_object_unref (clock);
+  g_mutex_unlock (&priv->stats_lock);
+}
+
+static void
+_stats_stop_timer (GESPipeline * self)
+{
+  GESPipelinePrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->stats_lock);
+  if (priv->stats_clock_id) {
+    gst_clock_id_unschedule (priv->stats_clock_id);
+    gst_clock_id_unref (priv->stats_clock_id);
+    priv->stats_clock_id = NULL;
+  }
+  g_mutex_unlock (&priv->stats_lock);
+}
+
+static void
+_timeline_commited_cb (GESTimeline * timeline, GESPipeline * self)
+{
+  /* Cached frames do not match what the timeline outputs anymore */
+  g_mutex_lock (&self->priv->scrub_lock);
+  _scrub_free_frames (self);
+  g_mutex_unlock (&self->priv->scrub_lock);
+}
+
 static void
 pad_added_cb (GstElement * timeline, GstPad * pad, GESPipeline * self)
 {
@@ -592,6 +1547,14 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GESPipeline * self)
     chain = new_output_chain_for_track (self, track);
   chain->srcpad = pad;
 
+  /* Keeps composited frames around in GES_PIPELINE_MODE_SCRUB, whatever mode
+   * we are currently in as it can change without the pad being added again */
+  if (track->type == GES_TRACK_TYPE_VIDEO)
+    chain->scrub_probe_id = gst_pad_add_probe (pad,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM |
+        GST_PAD_PROBE_TYPE_EVENT_FLUSH, (GstPadProbeCallback) _scrub_probe,
+        self, NULL);
+
   /* Adding tee */
   chain->tee = gst_element_factory_make ("tee", NULL);
   gst_bin_add (GST_BIN_CAST (self), chain->tee);
@@ -690,11 +1653,20 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GESPipeline * self)
     }
     gst_object_unref (tmppad);
 
+    if (!chain->encodebin_queue)
+      chain->encodebin_queue =
+          _stats_get_encodebin_queue (chain->encodebinpad);
   }
 
+  if (!chain->stats_probe_id)
+    chain->stats_probe_id = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+        (GstPadProbeCallback) _stats_track_probe, chain, NULL);
+
   /* If chain wasn't already present, insert it in list */
+  g_mutex_lock (&self->priv->stats_lock);
   if (!get_output_chain_for_track (self, track))
     self->priv->chains = g_list_append (self->priv->chains, chain);
+  g_mutex_unlock (&self->priv->stats_lock);
 
   GST_DEBUG ("done");
   return;
@@ -706,6 +1678,10 @@ error:
     }
     if (sinkpad)
       gst_object_unref (sinkpad);
+    if (chain->scrub_probe_id)
+      gst_pad_remove_probe (pad, chain->scrub_probe_id);
+    if (chain->encodebin_queue)
+      gst_object_unref (chain->encodebin_queue);
     g_free (chain);
   }
 }
@@ -757,6 +1733,16 @@ pad_removed_cb (GstElement * timeline, GstPad * pad, GESPipeline * self)
     chain->probe_id = 0;
   }
 
+  if (chain->scrub_probe_id) {
+    gst_pad_remove_probe (pad, chain->scrub_probe_id);
+    chain->scrub_probe_id = 0;
+  }
+
+  if (chain->stats_probe_id) {
+    gst_pad_remove_probe (pad, chain->stats_probe_id);
+    chain->stats_probe_id = 0;
+  }
+
   /* Unlike/remove tee */
   peer = gst_element_get_static_pad (chain->tee, "sink");
   gst_pad_unlink (pad, peer);
@@ -764,7 +1750,12 @@ pad_removed_cb (GstElement * timeline, GstPad * pad, GESPipeline * self)
   gst_element_set_state (chain->tee, GST_STATE_NULL);
   gst_bin_remove (GST_BIN (self), chain->tee);
 
+  g_mutex_lock (&self->priv->stats_lock);
   self->priv->chains = g_list_remove (self->priv->chains, chain);
+  g_mutex_unlock (&self->priv->stats_lock);
+
+  if (chain->encodebin_queue)
+    gst_object_unref (chain->encodebin_queue);
   g_free (chain);
 
   GST_DEBUG ("done");
@@ -822,6 +1813,8 @@ ges_pipeline_set_timeline (GESPipeline * pipeline, GESTimeline * timeline)
       pipeline);
   g_signal_connect (timeline, "no-more-pads", (GCallback) no_more_pads_cb,
       pipeline);
+  g_signal_connect (timeline, "commited", (GCallback) _timeline_commited_cb,
+      pipeline);
 
   /* FIXME Check if we should rollback if we can't sync state */
   gst_element_sync_state_with_parent (GST_ELEMENT (timeline));
@@ -915,9 +1908,135 @@ ges_pipeline_set_render_settings (GESPipeline * pipeline,
   /* We got a referencer when getting back the profile */
   pipeline->priv->profile = profile;
 
+  g_free (pipeline->priv->output_uri);
+  pipeline->priv->output_uri = g_strdup (output_uri);
+
   return TRUE;
 }
 
+/* Waits for a message of @type, returns %FALSE on error or if @cancelled
+ * got set */
+static gboolean
+_wait_for_message (GESPipeline * self, GstBus * bus, GstMessageType type,
+    volatile gint * cancelled)
+{
+  GstMessage *msg;
+
+  while (cancelled == NULL || !g_atomic_int_get (cancelled)) {
+    msg = gst_bus_timed_pop_filtered (bus, RENDER_POLL_TIMEOUT,
+        type | GST_MESSAGE_ERROR);
+
+    if (msg == NULL)
+      continue;
+
+    if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+      GError *err = NULL;
+
+      gst_message_parse_error (msg, &err, NULL);
+      GST_WARNING_OBJECT (self, "Error rendering to %s: %s",
+          self->priv->output_uri, err->message);
+      g_error_free (err);
+      gst_message_unref (msg);
+
+      return FALSE;
+    }
+
+    gst_message_unref (msg);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* Renders [@start - @stop] of the timeline of @self, which must be in
+ * #GES_PIPELINE_MODE_RENDER, blocking until done. The pipeline is left in
+ * %GST_STATE_NULL */
+gboolean
+_ges_pipeline_render_range (GESPipeline * self, GstClockTime start,
+    GstClockTime stop, volatile gint * cancelled)
+{
+  GstBus *bus;
+  gboolean res = FALSE;
+
+  bus = gst_element_get_bus (GST_ELEMENT (self));
+  if (gst_element_set_state (GST_ELEMENT (self), GST_STATE_PAUSED) ==
+      GST_STATE_CHANGE_FAILURE)
+    goto done;
+
+  if (!_wait_for_message (self, bus, GST_MESSAGE_ASYNC_DONE, cancelled))
+    goto done;
+
+  if (!gst_element_seek (GST_ELEMENT (self), 1.0, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE,
+          GST_SEEK_TYPE_SET, start, GST_SEEK_TYPE_SET, stop))
+    goto done;
+
+  if (gst_element_set_state (GST_ELEMENT (self), GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE)
+    goto done;
+
+  res = _wait_for_message (self, bus, GST_MESSAGE_EOS, cancelled);
+
+done:
+  gst_element_set_state (GST_ELEMENT (self), GST_STATE_NULL);
+  gst_object_unref (bus);
+
+  return res;
+}
+
+/**
+ * ges_pipeline_render_incremental:
+ * @pipeline: a #GESPipeline
+ * @segment_duration: The maximum duration of the segments the output is
+ * split in
+ * @error: (allow-none): An error to be set in case something wrong happens
+ * or %NULL
+ *
+ * Renders the timeline of @pipeline using the settings passed to
+ * #ges_pipeline_set_render_settings, only encoding again what changed since
+ * the previous call.
+ *
+ * The timeline is split into segments starting and ending at the edges of
+ * its clips, and no longer than @segment_duration (rounded to a multiple of
+ * the frame duration). Each segment is rendered as a standalone file
+ * starting with a keyframe. Those files are written in a directory next to
+ * the output file, named after it with a ".segments" suffix, together with
+ * a manifest describing how each segment was rendered. They are then
+ * concatenated into the output file, their encoded streams are only muxed
+ * again.
+ *
+ * On the next call, only the segments for which the content of the
+ * timeline, the tracks or the encoding settings changed are rendered again,
+ * the others are kept from the previous render, even if they moved in the
+ * timeline.
+ *
+ * This call blocks until rendering is done, the pipeline itself does not
+ * need to be in #GES_PIPELINE_MODE_RENDER and is not used while rendering.
+ *
+ * Returns: %TRUE if the output could be rendered, %FALSE otherwise
+ */
+gboolean
+ges_pipeline_render_incremental (GESPipeline * pipeline,
+    GstClockTime segment_duration, GError ** error)
+{
+  g_return_val_if_fail (GES_IS_PIPELINE (pipeline), FALSE);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (segment_duration) &&
+      segment_duration > 0, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  if (pipeline->priv->timeline == NULL || pipeline->priv->profile == NULL ||
+      pipeline->priv->output_uri == NULL) {
+    g_set_error (error, GES_ERROR, GES_ERROR_RENDERING,
+        "A timeline and render settings need to be set before rendering");
+
+    return FALSE;
+  }
+
+  return _ges_render_incremental (pipeline->priv->timeline,
+      pipeline->priv->output_uri, pipeline->priv->profile, segment_duration,
+      error);
+}
+
 /**
  * ges_pipeline_get_mode:
  * @pipeline: a #GESPipeline
@@ -956,12 +2075,19 @@ ges_pipeline_set_mode (GESPipeline * pipeline, GESPipelineFlags mode)
   if (mode == pipeline->priv->mode)
     return TRUE;
 
+  if ((mode & GES_PIPELINE_MODE_SCRUB) &&
+      !(mode & GES_PIPELINE_MODE_PREVIEW_VIDEO)) {
+    GST_ERROR_OBJECT (pipeline, "Scrubbing needs the video to be previewed");
+    return FALSE;
+  }
+
   /* FIXME: It would be nice if we are only (de)activating preview
    * modes to not set the whole pipeline to NULL, but instead just
    * do the proper (un)linking to playsink. */
 
   /* Switch pipeline to NULL since we're changing the configuration */
   gst_element_set_state (GST_ELEMENT_CAST (pipeline), GST_STATE_NULL);
+  _scrub_reset (pipeline, TRUE);
 
   /* remove no-longer needed components */
   if (pipeline->priv->mode & GES_PIPELINE_MODE_PREVIEW &&
@@ -1253,3 +2379,214 @@ ges_pipeline_preview_set_audio_sink (GESPipeline * self, GstElement * sink)
 
   g_object_set (self->priv->playsink, "audio-sink", sink, NULL);
 };
+
+/**
+ * ges_pipeline_scrub_to:
+ * @pipeline: a #GESPipeline in #GES_PIPELINE_MODE_SCRUB and
+ * %GST_STATE_PAUSED
+ * @position: the position to scrub to
+ *
+ * Requests the video frame at @position, the #GESPipeline::scrub-frame
+ * signal will be emitted once it is available.
+ *
+ * The most recently composited frames are kept around (see
+ * #GESPipeline:scrub-cache-size) so that going back and forth over the same
+ * part of the timeline does not need decoding them again. Frames served from
+ * that cache are only handed to the #GESPipeline::scrub-frame handlers, they
+ * are not rendered by the video sink again.
+ *
+ * Otherwise a seek to @position is issued in the background. If other
+ * positions are requested while it is in flight, only the latest of them
+ * will be seeked to once it is done, the others are skipped.
+ *
+ * The cache is cleared whenever the timeline is commited.
+ *
+ * Returns: %TRUE if the frame was cached and #GESPipeline::scrub-frame
+ * has been emitted already, %FALSE if it has to be decoded first.
+ */
+gboolean
+ges_pipeline_scrub_to (GESPipeline * pipeline, GstClockTime position)
+{
+  ScrubFrame *frame;
+  GstSample *sample = NULL;
+  GESPipelinePrivate *priv;
+
+  g_return_val_if_fail (GES_IS_PIPELINE (pipeline), FALSE);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), FALSE);
+  g_return_val_if_fail (pipeline->priv->mode & GES_PIPELINE_MODE_SCRUB,
+      FALSE);
+
+  priv = pipeline->priv;
+
+  g_mutex_lock (&priv->scrub_lock);
+  priv->scrub_target = position;
+  priv->scrub_request_time = g_get_monotonic_time ();
+
+  frame = _scrub_find_frame (pipeline, position);
+  if (frame) {
+    /* Whatever is in flight is not the latest request anymore */
+    priv->scrub_pending = FALSE;
+    sample = gst_sample_ref (frame->sample);
+    _scrub_record_step (pipeline, TRUE);
+  } else {
+    if (priv->scrub_pending)
+      priv->scrub_coalesced++;
+
+    priv->scrub_pending = TRUE;
+    if (!priv->scrub_seeking)
+      _scrub_start_seek (pipeline);
+  }
+  g_mutex_unlock (&priv->scrub_lock);
+
+  if (sample) {
+    GST_LOG_OBJECT (pipeline, "Frame at %" GST_TIME_FORMAT " was cached",
+        GST_TIME_ARGS (position));
+    g_signal_emit (pipeline, ges_pipeline_signals[SCRUB_FRAME], 0, sample,
+        position);
+    gst_sample_unref (sample);
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+/**
+ * ges_pipeline_scrub_step:
+ * @pipeline: a #GESPipeline in #GES_PIPELINE_MODE_SCRUB and
+ * %GST_STATE_PAUSED
+ * @n_frames: the number of frames to step, negative to step backward
+ *
+ * Steps @n_frames video frames from the latest position passed to
+ * ges_pipeline_scrub_to(), or from the current position if none was. See
+ * ges_pipeline_scrub_to() for more info.
+ *
+ * Returns: %TRUE if the frame was cached and #GESPipeline::scrub-frame
+ * has been emitted already, %FALSE if it has to be decoded first or if the
+ * frame duration is not known yet.
+ */
+gboolean
+ges_pipeline_scrub_step (GESPipeline * pipeline, gint n_frames)
+{
+  gint64 current = -1;
+  GstClockTime duration, step, position;
+
+  g_return_val_if_fail (GES_IS_PIPELINE (pipeline), FALSE);
+  g_return_val_if_fail (pipeline->priv->mode & GES_PIPELINE_MODE_SCRUB,
+      FALSE);
+
+  g_mutex_lock (&pipeline->priv->scrub_lock);
+  duration = pipeline->priv->scrub_frame_duration;
+  if (GST_CLOCK_TIME_IS_VALID (pipeline->priv->scrub_target))
+    current = pipeline->priv->scrub_target;
+  g_mutex_unlock (&pipeline->priv->scrub_lock);
+
+  if (!GST_CLOCK_TIME_IS_VALID (duration) || duration == 0) {
+    GST_WARNING_OBJECT (pipeline, "Frame duration unknown, can't step");
+    return FALSE;
+  }
+
+  if (current == -1 && !gst_element_query_position (GST_ELEMENT (pipeline),
+          GST_FORMAT_TIME, &current)) {
+    GST_WARNING_OBJECT (pipeline, "Current position unknown, can't step");
+    return FALSE;
+  }
+
+  step = duration * ABS (n_frames);
+  if (n_frames >= 0)
+    position = current + step;
+  else
+    position = (GstClockTime) current > step ? current - step : 0;
+
+  return ges_pipeline_scrub_to (pipeline, position);
+}
+
+/**
+ * ges_pipeline_get_scrub_stats:
+ * @pipeline: a #GESPipeline
+ *
+ * Gets statistics about the scrubbing steps done since @pipeline went to
+ * #GES_PIPELINE_MODE_SCRUB, as a #GstStructure named "ges-scrub-stats"
+ * with the following fields:
+ *
+ * - "steps" (#G_TYPE_UINT): the number of frames delivered through
+ *   #GESPipeline::scrub-frame
+ * - "cache-hits" (#G_TYPE_UINT): how many of those came from the cache
+ * - "coalesced" (#G_TYPE_UINT): the number of requested positions that
+ *   were skipped because a later one was requested before seeking to them
+ * - "last-latency", "average-latency" and "max-latency"
+ *   (#G_TYPE_UINT64): time between a position being requested and its
+ *   frame being delivered, in nanoseconds
+ *
+ * Returns: (transfer full): The scrubbing statistics
+ */
+GstStructure *
+ges_pipeline_get_scrub_stats (GESPipeline * pipeline)
+{
+  GstStructure *stats;
+  GESPipelinePrivate *priv;
+
+  g_return_val_if_fail (GES_IS_PIPELINE (pipeline), NULL);
+
+  priv = pipeline->priv;
+
+  g_mutex_lock (&priv->scrub_lock);
+  stats = gst_structure_new ("ges-scrub-stats",
+      "steps", G_TYPE_UINT, priv->scrub_steps,
+      "cache-hits", G_TYPE_UINT, priv->scrub_hits,
+      "coalesced", G_TYPE_UINT, priv->scrub_coalesced,
+      "last-latency", G_TYPE_UINT64, priv->scrub_last_latency,
+      "average-latency", G_TYPE_UINT64, priv->scrub_steps ?
+      priv->scrub_total_latency / priv->scrub_steps : 0,
+      "max-latency", G_TYPE_UINT64, priv->scrub_max_latency, NULL);
+  g_mutex_unlock (&priv->scrub_lock);
+
+  return stats;
+}
+
+/**
+ * ges_pipeline_get_stats:
+ * @pipeline: a #GESPipeline
+ *
+ * Gets statistics about the ongoing playback or render of @pipeline, as
+ * a #GstStructure named "ges-render-stats". The same structure is posted
+ * as an element message on the bus every #GESPipeline:stats-interval.
+ * All times are in nanoseconds:
+ *
+ * - "elapsed" (#G_TYPE_UINT64): wall clock time since the first buffer
+ *   left the timeline
+ * - "position" and "duration" (#G_TYPE_UINT64): how far the slowest track
+ *   got, and the duration of the timeline
+ * - "progress" (#G_TYPE_DOUBLE): position / duration, between 0 and 1
+ * - "speed" (#G_TYPE_DOUBLE): position / elapsed, above 1 when going
+ *   faster than realtime
+ * - "eta" (#G_TYPE_UINT64): estimated time until the end is reached,
+ *   #GST_CLOCK_TIME_NONE when unknown
+ * - "composite-time", "convert-time", "encode-time" and "mux-time"
+ *   (#G_TYPE_UINT64): time spent in each stage, see below
+ * - "tracks" (#GST_TYPE_ARRAY): a "ges-track-stats" #GstStructure per
+ *   track with "track-type" (#GES_TYPE_TRACK_TYPE), "frames" (#G_TYPE_UINT64),
+ *   "fps" (#G_TYPE_DOUBLE), "position", "composite-time", "blocked-time"
+ *   (#G_TYPE_UINT64) and "queue-level" (#G_TYPE_DOUBLE): how full the
+ *   encoder input queue of the track is in percent, -1 when not rendering
+ * - "stages" (#GST_TYPE_ARRAY): a "ges-stage-stats" #GstStructure per
+ *   converter, encoder and muxer plugged when rendering, with "stage"
+ *   (#G_TYPE_STRING, "convert", "encode" or "mux"), "element"
+ *   (#G_TYPE_STRING), "buffers" and "processing-time" (#G_TYPE_UINT64)
+ *
+ * Decoding, conforming and mixing all happen in the streaming thread of
+ * a track, they are accounted together as "composite-time": the time between
+ * two buffers leaving the track, minus the "blocked-time" spent waiting on
+ * a full encoder queue. A high "blocked-time" or "queue-level" means the
+ * encoding side is the bottleneck. The processing time of the stages is
+ * measured between buffers entering and leaving each element.
+ *
+ * Returns: (transfer full): The render statistics
+ */
+GstStructure *
+ges_pipeline_get_stats (GESPipeline * pipeline)
+{
+  g_return_val_if_fail (GES_IS_PIPELINE (pipeline), NULL);
+
+  return _stats_collect (pipeline);
+}
@@ -90,6 +90,10 @@ gboolean ges_pipeline_set_mode (GESPipeline *pipeline,
 
 GESPipelineFlags ges_pipeline_get_mode (GESPipeline *pipeline);
 
+gboolean ges_pipeline_render_incremental (GESPipeline *pipeline,
+                                          GstClockTime segment_duration,
+                                          GError **error);
+
 GstSample *
 ges_pipeline_get_thumbnail(GESPipeline *self, GstCaps *caps);
 
@@ -102,6 +106,18 @@ ges_pipeline_save_thumbnail(GESPipeline *self,
     int width, int height, const gchar *format, const gchar *location,
     GError **error);
 
+gboolean
+ges_pipeline_scrub_to (GESPipeline *pipeline, GstClockTime position);
+
+gboolean
+ges_pipeline_scrub_step (GESPipeline *pipeline, gint n_frames);
+
+GstStructure *
+ges_pipeline_get_scrub_stats (GESPipeline *pipeline);
+
+GstStructure *
+ges_pipeline_get_stats (GESPipeline *pipeline);
+
 GstElement *
 ges_pipeline_preview_get_video_sink (GESPipeline * self);
 
@@ -64,6 +64,8 @@ struct _GESProjectPrivate
   gchar *uri;
 
   GList *encoding_profiles;
+
+  gboolean lazy_loading;
 };
 
 typedef struct EmitLoadedInIdle
@@ -90,6 +92,7 @@ enum
 {
   PROP_0,
   PROP_URI,
+  PROP_LAZY_LOADING,
   PROP_LAST,
 };
 
@@ -287,6 +290,9 @@ _get_property (GESProject * project, guint property_id,
     case PROP_URI:
       g_value_set_string (value, priv->uri);
       break;
+    case PROP_LAZY_LOADING:
+      g_value_set_boolean (value, priv->lazy_loading);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (project, property_id, pspec);
   }
@@ -300,6 +306,9 @@ _set_property (GESProject * project, guint property_id,
     case PROP_URI:
       project->priv->uri = g_value_dup_string (value);
       break;
+    case PROP_LAZY_LOADING:
+      ges_project_set_lazy_loading (project, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (project, property_id, pspec);
   }
@@ -327,6 +336,18 @@ ges_project_class_init (GESProjectClass * klass)
   _properties[PROP_URI] = g_param_spec_string ("uri", "URI",
       "uri of the project", NULL, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
 
+  /**
+   * GESProject:lazy-loading:
+   *
+   * Whether the clips of the timelines extracted from the project are only
+   * created once they are needed, see ges_timeline_load_range(). The
+   * layers and tracks are always created. This only has an effect on the
+   * timelines extracted after it has been set.
+   */
+  _properties[PROP_LAZY_LOADING] = g_param_spec_boolean ("lazy-loading",
+      "Lazy loading", "Only create the clips once they are needed", FALSE,
+      G_PARAM_READWRITE);
+
   g_object_class_install_properties (object_class, PROP_LAST, _properties);
 
   /**
@@ -428,6 +449,7 @@ ges_project_init (GESProject * project)
   priv->formatters = NULL;
   priv->formatter_asset = NULL;
   priv->encoding_profiles = NULL;
+  priv->lazy_loading = FALSE;
   priv->assets = g_hash_table_new_full (g_str_hash, g_str_equal,
       g_free, gst_object_unref);
   priv->loading_assets = g_hash_table_new_full (g_str_hash, g_str_equal,
@@ -760,6 +782,9 @@ ges_project_save (GESProject * project, GESTimeline * timeline,
     goto out;
   }
 
+  /* The clips that have not been loaded would be lost otherwise */
+  timeline_load_range (timeline, NULL, 0, GST_CLOCK_TIME_NONE);
+
   if (formatter_asset == NULL)
     formatter_asset = gst_object_ref (ges_formatter_get_default ());
 
@@ -950,3 +975,40 @@ ges_project_get_loading_assets (GESProject * project)
 
   return ret;
 }
+
+/**
+ * ges_project_set_lazy_loading:
+ * @project: A #GESProject
+ * @lazy: Whether to load the clips lazily
+ *
+ * Sets #GESProject:lazy-loading, which has to be done before extracting
+ * a timeline from @project, for example to quickly open a big project and
+ * only render a range of it.
+ */
+void
+ges_project_set_lazy_loading (GESProject * project, gboolean lazy)
+{
+  g_return_if_fail (GES_IS_PROJECT (project));
+
+  if (project->priv->lazy_loading == lazy)
+    return;
+
+  project->priv->lazy_loading = lazy;
+  g_object_notify_by_pspec (G_OBJECT (project),
+      _properties[PROP_LAZY_LOADING]);
+}
+
+/**
+ * ges_project_get_lazy_loading:
+ * @project: A #GESProject
+ *
+ * Returns: Whether the clips of the timelines extracted from @project are
+ * loaded lazily, see #GESProject:lazy-loading
+ */
+gboolean
+ges_project_get_lazy_loading (GESProject * project)
+{
+  g_return_val_if_fail (GES_IS_PROJECT (project), FALSE);
+
+  return project->priv->lazy_loading;
+}
@@ -102,6 +102,10 @@ gboolean ges_project_add_encoding_profile       (GESProject *project,
                                                  GstEncodingProfile *profile);
 const GList *ges_project_list_encoding_profiles (GESProject *project);
 
+void ges_project_set_lazy_loading               (GESProject *project,
+                                                 gboolean lazy);
+gboolean ges_project_get_lazy_loading           (GESProject *project);
+
 G_END_DECLS
 
 #endif  /* _GES_PROJECT */
@@ -0,0 +1,911 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Render cache for timeline regions that can not be played in realtime.
+ *
+ * The user marks regions of a #GESTimeline, each time the timeline is commited
+ * we:
+ *   1- Extend each region so that no clip crosses its boundaries, that way
+ *      all the clips contributing to the region are fully contained in it.
+ *   2- Compute a key hashing everything that contributes to the region output
+ *      (tracks, clips, track elements, their children properties and
+ *      control bindings)
+ *   3- If a file for that key exists in the cache directory, we deactivate
+ *      the GnlObject-s of the region and replace them with one gnlsource
+ *      per track playing the cached file. Otherwise we copy the region into
+ *      a new timeline and render it in a background thread.
+ *
+ * As soon as anything in a region changes its key changes, and the original
+ * GnlObject-s are reactivated until a new cache file is available.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#include <string.h>
+#include <glib/gstdio.h>
+#include <gst/pbutils/encoding-profile.h>
+#include <gst/controller/gsttimedvaluecontrolsource.h>
+#include <gst/controller/gstinterpolationcontrolsource.h>
+
+#include "ges-internal.h"
+#include "ges-layer.h"
+#include "ges-clip.h"
+#include "ges-container.h"
+#include "ges-track.h"
+#include "ges-video-track.h"
+#include "ges-audio-track.h"
+#include "ges-pipeline.h"
+#include "ges-transition-clip.h"
+
+#define CACHE_FILE_SUFFIX ".mkv"
+#define PARTIAL_FILE_SUFFIX ".part"
+
+typedef struct
+{
+  GESTrack *track;
+  GstElement *source;
+} CacheSource;
+
+typedef struct
+{
+  /* As requested by the user */
+  GstClockTime start;
+  GstClockTime duration;
+
+  /* Extended so no clip crosses them */
+  GstClockTime cstart;
+  GstClockTime cend;
+
+  gchar *key;
+  gboolean substituted;
+
+  GList *disabled;              /* GESTrackElement-s we deactivated in GNL */
+  GList *sources;               /* CacheSource-s replacing them */
+} Region;
+
+typedef struct
+{
+  GESRenderCache *cache;
+
+  GESTimeline *timeline;        /* The copy to render, owned */
+  GstClockTime start;
+  GstClockTime stop;
+  gchar *key;
+  gchar *location;
+
+  gboolean success;
+} RenderJob;
+
+struct _GESRenderCache
+{
+  volatile gint refcount;
+  volatile gint cancelled;
+
+  /* NULL once the timeline has been disposed */
+  GESTimeline *timeline;
+
+  gchar *directory;
+  guint64 max_size;
+
+  GList *regions;               /* Region-s sorted by start */
+
+  GHashTable *pending;          /* {key: NULL} being rendered */
+  GHashTable *failed;           /* {key: NULL} which failed to render */
+};
+
+static GThreadPool *render_pool = NULL;
+
+static GESRenderCache *
+ges_render_cache_ref (GESRenderCache * cache)
+{
+  g_atomic_int_inc (&cache->refcount);
+
+  return cache;
+}
+
+static void
+ges_render_cache_unref (GESRenderCache * cache)
+{
+  if (!g_atomic_int_dec_and_test (&cache->refcount))
+    return;
+
+  g_free (cache->directory);
+  g_hash_table_unref (cache->pending);
+  g_hash_table_unref (cache->failed);
+  g_slice_free (GESRenderCache, cache);
+}
+
+static gchar *
+_location_for_key (GESRenderCache * cache, const gchar * key)
+{
+  gchar *filename, *location;
+
+  filename = g_strconcat (key, CACHE_FILE_SUFFIX, NULL);
+  location = g_build_filename (cache->directory, filename, NULL);
+  g_free (filename);
+
+  return location;
+}
+
+/************************************************
+ *                                              *
+ *          Region bounds and hashing           *
+ *                                              *
+ ************************************************/
+static inline gboolean
+_clip_in_bounds (GESClip * clip, GstClockTime start, GstClockTime end)
+{
+  return _START (clip) < end && _END (clip) > start;
+}
+
+/* Returns %FALSE if no clip contributes to the region */
+static gboolean
+_region_update_bounds (GESTimeline * timeline, Region * region)
+{
+  GList *tmp, *clips, *ctmp;
+  gboolean changed, has_content = FALSE;
+
+  region->cstart = region->start;
+  region->cend = region->start + region->duration;
+
+  do {
+    changed = FALSE;
+
+    /* Only create the clips the region can depend on */
+    timeline_load_range (timeline, NULL, region->cstart, region->cend);
+    for (tmp = timeline->layers; tmp; tmp = tmp->next) {
+      clips = _ges_layer_get_loaded_clips (tmp->data);
+
+      for (ctmp = clips; ctmp; ctmp = ctmp->next) {
+        GESClip *clip = ctmp->data;
+
+        if (!_clip_in_bounds (clip, region->cstart, region->cend))
+          continue;
+
+        has_content = TRUE;
+        if (_START (clip) < region->cstart) {
+          region->cstart = _START (clip);
+          changed = TRUE;
+        }
+
+        if (_END (clip) > region->cend) {
+          region->cend = _END (clip);
+          changed = TRUE;
+        }
+      }
+
+      g_list_free_full (clips, gst_object_unref);
+    }
+  } while (changed);
+
+  return has_content;
+}
+
+static gchar *
+_region_compute_key (GESTimeline * timeline, Region * region)
+{
+  return g_strdup_printf ("%016" G_GINT64_MODIFIER "x",
+      _ges_timeline_get_range_hash (timeline, region->cstart, region->cend));
+}
+
+/************************************************
+ *                                              *
+ *           Cached segment substitution        *
+ *                                              *
+ ************************************************/
+static void
+_region_restore (Region * region)
+{
+  GList *tmp;
+
+  for (tmp = region->disabled; tmp; tmp = tmp->next) {
+    GESTrackElement *trackelement = tmp->data;
+    GstElement *gnlobject = ges_track_element_get_gnlobject (trackelement);
+
+    if (gnlobject)
+      g_object_set (gnlobject, "active",
+          ges_track_element_is_active (trackelement), NULL);
+  }
+  g_list_free_full (region->disabled, gst_object_unref);
+  region->disabled = NULL;
+
+  for (tmp = region->sources; tmp; tmp = tmp->next) {
+    CacheSource *csource = tmp->data;
+
+    ges_track_remove_cache_source (csource->track, csource->source);
+    gst_object_unref (csource->track);
+    g_slice_free (CacheSource, csource);
+  }
+  g_list_free (region->sources);
+  region->sources = NULL;
+
+  region->substituted = FALSE;
+}
+
+static void
+_region_substitute (GESTimeline * timeline, Region * region,
+    const gchar * location)
+{
+  gchar *uri;
+  GList *tmp, *elements, *etmp;
+
+  uri = gst_filename_to_uri (location, NULL);
+  GST_INFO_OBJECT (timeline, "Using %s for [%" GST_TIME_FORMAT " - %"
+      GST_TIME_FORMAT "]", uri, GST_TIME_ARGS (region->cstart),
+      GST_TIME_ARGS (region->cend));
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
+    GESTrack *track = tmp->data;
+    CacheSource *csource;
+    GstElement *source;
+
+    elements = ges_track_get_elements (track);
+    for (etmp = elements; etmp; etmp = etmp->next) {
+      GESTrackElement *trackelement = etmp->data;
+      GstElement *gnlobject = ges_track_element_get_gnlobject (trackelement);
+
+      if (gnlobject == NULL || _START (trackelement) >= region->cend ||
+          _END (trackelement) <= region->cstart)
+        continue;
+
+      /* We do not touch GESTrackElement:active so users still get the
+       * value they set */
+      g_object_set (gnlobject, "active", FALSE, NULL);
+      region->disabled = g_list_prepend (region->disabled,
+          gst_object_ref (trackelement));
+    }
+    g_list_free_full (elements, gst_object_unref);
+
+    source = ges_track_add_cache_source (track, uri, region->cstart,
+        region->cend - region->cstart);
+    if (source == NULL)
+      continue;
+
+    csource = g_slice_new (CacheSource);
+    csource->track = gst_object_ref (track);
+    csource->source = source;
+    region->sources = g_list_prepend (region->sources, csource);
+  }
+
+  /* Keep the most recently used files last when trimming the cache */
+  g_utime (location, NULL);
+
+  region->substituted = TRUE;
+  g_free (uri);
+}
+
+static void
+_region_free (Region * region)
+{
+  _region_restore (region);
+  g_free (region->key);
+  g_slice_free (Region, region);
+}
+
+/************************************************
+ *                                              *
+ *               Background rendering           *
+ *                                              *
+ ************************************************/
+static void
+_copy_bindings (GESTrackElement * trackelement, GESTrackElement * copy)
+{
+  guint n, n_specs;
+  GParamSpec **specs;
+
+  specs = ges_track_element_list_children_properties (trackelement, &n_specs);
+  for (n = 0; n < n_specs; n++) {
+    GList *values, *tmp;
+    GstControlSource *source;
+    GstTimedValueControlSource *new_source;
+    GstInterpolationMode mode;
+    GstControlBinding *binding =
+        ges_track_element_get_control_binding (trackelement, specs[n]->name);
+
+    if (binding == NULL)
+      goto next;
+
+    g_object_get (binding, "control-source", &source, NULL);
+    if (!GST_IS_INTERPOLATION_CONTROL_SOURCE (source)) {
+      gst_object_unref (source);
+      goto next;
+    }
+
+    new_source =
+        GST_TIMED_VALUE_CONTROL_SOURCE (gst_interpolation_control_source_new
+        ());
+    g_object_get (source, "mode", &mode, NULL);
+    g_object_set (new_source, "mode", mode, NULL);
+
+    values = gst_timed_value_control_source_get_all
+        (GST_TIMED_VALUE_CONTROL_SOURCE (source));
+    for (tmp = values; tmp; tmp = tmp->next) {
+      GstTimedValue *value = tmp->data;
+
+      gst_timed_value_control_source_set (new_source, value->timestamp,
+          value->value);
+    }
+    g_list_free (values);
+
+    ges_track_element_set_control_source (copy,
+        GST_CONTROL_SOURCE (new_source), specs[n]->name, "direct");
+    gst_object_unref (source);
+
+  next:
+    g_param_spec_unref (specs[n]);
+  }
+  g_free (specs);
+}
+
+static void
+_copy_clip (GESClip * clip, GESLayer * layer)
+{
+  GList *tmp;
+  GESClip *copy;
+
+  copy = GES_CLIP (ges_timeline_element_copy (GES_TIMELINE_ELEMENT (clip),
+          FALSE));
+
+  /* Same as in ges_clip_split, we add the children ourself */
+  ges_clip_set_moving_from_layer (copy, TRUE);
+  ges_layer_add_clip (layer, copy);
+  ges_clip_set_moving_from_layer (copy, FALSE);
+
+  for (tmp = GES_CONTAINER_CHILDREN (clip); tmp; tmp = tmp->next) {
+    GESTrackElement *trackelement = tmp->data, *child_copy;
+
+    child_copy = GES_TRACK_ELEMENT (ges_timeline_element_copy
+        (GES_TIMELINE_ELEMENT (trackelement), FALSE));
+    if (child_copy == NULL) {
+      GST_WARNING_OBJECT (trackelement, "Could not create a copy");
+      continue;
+    }
+
+    if (!ges_container_add (GES_CONTAINER (copy),
+            GES_TIMELINE_ELEMENT (child_copy)))
+      continue;
+
+    ges_track_element_copy_properties (GES_TIMELINE_ELEMENT (trackelement),
+        GES_TIMELINE_ELEMENT (child_copy));
+    _copy_bindings (trackelement, child_copy);
+  }
+}
+
+static GESTrack *
+_copy_track (GESTrack * track)
+{
+  GESTrack *copy;
+  GstCaps *restriction = NULL;
+
+  if (GES_IS_VIDEO_TRACK (track))
+    copy = GES_TRACK (ges_video_track_new ());
+  else if (GES_IS_AUDIO_TRACK (track))
+    copy = GES_TRACK (ges_audio_track_new ());
+  else
+    copy = ges_track_new (track->type,
+        gst_caps_copy (ges_track_get_caps (track)));
+
+  g_object_get (track, "restriction-caps", &restriction, NULL);
+  if (restriction) {
+    ges_track_set_restriction_caps (copy, restriction);
+    gst_caps_unref (restriction);
+  }
+
+  return copy;
+}
+
+/* Copies all the clips of @timeline overlapping [@start - @stop] into a new
+ * timeline */
+GESTimeline *
+_ges_timeline_copy_range (GESTimeline * timeline, GstClockTime start,
+    GstClockTime stop)
+{
+  GList *tmp, *clips, *ctmp;
+  GESTimeline *copy = ges_timeline_new ();
+
+  timeline_load_range (timeline, NULL, start, stop);
+  ges_timeline_set_auto_transition (copy,
+      ges_timeline_get_auto_transition (timeline));
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next)
+    ges_timeline_add_track (copy, _copy_track (tmp->data));
+
+  for (tmp = timeline->layers; tmp; tmp = tmp->next) {
+    GESLayer *layer = tmp->data, *layer_copy = ges_layer_new ();
+    gboolean auto_transition = ges_layer_get_auto_transition (layer);
+
+    ges_layer_set_priority (layer_copy, ges_layer_get_priority (layer));
+    ges_layer_set_auto_transition (layer_copy, auto_transition);
+    ges_timeline_add_layer (copy, layer_copy);
+
+    clips = _ges_layer_get_loaded_clips (layer);
+    for (ctmp = clips; ctmp; ctmp = ctmp->next) {
+      if (!_clip_in_bounds (ctmp->data, start, stop))
+        continue;
+
+      /* Those will be recreated in the copy */
+      if (auto_transition && GES_IS_TRANSITION_CLIP (ctmp->data))
+        continue;
+
+      _copy_clip (ctmp->data, layer_copy);
+    }
+    g_list_free_full (clips, gst_object_unref);
+  }
+
+  ges_timeline_commit (copy);
+
+  return copy;
+}
+
+static GstEncodingProfile *
+_create_encoding_profile (GESTimeline * timeline)
+{
+  GList *tmp;
+  GstCaps *caps;
+  GstEncodingContainerProfile *container;
+
+  caps = gst_caps_from_string ("video/x-matroska");
+  container = gst_encoding_container_profile_new ("ges-render-cache",
+      NULL, caps, NULL);
+  gst_caps_unref (caps);
+
+  /* We want intra only and cheap to decode intermediate files */
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
+    GESTrack *track = tmp->data;
+    GstCaps *restriction = NULL;
+    GstEncodingProfile *profile = NULL;
+
+    g_object_get (track, "restriction-caps", &restriction, NULL);
+    if (track->type == GES_TRACK_TYPE_VIDEO) {
+      caps = gst_caps_from_string ("image/jpeg");
+      profile = GST_ENCODING_PROFILE (gst_encoding_video_profile_new (caps,
+              NULL, restriction, 0));
+      gst_caps_unref (caps);
+    } else if (track->type == GES_TRACK_TYPE_AUDIO) {
+      caps = gst_caps_from_string ("audio/x-flac");
+      profile = GST_ENCODING_PROFILE (gst_encoding_audio_profile_new (caps,
+              NULL, restriction, 0));
+      gst_caps_unref (caps);
+    }
+
+    if (restriction)
+      gst_caps_unref (restriction);
+
+    if (profile)
+      gst_encoding_container_profile_add_profile (container, profile);
+  }
+
+  return GST_ENCODING_PROFILE (container);
+}
+
+static void
+_render_job_free (RenderJob * job)
+{
+  if (job->timeline)
+    gst_object_unref (job->timeline);
+
+  ges_render_cache_unref (job->cache);
+  g_free (job->key);
+  g_free (job->location);
+  g_slice_free (RenderJob, job);
+}
+
+
+typedef struct
+{
+  gchar *location;
+  guint64 size;
+  time_t mtime;
+} CacheFile;
+
+static void
+_cache_file_free (CacheFile * file)
+{
+  g_free (file->location);
+  g_slice_free (CacheFile, file);
+}
+
+static gint
+_compare_mtime (CacheFile * a, CacheFile * b)
+{
+  if (a->mtime < b->mtime)
+    return -1;
+  if (a->mtime > b->mtime)
+    return 1;
+
+  return 0;
+}
+
+static gboolean
+_location_in_use (GESRenderCache * cache, const gchar * location)
+{
+  GList *tmp;
+  gboolean in_use = FALSE;
+
+  for (tmp = cache->regions; tmp && !in_use; tmp = tmp->next) {
+    Region *region = tmp->data;
+    gchar *rlocation;
+
+    if (!region->substituted)
+      continue;
+
+    rlocation = _location_for_key (cache, region->key);
+    in_use = !g_strcmp0 (location, rlocation);
+    g_free (rlocation);
+  }
+
+  return in_use;
+}
+
+/* Removes least recently used files until we fit in cache->max_size */
+static void
+_enforce_max_size (GESRenderCache * cache)
+{
+  GDir *dir;
+  GList *files = NULL, *tmp;
+  guint64 total = 0;
+  const gchar *name;
+
+  if (cache->max_size == 0)
+    return;
+
+  if (!(dir = g_dir_open (cache->directory, 0, NULL)))
+    return;
+
+  while ((name = g_dir_read_name (dir))) {
+    GStatBuf st;
+    CacheFile *file;
+    gchar *location;
+
+    if (!g_str_has_suffix (name, CACHE_FILE_SUFFIX))
+      continue;
+
+    location = g_build_filename (cache->directory, name, NULL);
+    if (g_stat (location, &st) != 0) {
+      g_free (location);
+      continue;
+    }
+
+    file = g_slice_new (CacheFile);
+    file->location = location;
+    file->size = st.st_size;
+    file->mtime = st.st_mtime;
+    files = g_list_prepend (files, file);
+    total += file->size;
+  }
+  g_dir_close (dir);
+
+  files = g_list_sort (files, (GCompareFunc) _compare_mtime);
+  for (tmp = files; tmp && total > cache->max_size; tmp = tmp->next) {
+    CacheFile *file = tmp->data;
+
+    if (_location_in_use (cache, file->location))
+      continue;
+
+    GST_INFO ("Removing %s from the render cache", file->location);
+    if (g_unlink (file->location) == 0)
+      total -= file->size;
+  }
+
+  g_list_free_full (files, (GDestroyNotify) _cache_file_free);
+}
+
+/* Called from the main context once a job is over */
+static gboolean
+_render_job_done (RenderJob * job)
+{
+  GList *tmp;
+  gboolean needs_commit = FALSE;
+  GESRenderCache *cache = job->cache;
+
+  g_hash_table_remove (cache->pending, job->key);
+
+  if (cache->timeline == NULL)
+    goto done;
+
+  if (!job->success) {
+    g_hash_table_insert (cache->failed, g_strdup (job->key), NULL);
+    goto done;
+  }
+
+  _enforce_max_size (cache);
+
+  for (tmp = cache->regions; tmp; tmp = tmp->next) {
+    Region *region = tmp->data;
+
+    if (!region->substituted && !g_strcmp0 (region->key, job->key))
+      needs_commit = TRUE;
+  }
+
+  /* The substitution happens while commiting */
+  if (needs_commit)
+    ges_timeline_commit (cache->timeline);
+
+done:
+  _render_job_free (job);
+
+  return FALSE;
+}
+
+static void
+_render_job_func (RenderJob * job, gpointer unused)
+{
+  gchar *partial, *uri;
+  GESPipeline *pipeline;
+  GstEncodingProfile *profile;
+
+  if (g_atomic_int_get (&job->cache->cancelled))
+    goto done;
+
+  partial = g_strconcat (job->location, PARTIAL_FILE_SUFFIX, NULL);
+  uri = gst_filename_to_uri (partial, NULL);
+
+  profile = _create_encoding_profile (job->timeline);
+  pipeline = ges_pipeline_new ();
+  /* The pipeline takes its own reference */
+  if (!ges_pipeline_set_timeline (pipeline, job->timeline) ||
+      !ges_pipeline_set_render_settings (pipeline, uri, profile) ||
+      !ges_pipeline_set_mode (pipeline, GES_PIPELINE_MODE_RENDER)) {
+    GST_WARNING ("Could not setup rendering of %s", job->location);
+    goto cleanup;
+  }
+
+  GST_INFO ("Rendering [%" GST_TIME_FORMAT " - %" GST_TIME_FORMAT "] to %s",
+      GST_TIME_ARGS (job->start), GST_TIME_ARGS (job->stop), job->location);
+
+  job->success = _ges_pipeline_render_range (pipeline, job->start, job->stop,
+      &job->cache->cancelled);
+
+cleanup:
+  gst_object_unref (pipeline);
+  gst_encoding_profile_unref (profile);
+
+  if (job->success && g_rename (partial, job->location) != 0) {
+    GST_WARNING ("Could not move %s to %s", partial, job->location);
+    job->success = FALSE;
+  }
+
+  if (!job->success)
+    g_unlink (partial);
+
+  g_free (partial);
+  g_free (uri);
+
+done:
+  g_idle_add ((GSourceFunc) _render_job_done, job);
+}
+
+static void
+_region_render (GESRenderCache * cache, Region * region)
+{
+  RenderJob *job;
+  GError *err = NULL;
+
+  if (render_pool == NULL) {
+    render_pool = g_thread_pool_new ((GFunc) _render_job_func, NULL, 1,
+        FALSE, &err);
+
+    if (render_pool == NULL) {
+      GST_ERROR ("Could not create render thread: %s", err->message);
+      g_error_free (err);
+
+      return;
+    }
+  }
+
+  if (g_mkdir_with_parents (cache->directory, 0755) != 0) {
+    GST_WARNING ("Could not create render cache directory %s",
+        cache->directory);
+
+    return;
+  }
+
+  job = g_slice_new0 (RenderJob);
+  job->cache = ges_render_cache_ref (cache);
+  job->timeline = gst_object_ref_sink (_ges_timeline_copy_range
+      (cache->timeline, region->cstart, region->cend));
+  job->start = region->cstart;
+  job->stop = region->cend;
+  job->key = g_strdup (region->key);
+  job->location = _location_for_key (cache, region->key);
+
+  g_hash_table_insert (cache->pending, g_strdup (region->key), NULL);
+  g_thread_pool_push (render_pool, job, NULL);
+}
+
+/************************************************
+ *                                              *
+ *                  Internal API                *
+ *                                              *
+ ************************************************/
+GESRenderCache *
+ges_render_cache_new (GESTimeline * timeline)
+{
+  GESRenderCache *cache = g_slice_new0 (GESRenderCache);
+
+  cache->refcount = 1;
+  cache->timeline = timeline;
+  cache->directory = g_build_filename (g_get_user_cache_dir (),
+      "gstreamer-editing-services", "render-cache", NULL);
+  cache->max_size = DEFAULT_RENDER_CACHE_MAX_SIZE;
+  cache->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      NULL);
+  cache->failed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      NULL);
+
+  return cache;
+}
+
+void
+ges_render_cache_free (GESRenderCache * cache)
+{
+  g_atomic_int_set (&cache->cancelled, 1);
+
+  g_list_free_full (cache->regions, (GDestroyNotify) _region_free);
+  cache->regions = NULL;
+  cache->timeline = NULL;
+
+  ges_render_cache_unref (cache);
+}
+
+const gchar *
+ges_render_cache_get_directory (GESRenderCache * cache)
+{
+  return cache->directory;
+}
+
+void
+ges_render_cache_set_directory (GESRenderCache * cache, const gchar * directory)
+{
+  GList *tmp;
+
+  g_free (cache->directory);
+  cache->directory = g_strdup (directory);
+
+  /* Force looking for the files in the new directory on next commit */
+  for (tmp = cache->regions; tmp; tmp = tmp->next) {
+    Region *region = tmp->data;
+
+    _region_restore (region);
+    g_free (region->key);
+    region->key = NULL;
+  }
+  g_hash_table_remove_all (cache->failed);
+}
+
+guint64
+ges_render_cache_get_max_size (GESRenderCache * cache)
+{
+  return cache->max_size;
+}
+
+void
+ges_render_cache_set_max_size (GESRenderCache * cache, guint64 max_size)
+{
+  cache->max_size = max_size;
+
+  _enforce_max_size (cache);
+}
+
+static gint
+_compare_region (Region * a, Region * b)
+{
+  if (a->start < b->start)
+    return -1;
+  if (a->start > b->start)
+    return 1;
+
+  return 0;
+}
+
+gboolean
+ges_render_cache_add_region (GESRenderCache * cache, GstClockTime start,
+    GstClockTime duration)
+{
+  GList *tmp;
+  Region *region;
+
+  for (tmp = cache->regions; tmp; tmp = tmp->next) {
+    region = tmp->data;
+
+    if (start < region->start + region->duration &&
+        start + duration > region->start) {
+      GST_INFO ("Region [%" GST_TIME_FORMAT " - %" GST_TIME_FORMAT
+          "] overlaps an existing one", GST_TIME_ARGS (start),
+          GST_TIME_ARGS (start + duration));
+
+      return FALSE;
+    }
+  }
+
+  region = g_slice_new0 (Region);
+  region->start = start;
+  region->duration = duration;
+  cache->regions = g_list_insert_sorted (cache->regions, region,
+      (GCompareFunc) _compare_region);
+
+  return TRUE;
+}
+
+gboolean
+ges_render_cache_remove_region (GESRenderCache * cache, GstClockTime start,
+    GstClockTime duration)
+{
+  GList *tmp;
+
+  for (tmp = cache->regions; tmp; tmp = tmp->next) {
+    Region *region = tmp->data;
+
+    if (region->start == start && region->duration == duration) {
+      cache->regions = g_list_delete_link (cache->regions, tmp);
+      _region_free (region);
+
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/* Must be called right before the tracks are commited */
+void
+ges_render_cache_update (GESRenderCache * cache)
+{
+  GList *tmp;
+  GstClockTime last_end = 0;
+
+  for (tmp = cache->regions; tmp; tmp = tmp->next) {
+    gchar *key = NULL, *location;
+    Region *region = tmp->data;
+
+    if (_region_update_bounds (cache->timeline, region) &&
+        region->cstart >= last_end) {
+      key = _region_compute_key (cache->timeline, region);
+      last_end = region->cend;
+    } else {
+      GST_DEBUG ("Nothing to cache for region [%" GST_TIME_FORMAT " - %"
+          GST_TIME_FORMAT "]", GST_TIME_ARGS (region->start),
+          GST_TIME_ARGS (region->start + region->duration));
+    }
+
+    if (g_strcmp0 (key, region->key)) {
+      GST_DEBUG ("Region [%" GST_TIME_FORMAT " - %" GST_TIME_FORMAT
+          "] changed, new key: %s", GST_TIME_ARGS (region->cstart),
+          GST_TIME_ARGS (region->cend), key);
+
+      _region_restore (region);
+      g_free (region->key);
+      region->key = key;
+    } else {
+      g_free (key);
+    }
+
+    if (region->key == NULL || region->substituted)
+      continue;
+
+    location = _location_for_key (cache, region->key);
+    if (g_file_test (location, G_FILE_TEST_IS_REGULAR))
+      _region_substitute (cache->timeline, region, location);
+    else if (!g_hash_table_contains (cache->pending, region->key) &&
+        !g_hash_table_contains (cache->failed, region->key))
+      _region_render (cache, region);
+    g_free (location);
+  }
+}
@@ -0,0 +1,390 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Frame and keyframe timestamps of video streams.
+ *
+ * The stream is demuxed and parsed but never decoded: uridecodebin is told
+ * to expose the parsed stream instead of plugging a decoder, and the
+ * timestamps of all the frames are collected along with the ones of the
+ * frames not flagged as delta units.
+ *
+ * The index is a single block of memory, which is exactly what is saved in
+ * the user cache directory and mapped from there:
+ *
+ *   IndexHeader | guint64 frames[n_frames] | guint64 keyframes[n_keyframes]
+ *
+ * Both arrays are sorted by presentation timestamp.
+ *
+ * NOTE: This is for internal use exclusively
+ */
+
+#include <string.h>
+
+#include "ges-internal.h"
+
+/* "GESI" in native endianness */
+#define INDEX_MAGIC 0x47455349
+#define INDEX_VERSION 1
+
+/* Demuxing is mostly IO bound */
+#define MAX_INDEX_THREADS 1
+
+/* From GstAutoplugSelectResult in the playback plugin */
+#define AUTOPLUG_SELECT_TRY 0
+#define AUTOPLUG_SELECT_EXPOSE 1
+
+typedef struct
+{
+  guint32 magic;
+  guint32 version;
+  guint32 n_frames;
+  guint32 n_keyframes;
+} IndexHeader;
+
+typedef struct
+{
+  gchar *uri;
+  gchar *stream_id;
+
+  GESSeekIndexReadyFunc func;
+  gpointer user_data;
+  GDestroyNotify notify;
+
+  GBytes *index;
+} IndexJob;
+
+typedef struct
+{
+  const gchar *stream_id;
+  gboolean linked;
+
+  GArray *frames;
+  GArray *keyframes;
+
+  /* Increased for each parsed buffer */
+  volatile gint progress;
+} IndexBuilder;
+
+static GThreadPool *index_pool = NULL;
+
+static void
+_handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    IndexBuilder * builder)
+{
+  GstClockTime ts = GST_BUFFER_PTS (buffer);
+
+  g_atomic_int_inc (&builder->progress);
+
+  /* Some parsers only know the decoding timestamp of keyframes */
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    ts = GST_BUFFER_DTS (buffer);
+
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    return;
+
+  g_array_append_val (builder->frames, ts);
+  if (!GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT))
+    g_array_append_val (builder->keyframes, ts);
+}
+
+static gint
+_autoplug_select_cb (GstElement * decodebin, GstPad * pad, GstCaps * caps,
+    GstElementFactory * factory, gpointer unused)
+{
+  const gchar *klass = gst_element_factory_get_metadata (factory,
+      GST_ELEMENT_METADATA_KLASS);
+
+  /* We only need the parsed stream */
+  if (klass && strstr (klass, "Decoder"))
+    return AUTOPLUG_SELECT_EXPOSE;
+
+  return AUTOPLUG_SELECT_TRY;
+}
+
+static void
+_decoder_pad_added_cb (GstElement * decodebin, GstPad * pad,
+    IndexBuilder * builder)
+{
+  GstPad *sinkpad;
+  GstElement *sink;
+  gchar *stream_id = gst_pad_get_stream_id (pad);
+  GstElement *pipeline = GST_ELEMENT (gst_element_get_parent (decodebin));
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+
+  if (!builder->linked && (stream_id == NULL ||
+          !g_strcmp0 (stream_id, builder->stream_id))) {
+    g_object_set (sink, "signal-handoffs", TRUE, NULL);
+    g_signal_connect (sink, "handoff", G_CALLBACK (_handoff_cb), builder);
+    builder->linked = TRUE;
+  }
+
+  gst_bin_add (GST_BIN (pipeline), sink);
+  gst_element_sync_state_with_parent (sink);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  if (gst_pad_link (pad, sinkpad) != GST_PAD_LINK_OK)
+    GST_WARNING ("Could not link %" GST_PTR_FORMAT, pad);
+
+  gst_object_unref (sinkpad);
+  gst_object_unref (pipeline);
+  g_free (stream_id);
+}
+
+static gboolean
+_demux (IndexJob * job, IndexBuilder * builder)
+{
+  gboolean res = FALSE;
+  GstElement *pipeline, *decodebin;
+
+  decodebin = gst_element_factory_make ("uridecodebin", NULL);
+  if (decodebin == NULL) {
+    GST_ERROR ("Missing uridecodebin to index %s", job->uri);
+
+    return FALSE;
+  }
+
+  pipeline = gst_pipeline_new ("seek-index");
+  /* The parsed streams are exposed from _autoplug_select_cb, any caps
+   * being final would expose the undemuxed container stream */
+  g_object_set (decodebin, "uri", job->uri, NULL);
+  gst_bin_add (GST_BIN (pipeline), decodebin);
+  g_signal_connect (decodebin, "autoplug-select",
+      G_CALLBACK (_autoplug_select_cb), NULL);
+  g_signal_connect (decodebin, "pad-added",
+      G_CALLBACK (_decoder_pad_added_cb), builder);
+
+  if (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE) {
+    res = ges_wait_for_eos (pipeline, &builder->progress,
+        GES_MEDIA_STALL_TIMEOUT);
+    if (!res)
+      GST_WARNING ("Could not demux %s", job->uri);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return res && builder->linked && builder->keyframes->len > 0;
+}
+
+static gint
+_compare_timestamps (const guint64 * a, const guint64 * b)
+{
+  if (*a < *b)
+    return -1;
+
+  return *a > *b;
+}
+
+static GBytes *
+_build (IndexJob * job)
+{
+  gsize size;
+  guint8 *data;
+  IndexHeader *header;
+  IndexBuilder builder = { job->stream_id, FALSE, NULL, NULL, 0 };
+
+  builder.frames = g_array_new (FALSE, FALSE, sizeof (guint64));
+  builder.keyframes = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+  if (_demux (job, &builder)) {
+    /* Frames come in decoding order */
+    g_array_sort (builder.frames, (GCompareFunc) _compare_timestamps);
+    g_array_sort (builder.keyframes, (GCompareFunc) _compare_timestamps);
+
+    size = sizeof (IndexHeader) + (builder.frames->len +
+        builder.keyframes->len) * sizeof (guint64);
+    data = g_malloc (size);
+
+    header = (IndexHeader *) data;
+    header->magic = INDEX_MAGIC;
+    header->version = INDEX_VERSION;
+    header->n_frames = builder.frames->len;
+    header->n_keyframes = builder.keyframes->len;
+
+    memcpy (data + sizeof (IndexHeader), builder.frames->data,
+        builder.frames->len * sizeof (guint64));
+    memcpy (data + sizeof (IndexHeader) + builder.frames->len *
+        sizeof (guint64), builder.keyframes->data,
+        builder.keyframes->len * sizeof (guint64));
+
+    job->index = g_bytes_new_take (data, size);
+  }
+
+  g_array_unref (builder.frames);
+  g_array_unref (builder.keyframes);
+
+  return job->index;
+}
+
+static const IndexHeader *
+_get_header (GBytes * bytes)
+{
+  gsize size;
+  const IndexHeader *header = g_bytes_get_data (bytes, &size);
+
+  if (size < sizeof (IndexHeader) || header->magic != INDEX_MAGIC ||
+      header->version != INDEX_VERSION || header->n_keyframes == 0 ||
+      (size - sizeof (IndexHeader)) / sizeof (guint64) !=
+      (guint64) header->n_frames + header->n_keyframes)
+    return NULL;
+
+  return header;
+}
+
+/* Returns the index of the last element of @array smaller than or equal to
+ * @ts, or -1 */
+static gint
+_find_before (const guint64 * array, guint len, guint64 ts)
+{
+  gint low = 0, high = (gint) len - 1, res = -1;
+
+  while (low <= high) {
+    gint middle = low + (high - low) / 2;
+
+    if (array[middle] <= ts) {
+      res = middle;
+      low = middle + 1;
+    } else {
+      high = middle - 1;
+    }
+  }
+
+  return res;
+}
+
+static void
+_job_free (IndexJob * job)
+{
+  if (job->notify)
+    job->notify (job->user_data);
+  if (job->index)
+    g_bytes_unref (job->index);
+
+  g_free (job->uri);
+  g_free (job->stream_id);
+  g_slice_free (IndexJob, job);
+}
+
+static gboolean
+_job_done (IndexJob * job)
+{
+  job->func (job->index, job->user_data);
+
+  return FALSE;
+}
+
+static void
+_run_job (IndexJob * job, gpointer unused)
+{
+  gchar *location, *extra;
+
+  extra = g_strdup_printf ("%s\n%d", job->stream_id, INDEX_VERSION);
+  location = ges_get_media_cache_location (job->uri, "seek-index", extra);
+  g_free (extra);
+
+  job->index = ges_media_cache_load (location);
+  if (job->index && _get_header (job->index) == NULL) {
+    GST_INFO ("Ignoring invalid seek index %s", location);
+    g_bytes_unref (job->index);
+    job->index = NULL;
+  }
+
+  if (job->index) {
+    GST_DEBUG ("Using cached seek index of %s from %s", job->uri, location);
+  } else {
+    GST_DEBUG ("Indexing %s (%s)", job->uri, job->stream_id);
+
+    if (_build (job))
+      ges_media_cache_save (location, job->index);
+  }
+  g_free (location);
+
+  g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, (GSourceFunc) _job_done, job,
+      (GDestroyNotify) _job_free);
+}
+
+/*****************************************************
+ *                   Internal API                    *
+ *****************************************************/
+void
+ges_seek_index_init (void)
+{
+  if (index_pool)
+    return;
+
+  index_pool = g_thread_pool_new ((GFunc) _run_job, NULL, MAX_INDEX_THREADS,
+      FALSE, NULL);
+}
+
+/* Gets the seek index of the stream @stream_id of @uri from the disk cache,
+ * or builds it, in a background thread. @func is called from the default
+ * main context with the index, or %NULL if it could not be built */
+void
+ges_seek_index_request (const gchar * uri, const gchar * stream_id,
+    GESSeekIndexReadyFunc func, gpointer user_data, GDestroyNotify notify)
+{
+  IndexJob *job = g_slice_new0 (IndexJob);
+
+  job->uri = g_strdup (uri);
+  job->stream_id = g_strdup (stream_id);
+  job->func = func;
+  job->user_data = user_data;
+  job->notify = notify;
+
+  g_thread_pool_push (index_pool, job, NULL);
+}
+
+/* Finds the last keyframe at or before @position and the number of frames
+ * between that keyframe and @position. Returns %FALSE if @position is out of
+ * the indexed stream. */
+gboolean
+ges_seek_index_lookup (GBytes * index, GstClockTime position,
+    GstClockTime * keyframe, guint * n_skip_frames)
+{
+  gint k, f, kf;
+  const guint64 *frames, *keyframes;
+  const IndexHeader *header = _get_header (index);
+
+  g_return_val_if_fail (header, FALSE);
+
+  frames = (const guint64 *) (header + 1);
+  keyframes = frames + header->n_frames;
+
+  k = _find_before (keyframes, header->n_keyframes, position);
+  f = _find_before (frames, header->n_frames, position);
+  if (k < 0 || f < 0 || position > frames[header->n_frames - 1])
+    return FALSE;
+
+  if (keyframe)
+    *keyframe = keyframes[k];
+
+  if (n_skip_frames) {
+    /* Frames strictly before @position that need to be decoded */
+    kf = _find_before (frames, header->n_frames, keyframes[k]);
+    if (frames[f] == position)
+      f--;
+    *n_skip_frames = MAX (f - kf + 1, 0);
+  }
+
+  return TRUE;
+}
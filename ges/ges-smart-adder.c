@@ -41,28 +41,23 @@ static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink_%u",
     GST_STATIC_CAPS ("audio/x-raw")
     );
 
+/* Mixing in float avoids clipping intermediate sums and uses adder's SIMD
+ * float path */
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
-#define DEFAULT_CAPS "audio/x-raw,format=(string)S32LE;"
+#define DEFAULT_CAPS "audio/x-raw,format=(string)F32LE;"
 #else
-#define DEFAULT_CAPS "audio/x-raw,format=(string)S32BE;"
+#define DEFAULT_CAPS "audio/x-raw,format=(string)F32BE;"
 #endif
 
 typedef struct _PadInfos
 {
   GESSmartAdder *self;
   GstPad *adder_pad;
-  GstElement *bin;
 } PadInfos;
 
 static void
 destroy_pad (PadInfos * infos)
 {
-  if (G_LIKELY (infos->bin)) {
-    gst_element_set_state (infos->bin, GST_STATE_NULL);
-    gst_element_unlink (infos->bin, infos->self->adder);
-    gst_bin_remove (GST_BIN (infos->self), infos->bin);
-  }
-
   if (infos->adder_pad) {
     gst_element_release_request_pad (infos->self->adder, infos->adder_pad);
     gst_object_unref (infos->adder_pad);
@@ -77,47 +72,28 @@ static GstPad *
 _request_new_pad (GstElement * element, GstPadTemplate * templ,
     const gchar * name, const GstCaps * caps)
 {
-  GstPad *audioresample_srcpad, *audioconvert_sinkpad, *tmpghost;
   GstPad *ghost;
-  GstElement *audioconvert, *audioresample;
   PadInfos *infos = g_slice_new0 (PadInfos);
   GESSmartAdder *self = GES_SMART_ADDER (element);
 
   infos->adder_pad = gst_element_request_pad (self->adder, templ, NULL, caps);
   if (infos->adder_pad == NULL) {
     GST_WARNING_OBJECT (element, "Could not get any pad from GstAdder");
+    g_slice_free (PadInfos, infos);
 
     return NULL;
   }
 
   infos->self = self;
 
-  infos->bin = gst_bin_new (NULL);
-  audioconvert = gst_element_factory_make ("audioconvert", NULL);
-  audioresample = gst_element_factory_make ("audioresample", NULL);
-
-  gst_bin_add_many (GST_BIN (infos->bin), audioconvert, audioresample, NULL);
-  gst_element_link_many (audioconvert, audioresample, NULL);
-
-  audioconvert_sinkpad = gst_element_get_static_pad (audioconvert, "sink");
-  tmpghost = GST_PAD (gst_ghost_pad_new (NULL, audioconvert_sinkpad));
-  gst_object_unref (audioconvert_sinkpad);
-  gst_pad_set_active (tmpghost, TRUE);
-  gst_element_add_pad (GST_ELEMENT (infos->bin), tmpghost);
-
-  gst_bin_add (GST_BIN (self), infos->bin);
-  ghost = gst_ghost_pad_new (NULL, tmpghost);
+  /* Every input of the mixer (sources, transitions, effects and gaps)
+   * converts its output itself, adder then only accepts the format it
+   * negotiated first, so there is no need for any converter here */
+  ghost = gst_ghost_pad_new (NULL, infos->adder_pad);
   gst_pad_set_active (ghost, TRUE);
   if (!gst_element_add_pad (GST_ELEMENT (self), ghost))
     goto could_not_add;
 
-  audioresample_srcpad = gst_element_get_static_pad (audioresample, "src");
-  tmpghost = GST_PAD (gst_ghost_pad_new (NULL, audioresample_srcpad));
-  gst_object_unref (audioresample_srcpad);
-  gst_pad_set_active (tmpghost, TRUE);
-  gst_element_add_pad (GST_ELEMENT (infos->bin), tmpghost);
-  gst_pad_link (tmpghost, infos->adder_pad);
-
   LOCK (self);
   g_hash_table_insert (self->pads_infos, ghost, infos);
   UNLOCK (self);
@@ -204,10 +180,15 @@ ges_smart_adder_init (GESSmartAdder * self)
 GstElement *
 ges_smart_adder_new (GESTrack * track)
 {
+  GstCaps *caps;
   GESSmartAdder *self = g_object_new (GES_TYPE_SMART_ADDER, NULL);
   self->track = track;
 
-  /* FIXME Make adder smart and let it properly negotiate caps! */
-  g_object_set (self->adder, "caps", gst_caps_from_string (DEFAULT_CAPS), NULL);
+  /* Rate and channels get fixed by the first input to negotiate, the other
+   * inputs convert to them */
+  caps = gst_caps_from_string (DEFAULT_CAPS);
+  g_object_set (self->adder, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
   return GST_ELEMENT (self);
 }
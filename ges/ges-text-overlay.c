@@ -50,6 +50,9 @@ enum
 
 static void ges_text_overlay_dispose (GObject * object);
 
+static void _text_el_notify_cb (GstElement * text, GParamSpec * pspec,
+    GESTextOverlay * self);
+
 static void ges_text_overlay_finalize (GObject * object);
 
 static void ges_text_overlay_get_property (GObject * object, guint
@@ -105,6 +108,8 @@ ges_text_overlay_dispose (GObject * object)
   }
 
   if (self->priv->text_el) {
+    g_signal_handlers_disconnect_by_func (self->priv->text_el,
+        _text_el_notify_cb, self);
     gst_object_unref (self->priv->text_el);
     self->priv->text_el = NULL;
   }
@@ -138,6 +143,37 @@ ges_text_overlay_set_property (GObject * object,
   }
 }
 
+/* Keeps our values in sync with the element when its properties are set
+ * directly, as children properties, so that the setters only skip values
+ * that the element really has */
+static void
+_text_el_notify_cb (GstElement * text, GParamSpec * pspec,
+    GESTextOverlay * self)
+{
+  gint align;
+  GESTextOverlayPrivate *priv = self->priv;
+
+  if (!g_strcmp0 (pspec->name, "text")) {
+    g_free (priv->text);
+    g_object_get (text, "text", &priv->text, NULL);
+  } else if (!g_strcmp0 (pspec->name, "font-desc")) {
+    g_free (priv->font_desc);
+    g_object_get (text, "font-desc", &priv->font_desc, NULL);
+  } else if (!g_strcmp0 (pspec->name, "halignment")) {
+    g_object_get (text, "halignment", &align, NULL);
+    priv->halign = align;
+  } else if (!g_strcmp0 (pspec->name, "valignment")) {
+    g_object_get (text, "valignment", &align, NULL);
+    priv->valign = align;
+  } else if (!g_strcmp0 (pspec->name, "color")) {
+    g_object_get (text, "color", &priv->color, NULL);
+  } else if (!g_strcmp0 (pspec->name, "xpos")) {
+    g_object_get (text, "xpos", &priv->xpos, NULL);
+  } else if (!g_strcmp0 (pspec->name, "ypos")) {
+    g_object_get (text, "ypos", &priv->ypos, NULL);
+  }
+}
+
 static GstElement *
 ges_text_overlay_create_element (GESTrackElement * track_element)
 {
@@ -145,6 +181,9 @@ ges_text_overlay_create_element (GESTrackElement * track_element)
   GstPad *src_target, *sink_target;
   GstPad *src, *sink;
   GESTextOverlay *self = GES_TEXT_OVERLAY (track_element);
+  const gchar *props[] = { "text", "font-desc", "valignment", "halignment",
+    "color", "xpos", "ypos", NULL
+  };
 
   text = gst_element_factory_make ("textoverlay", NULL);
   iconv = gst_element_factory_make ("videoconvert", NULL);
@@ -163,6 +202,10 @@ ges_text_overlay_create_element (GESTrackElement * track_element)
   g_object_set (text, "xpos", (gdouble) self->priv->xpos, NULL);
   g_object_set (text, "ypos", (gdouble) self->priv->ypos, NULL);
 
+  g_signal_connect (text, "notify", G_CALLBACK (_text_el_notify_cb), self);
+  ges_track_element_add_children_props (track_element, text, NULL, NULL,
+      props);
+
   ret = gst_bin_new ("overlay-bin");
   gst_bin_add_many (GST_BIN (ret), text, iconv, oconv, NULL);
   gst_element_link_many (iconv, text, oconv, NULL);
@@ -193,6 +236,11 @@ ges_text_overlay_create_element (GESTrackElement * track_element)
 void
 ges_text_overlay_set_text (GESTextOverlay * self, const gchar * text)
 {
+  /* Setting a property on textoverlay makes it lay the text out and
+   * render it again, avoid it when nothing changed */
+  if (!g_strcmp0 (self->priv->text, text))
+    return;
+
   GST_DEBUG ("self:%p, text:%s", self, text);
 
   if (self->priv->text)
@@ -215,6 +263,9 @@ ges_text_overlay_set_text (GESTextOverlay * self, const gchar * text)
 void
 ges_text_overlay_set_font_desc (GESTextOverlay * self, const gchar * font_desc)
 {
+  if (!g_strcmp0 (self->priv->font_desc, font_desc))
+    return;
+
   GST_DEBUG ("self:%p, font_desc:%s", self, font_desc);
 
   if (self->priv->font_desc)
@@ -238,6 +289,9 @@ ges_text_overlay_set_font_desc (GESTextOverlay * self, const gchar * font_desc)
 void
 ges_text_overlay_set_valignment (GESTextOverlay * self, GESTextVAlign valign)
 {
+  if (self->priv->valign == valign)
+    return;
+
   GST_DEBUG ("self:%p, halign:%d", self, valign);
 
   self->priv->valign = valign;
@@ -257,6 +311,9 @@ ges_text_overlay_set_valignment (GESTextOverlay * self, GESTextVAlign valign)
 void
 ges_text_overlay_set_halignment (GESTextOverlay * self, GESTextHAlign halign)
 {
+  if (self->priv->halign == halign)
+    return;
+
   GST_DEBUG ("self:%p, halign:%d", self, halign);
 
   self->priv->halign = halign;
@@ -274,6 +331,9 @@ ges_text_overlay_set_halignment (GESTextOverlay * self, GESTextHAlign halign)
 void
 ges_text_overlay_set_color (GESTextOverlay * self, guint32 color)
 {
+  if (self->priv->color == color)
+    return;
+
   GST_DEBUG ("self:%p, color:%d", self, color);
 
   self->priv->color = color;
@@ -291,6 +351,9 @@ ges_text_overlay_set_color (GESTextOverlay * self, guint32 color)
 void
 ges_text_overlay_set_xpos (GESTextOverlay * self, gdouble position)
 {
+  if (self->priv->xpos == position)
+    return;
+
   GST_DEBUG ("self:%p, xpos:%f", self, position);
 
   self->priv->xpos = position;
@@ -308,6 +371,9 @@ ges_text_overlay_set_xpos (GESTextOverlay * self, gdouble position)
 void
 ges_text_overlay_set_ypos (GESTextOverlay * self, gdouble position)
 {
+  if (self->priv->ypos == position)
+    return;
+
   GST_DEBUG ("self:%p, ypos:%f", self, position);
 
   self->priv->ypos = position;
@@ -26,10 +26,15 @@
  * responsible for controlling its timing properties.
  */
 
+#include <string.h>
+
 #include "ges-timeline-element.h"
 #include "ges-extractable.h"
 #include "ges-meta-container.h"
 #include "ges-internal.h"
+#include "ges-container.h"
+#include "ges-clip.h"
+#include "ges-layer.h"
 
 static void
 extractable_set_asset (GESExtractable * extractable, GESAsset * asset)
@@ -65,7 +70,13 @@ static GParamSpec *properties[PROP_LAST] = { NULL, };
 
 struct _GESTimelineElementPrivate
 {
-  gpointer dummy;
+  /* Cached content hash, only valid if !hash_dirty */
+  guint64 hash;
+  gboolean hash_dirty;
+
+  /* Same without the timing, only valid if !media_hash_dirty */
+  guint64 media_hash;
+  gboolean media_hash_dirty;
 };
 
 static void
@@ -137,6 +148,12 @@ _set_property (GObject * object, guint property_id,
 static void
 ges_timeline_element_init (GESTimelineElement * ges_timeline_element)
 {
+  ges_timeline_element->priv =
+      G_TYPE_INSTANCE_GET_PRIVATE (ges_timeline_element,
+      GES_TYPE_TIMELINE_ELEMENT, GESTimelineElementPrivate);
+
+  ges_timeline_element->priv->hash_dirty = TRUE;
+  ges_timeline_element->priv->media_hash_dirty = TRUE;
 
 }
 
@@ -146,13 +163,25 @@ ges_timeline_element_finalize (GObject * self)
   G_OBJECT_CLASS (ges_timeline_element_parent_class)->finalize (self);
 }
 
+static void
+_notify (GObject * object, GParamSpec * pspec)
+{
+  /* Any property of the element can change its output but the timeline */
+  if (pspec != properties[PROP_TIMELINE])
+    _ges_timeline_element_invalidate_content_hash (GES_TIMELINE_ELEMENT
+        (object));
+}
+
 static void
 ges_timeline_element_class_init (GESTimelineElementClass * klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
+  g_type_class_add_private (klass, sizeof (GESTimelineElementPrivate));
+
   object_class->get_property = _get_property;
   object_class->set_property = _set_property;
+  object_class->notify = _notify;
 
   /**
    * GESTimelineElement:parent:
@@ -279,6 +308,10 @@ ges_timeline_element_set_parent (GESTimelineElement * self,
       return FALSE;
   }
 
+  /* The new parent will be invalidated when notifying */
+  if (self->parent)
+    _ges_timeline_element_invalidate_content_hash (self->parent);
+
   self->parent = parent;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PARENT]);
@@ -339,6 +372,8 @@ ges_timeline_element_set_timeline (GESTimelineElement * self,
     goto had_timeline;
 
   self->timeline = timeline;
+  ges_meta_container_set_store (GES_META_CONTAINER (self),
+      timeline ? _ges_timeline_get_meta_store (timeline) : NULL);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TIMELINE]);
   return TRUE;
@@ -880,3 +915,208 @@ ges_timeline_element_get_toplevel_parent (GESTimelineElement * self)
 
   return gst_object_ref (toplevel);
 }
+
+/*********************************************
+ *               Content hash                *
+ *********************************************/
+guint64
+_ges_checksum_get_uint64 (GChecksum * checksum)
+{
+  guint64 res;
+  guint8 digest[64];
+  gsize len = sizeof (digest);
+
+  g_checksum_get_digest (checksum, digest, &len);
+  memcpy (&res, digest, MIN (len, sizeof (res)));
+
+  return GUINT64_FROM_BE (res);
+}
+
+static gint
+_compare_uint64 (const guint64 * a, const guint64 * b)
+{
+  if (*a < *b)
+    return -1;
+  if (*a > *b)
+    return 1;
+
+  return 0;
+}
+
+/* Hashes @hashes independently of their order */
+void
+_ges_checksum_update_hashes (GChecksum * checksum, GArray * hashes)
+{
+  g_array_sort (hashes, (GCompareFunc) _compare_uint64);
+  g_checksum_update (checksum, (const guchar *) hashes->data,
+      hashes->len * sizeof (guint64));
+}
+
+void
+_ges_checksum_update_value (GChecksum * checksum, const gchar * name,
+    const GValue * value)
+{
+  gchar *serialized = gst_value_serialize (value);
+
+  g_checksum_update (checksum, (const guchar *) name, strlen (name) + 1);
+  if (serialized) {
+    g_checksum_update (checksum, (const guchar *) serialized, -1);
+    g_free (serialized);
+  }
+}
+
+static guint64 _get_hash (GESTimelineElement * self, gboolean timed,
+    gboolean * is_volatile);
+
+/* Without @timed, where @self is in the timeline is left out, only its
+ * timing relative to its parent is kept */
+static guint64
+_compute_content_hash (GESTimelineElement * self, gboolean timed,
+    gboolean * is_volatile)
+{
+  guint64 res;
+  guint i, n_specs;
+  GParamSpec **specs;
+  GESAsset *asset = ges_extractable_get_asset (GES_EXTRACTABLE (self));
+  GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+  *is_volatile = FALSE;
+
+  g_checksum_update (checksum, (const guchar *) G_OBJECT_TYPE_NAME (self), -1);
+  if (asset)
+    g_checksum_update (checksum, (const guchar *) ges_asset_get_id (asset), -1);
+
+  /* Start, inpoint, duration, priority but also the properties of the
+   * subclasses (title text, test pattern, transition type...) */
+  specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (self), &n_specs);
+  for (i = 0; i < n_specs; i++) {
+    GValue val = { 0, };
+
+    if (!(specs[i]->flags & G_PARAM_READABLE) ||
+        g_type_is_a (specs[i]->value_type, G_TYPE_OBJECT))
+      continue;
+
+    if (!timed && (!g_strcmp0 (specs[i]->name, "start") ||
+            !g_strcmp0 (specs[i]->name, "in-point") ||
+            !g_strcmp0 (specs[i]->name, "duration")))
+      continue;
+
+    g_value_init (&val, specs[i]->value_type);
+    g_object_get_property (G_OBJECT (self), specs[i]->name, &val);
+    _ges_checksum_update_value (checksum, specs[i]->name, &val);
+    g_value_unset (&val);
+  }
+  g_free (specs);
+
+  if (!timed && self->parent) {
+    gint64 offsets[3];
+
+    offsets[0] = _START (self) - _START (self->parent);
+    offsets[1] = _INPOINT (self) - _INPOINT (self->parent);
+    offsets[2] = _DURATION (self) - _DURATION (self->parent);
+    g_checksum_update (checksum, (const guchar *) offsets, sizeof (offsets));
+  }
+
+  if (GES_IS_TRACK_ELEMENT (self)) {
+    /* Keyframes can change without us being notified */
+    *is_volatile = ges_track_element_hash_children_properties
+        (GES_TRACK_ELEMENT (self), checksum);
+  } else if (GES_IS_CONTAINER (self)) {
+    GList *tmp;
+    GArray *hashes = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+    for (tmp = GES_CONTAINER_CHILDREN (self); tmp; tmp = tmp->next) {
+      gboolean child_volatile;
+      guint64 hash = _get_hash (tmp->data, timed, &child_volatile);
+
+      g_array_append_val (hashes, hash);
+      *is_volatile |= child_volatile;
+    }
+
+    _ges_checksum_update_hashes (checksum, hashes);
+    g_array_free (hashes, TRUE);
+  }
+
+  res = _ges_checksum_get_uint64 (checksum);
+  g_checksum_free (checksum);
+
+  return res;
+}
+
+static guint64
+_get_hash (GESTimelineElement * self, gboolean timed, gboolean * is_volatile)
+{
+  GESTimelineElementPrivate *priv = self->priv;
+  guint64 *hash = timed ? &priv->hash : &priv->media_hash;
+  gboolean *dirty = timed ? &priv->hash_dirty : &priv->media_hash_dirty;
+  gboolean volatile_hash = FALSE;
+
+  if (*dirty) {
+    *hash = _compute_content_hash (self, timed, &volatile_hash);
+    *dirty = volatile_hash;
+  }
+
+  if (is_volatile)
+    *is_volatile = *dirty;
+
+  return *hash;
+}
+
+guint64
+_ges_timeline_element_get_content_hash (GESTimelineElement * self,
+    gboolean * is_volatile)
+{
+  return _get_hash (self, TRUE, is_volatile);
+}
+
+/* Hash of what @self outputs, wherever it is placed in the timeline and
+ * whatever part of its media it uses */
+guint64
+_ges_timeline_element_get_media_hash (GESTimelineElement * self)
+{
+  return _get_hash (self, FALSE, NULL);
+}
+
+void
+_ges_timeline_element_invalidate_content_hash (GESTimelineElement * self)
+{
+  GESTimelineElement *tmp;
+
+  for (tmp = self; tmp; tmp = tmp->parent) {
+    tmp->priv->hash_dirty = TRUE;
+    tmp->priv->media_hash_dirty = TRUE;
+
+    if (GES_IS_CLIP (tmp)) {
+      GESLayer *layer = ges_clip_get_layer (GES_CLIP (tmp));
+
+      if (layer) {
+        _ges_layer_invalidate_content_hash (layer);
+        if (layer->timeline)
+          timeline_invalidate_clip_hash (layer->timeline, GES_CLIP (tmp));
+        gst_object_unref (layer);
+      }
+    }
+  }
+}
+
+/**
+ * ges_timeline_element_get_content_hash:
+ * @self: a #GESTimelineElement
+ *
+ * Gets a hash of everything that has an influence on the output of @self:
+ * its timing, priority, asset, properties, and for #GESTrackElement-s
+ * their children properties and control bindings. The hash of a
+ * #GESContainer also covers all its children.
+ *
+ * The hash is updated incrementally: only the elements that changed
+ * since the last call (and their parents) are hashed again.
+ *
+ * Returns: The content hash of @self
+ */
+guint64
+ges_timeline_element_get_content_hash (GESTimelineElement * self)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_ELEMENT (self), 0);
+
+  return _ges_timeline_element_get_content_hash (self, NULL);
+}
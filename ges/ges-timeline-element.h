@@ -209,6 +209,7 @@ gboolean ges_timeline_element_roll_start             (GESTimelineElement *self,
 gboolean ges_timeline_element_roll_end               (GESTimelineElement *self, GstClockTime  end);
 gboolean ges_timeline_element_trim                   (GESTimelineElement *self, GstClockTime  start);
 GESTimelineElement * ges_timeline_element_copy       (GESTimelineElement *self, gboolean deep);
+guint64 ges_timeline_element_get_content_hash       (GESTimelineElement *self);
 
 G_END_DECLS
 
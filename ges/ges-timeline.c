@@ -164,6 +164,30 @@ struct _GESTimelinePrivate
   /* We keep 1 reference to our trackelement here */
   GSequence *tracksources;      /* Source-s sorted by start/priorities */
 
+  /* Snap points cache, see _snap_points_rebuild */
+  GArray *snap_points;          /* SnapPoint sorted by position */
+  GESContainer *snap_excluded;  /* Toplevel container left out of it */
+  gboolean snap_points_dirty;
+  GHashTable *snap_sources;     /* {guint64 *}, extra points to snap to */
+  guint64 snapping_playhead;
+
+  GESMarkerList *markers;
+
+  /* Whether the track elements are being profiled */
+  gboolean profiling;
+
+  /* The metas of all our elements, see ges_timeline_find_elements_by_meta */
+  GESMetaStore *meta_store;
+
+  /* Clip indexes, see ges_timeline_iterate_clips_in_range. Modified with
+   * query_lock held, query_cookie being bumped on each change */
+  GMutex query_lock;
+  guint32 query_cookie;
+  GHashTable *clip_entries;     /* {GESClip: ClipEntry} */
+  GSequence *clips_by_start;    /* GESClip-s sorted by start */
+  GSequence *clips_by_duration; /* GESClip-s sorted by duration */
+  GHashTable *clips_by_asset;   /* {GESAsset: {GESClip}} */
+
   GRecMutex dyn_mutex;
   GList *priv_tracks;
   /* FIXME: We should definitly offer an API over this,
@@ -181,14 +205,97 @@ struct _GESTimelinePrivate
    * and %FALSE otherwize */
   gboolean needs_transitions_update;
 
+  /* Set while a batch operation (like ges_clip_split_many) is running, the
+   * transitions are then recomputed once it is done */
+  gboolean transitions_frozen;
+
   /* While we are creating and adding the TrackElements for a clip, we need to
    * ignore the child-added signal */
   GESClip *ignore_track_element_added;
   GList *groups;
 
   guint group_id;
+
+  GESRenderCache *render_cache;
+
+  /* The last HashSnapshot-s, most recent first */
+  GQueue hash_snapshots;
+  /* Set by the first ges_timeline_get_content_hash, from then on each
+   * commited state is remembered too */
+  gboolean track_commits;
+  /* GESClip -> ClipHashEntry as of the last snapshot, and the clips that
+   * changed since then, see timeline_invalidate_clip_hash */
+  GHashTable *clip_hashes;
+  GHashTable *dirty_hash_clips;
+
+  /* Builds the clips of a lazily loaded project, see ges_timeline_load_range */
+  GESTimelineLoadRangeFunc lazy_load;
+  gpointer lazy_load_data;
+  GDestroyNotify lazy_load_destroy;
+  gboolean lazy_loading;        /* lazy_load is running */
+  gboolean range_loaded;        /* ges_timeline_load_range was called */
+  /* Where the clips that are not loaded yet end, as indexed by lazy_load */
+  GstClockTime unloaded_end;
 };
 
+/* Keep that many timeline states around for ges_timeline_get_changed_ranges */
+#define MAX_HASH_SNAPSHOTS 32
+
+typedef struct
+{
+  guint64 hash;                 /* Content hash of the clip and its layer prio */
+  GstClockTime start;
+  GstClockTime stop;
+} ClipHashEntry;
+
+typedef struct
+{
+  guint64 hash;
+  guint64 tracks_hash;
+  GstClockTime duration;
+  /* ClipHashEntry that changed since the previous snapshot */
+  GArray *removed;
+  GArray *added;
+} HashSnapshot;
+
+static void
+_hash_snapshot_free (HashSnapshot * snapshot)
+{
+  g_array_free (snapshot->removed, TRUE);
+  g_array_free (snapshot->added, TRUE);
+  g_slice_free (HashSnapshot, snapshot);
+}
+
+static void
+_clip_hash_entry_free (ClipHashEntry * entry)
+{
+  g_slice_free (ClipHashEntry, entry);
+}
+
+/* What a clip is indexed under, see ges_timeline_iterate_clips_in_range */
+typedef struct
+{
+  GSequenceIter *by_start;
+  GSequenceIter *by_duration;
+  GESAsset *asset;
+} ClipEntry;
+
+static void
+_free_clip_entry (ClipEntry * entry)
+{
+  g_slice_free (ClipEntry, entry);
+}
+
+/* A position elements can be snapped to, @timecode is what
+ * ges_timeline_snap_position returns, @position its value when it was
+ * inserted in the sorted snap_points array */
+typedef struct
+{
+  guint64 position;
+  guint64 *timecode;
+  GESTrackElement *element;     /* %NULL for the extra snap sources */
+} SnapPoint;
+
 /* private structure to contain our track-related information */
 
 typedef struct
@@ -208,6 +315,10 @@ enum
   PROP_AUTO_TRANSITION,
   PROP_SNAPPING_DISTANCE,
   PROP_UPDATE,
+  PROP_RENDER_CACHE_DIRECTORY,
+  PROP_RENDER_CACHE_MAX_SIZE,
+  PROP_SNAPPING_PLAYHEAD,
+  PROP_PROFILING,
   PROP_LAST
 };
 
@@ -231,6 +342,9 @@ static GstBinClass *parent_class;
 static guint ges_timeline_signals[LAST_SIGNAL] = { 0 };
 
 static gint custom_find_track (TrackPrivate * tr_priv, GESTrack * track);
+static void _lazy_load (GESTimeline * timeline, GESLayer * layer,
+    GstClockTime start, GstClockTime stop, GESAsset * asset,
+    const gchar * meta_item);
 
 static guint nb_assets = 0;
 
@@ -283,7 +397,7 @@ ges_timeline_get_property (GObject * object, guint property_id,
 
   switch (property_id) {
     case PROP_DURATION:
-      g_value_set_uint64 (value, timeline->priv->duration);
+      g_value_set_uint64 (value, ges_timeline_get_duration (timeline));
       break;
     case PROP_AUTO_TRANSITION:
       g_value_set_boolean (value, timeline->priv->auto_transition);
@@ -291,6 +405,20 @@ ges_timeline_get_property (GObject * object, guint property_id,
     case PROP_SNAPPING_DISTANCE:
       g_value_set_uint64 (value, timeline->priv->snapping_distance);
       break;
+    case PROP_RENDER_CACHE_DIRECTORY:
+      g_value_set_string (value,
+          ges_render_cache_get_directory (timeline->priv->render_cache));
+      break;
+    case PROP_RENDER_CACHE_MAX_SIZE:
+      g_value_set_uint64 (value,
+          ges_render_cache_get_max_size (timeline->priv->render_cache));
+      break;
+    case PROP_SNAPPING_PLAYHEAD:
+      g_value_set_uint64 (value, timeline->priv->snapping_playhead);
+      break;
+    case PROP_PROFILING:
+      g_value_set_boolean (value, timeline->priv->profiling);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -309,17 +437,75 @@ ges_timeline_set_property (GObject * object, guint property_id,
     case PROP_SNAPPING_DISTANCE:
       timeline->priv->snapping_distance = g_value_get_uint64 (value);
       break;
+    case PROP_RENDER_CACHE_DIRECTORY:
+      ges_render_cache_set_directory (timeline->priv->render_cache,
+          g_value_get_string (value));
+      break;
+    case PROP_RENDER_CACHE_MAX_SIZE:
+      ges_render_cache_set_max_size (timeline->priv->render_cache,
+          g_value_get_uint64 (value));
+      break;
+    case PROP_SNAPPING_PLAYHEAD:
+      ges_timeline_set_snapping_playhead (timeline,
+          g_value_get_uint64 (value));
+      break;
+    case PROP_PROFILING:
+      ges_timeline_set_profiling (timeline, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
 }
 
+static void
+_clear_lazy_loader (GESTimeline * timeline)
+{
+  GESTimelinePrivate *priv = timeline->priv;
+  GDestroyNotify destroy = priv->lazy_load_destroy;
+  gpointer data = priv->lazy_load_data;
+
+  priv->lazy_load = NULL;
+  priv->lazy_load_data = NULL;
+  priv->lazy_load_destroy = NULL;
+  priv->unloaded_end = 0;
+
+  if (destroy)
+    destroy (data);
+}
+
 static void
 ges_timeline_dispose (GObject * object)
 {
   GESTimeline *tl = GES_TIMELINE (object);
   GESTimelinePrivate *priv = tl->priv;
 
+  _clear_lazy_loader (tl);
+
+  if (priv->render_cache) {
+    ges_render_cache_free (priv->render_cache);
+    priv->render_cache = NULL;
+  }
+
+  g_queue_foreach (&priv->hash_snapshots, (GFunc) _hash_snapshot_free, NULL);
+  g_queue_clear (&priv->hash_snapshots);
+  if (priv->clip_hashes) {
+    g_hash_table_unref (priv->clip_hashes);
+    g_hash_table_unref (priv->dirty_hash_clips);
+    priv->clip_hashes = NULL;
+    priv->dirty_hash_clips = NULL;
+  }
+
+  if (priv->markers) {
+    g_signal_handlers_disconnect_by_data (priv->markers, tl);
+    g_object_unref (priv->markers);
+    priv->markers = NULL;
+
+    /* The positions of the markers are gone */
+    g_hash_table_remove_all (priv->snap_sources);
+    priv->snap_points_dirty = TRUE;
+    priv->movecontext.last_snap_ts = NULL;
+  }
+
   while (tl->layers) {
     GESLayer *layer = (GESLayer *) tl->layers->data;
     ges_timeline_remove_layer (GES_TIMELINE (object), layer);
@@ -344,17 +530,35 @@ ges_timeline_dispose (GObject * object)
   g_hash_table_unref (priv->obj_iters);
   g_sequence_free (priv->starts_ends);
   g_sequence_free (priv->tracksources);
+  g_array_free (priv->snap_points, TRUE);
+  g_hash_table_unref (priv->snap_sources);
   g_list_free (priv->movecontext.moving_trackelements);
   g_hash_table_unref (priv->movecontext.toplevel_containers);
 
   g_hash_table_unref (priv->auto_transitions);
 
+  if (priv->meta_store) {
+    ges_meta_store_free (priv->meta_store);
+    priv->meta_store = NULL;
+  }
+
+  /* All the clips went away with the layers */
+  if (priv->clip_entries) {
+    g_hash_table_unref (priv->clip_entries);
+    g_sequence_free (priv->clips_by_start);
+    g_sequence_free (priv->clips_by_duration);
+    g_hash_table_unref (priv->clips_by_asset);
+    priv->clip_entries = NULL;
+  }
+
   G_OBJECT_CLASS (ges_timeline_parent_class)->dispose (object);
 }
 
 static void
 ges_timeline_finalize (GObject * object)
 {
+  g_mutex_clear (&GES_TIMELINE (object)->priv->query_lock);
+
   G_OBJECT_CLASS (ges_timeline_parent_class)->finalize (object);
 }
 
@@ -423,6 +627,56 @@ ges_timeline_class_init (GESTimelineClass * klass)
   g_object_class_install_property (object_class, PROP_SNAPPING_DISTANCE,
       properties[PROP_SNAPPING_DISTANCE]);
 
+  /**
+   * GESTimeline:render-cache-directory:
+   *
+   * The directory where the renderings of the regions added with
+   * #ges_timeline_add_render_cache_region are stored.
+   */
+  properties[PROP_RENDER_CACHE_DIRECTORY] =
+      g_param_spec_string ("render-cache-directory", "Render cache directory",
+      "Directory where cached renderings are stored", NULL, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_RENDER_CACHE_DIRECTORY,
+      properties[PROP_RENDER_CACHE_DIRECTORY]);
+
+  /**
+   * GESTimeline:render-cache-max-size:
+   *
+   * Maximum size (in bytes) of the render cache directory, the least recently
+   * used renderings get removed when it is exceeded. 0 means no limit.
+   */
+  properties[PROP_RENDER_CACHE_MAX_SIZE] =
+      g_param_spec_uint64 ("render-cache-max-size", "Render cache max size",
+      "Maximum size of the render cache in bytes", 0, G_MAXUINT64,
+      DEFAULT_RENDER_CACHE_MAX_SIZE, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_RENDER_CACHE_MAX_SIZE,
+      properties[PROP_RENDER_CACHE_MAX_SIZE]);
+
+  /**
+   * GESTimeline:snapping-playhead:
+   *
+   * Position of the playhead, moving objects also snap to it. Set it to
+   * #GST_CLOCK_TIME_NONE to not snap to the playhead.
+   */
+  properties[PROP_SNAPPING_PLAYHEAD] =
+      g_param_spec_uint64 ("snapping-playhead", "Snapping playhead",
+      "Position of the playhead moving objects snap to", 0, G_MAXUINT64,
+      GST_CLOCK_TIME_NONE, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_SNAPPING_PLAYHEAD,
+      properties[PROP_SNAPPING_PLAYHEAD]);
+
+  /**
+   * GESTimeline:profiling:
+   *
+   * Whether to measure the time the elements of the #GESTrackElement-s of
+   * the timeline take to process their data. See ges_timeline_get_profile().
+   */
+  properties[PROP_PROFILING] =
+      g_param_spec_boolean ("profiling", "Profiling",
+      "Whether to profile the track elements", FALSE, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_PROFILING,
+      properties[PROP_PROFILING]);
+
   /**
    * GESTimeline::track-added:
    * @timeline: the #GESTimeline
@@ -475,7 +729,8 @@ ges_timeline_class_init (GESTimelineClass * klass)
    * GESTimeline::track-elements-snapping:
    * @timeline: the #GESTimeline
    * @obj1: the first #GESTrackElement that was snapping.
-   * @obj2: the second #GESTrackElement that was snapping.
+   * @obj2: the second #GESTrackElement that was snapping, %NULL when
+   * snapping to the #GESTimeline:snapping-playhead
    * @position: the position where the two objects finally snapping.
    *
    * Will be emitted when the 2 #GESTrackElement first snapped
@@ -523,6 +778,29 @@ ges_timeline_class_init (GESTimelineClass * klass)
       G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
 }
 
+/* The markers of the timeline are positions to snap to */
+static void
+_marker_added_cb (GESMarkerList * markers, GESMarker * marker,
+    GESTimeline * timeline)
+{
+  timeline_add_snap_point (timeline, ges_marker_get_timecode (marker));
+}
+
+static void
+_marker_removed_cb (GESMarkerList * markers, GESMarker * marker,
+    GESTimeline * timeline)
+{
+  timeline_remove_snap_point (timeline, ges_marker_get_timecode (marker));
+}
+
+static void
+_marker_moved_cb (GESMarkerList * markers, GESMarker * marker,
+    guint64 old_position, GESTimeline * timeline)
+{
+  timeline_snap_point_moved (timeline, ges_marker_get_timecode (marker),
+      old_position);
+}
+
 static void
 ges_timeline_init (GESTimeline * self)
 {
@@ -552,12 +830,35 @@ ges_timeline_init (GESTimeline * self)
       (GDestroyNotify) _destroy_obj_iters);
   priv->starts_ends = g_sequence_new (g_free);
   priv->tracksources = g_sequence_new (gst_object_unref);
+  priv->snap_points = g_array_new (FALSE, FALSE, sizeof (SnapPoint));
+  priv->snap_points_dirty = TRUE;
+  priv->snap_sources = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->snapping_playhead = GST_CLOCK_TIME_NONE;
+
+  priv->markers = ges_marker_list_new ();
+  priv->meta_store = ges_meta_store_new ();
+
+  g_mutex_init (&priv->query_lock);
+  priv->clip_entries = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) _free_clip_entry);
+  priv->clips_by_start = g_sequence_new (NULL);
+  priv->clips_by_duration = g_sequence_new (NULL);
+  priv->clips_by_asset = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, gst_object_unref, (GDestroyNotify) g_hash_table_unref);
+  g_signal_connect (priv->markers, "marker-added",
+      G_CALLBACK (_marker_added_cb), self);
+  g_signal_connect (priv->markers, "marker-removed",
+      G_CALLBACK (_marker_removed_cb), self);
+  g_signal_connect (priv->markers, "marker-moved",
+      G_CALLBACK (_marker_moved_cb), self);
 
   priv->auto_transitions =
       g_hash_table_new_full (g_str_hash, g_str_equal, NULL, gst_object_unref);
   priv->needs_transitions_update = TRUE;
 
   priv->group_id = -1;
+  priv->render_cache = ges_render_cache_new (self);
+  g_queue_init (&priv->hash_snapshots);
 
   g_signal_connect_after (self, "select-tracks-for-object",
       G_CALLBACK (select_tracks_for_object_default), NULL);
@@ -663,17 +964,178 @@ custom_find_track (TrackPrivate * tr_priv, GESTrack * track)
   return -1;
 }
 
+/* Snap points
+ *
+ * All the positions elements can snap to, sorted, without the ones of the
+ * toplevel container being edited so that the closest point to snap to is
+ * always one of the two around the snapped position. The array is rebuilt
+ * when the edited container changes or something is added to or removed
+ * from the timeline, and kept sorted as the points move otherwise */
+
+/* Index of the first point at or after @position */
+static guint
+_snap_points_lower_bound (GArray * points, guint64 position)
+{
+  guint low = 0, high = points->len;
+
+  while (low < high) {
+    guint mid = low + (high - low) / 2;
+
+    if (g_array_index (points, SnapPoint, mid).position < position)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  return low;
+}
+
+static void
+_snap_points_insert (GArray * points, guint64 * timecode,
+    GESTrackElement * element)
+{
+  SnapPoint point = { *timecode, timecode, element };
+
+  g_array_insert_val (points, _snap_points_lower_bound (points, *timecode),
+      point);
+}
+
+/* Returns %FALSE if @timecode was not there, which is the case for the
+ * points of the edited container */
+static gboolean
+_snap_points_remove (GArray * points, guint64 * timecode, guint64 position,
+    GESTrackElement ** element)
+{
+  guint i;
+
+  for (i = _snap_points_lower_bound (points, position); i < points->len; i++) {
+    SnapPoint *point = &g_array_index (points, SnapPoint, i);
+
+    if (point->position != position)
+      break;
+
+    if (point->timecode == timecode) {
+      if (element)
+        *element = point->element;
+      g_array_remove_index (points, i);
+
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/* To be called when the value of @timecode changed from @old_position */
+static void
+_snap_point_moved (GESTimeline * timeline, guint64 * timecode,
+    guint64 old_position)
+{
+  GESTrackElement *element;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  if (priv->snap_points_dirty || *timecode == old_position)
+    return;
+
+  if (_snap_points_remove (priv->snap_points, timecode, old_position,
+          &element))
+    _snap_points_insert (priv->snap_points, timecode, element);
+}
+
+static gint
+_compare_snap_points (const SnapPoint * a, const SnapPoint * b)
+{
+  if (a->position < b->position)
+    return -1;
+
+  return a->position > b->position;
+}
+
+static void
+_snap_points_rebuild (GESTimeline * timeline, GESContainer * excluded)
+{
+  SnapPoint point;
+  GHashTableIter hiter;
+  GSequenceIter *iter;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  GST_DEBUG_OBJECT (timeline, "Rebuilding snap points without %"
+      GST_PTR_FORMAT, excluded);
+
+  g_array_set_size (priv->snap_points, 0);
+
+  for (iter = g_sequence_get_begin_iter (priv->tracksources);
+      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+    GESTrackElement *element = g_sequence_get (iter);
+
+    if (get_toplevel_container (element) == excluded)
+      continue;
+
+    point.element = element;
+    point.timecode = g_hash_table_lookup (priv->by_start, element);
+    point.position = *point.timecode;
+    g_array_append_val (priv->snap_points, point);
+
+    point.timecode = g_hash_table_lookup (priv->by_end, element);
+    point.position = *point.timecode;
+    g_array_append_val (priv->snap_points, point);
+  }
+
+  g_hash_table_iter_init (&hiter, priv->snap_sources);
+  while (g_hash_table_iter_next (&hiter, (gpointer *) & point.timecode, NULL)) {
+    point.element = NULL;
+    point.position = *point.timecode;
+    g_array_append_val (priv->snap_points, point);
+  }
+
+  g_array_sort (priv->snap_points, (GCompareFunc) _compare_snap_points);
+  priv->snap_excluded = excluded;
+  priv->snap_points_dirty = FALSE;
+}
+
+void
+timeline_add_snap_point (GESTimeline * timeline, guint64 * timecode)
+{
+  GESTimelinePrivate *priv = timeline->priv;
+
+  g_hash_table_add (priv->snap_sources, timecode);
+  if (!priv->snap_points_dirty)
+    _snap_points_insert (priv->snap_points, timecode, NULL);
+}
+
+void
+timeline_remove_snap_point (GESTimeline * timeline, guint64 * timecode)
+{
+  GESTimelinePrivate *priv = timeline->priv;
+
+  g_hash_table_remove (priv->snap_sources, timecode);
+  if (!priv->snap_points_dirty)
+    _snap_points_remove (priv->snap_points, timecode, *timecode, NULL);
+
+  if (priv->movecontext.last_snap_ts == timecode)
+    priv->movecontext.last_snap_ts = NULL;
+}
+
+void
+timeline_snap_point_moved (GESTimeline * timeline, guint64 * timecode,
+    guint64 old_position)
+{
+  _snap_point_moved (timeline, timecode, old_position);
+}
+
 static inline void
 sort_starts_ends_end (GESTimeline * timeline, TrackObjIters * iters)
 {
   GESTimelineElement *obj = GES_TIMELINE_ELEMENT (iters->trackelement);
   GESTimelinePrivate *priv = timeline->priv;
   guint64 *end = g_hash_table_lookup (priv->by_end, obj);
+  guint64 old_end = *end;
 
   *end = _START (obj) + _DURATION (obj);
 
   g_sequence_sort_changed (iters->iter_end, (GCompareDataFunc) compare_uint64,
       NULL);
+  _snap_point_moved (timeline, end, old_end);
   timeline_update_duration (timeline);
 }
 
@@ -683,11 +1145,13 @@ sort_starts_ends_start (GESTimeline * timeline, TrackObjIters * iters)
   GESTimelineElement *obj = GES_TIMELINE_ELEMENT (iters->trackelement);
   GESTimelinePrivate *priv = timeline->priv;
   guint64 *start = g_hash_table_lookup (priv->by_start, obj);
+  guint64 old_start = *start;
 
   *start = _START (obj);
 
   g_sequence_sort_changed (iters->iter_start,
       (GCompareDataFunc) compare_uint64, NULL);
+  _snap_point_moved (timeline, start, old_start);
   timeline_update_duration (timeline);
 }
 
@@ -897,7 +1361,7 @@ create_transitions (GESTimeline * timeline, GESTrackElement * track_element)
 
   GESTimelinePrivate *priv = timeline->priv;
 
-  if (!priv->needs_transitions_update)
+  if (!priv->needs_transitions_update || priv->transitions_frozen)
     return;
 
   GST_DEBUG_OBJECT (timeline, "Creating transitions around %p", track_element);
@@ -914,6 +1378,26 @@ create_transitions (GESTimeline * timeline, GESTrackElement * track_element)
   GST_DEBUG_OBJECT (timeline, "Done updating transitions");
 }
 
+void
+timeline_freeze_transitions (GESTimeline * timeline)
+{
+  timeline->priv->transitions_frozen = TRUE;
+}
+
+/* Recomputes the auto transitions of @layer in one pass */
+void
+timeline_thaw_transitions (GESTimeline * timeline, GESLayer * layer)
+{
+  timeline->priv->transitions_frozen = FALSE;
+
+  /* Same as create_transitions, some edits handle transitions themselves */
+  if (!timeline->priv->needs_transitions_update)
+    return;
+
+  _create_transitions_on_layer (timeline, layer, NULL, NULL,
+      _find_transition_from_auto_transitions);
+}
+
 /* Timeline edition functions */
 static inline void
 init_movecontext (MoveContext * mv_ctx, gboolean first_init)
@@ -966,6 +1450,7 @@ stop_tracking_track_element (GESTimeline * timeline,
     g_sequence_remove (iters->iter_start);
     g_sequence_remove (iters->iter_end);
     g_sequence_remove (iters->iter_obj);
+    priv->snap_points_dirty = TRUE;
     timeline_update_duration (timeline);
   }
   g_hash_table_remove (priv->obj_iters, trackelement);
@@ -1033,6 +1518,7 @@ start_tracking_track_element (GESTimeline * timeline,
     g_hash_table_insert (priv->by_object, pend, trackelement);
 
     timeline->priv->movecontext.needs_move_ctx = TRUE;
+    priv->snap_points_dirty = TRUE;
 
     timeline_update_duration (timeline);
     create_transitions (timeline, trackelement);
@@ -1093,14 +1579,13 @@ ges_timeline_snap_position (GESTimeline * timeline,
     gboolean emit)
 {
   GESTimelinePrivate *priv = timeline->priv;
-  GSequenceIter *iter, *prev_iter, *nxt_iter;
-  GESTrackElement *tmp_trackelement;
-  GESContainer *tmp_container, *container;
+  guint idx;
+  SnapPoint *point;
+  GESContainer *container;
 
   GstClockTime *last_snap_ts = priv->movecontext.last_snap_ts;
   guint64 snap_distance = timeline->priv->snapping_distance;
-  guint64 *prev_tc, *next_tc, *ret = NULL, off = G_MAXUINT64, off1 =
-      G_MAXUINT64;
+  guint64 *ret = NULL, off = G_MAXUINT64, off1 = G_MAXUINT64;
 
   /* Avoid useless calculations */
   if (snap_distance == 0)
@@ -1117,47 +1602,29 @@ ges_timeline_snap_position (GESTimeline * timeline,
   }
 
   container = get_toplevel_container (trackelement);
-
-  iter = g_sequence_search (priv->starts_ends, &timecode,
-      (GCompareDataFunc) compare_uint64, NULL);
-
-  /* Getting the next/previous  values, and use the closest one if any "respects"
-   * the snap_distance value */
-  nxt_iter = iter;
-  while (!g_sequence_iter_is_end (nxt_iter)) {
-    next_tc = g_sequence_get (iter);
-    tmp_trackelement = g_hash_table_lookup (timeline->priv->by_object, next_tc);
-    tmp_container = get_toplevel_container (tmp_trackelement);
-
-    off = timecode > *next_tc ? timecode - *next_tc : *next_tc - timecode;
-    if (next_tc != current && off <= snap_distance
-        && container != tmp_container) {
-
-      ret = next_tc;
-      break;
-    }
-
-    nxt_iter = g_sequence_iter_next (nxt_iter);
+  if (priv->snap_points_dirty || priv->snap_excluded != container)
+    _snap_points_rebuild (timeline, container);
+
+  /* The closest points are around the position, the next one wins if both
+   * are as close */
+  idx = _snap_points_lower_bound (priv->snap_points, timecode);
+  if (idx < priv->snap_points->len) {
+    point = &g_array_index (priv->snap_points, SnapPoint, idx);
+
+    off = point->position - timecode;
+    if (point->timecode != current && off <= snap_distance)
+      ret = point->timecode;
   }
 
   if (ret == NULL)
     off = G_MAXUINT64;
 
-  prev_iter = g_sequence_iter_prev (iter);
-  while (!g_sequence_iter_is_begin (prev_iter)) {
-    prev_tc = g_sequence_get (prev_iter);
-    tmp_trackelement = g_hash_table_lookup (timeline->priv->by_object, prev_tc);
-    tmp_container = get_toplevel_container (tmp_trackelement);
-
-    off1 = timecode > *prev_tc ? timecode - *prev_tc : *prev_tc - timecode;
-    if (prev_tc != current && off1 < off && off1 <= snap_distance &&
-        container != tmp_container) {
-      ret = prev_tc;
-
-      break;
-    }
+  if (idx > 0) {
+    point = &g_array_index (priv->snap_points, SnapPoint, idx - 1);
 
-    prev_iter = g_sequence_iter_prev (prev_iter);
+    off1 = timecode - point->position;
+    if (point->timecode != current && off1 < off && off1 <= snap_distance)
+      ret = point->timecode;
   }
 
 done:
@@ -1302,6 +1769,8 @@ ges_timeline_set_moving_context (GESTimeline * timeline, GESTrackElement * obj,
       mv_ctx->mode, mv_ctx->edge, clip, mode, edge, mv_ctx->needs_move_ctx);
 
   clean_movecontext (mv_ctx);
+  /* Groups might have changed, which we do not track */
+  timeline->priv->snap_points_dirty = TRUE;
   mv_ctx->edge = edge;
   mv_ctx->mode = mode;
   mv_ctx->clip = clip;
@@ -1465,6 +1934,42 @@ ges_timeline_trim_object_simple (GESTimeline * timeline,
   return ret;
 }
 
+/* Editing snaps to and moves the clips around the edited one, builds the
+ * clips @obj can reach when its @edge goes to @position */
+static void
+_load_before_edit (GESTimeline * timeline, GESTrackElement * obj,
+    GESEditMode mode, GESEdge edge, guint64 position)
+{
+  GESTimelineElement *toplevel;
+  gint64 start, end, offset;
+  gint64 snap = timeline->priv->snapping_distance;
+
+  if (timeline->priv->lazy_load == NULL)
+    return;
+
+  start = _START (obj);
+  end = start + _DURATION (obj);
+  if (mode == GES_EDIT_MODE_NORMAL && edge == GES_EDGE_NONE) {
+    /* The whole group moves along */
+    toplevel = GES_TIMELINE_ELEMENT (get_toplevel_container (obj));
+    offset = (gint64) position - start;
+    start = _START (toplevel);
+    end = start + _DURATION (toplevel);
+    start = MIN (start, start + offset);
+    end = MAX (end, end + offset);
+  } else {
+    start = MIN (start, (gint64) position);
+    end = MAX (end, (gint64) position);
+  }
+
+  start = MAX (start - snap, 0);
+  /* Rippling moves all the following clips */
+  if (mode == GES_EDIT_MODE_RIPPLE && edge != GES_EDGE_START)
+    timeline_load_range (timeline, NULL, start, GST_CLOCK_TIME_NONE);
+  else
+    timeline_load_range (timeline, NULL, start, end + snap + 1);
+}
+
 gboolean
 timeline_ripple_object (GESTimeline * timeline, GESTrackElement * obj,
     GList * layers, GESEdge edge, guint64 position)
@@ -1477,6 +1982,7 @@ timeline_ripple_object (GESTimeline * timeline, GESTrackElement * obj,
 
   MoveContext *mv_ctx = &timeline->priv->movecontext;
 
+  _load_before_edit (timeline, obj, GES_EDIT_MODE_RIPPLE, edge, position);
   mv_ctx->ignore_needs_ctx = TRUE;
 
   if (!ges_timeline_set_moving_context (timeline, obj, GES_EDIT_MODE_RIPPLE,
@@ -1575,7 +2081,6 @@ gboolean
 timeline_slide_object (GESTimeline * timeline, GESTrackElement * obj,
     GList * layers, GESEdge edge, guint64 position)
 {
-
   /* FIXME implement me! */
   GST_FIXME_OBJECT (timeline, "Slide mode editing not implemented yet");
 
@@ -1589,6 +2094,7 @@ timeline_trim_object (GESTimeline * timeline, GESTrackElement * object,
   gboolean ret = FALSE;
   MoveContext *mv_ctx = &timeline->priv->movecontext;
 
+  _load_before_edit (timeline, object, GES_EDIT_MODE_TRIM, edge, position);
   mv_ctx->ignore_needs_ctx = TRUE;
 
   if (!ges_timeline_set_moving_context (timeline, object, GES_EDIT_MODE_TRIM,
@@ -1613,6 +2119,7 @@ timeline_roll_object (GESTimeline * timeline, GESTrackElement * obj,
   gboolean ret = TRUE;
   GList *tmp;
 
+  _load_before_edit (timeline, obj, GES_EDIT_MODE_ROLL, edge, position);
   mv_ctx->ignore_needs_ctx = TRUE;
 
   GST_DEBUG_OBJECT (obj, "Rolling object to %" GST_TIME_FORMAT,
@@ -1727,6 +2234,8 @@ gboolean
 timeline_move_object (GESTimeline * timeline, GESTrackElement * object,
     GList * layers, GESEdge edge, guint64 position)
 {
+  _load_before_edit (timeline, object, GES_EDIT_MODE_NORMAL, edge, position);
+
   if (!ges_timeline_set_moving_context (timeline, object, GES_EDIT_MODE_NORMAL,
           edge, layers)) {
     GST_DEBUG_OBJECT (object, "Could not move to %" GST_TIME_FORMAT,
@@ -2064,57 +2573,372 @@ clip_track_element_removed_cb (GESClip * clip,
     ges_track_remove_element (track, track_element);
 }
 
-static void
-layer_object_added_cb (GESLayer * layer, GESClip * clip, GESTimeline * timeline)
+/****************************************************
+ *                 Clip indexes                     *
+ ****************************************************/
+
+static gint
+_compare_clips_by_start (GESClip * a, GESClip * b, gpointer unused)
 {
-  GESProject *project;
+  if (_START (a) != _START (b))
+    return _START (a) < _START (b) ? -1 : 1;
 
-  /* We make sure not to be connected twice */
-  g_signal_handlers_disconnect_by_func (clip, clip_track_element_added_cb,
-      timeline);
-  g_signal_handlers_disconnect_by_func (clip, clip_track_element_removed_cb,
-      timeline);
+  return a < b ? -1 : a > b ? 1 : 0;
+}
 
-  /* And we connect to the object */
-  g_signal_connect (clip, "child-added",
-      G_CALLBACK (clip_track_element_added_cb), timeline);
-  g_signal_connect (clip, "child-removed",
-      G_CALLBACK (clip_track_element_removed_cb), timeline);
+static gint
+_compare_clips_by_duration (GESClip * a, GESClip * b, gpointer unused)
+{
+  if (_DURATION (a) != _DURATION (b))
+    return _DURATION (a) < _DURATION (b) ? -1 : 1;
 
-  if (ges_clip_is_moving_from_layer (clip)) {
-    GST_DEBUG ("Clip %p moving from one layer to another, not creating "
-        "TrackElement", clip);
-    timeline->priv->movecontext.needs_move_ctx = TRUE;
-    _create_transitions_on_layer (timeline, layer, NULL, NULL,
-        _find_transition_from_auto_transitions);
+  return a < b ? -1 : a > b ? 1 : 0;
+}
+
+/* Call with query_lock held */
+static void
+_index_clip_asset (GESTimeline * timeline, GESClip * clip, ClipEntry * entry)
+{
+  GHashTable *clips;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  entry->asset = ges_extractable_get_asset (GES_EXTRACTABLE (clip));
+  if (entry->asset == NULL)
     return;
-  }
 
+  clips = g_hash_table_lookup (priv->clips_by_asset, entry->asset);
+  if (clips == NULL) {
+    clips = g_hash_table_new (g_direct_hash, g_direct_equal);
+    g_hash_table_insert (priv->clips_by_asset, gst_object_ref (entry->asset),
+        clips);
+  }
+  g_hash_table_add (clips, clip);
+}
 
-  add_object_to_tracks (timeline, clip, NULL);
+/* Call with query_lock held */
+static void
+_unindex_clip_asset (GESTimeline * timeline, GESClip * clip,
+    ClipEntry * entry)
+{
+  GHashTable *clips;
+  GESTimelinePrivate *priv = timeline->priv;
 
-  GST_DEBUG ("Making sure that the asset is in our project");
-  project =
-      GES_PROJECT (ges_extractable_get_asset (GES_EXTRACTABLE (timeline)));
-  ges_project_add_asset (project,
-      ges_extractable_get_asset (GES_EXTRACTABLE (clip)));
+  if (entry->asset == NULL)
+    return;
 
-  GST_DEBUG ("Done");
+  clips = g_hash_table_lookup (priv->clips_by_asset, entry->asset);
+  g_hash_table_remove (clips, clip);
+  if (g_hash_table_size (clips) == 0)
+    g_hash_table_remove (priv->clips_by_asset, entry->asset);
+  entry->asset = NULL;
 }
 
 static void
-layer_priority_changed_cb (GESLayer * layer,
-    GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
+_indexed_clip_moved_cb (GESClip * clip, GParamSpec * arg G_GNUC_UNUSED,
+    GESTimeline * timeline)
 {
-  timeline->layers = g_list_sort (timeline->layers, (GCompareFunc)
-      sort_layers);
+  GESTimelinePrivate *priv = timeline->priv;
+  ClipEntry *entry;
+
+  g_mutex_lock (&priv->query_lock);
+  entry = g_hash_table_lookup (priv->clip_entries, clip);
+  if (entry) {
+    g_sequence_sort_changed (entry->by_start,
+        (GCompareDataFunc) _compare_clips_by_start, NULL);
+    g_sequence_sort_changed (entry->by_duration,
+        (GCompareDataFunc) _compare_clips_by_duration, NULL);
+    priv->query_cookie++;
+  }
+  g_mutex_unlock (&priv->query_lock);
 }
 
 static void
-layer_object_removed_cb (GESLayer * layer, GESClip * clip,
-    GESTimeline * timeline)
+_index_clip (GESTimeline * timeline, GESClip * clip)
 {
-  GList *trackelements, *tmp;
+  ClipEntry *entry;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  /* Clips moving from a layer to another stay indexed */
+  if (priv->clip_entries == NULL ||
+      g_hash_table_lookup (priv->clip_entries, clip))
+    return;
+
+  g_mutex_lock (&priv->query_lock);
+  entry = g_slice_new0 (ClipEntry);
+  entry->by_start = g_sequence_insert_sorted (priv->clips_by_start, clip,
+      (GCompareDataFunc) _compare_clips_by_start, NULL);
+  entry->by_duration = g_sequence_insert_sorted (priv->clips_by_duration,
+      clip, (GCompareDataFunc) _compare_clips_by_duration, NULL);
+  _index_clip_asset (timeline, clip, entry);
+  g_hash_table_insert (priv->clip_entries, clip, entry);
+  priv->query_cookie++;
+  g_mutex_unlock (&priv->query_lock);
+
+  g_signal_connect (clip, "notify::start",
+      G_CALLBACK (_indexed_clip_moved_cb), timeline);
+  g_signal_connect (clip, "notify::duration",
+      G_CALLBACK (_indexed_clip_moved_cb), timeline);
+}
+
+static void
+_unindex_clip (GESTimeline * timeline, GESClip * clip)
+{
+  ClipEntry *entry;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  if (priv->clip_entries == NULL)
+    return;
+
+  entry = g_hash_table_lookup (priv->clip_entries, clip);
+  if (entry == NULL)
+    return;
+
+  g_signal_handlers_disconnect_by_func (clip, _indexed_clip_moved_cb,
+      timeline);
+
+  g_mutex_lock (&priv->query_lock);
+  g_sequence_remove (entry->by_start);
+  g_sequence_remove (entry->by_duration);
+  _unindex_clip_asset (timeline, clip, entry);
+  g_hash_table_remove (priv->clip_entries, clip);
+  priv->query_cookie++;
+  g_mutex_unlock (&priv->query_lock);
+}
+
+void
+timeline_update_clip_asset (GESTimeline * timeline, GESClip * clip)
+{
+  ClipEntry *entry;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  if (priv->clip_entries == NULL)
+    return;
+
+  g_mutex_lock (&priv->query_lock);
+  entry = g_hash_table_lookup (priv->clip_entries, clip);
+  if (entry && entry->asset !=
+      ges_extractable_get_asset (GES_EXTRACTABLE (clip))) {
+    _unindex_clip_asset (timeline, clip, entry);
+    _index_clip_asset (timeline, clip, entry);
+    priv->query_cookie++;
+  }
+  g_mutex_unlock (&priv->query_lock);
+}
+
+/* The first clip starting at or after @position, call with query_lock
+ * held */
+static GSequenceIter *
+_find_first_clip_from (GESTimelinePrivate * priv, GstClockTime position)
+{
+  GSequenceIter *begin = g_sequence_get_begin_iter (priv->clips_by_start);
+  GSequenceIter *end = g_sequence_get_end_iter (priv->clips_by_start);
+
+  while (begin != end) {
+    GSequenceIter *middle = g_sequence_range_get_midpoint (begin, end);
+
+    if (_START (g_sequence_get (middle)) < position)
+      begin = g_sequence_iter_next (middle);
+    else
+      end = middle;
+  }
+
+  return begin;
+}
+
+typedef struct
+{
+  GstIterator parent;
+
+  GESTimeline *timeline;
+  GstClockTime start;
+  GstClockTime stop;
+  guint32 first_layer;
+  guint32 last_layer;
+
+  GSequenceIter *iter;
+} ClipRangeIterator;
+
+/* Clips overlapping @start can not start more than the longest clip
+ * duration before it, call with query_lock held */
+static void
+_clip_range_iterator_resync (ClipRangeIterator * it)
+{
+  GESTimelinePrivate *priv = it->timeline->priv;
+  GstClockTime longest = 0;
+
+  if (g_sequence_get_length (priv->clips_by_duration))
+    longest = _DURATION (g_sequence_get (g_sequence_iter_prev
+            (g_sequence_get_end_iter (priv->clips_by_duration))));
+
+  it->iter = _find_first_clip_from (priv,
+      it->start > longest ? it->start - longest : 0);
+}
+
+static GstIteratorResult
+_clip_range_iterator_next (ClipRangeIterator * it, GValue * result)
+{
+  while (!g_sequence_iter_is_end (it->iter)) {
+    guint32 priority;
+    GESClip *clip = g_sequence_get (it->iter);
+
+    if (_START (clip) >= it->stop)
+      break;
+
+    it->iter = g_sequence_iter_next (it->iter);
+    if (_END (clip) <= it->start)
+      continue;
+
+    priority = ges_clip_get_layer_priority (clip);
+    if (priority < it->first_layer || priority > it->last_layer)
+      continue;
+
+    g_value_set_object (result, clip);
+    return GST_ITERATOR_OK;
+  }
+
+  return GST_ITERATOR_DONE;
+}
+
+static void
+_clip_range_iterator_copy (const ClipRangeIterator * it,
+    ClipRangeIterator * copy)
+{
+  copy->timeline = gst_object_ref (it->timeline);
+}
+
+static void
+_clip_range_iterator_free (ClipRangeIterator * it)
+{
+  gst_object_unref (it->timeline);
+}
+
+typedef struct
+{
+  GstIterator parent;
+
+  GESTimeline *timeline;
+  GESAsset *asset;
+
+  GHashTableIter iter;
+  gboolean done;
+} ClipAssetIterator;
+
+/* Call with query_lock held */
+static void
+_clip_asset_iterator_resync (ClipAssetIterator * it)
+{
+  GHashTable *clips = g_hash_table_lookup (it->timeline->priv->clips_by_asset,
+      it->asset);
+
+  it->done = clips == NULL;
+  if (clips)
+    g_hash_table_iter_init (&it->iter, clips);
+}
+
+static GstIteratorResult
+_clip_asset_iterator_next (ClipAssetIterator * it, GValue * result)
+{
+  GESClip *clip;
+
+  if (it->done || !g_hash_table_iter_next (&it->iter, (gpointer *) & clip,
+          NULL)) {
+    it->done = TRUE;
+
+    return GST_ITERATOR_DONE;
+  }
+
+  g_value_set_object (result, clip);
+
+  return GST_ITERATOR_OK;
+}
+
+static void
+_clip_asset_iterator_copy (const ClipAssetIterator * it,
+    ClipAssetIterator * copy)
+{
+  copy->timeline = gst_object_ref (it->timeline);
+  copy->asset = gst_object_ref (it->asset);
+}
+
+static void
+_clip_asset_iterator_free (ClipAssetIterator * it)
+{
+  gst_object_unref (it->timeline);
+  gst_object_unref (it->asset);
+}
+
+static void
+layer_object_added_cb (GESLayer * layer, GESClip * clip, GESTimeline * timeline)
+{
+  GESProject *project;
+
+  timeline_invalidate_clip_hash (timeline, clip);
+
+  /* Clips of layers added before us do not have their timeline set */
+  ges_meta_container_set_store (GES_META_CONTAINER (clip),
+      timeline->priv->meta_store);
+  _index_clip (timeline, clip);
+
+  /* We make sure not to be connected twice */
+  g_signal_handlers_disconnect_by_func (clip, clip_track_element_added_cb,
+      timeline);
+  g_signal_handlers_disconnect_by_func (clip, clip_track_element_removed_cb,
+      timeline);
+
+  /* And we connect to the object */
+  g_signal_connect (clip, "child-added",
+      G_CALLBACK (clip_track_element_added_cb), timeline);
+  g_signal_connect (clip, "child-removed",
+      G_CALLBACK (clip_track_element_removed_cb), timeline);
+
+  if (ges_clip_is_moving_from_layer (clip)) {
+    GST_DEBUG ("Clip %p moving from one layer to another, not creating "
+        "TrackElement", clip);
+    timeline->priv->movecontext.needs_move_ctx = TRUE;
+    if (!timeline->priv->transitions_frozen)
+      _create_transitions_on_layer (timeline, layer, NULL, NULL,
+          _find_transition_from_auto_transitions);
+    return;
+  }
+
+
+  add_object_to_tracks (timeline, clip, NULL);
+
+  GST_DEBUG ("Making sure that the asset is in our project");
+  project =
+      GES_PROJECT (ges_extractable_get_asset (GES_EXTRACTABLE (timeline)));
+  ges_project_add_asset (project,
+      ges_extractable_get_asset (GES_EXTRACTABLE (clip)));
+
+  GST_DEBUG ("Done");
+}
+
+static void
+layer_priority_changed_cb (GESLayer * layer,
+    GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
+{
+  GList *clips;
+
+  timeline->layers = g_list_sort (timeline->layers, (GCompareFunc)
+      sort_layers);
+
+  /* The layer priority is part of the hash of its clips */
+  if (timeline->priv->clip_hashes) {
+    for (clips = _ges_layer_get_loaded_clips (layer); clips;
+        clips = g_list_delete_link (clips, clips)) {
+      timeline_invalidate_clip_hash (timeline, clips->data);
+      gst_object_unref (clips->data);
+    }
+  }
+}
+
+static void
+layer_object_removed_cb (GESLayer * layer, GESClip * clip,
+    GESTimeline * timeline)
+{
+  GList *trackelements, *tmp;
+
+  timeline_invalidate_clip_hash (timeline, clip);
 
   if (ges_clip_is_moving_from_layer (clip)) {
     GST_DEBUG ("Clip %p is moving from a layer to another, not doing"
@@ -2151,6 +2975,8 @@ layer_object_removed_cb (GESLayer * layer, GESClip * clip,
       timeline);
   g_signal_handlers_disconnect_by_func (clip, clip_track_element_removed_cb,
       timeline);
+  ges_meta_container_set_store (GES_META_CONTAINER (clip), NULL);
+  _unindex_clip (timeline, clip);
 
   g_list_free_full (trackelements, gst_object_unref);
 
@@ -2268,6 +3094,9 @@ track_element_added_cb (GESTrack * track, GESTrackElement * track_element,
       "notify::priority", G_CALLBACK (trackelement_priority_changed_cb),
       timeline);
 
+  if (timeline->priv->profiling)
+    ges_track_element_set_profiling (track_element, TRUE);
+
   start_tracking_track_element (timeline, track_element);
 }
 
@@ -2289,6 +3118,8 @@ track_element_removed_cb (GESTrack * track,
   g_signal_handlers_disconnect_by_func (track_element,
       trackelement_priority_changed_cb, timeline);
 
+  ges_track_element_set_profiling (track_element, FALSE);
+
   stop_tracking_track_element (timeline, track_element);
 }
 
@@ -2586,7 +3417,7 @@ ges_timeline_add_layer (GESTimeline * timeline, GESLayer * layer)
   g_signal_emit (timeline, ges_timeline_signals[LAYER_ADDED], 0, layer);
 
   /* add any existing clips to the timeline */
-  objects = ges_layer_get_clips (layer);
+  objects = _ges_layer_get_loaded_clips (layer);
   for (tmp = objects; tmp; tmp = tmp->next) {
     layer_object_added_cb (layer, tmp->data, timeline);
     gst_object_unref (tmp->data);
@@ -2623,7 +3454,7 @@ ges_timeline_remove_layer (GESTimeline * timeline, GESLayer * layer)
 
   /* remove objects from any private data structures */
 
-  layer_objects = ges_layer_get_clips (layer);
+  layer_objects = _ges_layer_get_loaded_clips (layer);
   for (tmp = layer_objects; tmp; tmp = tmp->next) {
     layer_object_removed_cb (layer, GES_CLIP (tmp->data), timeline);
     gst_object_unref (G_OBJECT (tmp->data));
@@ -2722,7 +3553,7 @@ ges_timeline_add_track (GESTimeline * timeline, GESTrack * track)
 
   for (tmp = timeline->layers; tmp; tmp = tmp->next) {
     GList *objects, *obj;
-    objects = ges_layer_get_clips (tmp->data);
+    objects = _ges_layer_get_loaded_clips (tmp->data);
 
     for (obj = objects; obj; obj = obj->next) {
       GESClip *clip = obj->data;
@@ -2918,6 +3749,13 @@ ges_timeline_commit (GESTimeline * timeline)
         NULL, NULL, _find_transition_from_auto_transitions);
   }
 
+  ges_render_cache_update (timeline->priv->render_cache);
+
+  /* Record the commited state so changes can be tracked later on, only if
+   * someone cares, hashing is O(number of changed elements) */
+  if (timeline->priv->track_commits)
+    ges_timeline_get_content_hash (timeline);
+
   for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
     if (!ges_track_commit (GES_TRACK (tmp->data)))
       res = FALSE;
@@ -2936,7 +3774,9 @@ ges_timeline_commit (GESTimeline * timeline)
  * ges_timeline_get_duration:
  * @timeline: a #GESTimeline
  *
- * Get the current duration of @timeline
+ * Get the current duration of @timeline. When @timeline is loaded lazily,
+ * the end of the clips that have not been created yet is taken into account
+ * without creating them.
  *
  * Returns: The current duration of @timeline
  */
@@ -2945,7 +3785,7 @@ ges_timeline_get_duration (GESTimeline * timeline)
 {
   g_return_val_if_fail (GES_IS_TIMELINE (timeline), GST_CLOCK_TIME_NONE);
 
-  return timeline->priv->duration;
+  return MAX (timeline->priv->duration, timeline->priv->unloaded_end);
 }
 
 /**
@@ -3027,3 +3867,999 @@ ges_timeline_set_snapping_distance (GESTimeline * timeline,
 
   timeline->priv->snapping_distance = snapping_distance;
 }
+
+/**
+ * ges_timeline_get_snapping_playhead:
+ * @timeline: a #GESTimeline
+ *
+ * Gets the #GESTimeline:snapping-playhead property of the timeline.
+ *
+ * Returns: The position moving objects snap to, or #GST_CLOCK_TIME_NONE
+ */
+GstClockTime
+ges_timeline_get_snapping_playhead (GESTimeline * timeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), GST_CLOCK_TIME_NONE);
+
+  return timeline->priv->snapping_playhead;
+}
+
+/**
+ * ges_timeline_set_snapping_playhead:
+ * @timeline: a #GESTimeline
+ * @position: the position of the playhead, or #GST_CLOCK_TIME_NONE
+ *
+ * Sets the position of the playhead, objects moved closer than
+ * #GESTimeline:snapping-distance from it will snap to it.
+ */
+void
+ges_timeline_set_snapping_playhead (GESTimeline * timeline,
+    GstClockTime position)
+{
+  GESTimelinePrivate *priv;
+  GstClockTime old_position;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  priv = timeline->priv;
+  old_position = priv->snapping_playhead;
+  if (old_position == position)
+    return;
+
+  priv->snapping_playhead = position;
+  if (!GST_CLOCK_TIME_IS_VALID (old_position)) {
+    timeline_add_snap_point (timeline, &priv->snapping_playhead);
+  } else if (!GST_CLOCK_TIME_IS_VALID (position)) {
+    priv->snapping_playhead = old_position;
+    timeline_remove_snap_point (timeline, &priv->snapping_playhead);
+    priv->snapping_playhead = GST_CLOCK_TIME_NONE;
+  } else {
+    timeline_snap_point_moved (timeline, &priv->snapping_playhead,
+        old_position);
+  }
+
+  g_object_notify_by_pspec (G_OBJECT (timeline),
+      properties[PROP_SNAPPING_PLAYHEAD]);
+}
+
+/**
+ * ges_timeline_get_marker_list:
+ * @timeline: a #GESTimeline
+ *
+ * Gets the markers of @timeline, which objects being moved snap to just like
+ * they snap to the edges of the other objects.
+ *
+ * Returns: (transfer none): The #GESMarkerList of @timeline
+ */
+GESMarkerList *
+ges_timeline_get_marker_list (GESTimeline * timeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+
+  return timeline->priv->markers;
+}
+
+/**
+ * ges_timeline_get_profiling:
+ * @timeline: a #GESTimeline
+ *
+ * Gets whether the track elements of @timeline are being profiled.
+ *
+ * Returns: %TRUE if @timeline is profiling its track elements
+ */
+gboolean
+ges_timeline_get_profiling (GESTimeline * timeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+
+  return timeline->priv->profiling;
+}
+
+/**
+ * ges_timeline_set_profiling:
+ * @timeline: a #GESTimeline
+ * @profiling: whether to profile the track elements
+ *
+ * Starts or stops measuring the processing time of every #GESTrackElement
+ * of @timeline, including the ones added later on. Stopping drops what was
+ * measured so far. See ges_timeline_get_profile().
+ */
+void
+ges_timeline_set_profiling (GESTimeline * timeline, gboolean profiling)
+{
+  GList *tmp, *elements, *tmpelement;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  profiling = ! !profiling;
+  if (timeline->priv->profiling == profiling)
+    return;
+
+  timeline->priv->profiling = profiling;
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
+    elements = ges_track_get_elements (tmp->data);
+    for (tmpelement = elements; tmpelement; tmpelement = tmpelement->next)
+      ges_track_element_set_profiling (tmpelement->data, profiling);
+    g_list_free_full (elements, gst_object_unref);
+  }
+
+  g_object_notify_by_pspec (G_OBJECT (timeline), properties[PROP_PROFILING]);
+}
+
+static gint
+_compare_profiles (const GstStructure * a, const GstStructure * b)
+{
+  guint64 atime = 0, btime = 0;
+
+  gst_structure_get_uint64 (a, "processing-time", &atime);
+  gst_structure_get_uint64 (b, "processing-time", &btime);
+
+  /* Most expensive first */
+  return atime < btime ? 1 : atime > btime ? -1 : 0;
+}
+
+/**
+ * ges_timeline_get_profile:
+ * @timeline: a #GESTimeline
+ *
+ * Gets what was measured since #GESTimeline:profiling was enabled, as a
+ * #GstStructure named "ges-profile" with an "elements" #GST_TYPE_ARRAY
+ * field. It holds one "ges-element-profile" #GstStructure per
+ * #GESTrackElement, the ones that took the most processing time first,
+ * with the following fields:
+ *
+ * - "track-element" (#GES_TYPE_TRACK_ELEMENT): the profiled track element
+ * - "type" (#G_TYPE_STRING): its type name
+ * - "track-type" (#GES_TYPE_TRACK_TYPE) and "start" (#G_TYPE_UINT64)
+ * - "element" (#G_TYPE_STRING): the name of its GNonLin object
+ * - "layer" (#G_TYPE_INT): the priority of the layer of its clip
+ * - "asset" (#G_TYPE_STRING): the id of the asset of its clip
+ * - "buffers" (#G_TYPE_UINT64): the number of buffers it output
+ * - "processing-time" (#G_TYPE_UINT64): CPU time spent producing them, in
+ *   nanoseconds, wall clock time where the CPU time of a thread can not be
+ *   measured. For sources it includes the time spent downstream of them in
+ *   their streaming thread by the mixer.
+ * - "latency" (#G_TYPE_UINT64): for effects and transitions, the average
+ *   time between a buffer coming in and the result going out
+ * - "startup-latency" (#G_TYPE_UINT64): the average time between the
+ *   stream starting or being flushed and the first buffer being output
+ *
+ * Latencies are #GST_CLOCK_TIME_NONE when nothing could be measured.
+ *
+ * Returns: (transfer full): The profile of the track elements of @timeline
+ */
+GstStructure *
+ges_timeline_get_profile (GESTimeline * timeline)
+{
+  GList *tmp, *elements, *tmpelement, *profiles = NULL;
+  GstStructure *res;
+  GValue array = { 0 };
+  GValue item = { 0 };
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
+    elements = ges_track_get_elements (tmp->data);
+    for (tmpelement = elements; tmpelement; tmpelement = tmpelement->next) {
+      GstStructure *profile =
+          ges_track_element_get_profile (tmpelement->data);
+
+      if (profile)
+        profiles = g_list_prepend (profiles, profile);
+    }
+    g_list_free_full (elements, gst_object_unref);
+  }
+  profiles = g_list_sort (profiles, (GCompareFunc) _compare_profiles);
+
+  g_value_init (&array, GST_TYPE_ARRAY);
+  g_value_init (&item, GST_TYPE_STRUCTURE);
+  for (tmp = profiles; tmp; tmp = tmp->next) {
+    g_value_take_boxed (&item, tmp->data);
+    gst_value_array_append_value (&array, &item);
+  }
+  g_value_unset (&item);
+  g_list_free (profiles);
+
+  res = gst_structure_new_empty ("ges-profile");
+  gst_structure_take_value (res, "elements", &array);
+
+  return res;
+}
+
+/**
+ * ges_timeline_find_elements_by_meta:
+ * @timeline: a #GESTimeline
+ * @meta_item: The name of the meta to look for
+ * @value: The value @meta_item must have
+ *
+ * Looks for the elements of @timeline (clips, groups and track elements)
+ * whose @meta_item is set to @value, like all the clips of a given scene.
+ *
+ * The first lookup of a given @meta_item indexes its values, later lookups
+ * of that meta only cost a hash table lookup. When @timeline is loaded
+ * lazily, the clips having @meta_item set are created first.
+ *
+ * Returns: (transfer full) (element-type GESTimelineElement): The elements
+ * having @value for @meta_item, sorted by start
+ */
+GList *
+ges_timeline_find_elements_by_meta (GESTimeline * timeline,
+    const gchar * meta_item, const GValue * value)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+  g_return_val_if_fail (meta_item != NULL, NULL);
+  g_return_val_if_fail (G_IS_VALUE (value), NULL);
+
+  _lazy_load (timeline, NULL, 0, GST_CLOCK_TIME_NONE, NULL, meta_item);
+  if (timeline->priv->meta_store == NULL)
+    return NULL;
+
+  return g_list_sort (ges_meta_store_find (timeline->priv->meta_store,
+          meta_item, value), (GCompareFunc) element_start_compare);
+}
+
+GESMetaStore *
+_ges_timeline_get_meta_store (GESTimeline * timeline)
+{
+  return timeline->priv->meta_store;
+}
+
+/**
+ * ges_timeline_iterate_clips_in_range:
+ * @timeline: a #GESTimeline
+ * @start: The start of the range
+ * @stop: The end of the range, excluded
+ * @first_layer: The priority of the first layer to look into
+ * @last_layer: The priority of the last layer to look into, %G_MAXUINT32 for
+ * all the layers from @first_layer
+ *
+ * Iterates over the clips of @timeline overlapping [@start, @stop) in the
+ * layers whose priority goes from @first_layer to @last_layer, for example
+ * the clips in a selection rectangle. The clips are sorted by start.
+ *
+ * The clips are not copied into a list, they are looked up in indexes the
+ * timeline keeps up to date, so the iterator has to be resynced if
+ * @timeline changes while iterating over it.
+ *
+ * When @timeline is loaded lazily, the clips overlapping the range are
+ * created first, see ges_timeline_load_range(). Clips loaded by something
+ * else while iterating make the iterator resync.
+ *
+ * Returns: (transfer full): A #GstIterator of #GESClip
+ */
+GstIterator *
+ges_timeline_iterate_clips_in_range (GESTimeline * timeline,
+    GstClockTime start, GstClockTime stop, guint32 first_layer,
+    guint32 last_layer)
+{
+  ClipRangeIterator *it;
+  GESTimelinePrivate *priv;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (start), NULL);
+  g_return_val_if_fail (start <= stop, NULL);
+
+  timeline_load_range (timeline, NULL, start, stop);
+
+  priv = timeline->priv;
+  g_mutex_lock (&priv->query_lock);
+  it = (ClipRangeIterator *) gst_iterator_new (sizeof (ClipRangeIterator),
+      GES_TYPE_CLIP, &priv->query_lock, &priv->query_cookie,
+      (GstIteratorCopyFunction) _clip_range_iterator_copy,
+      (GstIteratorNextFunction) _clip_range_iterator_next,
+      (GstIteratorItemFunction) NULL,
+      (GstIteratorResyncFunction) _clip_range_iterator_resync,
+      (GstIteratorFreeFunction) _clip_range_iterator_free);
+
+  it->timeline = gst_object_ref (timeline);
+  it->start = start;
+  it->stop = stop;
+  it->first_layer = first_layer;
+  it->last_layer = last_layer;
+  _clip_range_iterator_resync (it);
+  g_mutex_unlock (&priv->query_lock);
+
+  return GST_ITERATOR (it);
+}
+
+/**
+ * ges_timeline_iterate_clips_at:
+ * @timeline: a #GESTimeline
+ * @position: A position in @timeline
+ *
+ * Iterates over the clips of @timeline being played at @position in all
+ * the layers, for example the ones under the playhead. See
+ * ges_timeline_iterate_clips_in_range().
+ *
+ * Returns: (transfer full): A #GstIterator of #GESClip
+ */
+GstIterator *
+ges_timeline_iterate_clips_at (GESTimeline * timeline, GstClockTime position)
+{
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), NULL);
+
+  return ges_timeline_iterate_clips_in_range (timeline, position,
+      position + 1, 0, G_MAXUINT32);
+}
+
+/**
+ * ges_timeline_iterate_clips_by_asset:
+ * @timeline: a #GESTimeline
+ * @asset: A #GESAsset
+ *
+ * Iterates over the clips of @timeline extracted from @asset, in no
+ * particular order. As with ges_timeline_iterate_clips_in_range(), the clips
+ * are looked up in an index of @timeline. When @timeline is loaded lazily,
+ * the clips extracted from @asset are created first.
+ *
+ * Returns: (transfer full): A #GstIterator of #GESClip
+ */
+GstIterator *
+ges_timeline_iterate_clips_by_asset (GESTimeline * timeline, GESAsset * asset)
+{
+  ClipAssetIterator *it;
+  GESTimelinePrivate *priv;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+  g_return_val_if_fail (GES_IS_ASSET (asset), NULL);
+
+  _lazy_load (timeline, NULL, 0, GST_CLOCK_TIME_NONE, asset, NULL);
+
+  priv = timeline->priv;
+  g_mutex_lock (&priv->query_lock);
+  it = (ClipAssetIterator *) gst_iterator_new (sizeof (ClipAssetIterator),
+      GES_TYPE_CLIP, &priv->query_lock, &priv->query_cookie,
+      (GstIteratorCopyFunction) _clip_asset_iterator_copy,
+      (GstIteratorNextFunction) _clip_asset_iterator_next,
+      (GstIteratorItemFunction) NULL,
+      (GstIteratorResyncFunction) _clip_asset_iterator_resync,
+      (GstIteratorFreeFunction) _clip_asset_iterator_free);
+
+  it->timeline = gst_object_ref (timeline);
+  it->asset = gst_object_ref (asset);
+  _clip_asset_iterator_resync (it);
+  g_mutex_unlock (&priv->query_lock);
+
+  return GST_ITERATOR (it);
+}
+
+void
+timeline_set_lazy_loader (GESTimeline * timeline,
+    GESTimelineLoadRangeFunc func, GstClockTime unloaded_end,
+    gpointer user_data, GDestroyNotify destroy)
+{
+  GESTimelinePrivate *priv = timeline->priv;
+
+  _clear_lazy_loader (timeline);
+
+  priv->lazy_load = func;
+  priv->lazy_load_data = user_data;
+  priv->lazy_load_destroy = destroy;
+  priv->unloaded_end = unloaded_end;
+}
+
+static void
+_lazy_load (GESTimeline * timeline, GESLayer * layer, GstClockTime start,
+    GstClockTime stop, GESAsset * asset, const gchar * meta_item)
+{
+  GESTimelinePrivate *priv = timeline->priv;
+
+  /* Handlers of the clip-added signals can query the timeline while we are
+   * adding the clips */
+  if (priv->lazy_load == NULL || priv->lazy_loading)
+    return;
+
+  GST_DEBUG_OBJECT (timeline, "Loading the clips of %" GST_PTR_FORMAT
+      " between %" GST_TIME_FORMAT " and %" GST_TIME_FORMAT " (asset: %"
+      GST_PTR_FORMAT ", meta: %s)", layer, GST_TIME_ARGS (start),
+      GST_TIME_ARGS (stop), asset, GST_STR_NULL (meta_item));
+
+  priv->lazy_loading = TRUE;
+  if (!priv->lazy_load (timeline, layer, start, stop, asset, meta_item,
+          &priv->unloaded_end, priv->lazy_load_data)) {
+    GST_INFO_OBJECT (timeline, "All the clips have been loaded");
+    _clear_lazy_loader (timeline);
+  }
+  priv->lazy_loading = FALSE;
+}
+
+void
+timeline_load_range (GESTimeline * timeline, GESLayer * layer,
+    GstClockTime start, GstClockTime stop)
+{
+  _lazy_load (timeline, layer, start, stop, NULL, NULL);
+}
+
+/* Loads all the clips that are left, unless the application chose what to
+ * load itself. Returns %TRUE if some clips were loaded */
+gboolean
+timeline_load_for_playback (GESTimeline * timeline)
+{
+  if (timeline->priv->lazy_load == NULL || timeline->priv->range_loaded)
+    return FALSE;
+
+  timeline_load_range (timeline, NULL, 0, GST_CLOCK_TIME_NONE);
+
+  return TRUE;
+}
+
+/* The duration of the clips created so far, without loading the others */
+GstClockTime
+timeline_get_loaded_duration (GESTimeline * timeline)
+{
+  return timeline->priv->duration;
+}
+
+/**
+ * ges_timeline_load_range:
+ * @timeline: a #GESTimeline
+ * @start: The start of the range
+ * @stop: The end of the range, excluded, %GST_CLOCK_TIME_NONE for the end
+ * of @timeline
+ *
+ * When @timeline was extracted from a #GESProject with
+ * #GESProject:lazy-loading set, creates the clips overlapping
+ * [@start, @stop) that were not needed until now. As any other change, they
+ * are only taken into account once @timeline is commited.
+ *
+ * Querying the clips of a layer, or iterating over the clips of a range
+ * loads them automatically. By default, all the remaining clips are loaded
+ * when a #GESPipeline starts playing @timeline. Once this function has been
+ * called, the application has to load what it wants to be played itself,
+ * for example to render a single range of a big project without loading the
+ * rest of it.
+ */
+void
+ges_timeline_load_range (GESTimeline * timeline, GstClockTime start,
+    GstClockTime stop)
+{
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (start));
+  g_return_if_fail (start <= stop);
+
+  timeline->priv->range_loaded = TRUE;
+  timeline_load_range (timeline, NULL, start, stop);
+}
+
+/**
+ * ges_timeline_is_fully_loaded:
+ * @timeline: a #GESTimeline
+ *
+ * Checks whether all the clips of a lazily loaded @timeline have been
+ * created, see ges_timeline_load_range().
+ *
+ * Returns: %FALSE if some clips of @timeline have not been loaded yet,
+ * %TRUE otherwise
+ */
+gboolean
+ges_timeline_is_fully_loaded (GESTimeline * timeline)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+
+  return timeline->priv->lazy_load == NULL;
+}
+
+/**
+ * ges_timeline_add_render_cache_region:
+ * @timeline: a #GESTimeline
+ * @start: The start of the region to cache
+ * @duration: The duration of the region to cache
+ *
+ * Marks a region of @timeline as being too complex to be played in realtime.
+ * When @timeline is commited, that region is rendered in the background into
+ * the #GESTimeline:render-cache-directory, and once this is done, the
+ * rendered file is played instead of the clips of the region.
+ *
+ * The region gets extended so that it fully contains all the clips that
+ * overlap it. As soon as any of those clips (or their children) change, the
+ * original clips are played again until a new rendering is available.
+ *
+ * Returns: %TRUE if the region could be added, %FALSE if it overlaps an
+ * existing region
+ */
+gboolean
+ges_timeline_add_render_cache_region (GESTimeline * timeline,
+    GstClockTime start, GstClockTime duration)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (start), FALSE);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (duration) && duration > 0,
+      FALSE);
+
+  return ges_render_cache_add_region (timeline->priv->render_cache, start,
+      duration);
+}
+
+/**
+ * ges_timeline_remove_render_cache_region:
+ * @timeline: a #GESTimeline
+ * @start: The start of the region, as passed to
+ * #ges_timeline_add_render_cache_region
+ * @duration: The duration of the region, as passed to
+ * #ges_timeline_add_render_cache_region
+ *
+ * Stops using the render cache for that region, the change will be taken
+ * into account on the next #ges_timeline_commit.
+ *
+ * Returns: %TRUE if the region was removed, %FALSE if no such region exists
+ */
+gboolean
+ges_timeline_remove_render_cache_region (GESTimeline * timeline,
+    GstClockTime start, GstClockTime duration)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+
+  return ges_render_cache_remove_region (timeline->priv->render_cache, start,
+      duration);
+}
+
+/* A ClipHashEntry added (+1) or removed (-1) between two snapshots */
+typedef struct
+{
+  const ClipHashEntry *entry;
+  gint count;
+} ClipHashChange;
+
+static gint
+_compare_clip_hash_changes (const ClipHashChange * a,
+    const ClipHashChange * b)
+{
+  if (a->entry->hash < b->entry->hash)
+    return -1;
+  if (a->entry->hash > b->entry->hash)
+    return 1;
+
+  return 0;
+}
+
+static void
+_append_clip_hash_changes (GArray * changes, GArray * entries, gint count)
+{
+  guint i;
+
+  for (i = 0; i < entries->len; i++) {
+    ClipHashChange change =
+        { &g_array_index (entries, ClipHashEntry, i), count };
+
+    g_array_append_val (changes, change);
+  }
+}
+
+static guint64
+_compute_tracks_hash (GESTimeline * timeline)
+{
+  GList *tmp;
+  guint64 res;
+  GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+  for (tmp = timeline->tracks; tmp; tmp = tmp->next) {
+    GValue val = { 0, };
+    GESTrack *track = tmp->data;
+
+    g_value_init (&val, GST_TYPE_CAPS);
+    g_value_set_boxed (&val, ges_track_get_caps (track));
+    _ges_checksum_update_value (checksum, "caps", &val);
+    g_value_reset (&val);
+    g_object_get_property (G_OBJECT (track), "restriction-caps", &val);
+    _ges_checksum_update_value (checksum, "restriction-caps", &val);
+    g_value_unset (&val);
+
+    g_checksum_update (checksum, (const guchar *) &track->type,
+        sizeof (track->type));
+  }
+
+  res = _ges_checksum_get_uint64 (checksum);
+  g_checksum_free (checksum);
+
+  return res;
+}
+
+/* The clip hash does not know about the layer the clip is in */
+static inline guint64
+_clip_hash_in_layer (GESTimelineElement * clip, guint64 layer_prio,
+    gboolean * is_volatile)
+{
+  return _ges_timeline_element_get_content_hash (clip, is_volatile) ^
+      (layer_prio * G_GUINT64_CONSTANT (0x9E3779B97F4A7C15));
+}
+
+/* The most recent snapshot of the state with that @hash */
+static GList *
+_find_hash_snapshot (GESTimeline * timeline, guint64 hash)
+{
+  GList *tmp;
+
+  for (tmp = timeline->priv->hash_snapshots.head; tmp; tmp = tmp->next) {
+    if (((HashSnapshot *) tmp->data)->hash == hash)
+      return tmp;
+  }
+
+  return NULL;
+}
+
+/* Called whenever the content hash of @clip, or where it is, changes so
+ * that the next snapshot only hashes the clips that changed */
+void
+timeline_invalidate_clip_hash (GESTimeline * timeline, GESClip * clip)
+{
+  GESTimelinePrivate *priv = timeline->priv;
+
+  if (priv->clip_hashes == NULL ||
+      g_hash_table_contains (priv->dirty_hash_clips, clip))
+    return;
+
+  g_hash_table_add (priv->dirty_hash_clips, gst_object_ref (clip));
+}
+
+/* Updates the ClipHashEntry of @clip, recording the change in @snapshot */
+static void
+_update_clip_hash_entry (GESTimeline * timeline, GESClip * clip,
+    HashSnapshot * snapshot)
+{
+  ClipHashEntry new_entry;
+  gboolean is_volatile = FALSE;
+  GESTimelinePrivate *priv = timeline->priv;
+  GESLayer *layer = ges_clip_get_layer (clip);
+  ClipHashEntry *entry = g_hash_table_lookup (priv->clip_hashes, clip);
+
+  if (layer == NULL || ges_layer_get_timeline (layer) != timeline) {
+    /* Removed from the timeline */
+    if (entry) {
+      g_array_append_val (snapshot->removed, *entry);
+      g_hash_table_remove (priv->clip_hashes, clip);
+    }
+
+    goto done;
+  }
+
+  new_entry.hash = _clip_hash_in_layer (GES_TIMELINE_ELEMENT (clip),
+      ges_layer_get_priority (layer), &is_volatile);
+  new_entry.start = _START (clip);
+  new_entry.stop = _END (clip);
+
+  /* Its hash has to be computed again next time */
+  if (is_volatile)
+    timeline_invalidate_clip_hash (timeline, clip);
+
+  if (entry && entry->hash == new_entry.hash)
+    goto done;
+
+  if (entry) {
+    g_array_append_val (snapshot->removed, *entry);
+  } else {
+    entry = g_slice_new (ClipHashEntry);
+    g_hash_table_insert (priv->clip_hashes, clip, entry);
+  }
+  *entry = new_entry;
+  g_array_append_val (snapshot->added, new_entry);
+
+done:
+  if (layer)
+    gst_object_unref (layer);
+}
+
+/* Snapshots only keep what changed since the previous one, so that
+ * recording a state is O(number of clips that changed) */
+static void
+_record_hash_snapshot (GESTimeline * timeline, guint64 hash,
+    guint64 tracks_hash)
+{
+  GList *tmp, *clips;
+  GESClip *clip;
+  GHashTable *dirty;
+  GHashTableIter iter;
+  HashSnapshot *snapshot;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  if (priv->clip_hashes == NULL) {
+    priv->clip_hashes = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+        NULL, (GDestroyNotify) _clip_hash_entry_free);
+    priv->dirty_hash_clips = g_hash_table_new_full (g_direct_hash,
+        g_direct_equal, gst_object_unref, NULL);
+
+    /* Only the first snapshot has to hash all the clips */
+    for (tmp = timeline->layers; tmp; tmp = tmp->next) {
+      for (clips = _ges_layer_get_loaded_clips (tmp->data); clips;
+          clips = g_list_delete_link (clips, clips))
+        g_hash_table_add (priv->dirty_hash_clips, clips->data);
+    }
+  }
+
+  snapshot = g_queue_peek_head (&priv->hash_snapshots);
+  if (snapshot && snapshot->hash == hash)
+    return;
+
+  snapshot = g_slice_new0 (HashSnapshot);
+  snapshot->hash = hash;
+  snapshot->tracks_hash = tracks_hash;
+  snapshot->duration = priv->duration;
+  snapshot->removed = g_array_new (FALSE, FALSE, sizeof (ClipHashEntry));
+  snapshot->added = g_array_new (FALSE, FALSE, sizeof (ClipHashEntry));
+
+  dirty = priv->dirty_hash_clips;
+  priv->dirty_hash_clips = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, gst_object_unref, NULL);
+  g_hash_table_iter_init (&iter, dirty);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & clip, NULL))
+    _update_clip_hash_entry (timeline, clip, snapshot);
+  g_hash_table_unref (dirty);
+
+  g_queue_push_head (&priv->hash_snapshots, snapshot);
+  while (g_queue_get_length (&priv->hash_snapshots) > MAX_HASH_SNAPSHOTS)
+    _hash_snapshot_free (g_queue_pop_tail (&priv->hash_snapshots));
+}
+
+/* Hash of everything that has an influence on the output of @timeline
+ * between @start and @stop */
+guint64
+_ges_timeline_get_range_hash (GESTimeline * timeline, GstClockTime start,
+    GstClockTime stop)
+{
+  GList *tmp, *clips;
+  guint64 res, tracks_hash;
+  GArray *hashes;
+  GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+  timeline_load_range (timeline, NULL, start, stop);
+
+  tracks_hash = _compute_tracks_hash (timeline);
+  g_checksum_update (checksum, (const guchar *) &tracks_hash,
+      sizeof (tracks_hash));
+  g_checksum_update (checksum, (const guchar *) &start, sizeof (start));
+  g_checksum_update (checksum, (const guchar *) &stop, sizeof (stop));
+
+  hashes = g_array_new (FALSE, FALSE, sizeof (guint64));
+  for (tmp = timeline->layers; tmp; tmp = tmp->next) {
+    guint64 prio = ges_layer_get_priority (tmp->data);
+
+    for (clips = _ges_layer_get_loaded_clips (tmp->data); clips;
+        clips = g_list_delete_link (clips, clips)) {
+      GESTimelineElement *clip = clips->data;
+
+      if (_START (clip) < stop && _END (clip) > start) {
+        guint64 hash = _clip_hash_in_layer (clip, prio, NULL);
+
+        g_array_append_val (hashes, hash);
+      }
+      gst_object_unref (clip);
+    }
+  }
+  _ges_checksum_update_hashes (checksum, hashes);
+
+  res = _ges_checksum_get_uint64 (checksum);
+  g_array_free (hashes, TRUE);
+  g_checksum_free (checksum);
+
+  return res;
+}
+
+/* Hash of what @clip outputs between @start and @stop, the same wherever
+ * that range is in the timeline */
+static guint64
+_clip_hash_in_segment (GESTimelineElement * clip, guint64 layer_prio,
+    GstClockTime start, GstClockTime stop)
+{
+  guint64 res, data[5];
+  GstClockTime cstart = MAX (_START (clip), start);
+  GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+  data[0] = _ges_timeline_element_get_media_hash (clip);
+  data[1] = layer_prio;
+  data[2] = cstart - start;
+  data[3] = _INPOINT (clip) + cstart - _START (clip);
+  data[4] = MIN (_END (clip), stop) - cstart;
+  g_checksum_update (checksum, (const guchar *) data, sizeof (data));
+  res = _ges_checksum_get_uint64 (checksum);
+  g_checksum_free (checksum);
+
+  return res;
+}
+
+/* Like _ges_timeline_get_range_hash but independent of where the range is,
+ * so that the range can be found again after the timeline was rippled */
+guint64
+_ges_timeline_get_segment_hash (GESTimeline * timeline, GstClockTime start,
+    GstClockTime stop)
+{
+  GList *tmp, *clips;
+  guint64 res, tracks_hash, duration = stop - start;
+  GArray *hashes;
+  GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+  timeline_load_range (timeline, NULL, start, stop);
+
+  tracks_hash = _compute_tracks_hash (timeline);
+  g_checksum_update (checksum, (const guchar *) &tracks_hash,
+      sizeof (tracks_hash));
+  g_checksum_update (checksum, (const guchar *) &duration, sizeof (duration));
+
+  hashes = g_array_new (FALSE, FALSE, sizeof (guint64));
+  for (tmp = timeline->layers; tmp; tmp = tmp->next) {
+    guint64 prio = ges_layer_get_priority (tmp->data);
+
+    for (clips = _ges_layer_get_loaded_clips (tmp->data); clips;
+        clips = g_list_delete_link (clips, clips)) {
+      GESTimelineElement *clip = clips->data;
+
+      if (_START (clip) < stop && _END (clip) > start) {
+        guint64 hash = _clip_hash_in_segment (clip, prio, start, stop);
+
+        g_array_append_val (hashes, hash);
+      }
+      gst_object_unref (clip);
+    }
+  }
+  _ges_checksum_update_hashes (checksum, hashes);
+
+  res = _ges_checksum_get_uint64 (checksum);
+  g_array_free (hashes, TRUE);
+  g_checksum_free (checksum);
+
+  return res;
+}
+
+/**
+ * ges_timeline_get_content_hash:
+ * @timeline: a #GESTimeline
+ *
+ * Gets a hash of everything that has an influence on the output of
+ * @timeline: its tracks and the content hash of all its layers, see
+ * ges_layer_get_content_hash() and ges_timeline_element_get_content_hash().
+ * Only the parts of the timeline that changed since the last call are
+ * hashed again.
+ *
+ * The state of @timeline corresponding to the returned hash is remembered
+ * so that it can later be passed to #ges_timeline_get_changed_ranges. From
+ * the first call on, the state of @timeline is also remembered on each
+ * #ges_timeline_commit.
+ *
+ * Returns: The content hash of @timeline
+ */
+guint64
+ges_timeline_get_content_hash (GESTimeline * timeline)
+{
+  GList *tmp;
+  guint64 res, tracks_hash;
+  GArray *hashes;
+  GChecksum *checksum;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), 0);
+
+  timeline->priv->track_commits = TRUE;
+  tracks_hash = _compute_tracks_hash (timeline);
+  hashes = g_array_new (FALSE, FALSE, sizeof (guint64));
+  for (tmp = timeline->layers; tmp; tmp = tmp->next) {
+    guint64 hash = _ges_layer_get_content_hash (tmp->data, NULL);
+
+    g_array_append_val (hashes, hash);
+  }
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  g_checksum_update (checksum, (const guchar *) &tracks_hash,
+      sizeof (tracks_hash));
+  _ges_checksum_update_hashes (checksum, hashes);
+  res = _ges_checksum_get_uint64 (checksum);
+  g_checksum_free (checksum);
+  g_array_free (hashes, TRUE);
+
+  _record_hash_snapshot (timeline, res, tracks_hash);
+
+  return res;
+}
+
+static gint
+_compare_ranges (const GESTimelineRange * a, const GESTimelineRange * b)
+{
+  if (a->start < b->start)
+    return -1;
+  if (a->start > b->start)
+    return 1;
+
+  return 0;
+}
+
+/**
+ * ges_timeline_get_changed_ranges:
+ * @timeline: a #GESTimeline
+ * @from_hash: A hash previously returned by #ges_timeline_get_content_hash
+ * @to_hash: A hash previously returned by #ges_timeline_get_content_hash
+ *
+ * Computes which time ranges of @timeline have a different output
+ * between the states identified by @from_hash and @to_hash. This makes it
+ * possible to only render again the parts of a timeline that changed.
+ *
+ * Only the last 32 states of @timeline are remembered.
+ *
+ * Returns: (transfer full) (element-type GESTimelineRange): A sorted
+ * array of non overlapping #GESTimelineRange, empty if nothing changed, or
+ * %NULL if one of the hashes is not known by @timeline.
+ */
+GArray *
+ges_timeline_get_changed_ranges (GESTimeline * timeline, guint64 from_hash,
+    guint64 to_hash)
+{
+  guint i, n;
+  gint count;
+  GArray *ranges, *changes;
+  GList *from_link, *to_link, *tmp;
+  HashSnapshot *from, *to;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+
+  from_link = _find_hash_snapshot (timeline, from_hash);
+  to_link = _find_hash_snapshot (timeline, to_hash);
+  if (from_link == NULL || to_link == NULL) {
+    GST_INFO_OBJECT (timeline, "Unknown hash, can not compute changes");
+
+    return NULL;
+  }
+
+  from = from_link->data;
+  to = to_link->data;
+  ranges = g_array_new (FALSE, FALSE, sizeof (GESTimelineRange));
+  if (from == to)
+    return ranges;
+
+  if (from->tracks_hash != to->tracks_hash) {
+    GESTimelineRange range = { 0, MAX (from->duration, to->duration) };
+
+    g_array_append_val (ranges, range);
+
+    return ranges;
+  }
+
+  /* Sum up the changes of the snapshots taken after the oldest of the two
+   * up to the most recent one, which @from_link is made to be */
+  tmp = from_link;
+  while (tmp && tmp != to_link)
+    tmp = tmp->next;
+  if (tmp == NULL) {
+    tmp = from_link;
+    from_link = to_link;
+    to_link = tmp;
+  }
+
+  changes = g_array_new (FALSE, FALSE, sizeof (ClipHashChange));
+  for (tmp = to_link; tmp != from_link; tmp = tmp->prev) {
+    HashSnapshot *snapshot = tmp->prev->data;
+
+    _append_clip_hash_changes (changes, snapshot->added, 1);
+    _append_clip_hash_changes (changes, snapshot->removed, -1);
+  }
+
+  /* Clips changed and then changed back cancel out */
+  g_array_sort (changes, (GCompareFunc) _compare_clip_hash_changes);
+  for (i = 0; i < changes->len; i = n) {
+    ClipHashChange *change = &g_array_index (changes, ClipHashChange, i);
+
+    for (n = i, count = 0; n < changes->len &&
+        _compare_clip_hash_changes (change,
+            &g_array_index (changes, ClipHashChange, n)) == 0; n++)
+      count += g_array_index (changes, ClipHashChange, n).count;
+
+    if (count != 0) {
+      GESTimelineRange range = { change->entry->start, change->entry->stop };
+
+      g_array_append_val (ranges, range);
+    }
+  }
+  g_array_free (changes, TRUE);
+
+  /* Merge overlapping ranges */
+  g_array_sort (ranges, (GCompareFunc) _compare_ranges);
+  for (i = 1, n = 0; i < ranges->len; i++) {
+    GESTimelineRange *cur = &g_array_index (ranges, GESTimelineRange, n);
+    GESTimelineRange *next = &g_array_index (ranges, GESTimelineRange, i);
+
+    if (next->start <= cur->stop) {
+      cur->stop = MAX (cur->stop, next->stop);
+    } else {
+      n++;
+      g_array_index (ranges, GESTimelineRange, n) = *next;
+    }
+  }
+  if (ranges->len)
+    g_array_set_size (ranges, n + 1);
+
+  return ranges;
+}
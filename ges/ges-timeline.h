@@ -78,6 +78,18 @@ struct _GESTimeline {
   gpointer _ges_reserved[GES_PADDING];
 };
 
+/**
+ * GESTimelineRange:
+ * @start: The start of the range
+ * @stop: The end of the range
+ *
+ * A time range of a #GESTimeline, see #ges_timeline_get_changed_ranges.
+ */
+typedef struct {
+  GstClockTime start;
+  GstClockTime stop;
+} GESTimelineRange;
+
 /**
  * GESTimelineClass:
  * @parent_class: parent class
@@ -124,6 +136,33 @@ gboolean ges_timeline_get_auto_transition (GESTimeline * timeline);
 void ges_timeline_set_auto_transition (GESTimeline * timeline, gboolean auto_transition);
 GstClockTime ges_timeline_get_snapping_distance (GESTimeline * timeline);
 void ges_timeline_set_snapping_distance (GESTimeline * timeline, GstClockTime snapping_distance);
+GstClockTime ges_timeline_get_snapping_playhead (GESTimeline * timeline);
+void ges_timeline_set_snapping_playhead (GESTimeline * timeline, GstClockTime position);
+GESMarkerList * ges_timeline_get_marker_list (GESTimeline * timeline);
+gboolean ges_timeline_get_profiling (GESTimeline * timeline);
+void ges_timeline_set_profiling (GESTimeline * timeline, gboolean profiling);
+GstStructure * ges_timeline_get_profile (GESTimeline * timeline);
+GList * ges_timeline_find_elements_by_meta (GESTimeline * timeline,
+    const gchar * meta_item, const GValue * value);
+GstIterator * ges_timeline_iterate_clips_in_range (GESTimeline * timeline,
+    GstClockTime start, GstClockTime stop, guint32 first_layer,
+    guint32 last_layer);
+GstIterator * ges_timeline_iterate_clips_at (GESTimeline * timeline,
+    GstClockTime position);
+GstIterator * ges_timeline_iterate_clips_by_asset (GESTimeline * timeline,
+    GESAsset * asset);
+void ges_timeline_load_range (GESTimeline * timeline, GstClockTime start,
+    GstClockTime stop);
+gboolean ges_timeline_is_fully_loaded (GESTimeline * timeline);
+
+gboolean ges_timeline_add_render_cache_region (GESTimeline * timeline,
+    GstClockTime start, GstClockTime duration);
+gboolean ges_timeline_remove_render_cache_region (GESTimeline * timeline,
+    GstClockTime start, GstClockTime duration);
+
+guint64 ges_timeline_get_content_hash (GESTimeline * timeline);
+GArray * ges_timeline_get_changed_ranges (GESTimeline * timeline,
+    guint64 from_hash, guint64 to_hash);
 
 G_END_DECLS
 
@@ -52,6 +52,11 @@ enum
 
 static void ges_title_source_dispose (GObject * object);
 
+static void _text_el_notify_cb (GstElement * text, GParamSpec * pspec,
+    GESTitleSource * self);
+static void _background_el_notify_cb (GstElement * background,
+    GParamSpec * pspec, GESTitleSource * self);
+
 static void ges_title_source_get_property (GObject * object, guint
     property_id, GValue * value, GParamSpec * pspec);
 
@@ -106,11 +111,15 @@ ges_title_source_dispose (GObject * object)
   }
 
   if (self->priv->text_el) {
+    g_signal_handlers_disconnect_by_func (self->priv->text_el,
+        _text_el_notify_cb, self);
     gst_object_unref (self->priv->text_el);
     self->priv->text_el = NULL;
   }
 
   if (self->priv->background_el) {
+    g_signal_handlers_disconnect_by_func (self->priv->background_el,
+        _background_el_notify_cb, self);
     gst_object_unref (self->priv->background_el);
     self->priv->background_el = NULL;
   }
@@ -138,6 +147,45 @@ ges_title_source_set_property (GObject * object,
   }
 }
 
+/* Keeps our values in sync with the element when its properties are set
+ * directly, as children properties, so that the setters only skip values
+ * that the element really has */
+static void
+_text_el_notify_cb (GstElement * text, GParamSpec * pspec,
+    GESTitleSource * self)
+{
+  gint align;
+  GESTitleSourcePrivate *priv = self->priv;
+
+  if (!g_strcmp0 (pspec->name, "text")) {
+    g_free (priv->text);
+    g_object_get (text, "text", &priv->text, NULL);
+  } else if (!g_strcmp0 (pspec->name, "font-desc")) {
+    g_free (priv->font_desc);
+    g_object_get (text, "font-desc", &priv->font_desc, NULL);
+  } else if (!g_strcmp0 (pspec->name, "halignment")) {
+    g_object_get (text, "halignment", &align, NULL);
+    priv->halign = align;
+  } else if (!g_strcmp0 (pspec->name, "valignment")) {
+    g_object_get (text, "valignment", &align, NULL);
+    priv->valign = align;
+  } else if (!g_strcmp0 (pspec->name, "color")) {
+    g_object_get (text, "color", &priv->color, NULL);
+  } else if (!g_strcmp0 (pspec->name, "xpos")) {
+    g_object_get (text, "xpos", &priv->xpos, NULL);
+  } else if (!g_strcmp0 (pspec->name, "ypos")) {
+    g_object_get (text, "ypos", &priv->ypos, NULL);
+  }
+}
+
+static void
+_background_el_notify_cb (GstElement * background, GParamSpec * pspec,
+    GESTitleSource * self)
+{
+  g_object_get (background, "foreground-color", &self->priv->background,
+      NULL);
+}
+
 static GstElement *
 ges_title_source_create_source (GESTrackElement * object)
 {
@@ -145,6 +193,10 @@ ges_title_source_create_source (GESTrackElement * object)
   GESTitleSourcePrivate *priv = self->priv;
   GstElement *topbin, *background, *text;
   GstPad *src, *pad;
+  const gchar *text_props[] = { "text", "font-desc", "valignment",
+    "halignment", "color", "xpos", "ypos", NULL
+  };
+  const gchar *bg_props[] = { "foreground-color", NULL };
 
   topbin = gst_bin_new ("titlesrc-bin");
   background = gst_element_factory_make ("videotestsrc", "titlesrc-bg");
@@ -182,6 +234,13 @@ ges_title_source_create_source (GESTrackElement * object)
 
   priv->text_el = text;
   priv->background_el = background;
+  g_signal_connect (text, "notify", G_CALLBACK (_text_el_notify_cb), self);
+  g_signal_connect (background, "notify::foreground-color",
+      G_CALLBACK (_background_el_notify_cb), self);
+
+  ges_track_element_add_children_props (object, text, NULL, NULL, text_props);
+  ges_track_element_add_children_props (object, background, NULL, NULL,
+      bg_props);
 
   return topbin;
 }
@@ -198,6 +257,11 @@ ges_title_source_create_source (GESTrackElement * object)
 void
 ges_title_source_set_text (GESTitleSource * self, const gchar * text)
 {
+  /* Setting a property on textoverlay makes it lay the text out and
+   * render it again, avoid it when nothing changed */
+  if (!g_strcmp0 (self->priv->text, text))
+    return;
+
   if (self->priv->text)
     g_free (self->priv->text);
 
@@ -220,6 +284,9 @@ ges_title_source_set_text (GESTitleSource * self, const gchar * text)
 void
 ges_title_source_set_font_desc (GESTitleSource * self, const gchar * font_desc)
 {
+  if (!g_strcmp0 (self->priv->font_desc, font_desc))
+    return;
+
   if (self->priv->font_desc)
     g_free (self->priv->font_desc);
 
@@ -240,6 +307,9 @@ ges_title_source_set_font_desc (GESTitleSource * self, const gchar * font_desc)
 void
 ges_title_source_set_valignment (GESTitleSource * self, GESTextVAlign valign)
 {
+  if (self->priv->valign == valign)
+    return;
+
   GST_DEBUG ("self:%p, valign:%d", self, valign);
 
   self->priv->valign = valign;
@@ -257,6 +327,9 @@ ges_title_source_set_valignment (GESTitleSource * self, GESTextVAlign valign)
 void
 ges_title_source_set_halignment (GESTitleSource * self, GESTextHAlign halign)
 {
+  if (self->priv->halign == halign)
+    return;
+
   GST_DEBUG ("self:%p, halign:%d", self, halign);
 
   self->priv->halign = halign;
@@ -274,6 +347,9 @@ ges_title_source_set_halignment (GESTitleSource * self, GESTextHAlign halign)
 void
 ges_title_source_set_text_color (GESTitleSource * self, guint32 color)
 {
+  if (self->priv->color == color)
+    return;
+
   GST_DEBUG ("self:%p, color:%d", self, color);
 
   self->priv->color = color;
@@ -291,6 +367,9 @@ ges_title_source_set_text_color (GESTitleSource * self, guint32 color)
 void
 ges_title_source_set_background_color (GESTitleSource * self, guint32 color)
 {
+  if (self->priv->background == color)
+    return;
+
   GST_DEBUG ("self:%p, background color:%d", self, color);
 
   self->priv->background = color;
@@ -308,6 +387,9 @@ ges_title_source_set_background_color (GESTitleSource * self, guint32 color)
 void
 ges_title_source_set_xpos (GESTitleSource * self, gdouble position)
 {
+  if (self->priv->xpos == position)
+    return;
+
   GST_DEBUG ("self:%p, xpos:%f", self, position);
 
   self->priv->xpos = position;
@@ -325,6 +407,9 @@ ges_title_source_set_xpos (GESTitleSource * self, gdouble position)
 void
 ges_title_source_set_ypos (GESTitleSource * self, gdouble position)
 {
+  if (self->priv->ypos == position)
+    return;
+
   GST_DEBUG ("self:%p, ypos:%f", self, position);
 
   self->priv->ypos = position;
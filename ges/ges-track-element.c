@@ -29,6 +29,10 @@
  * its container, like the start position, the inpoint, the duration and the
  * priority.
  */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include "ges-utils.h"
 #include "ges-internal.h"
 #include "ges-extractable.h"
@@ -36,10 +40,16 @@
 #include "ges-clip.h"
 #include "ges-meta-container.h"
 #include <gobject/gvaluecollector.h>
+#include <stdlib.h>
+#include <time.h>
 
 G_DEFINE_ABSTRACT_TYPE (GESTrackElement, ges_track_element,
     GES_TYPE_TIMELINE_ELEMENT);
 
+typedef struct _ElementProfile ElementProfile;
+
+static void _profile_release (ElementProfile * profile);
+
 struct _GESTrackElementPrivate
 {
   GESTrackType track_type;
@@ -69,6 +79,45 @@ struct _GESTrackElementPrivate
                                            and deserialize keyframes */
 
   GList *pending_bindings;
+
+  ElementProfile *profile;      /* Only set when profiling */
+};
+
+typedef struct
+{
+  GstPad *pad;
+  gulong id;
+} ProfileProbe;
+
+/* Timings of the element created by create_element, see
+ * ges_track_element_set_profiling().
+ *
+ * The track element, the pad probes and the pad-added handler each hold a
+ * reference, so the probes running in streaming threads can still use it
+ * after profiling has been turned off */
+struct _ElementProfile
+{
+  gint refcount;
+  GMutex lock;
+  gboolean released;            /* Profiling has been turned off */
+  GstElement *element;
+  gulong pad_added_id;
+  GSList *probes;               /* ProfileProbe */
+
+  gboolean has_input;
+  GThread *input_thread;
+  GstClockTime input_time;      /* Thread time of the last input */
+  GstClockTime input_wall_time;
+  GThread *output_thread;
+  GstClockTime output_time;     /* Thread time of the last output */
+  GstClockTime startup_time;    /* Data is expected to flow from there */
+
+  guint64 buffers;
+  GstClockTime processing_time;
+  GstClockTime latency;
+  guint64 n_latencies;
+  GstClockTime startup_latency;
+  guint64 n_startups;
 };
 
 typedef struct
@@ -79,6 +128,15 @@ typedef struct
   gchar *binding_type;
 } PendingBinding;
 
+static void
+_free_pending_binding (PendingBinding * pend)
+{
+  gst_object_unref (pend->source);
+  g_free (pend->propname);
+  g_free (pend->binding_type);
+  g_slice_free (PendingBinding, pend);
+}
+
 enum
 {
   PROP_0,
@@ -166,8 +224,15 @@ ges_track_element_dispose (GObject * object)
   GESTrackElementPrivate *priv = element->priv;
 
   g_hash_table_destroy (priv->children_props);
+  if (priv->profile) {
+    _profile_release (priv->profile);
+    priv->profile = NULL;
+  }
   if (priv->bindings_hashtable)
     g_hash_table_destroy (priv->bindings_hashtable);
+  g_list_free_full (priv->pending_bindings,
+      (GDestroyNotify) _free_pending_binding);
+  priv->pending_bindings = NULL;
 
   if (priv->gnlobject) {
     GstState cstate;
@@ -500,6 +565,8 @@ ges_track_element_set_active (GESTrackElement * object, gboolean active)
       return FALSE;
 
     g_object_set (object->priv->gnlobject, "active", active, NULL);
+    _ges_timeline_element_invalidate_content_hash (GES_TIMELINE_ELEMENT
+        (object));
 
     if (active != object->active) {
       object->active = active;
@@ -535,6 +602,9 @@ static void
 gst_element_prop_changed_cb (GstElement * element, GParamSpec * arg
     G_GNUC_UNUSED, GESTrackElement * track_element)
 {
+  _ges_timeline_element_invalidate_content_hash (GES_TIMELINE_ELEMENT
+      (track_element));
+
   g_signal_emit (track_element, ges_track_element_signals[DEEP_NOTIFY], 0,
       GST_ELEMENT (element), arg);
 }
@@ -558,6 +628,203 @@ connect_properties_signals (GESTrackElement * object)
       (GHFunc) connect_signal, object);
 }
 
+/****************************************************
+ *                 Profiling                        *
+ ****************************************************/
+
+/* CPU time of the calling thread where available, so that time spent waiting
+ * on other streaming threads is not accounted */
+static GstClockTime
+_profile_get_thread_time (void)
+{
+#if defined (HAVE_CLOCK_GETTIME) && defined (CLOCK_THREAD_CPUTIME_ID)
+  struct timespec ts;
+
+  if (clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+    return GST_TIMESPEC_TO_TIME (ts);
+#endif
+
+  return gst_util_get_timestamp ();
+}
+
+static GstPadProbeReturn
+_profile_sink_probe (GstPad * pad, GstPadProbeInfo * info,
+    ElementProfile * profile)
+{
+  g_mutex_lock (&profile->lock);
+  profile->has_input = TRUE;
+  profile->input_thread = g_thread_self ();
+  profile->input_time = _profile_get_thread_time ();
+  profile->input_wall_time = gst_util_get_timestamp ();
+  g_mutex_unlock (&profile->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+_profile_src_probe (GstPad * pad, GstPadProbeInfo * info,
+    ElementProfile * profile)
+{
+  GstClockTime now = gst_util_get_timestamp ();
+  GstClockTime thread_time;
+  GThread *self;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_EVENT_BOTH) {
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+    /* We measure how long it takes to get data flowing after those */
+    if (GST_EVENT_TYPE (event) == GST_EVENT_STREAM_START ||
+        GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+      g_mutex_lock (&profile->lock);
+      profile->startup_time = now;
+      g_mutex_unlock (&profile->lock);
+    }
+
+    return GST_PAD_PROBE_OK;
+  }
+
+  self = g_thread_self ();
+  thread_time = _profile_get_thread_time ();
+
+  g_mutex_lock (&profile->lock);
+  profile->buffers++;
+
+  if (GST_CLOCK_TIME_IS_VALID (profile->startup_time)) {
+    profile->startup_latency += now - profile->startup_time;
+    profile->n_startups++;
+    profile->startup_time = GST_CLOCK_TIME_NONE;
+  }
+
+  if (profile->has_input) {
+    /* Time between the input and the output it produced */
+    if (profile->input_thread == self &&
+        GST_CLOCK_TIME_IS_VALID (profile->input_time)) {
+      profile->processing_time += thread_time - profile->input_time;
+      profile->latency += now - profile->input_wall_time;
+      profile->n_latencies++;
+      profile->input_time = GST_CLOCK_TIME_NONE;
+    }
+  } else if (profile->output_thread == self &&
+      GST_CLOCK_TIME_IS_VALID (profile->output_time)) {
+    /* Sources produce everything in their own streaming thread */
+    profile->processing_time += thread_time - profile->output_time;
+  }
+  profile->output_thread = self;
+  profile->output_time = thread_time;
+  g_mutex_unlock (&profile->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static ElementProfile *
+_profile_ref (ElementProfile * profile)
+{
+  g_atomic_int_inc (&profile->refcount);
+
+  return profile;
+}
+
+static void
+_profile_unref (ElementProfile * profile)
+{
+  if (!g_atomic_int_dec_and_test (&profile->refcount))
+    return;
+
+  g_mutex_clear (&profile->lock);
+  g_slice_free (ElementProfile, profile);
+}
+
+/* Must be called with the profile lock */
+static void
+_profile_probe_pad (ElementProfile * profile, GstPad * pad)
+{
+  ProfileProbe *probe;
+
+  if (profile->released)
+    return;
+
+  probe = g_slice_new (ProfileProbe);
+  probe->pad = gst_object_ref (pad);
+  if (GST_PAD_DIRECTION (pad) == GST_PAD_SINK)
+    probe->id = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+        (GstPadProbeCallback) _profile_sink_probe, _profile_ref (profile),
+        (GDestroyNotify) _profile_unref);
+  else
+    probe->id = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+        GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+        (GstPadProbeCallback) _profile_src_probe, _profile_ref (profile),
+        (GDestroyNotify) _profile_unref);
+
+  profile->probes = g_slist_prepend (profile->probes, probe);
+}
+
+static void
+_profile_pad_added_cb (GstElement * element, GstPad * pad,
+    ElementProfile * profile)
+{
+  g_mutex_lock (&profile->lock);
+  _profile_probe_pad (profile, pad);
+  g_mutex_unlock (&profile->lock);
+}
+
+/* Puts the probes on the element created by create_element */
+static void
+_profile_attach (GESTrackElement * self)
+{
+  GList *tmp;
+  ElementProfile *profile = self->priv->profile;
+  GstElement *element = self->priv->element;
+
+  if (profile == NULL || element == NULL || profile->element)
+    return;
+
+  GST_DEBUG_OBJECT (self, "Profiling %" GST_PTR_FORMAT, element);
+
+  g_mutex_lock (&profile->lock);
+  profile->element = gst_object_ref (element);
+
+  GST_OBJECT_LOCK (element);
+  for (tmp = element->pads; tmp; tmp = tmp->next)
+    _profile_probe_pad (profile, tmp->data);
+  GST_OBJECT_UNLOCK (element);
+  g_mutex_unlock (&profile->lock);
+
+  profile->pad_added_id = g_signal_connect_data (element, "pad-added",
+      G_CALLBACK (_profile_pad_added_cb), _profile_ref (profile),
+      (GClosureNotify) _profile_unref, 0);
+}
+
+/* Removes the probes and drops the reference of the track element. Probes
+ * that are already running keep the profile alive until they return */
+static void
+_profile_release (ElementProfile * profile)
+{
+  GSList *tmp, *probes;
+
+  g_mutex_lock (&profile->lock);
+  profile->released = TRUE;
+  probes = profile->probes;
+  profile->probes = NULL;
+  g_mutex_unlock (&profile->lock);
+
+  if (profile->element) {
+    g_signal_handler_disconnect (profile->element, profile->pad_added_id);
+    gst_object_unref (profile->element);
+    profile->element = NULL;
+  }
+
+  for (tmp = probes; tmp; tmp = tmp->next) {
+    ProfileProbe *probe = tmp->data;
+
+    gst_pad_remove_probe (probe->pad, probe->id);
+    gst_object_unref (probe->pad);
+    g_slice_free (ProfileProbe, probe);
+  }
+  g_slist_free (probes);
+
+  _profile_unref (profile);
+}
+
 /* default 'create_gnl_object' virtual method implementation */
 static GstElement *
 ges_track_element_create_gnl_object_func (GESTrackElement * self)
@@ -594,6 +861,7 @@ ges_track_element_create_gnl_object_func (GESTrackElement * self)
 
     GST_DEBUG ("Succesfully got the element to put in the gnlobject");
     self->priv->element = child;
+    _profile_attach (self);
   }
 
   GST_DEBUG ("done");
@@ -860,12 +1128,6 @@ ges_track_element_add_children_props (GESTrackElement * self,
 }
 
 /* INTERNAL USAGE */
-static void
-_free_pending_binding (PendingBinding * pend)
-{
-  g_slice_free (PendingBinding, pend);
-}
-
 gboolean
 ges_track_element_set_track (GESTrackElement * object, GESTrack * track)
 {
@@ -892,8 +1154,6 @@ ges_track_element_set_track (GESTrackElement * object, GESTrack * track)
           pbinding = tmp->data;
           ges_track_element_set_control_source (pbinding->element,
               pbinding->source, pbinding->propname, pbinding->binding_type);
-          g_free (pbinding->propname);
-          g_free (pbinding->binding_type);
         }
         g_list_free_full (object->priv->pending_bindings,
             (GDestroyNotify) _free_pending_binding);
@@ -1453,6 +1713,75 @@ ges_track_element_copy_properties (GESTimelineElement * element,
   g_free (specs);
 }
 
+static gint
+_compare_pspecs_by_name (GParamSpec ** a, GParamSpec ** b)
+{
+  return g_strcmp0 ((*a)->name, (*b)->name);
+}
+
+/* Adds the children properties and keyframes of @self to @checksum.
+ *
+ * Returns: %TRUE if @self has control bindings, meaning that its content can
+ * change without it being notified */
+gboolean
+ges_track_element_hash_children_properties (GESTrackElement * self,
+    GChecksum * checksum)
+{
+  guint n, n_specs;
+  GParamSpec **specs;
+  gboolean has_bindings = FALSE;
+
+  /* Make sure the result does not depend on the hash table order */
+  specs = ges_track_element_list_children_properties (self, &n_specs);
+  qsort (specs, n_specs, sizeof (GParamSpec *),
+      (GCompareFunc) _compare_pspecs_by_name);
+  for (n = 0; n < n_specs; ++n) {
+    GValue val = { 0 };
+    GstControlBinding *binding;
+    GstControlSource *source;
+
+    g_value_init (&val, specs[n]->value_type);
+    ges_track_element_get_child_property_by_pspec (self, specs[n], &val);
+    _ges_checksum_update_value (checksum, specs[n]->name, &val);
+    g_value_unset (&val);
+
+    binding = ges_track_element_get_control_binding (self, specs[n]->name);
+    if (binding) {
+      has_bindings = TRUE;
+
+      g_object_get (binding, "control_source", &source, NULL);
+      if (GST_IS_TIMED_VALUE_CONTROL_SOURCE (source)) {
+        GList *values, *tmp;
+        GstInterpolationMode mode;
+
+        values =
+            gst_timed_value_control_source_get_all
+            (GST_TIMED_VALUE_CONTROL_SOURCE (source));
+        for (tmp = values; tmp; tmp = tmp->next) {
+          GstTimedValue *value = tmp->data;
+
+          g_checksum_update (checksum, (const guchar *) &value->timestamp,
+              sizeof (value->timestamp));
+          g_checksum_update (checksum, (const guchar *) &value->value,
+              sizeof (value->value));
+        }
+        g_list_free (values);
+
+        if (GST_IS_INTERPOLATION_CONTROL_SOURCE (source)) {
+          g_object_get (source, "mode", &mode, NULL);
+          g_checksum_update (checksum, (const guchar *) &mode, sizeof (mode));
+        }
+      }
+      gst_object_unref (source);
+    }
+    g_param_spec_unref (specs[n]);
+  }
+
+  g_free (specs);
+
+  return has_bindings;
+}
+
 void
 ges_track_element_split_bindings (GESTrackElement * element,
     GESTrackElement * new_element, guint64 position)
@@ -1526,6 +1855,34 @@ ges_track_element_split_bindings (GESTrackElement * element,
   g_free (specs);
 }
 
+/* Makes @new_element be controlled by the same control sources as
+ * @element, for all the children properties they have in common */
+void
+ges_track_element_copy_bindings (GESTrackElement * element,
+    GESTrackElement * new_element)
+{
+  GParamSpec **specs;
+  guint n, n_specs;
+  GstControlBinding *binding;
+  GstControlSource *source;
+
+  specs = ges_track_element_list_children_properties (element, &n_specs);
+  for (n = 0; n < n_specs; ++n) {
+    binding = ges_track_element_get_control_binding (element, specs[n]->name);
+    if (!binding)
+      continue;
+
+    g_object_get (binding, "control_source", &source, NULL);
+
+    /* We only manage direct bindings, see TODO in set_control_source */
+    ges_track_element_set_control_source (new_element, source,
+        specs[n]->name, "direct");
+    gst_object_unref (source);
+  }
+
+  g_free (specs);
+}
+
 /**
  * ges_track_element_edit:
  * @object: the #GESTrackElement to edit
@@ -1630,7 +1987,7 @@ ges_track_element_set_control_source (GESTrackElement * object,
     GST_INFO ("Adding this source to the future bindings");
     pbinding = g_slice_new0 (PendingBinding);
     pbinding->element = object;
-    pbinding->source = source;
+    pbinding->source = gst_object_ref (source);
     pbinding->propname = g_strdup (property_name);
     pbinding->binding_type = g_strdup (binding_type);
     priv->pending_bindings = g_list_append (priv->pending_bindings, pbinding);
@@ -1659,6 +2016,8 @@ ges_track_element_set_control_source (GESTrackElement * object,
     gst_object_add_control_binding (GST_OBJECT (element), binding);
     g_hash_table_insert (priv->bindings_hashtable, g_strdup (property_name),
         binding);
+    _ges_timeline_element_invalidate_content_hash (GES_TIMELINE_ELEMENT
+        (object));
     return TRUE;
   }
 
@@ -1694,3 +2053,84 @@ ges_track_element_get_control_binding (GESTrackElement * object,
       property_name);
   return binding;
 }
+
+/* ges_track_element_set_profiling:
+ * @self: a #GESTrackElement
+ * @profiling: whether to profile @self
+ *
+ * Measures the buffers processed by the element created by the
+ * create_element vmethod, how much CPU time they took and how long they
+ * spent in the element. Disabling profiling drops the measurements.
+ */
+void
+ges_track_element_set_profiling (GESTrackElement * self, gboolean profiling)
+{
+  GESTrackElementPrivate *priv = self->priv;
+
+  if (profiling && priv->profile == NULL) {
+    ElementProfile *profile = g_slice_new0 (ElementProfile);
+
+    profile->refcount = 1;
+    g_mutex_init (&profile->lock);
+    profile->input_time = GST_CLOCK_TIME_NONE;
+    profile->output_time = GST_CLOCK_TIME_NONE;
+    profile->startup_time = GST_CLOCK_TIME_NONE;
+    priv->profile = profile;
+
+    _profile_attach (self);
+  } else if (!profiling && priv->profile) {
+    _profile_release (priv->profile);
+    priv->profile = NULL;
+  }
+}
+
+/* ges_track_element_get_profile:
+ * @self: a #GESTrackElement
+ *
+ * Returns: (transfer full): A "ges-element-profile" #GstStructure, as
+ * described in ges_timeline_get_profile(), or %NULL if @self is not being
+ * profiled
+ */
+GstStructure *
+ges_track_element_get_profile (GESTrackElement * self)
+{
+  GESAsset *asset;
+  GstStructure *res;
+  gint layer_priority;
+  ElementProfile *profile = self->priv->profile;
+  GESTimelineElement *parent = GES_TIMELINE_ELEMENT_PARENT (self);
+
+  if (profile == NULL)
+    return NULL;
+
+  g_mutex_lock (&profile->lock);
+  res = gst_structure_new ("ges-element-profile",
+      "track-element", GES_TYPE_TRACK_ELEMENT, self,
+      "type", G_TYPE_STRING, G_OBJECT_TYPE_NAME (self),
+      "track-type", GES_TYPE_TRACK_TYPE, self->priv->track_type,
+      "start", G_TYPE_UINT64, _START (self),
+      "element", G_TYPE_STRING, self->priv->gnlobject ?
+      GST_ELEMENT_NAME (self->priv->gnlobject) : NULL,
+      "buffers", G_TYPE_UINT64, profile->buffers,
+      "processing-time", G_TYPE_UINT64, profile->processing_time,
+      "latency", G_TYPE_UINT64, profile->n_latencies ?
+      profile->latency / profile->n_latencies : GST_CLOCK_TIME_NONE,
+      "startup-latency", G_TYPE_UINT64, profile->n_startups ?
+      profile->startup_latency / profile->n_startups : GST_CLOCK_TIME_NONE,
+      NULL);
+  g_mutex_unlock (&profile->lock);
+
+  /* Map back to what the user put in the timeline */
+  if (GES_IS_CLIP (parent)) {
+    layer_priority = (gint) ges_clip_get_layer_priority (GES_CLIP (parent));
+    asset = ges_extractable_get_asset (GES_EXTRACTABLE (parent));
+  } else {
+    layer_priority = _ges_track_element_get_layer_priority (self);
+    asset = ges_extractable_get_asset (GES_EXTRACTABLE (self));
+  }
+
+  gst_structure_set (res, "layer", G_TYPE_INT, layer_priority,
+      "asset", G_TYPE_STRING, asset ? ges_asset_get_id (asset) : NULL, NULL);
+
+  return res;
+}
@@ -57,6 +57,7 @@ struct _GESTrackPrivate
   GSequence *trackelements_by_start;
   GHashTable *trackelements_iter;
   GList *gaps;
+  GList *cache_sources;         /* gnlsource-s sorted by start */
 
   guint64 duration;
 
@@ -174,10 +175,59 @@ free_gap (Gap * gap)
   g_slice_free (Gap, gap);
 }
 
+static gint
+compare_gnl_start (GstElement * a, GstElement * b)
+{
+  guint64 start_a, start_b;
+
+  g_object_get (a, "start", &start_a, NULL);
+  g_object_get (b, "start", &start_b, NULL);
+
+  if (start_a < start_b)
+    return -1;
+  if (start_a > start_b)
+    return 1;
+
+  return 0;
+}
+
+/* Fills [start, end[ with gaps, leaving the ranges covered by cache
+ * sources out */
+static void
+fill_gap (GESTrack * track, GstClockTime start, GstClockTime end)
+{
+  Gap *gap;
+  GList *tmp;
+  guint64 cstart, cduration;
+  GESTrackPrivate *priv = track->priv;
+
+  for (tmp = priv->cache_sources; tmp && start < end; tmp = tmp->next) {
+    g_object_get (tmp->data, "start", &cstart, "duration", &cduration, NULL);
+
+    if (cstart + cduration <= start || cstart >= end)
+      continue;
+
+    if (cstart > start) {
+      gap = gap_new (track, start, cstart - start);
+
+      if (G_LIKELY (gap != NULL))
+        priv->gaps = g_list_prepend (priv->gaps, gap);
+    }
+
+    start = MAX (start, cstart + cduration);
+  }
+
+  if (start < end) {
+    gap = gap_new (track, start, end - start);
+
+    if (G_LIKELY (gap != NULL))
+      priv->gaps = g_list_prepend (priv->gaps, gap);
+  }
+}
+
 static inline void
 update_gaps (GESTrack * track)
 {
-  Gap *gap;
   GList *gaps;
   GSequenceIter *it;
 
@@ -203,27 +253,19 @@ update_gaps (GESTrack * track)
     start = _START (trackelement);
     end = start + _DURATION (trackelement);
 
-    if (start > duration) {
-      /* 2- Fill gap */
-      gap = gap_new (track, duration, start - duration);
-
-      if (G_LIKELY (gap != NULL))
-        priv->gaps = g_list_prepend (priv->gaps, gap);
-    }
+    /* 2- Fill gap */
+    if (start > duration)
+      fill_gap (track, duration, start);
 
     duration = MAX (duration, end);
   }
 
   /* 4- Add a gap at the end of the timeline if needed */
   if (priv->timeline) {
-    g_object_get (priv->timeline, "duration", &timeline_duration, NULL);
+    timeline_duration = timeline_get_loaded_duration (priv->timeline);
 
     if (duration < timeline_duration) {
-      gap = gap_new (track, duration, timeline_duration - duration);
-
-      if (G_LIKELY (gap != NULL)) {
-        priv->gaps = g_list_prepend (priv->gaps, gap);
-      }
+      fill_gap (track, duration, timeline_duration);
 
       priv->duration = timeline_duration;
     }
@@ -424,6 +466,7 @@ ges_track_dispose (GObject * object)
       (GFunc) dispose_trackelements_foreach, track);
   g_sequence_free (priv->trackelements_by_start);
   g_list_free_full (priv->gaps, (GDestroyNotify) free_gap);
+  g_list_free_full (priv->cache_sources, gst_object_unref);
 
   if (priv->mixing_operation)
     gst_object_unref (priv->mixing_operation);
@@ -985,6 +1028,80 @@ ges_track_commit (GESTrack * track)
   return ret;
 }
 
+/* ges_track_add_cache_source:
+ * @track: a #GESTrack
+ * @uri: The URI of the cached rendering of [@start, @start + @duration[
+ * @start: The start of the segment to replace
+ * @duration: The duration of the segment to replace
+ *
+ * Plays @uri in place of the gaps of @track in that segment, it is up to the
+ * caller to deactivate the GnlObject-s of that segment.
+ *
+ * Returns: (transfer none): The newly created gnlsource, or %NULL
+ */
+GstElement *
+ges_track_add_cache_source (GESTrack * track, const gchar * uri,
+    GstClockTime start, GstClockTime duration)
+{
+  GstElement *source, *decodebin, *convert = NULL;
+  GESTrackPrivate *priv = track->priv;
+
+  source = gst_element_factory_make ("gnlsource", NULL);
+  if (G_UNLIKELY (source == NULL)) {
+    GST_WARNING_OBJECT (track, "Could not create a gnlsource");
+
+    return NULL;
+  }
+
+  decodebin = gst_element_factory_make ("uridecodebin", NULL);
+  g_object_set (decodebin, "uri", uri, "caps", priv->caps, NULL);
+
+  /* The cached file is not played through the conform chain of the
+   * GESSource-s so we convert it ourself to what the mixer expects */
+  if (track->type == GES_TRACK_TYPE_AUDIO)
+    convert = gst_parse_bin_from_description ("audioconvert ! audioresample",
+        TRUE, NULL);
+  else if (track->type == GES_TRACK_TYPE_VIDEO)
+    convert = gst_parse_bin_from_description ("videoconvert", TRUE, NULL);
+
+  if (convert)
+    gst_bin_add (GST_BIN (source), ges_source_create_topbin ("cachesrcbin",
+            decodebin, convert, NULL));
+  else
+    gst_bin_add (GST_BIN (source), decodebin);
+
+  /* Gaps never overlap cache sources so we can use their priority */
+  g_object_set (source, "start", start, "duration", duration,
+      "inpoint", (guint64) 0, "priority", 1, "caps", priv->caps, NULL);
+
+  if (G_UNLIKELY (!gst_bin_add (GST_BIN (priv->composition), source))) {
+    GST_WARNING_OBJECT (track, "Could not add cache source to composition");
+    gst_object_unref (source);
+
+    return NULL;
+  }
+
+  priv->cache_sources = g_list_insert_sorted (priv->cache_sources,
+      gst_object_ref (source), (GCompareFunc) compare_gnl_start);
+
+  return source;
+}
+
+void
+ges_track_remove_cache_source (GESTrack * track, GstElement * source)
+{
+  GList *tmp;
+  GESTrackPrivate *priv = track->priv;
+
+  if (G_UNLIKELY (!(tmp = g_list_find (priv->cache_sources, source))))
+    return;
+
+  priv->cache_sources = g_list_delete_link (priv->cache_sources, tmp);
+  gst_bin_remove (GST_BIN (priv->composition), source);
+  gst_element_set_state (source, GST_STATE_NULL);
+  gst_object_unref (source);
+}
+
 
 /**
  * ges_track_set_create_element_for_gap_func:
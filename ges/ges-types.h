@@ -86,6 +86,12 @@ typedef struct _GESEffectClipClass GESEffectClipClass;
 typedef struct _GESGroup GESGroup;
 typedef struct _GESGroupClass GESGroupClass;
 
+typedef struct _GESMarker GESMarker;
+typedef struct _GESMarkerClass GESMarkerClass;
+
+typedef struct _GESMarkerList GESMarkerList;
+typedef struct _GESMarkerListClass GESMarkerListClass;
+
 typedef struct _GESTrack GESTrack;
 typedef struct _GESTrackClass GESTrackClass;
 
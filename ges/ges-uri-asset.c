@@ -73,8 +73,26 @@ struct _GESUriSourceAssetPrivate
   GESUriClipAsset *parent_asset;
 
   const gchar *uri;
+
+  /* Waveform peaks of audio streams, computed lazily */
+  GBytes *peaks;
+  gboolean peaks_requested;
+
+  /* Seek index of video streams, built lazily and then read from any
+   * thread */
+  GBytes *seek_index;
+  gint seek_index_requested;
 };
 
+enum
+{
+  PEAKS_READY,
+  SEEK_INDEX_READY,
+  LAST_SOURCE_ASSET_SIGNAL
+};
+
+static guint ges_uri_source_asset_signals[LAST_SOURCE_ASSET_SIGNAL] = { 0 };
+
 
 static void
 ges_uri_clip_asset_get_property (GObject * object, guint property_id,
@@ -537,6 +555,122 @@ ges_uri_clip_asset_get_stream_assets (GESUriClipAsset * self)
   return self->priv->asset_trackfilesources;
 }
 
+static void
+_analyze_in_thread (GSimpleAsyncResult * simple, GObject * object,
+    GCancellable * cancellable)
+{
+  GError *error = NULL;
+  GstStructure *results;
+
+  results = ges_asset_analysis_run (ges_asset_get_id (GES_ASSET (object)),
+      cancellable, &error);
+
+  if (results == NULL)
+    g_simple_async_result_take_error (simple, error);
+  else
+    g_simple_async_result_set_op_res_gpointer (simple, results,
+        (GDestroyNotify) gst_structure_free);
+}
+
+/**
+ * ges_uri_clip_asset_analyze_async:
+ * @self: A #GESUriClipAsset
+ * @cancellable: optional %GCancellable object, %NULL to ignore.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the analysis
+ * is done
+ * @user_data: The user data to pass when @callback is called
+ *
+ * Analyses the content of the file represented by @self in a separate
+ * thread, decoding it only once: scene changes are detected in its video
+ * stream, and the loudness and waveform peaks of its audio stream are
+ * computed. Once ges_uri_clip_asset_analyze_finish() is called, the results
+ * are available as the #GES_META_ANALYSIS_SCENE_CHANGES,
+ * #GES_META_ANALYSIS_LOUDNESS, #GES_META_ANALYSIS_INTEGRATED_LOUDNESS and
+ * #GES_META_ANALYSIS_WAVEFORM_PEAKS metas of @self.
+ *
+ * Results are cached on disk so a file is only analysed again if it
+ * changes.
+ */
+void
+ges_uri_clip_asset_analyze_async (GESUriClipAsset * self,
+    GCancellable * cancellable, GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  GSimpleAsyncResult *simple;
+
+  g_return_if_fail (GES_IS_URI_CLIP_ASSET (self));
+
+  simple = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+      ges_uri_clip_asset_analyze_async);
+  g_simple_async_result_run_in_thread (simple, _analyze_in_thread,
+      G_PRIORITY_DEFAULT, cancellable);
+  g_object_unref (simple);
+}
+
+/**
+ * ges_uri_clip_asset_analyze_finish:
+ * @self: A #GESUriClipAsset
+ * @res: The #GAsyncResult passed to the callback of
+ * ges_uri_clip_asset_analyze_async()
+ * @error: (allow-none): An error to be set in case something wrong happens
+ * or %NULL
+ *
+ * Finishes an analysis started with ges_uri_clip_asset_analyze_async(),
+ * setting its results as metas of @self.
+ *
+ * Returns: %TRUE if @self could be analysed, %FALSE otherwise
+ */
+gboolean
+ges_uri_clip_asset_analyze_finish (GESUriClipAsset * self, GAsyncResult * res,
+    GError ** error)
+{
+  GSimpleAsyncResult *simple;
+
+  g_return_val_if_fail (GES_IS_URI_CLIP_ASSET (self), FALSE);
+  g_return_val_if_fail (g_simple_async_result_is_valid (res, G_OBJECT (self),
+          ges_uri_clip_asset_analyze_async), FALSE);
+
+  simple = G_SIMPLE_ASYNC_RESULT (res);
+  if (g_simple_async_result_propagate_error (simple, error))
+    return FALSE;
+
+  ges_asset_analysis_apply (g_simple_async_result_get_op_res_gpointer
+      (simple), GES_META_CONTAINER (self));
+
+  return TRUE;
+}
+
+/**
+ * ges_uri_clip_asset_analyze_sync:
+ * @self: A #GESUriClipAsset
+ * @cancellable: optional %GCancellable object, %NULL to ignore.
+ * @error: (allow-none): An error to be set in case something wrong happens
+ * or %NULL
+ *
+ * Same as ges_uri_clip_asset_analyze_async() but blocks until the analysis
+ * is done. You should avoid using it in applications.
+ *
+ * Returns: %TRUE if @self could be analysed, %FALSE otherwise
+ */
+gboolean
+ges_uri_clip_asset_analyze_sync (GESUriClipAsset * self,
+    GCancellable * cancellable, GError ** error)
+{
+  GstStructure *results;
+
+  g_return_val_if_fail (GES_IS_URI_CLIP_ASSET (self), FALSE);
+
+  results = ges_asset_analysis_run (ges_asset_get_id (GES_ASSET (self)),
+      cancellable, error);
+  if (results == NULL)
+    return FALSE;
+
+  ges_asset_analysis_apply (results, GES_META_CONTAINER (self));
+  gst_structure_free (results);
+
+  return TRUE;
+}
+
 /*****************************************************************
  *            GESUriSourceAsset implementation             *
  *****************************************************************/
@@ -590,12 +724,50 @@ _extract (GESAsset * asset, GError ** error)
   return GES_EXTRACTABLE (trackelement);
 }
 
+static void
+ges_uri_source_asset_finalize (GObject * object)
+{
+  GESUriSourceAssetPrivate *priv = GES_URI_SOURCE_ASSET (object)->priv;
+
+  if (priv->peaks)
+    g_bytes_unref (priv->peaks);
+  if (priv->seek_index)
+    g_bytes_unref (priv->seek_index);
+
+  G_OBJECT_CLASS (ges_uri_source_asset_parent_class)->finalize (object);
+}
+
 static void
 ges_uri_source_asset_class_init (GESUriSourceAssetClass * klass)
 {
   g_type_class_add_private (klass, sizeof (GESUriSourceAssetPrivate));
 
+  G_OBJECT_CLASS (klass)->finalize = ges_uri_source_asset_finalize;
   GES_ASSET_CLASS (klass)->extract = _extract;
+
+  /**
+   * GESUriSourceAsset::peaks-ready:
+   * @asset: the #GESUriSourceAsset
+   *
+   * Will be emitted once the waveform peaks requested with
+   * ges_uri_source_asset_get_peaks() are available.
+   */
+  ges_uri_source_asset_signals[PEAKS_READY] =
+      g_signal_new ("peaks-ready", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_marshal_generic,
+      G_TYPE_NONE, 0);
+
+  /**
+   * GESUriSourceAsset::seek-index-ready:
+   * @asset: the #GESUriSourceAsset
+   *
+   * Will be emitted once the seek index of the video stream of @asset is
+   * available, see ges_uri_source_asset_get_keyframe().
+   */
+  ges_uri_source_asset_signals[SEEK_INDEX_READY] =
+      g_signal_new ("seek-index-ready", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_marshal_generic,
+      G_TYPE_NONE, 0);
 }
 
 static void
@@ -650,3 +822,132 @@ ges_uri_source_asset_get_filesource_asset (GESUriSourceAsset * asset)
 
   return asset->priv->parent_asset;
 }
+
+static void
+_peaks_ready_cb (GBytes * peaks, GESUriSourceAsset * asset)
+{
+  if (peaks == NULL) {
+    GST_WARNING_OBJECT (asset, "Could not compute waveform peaks");
+
+    /* Try again on the next request */
+    asset->priv->peaks_requested = FALSE;
+    return;
+  }
+
+  asset->priv->peaks = g_bytes_ref (peaks);
+  g_signal_emit (asset, ges_uri_source_asset_signals[PEAKS_READY], 0);
+}
+
+/**
+ * ges_uri_source_asset_get_peaks:
+ * @asset: A #GESUriSourceAsset of an audio stream
+ * @start: The start of the range of the stream to get peaks for
+ * @stop: The end of the range, or #GST_CLOCK_TIME_NONE for the end of the
+ * stream
+ * @samples_per_pixel: The number of audio samples drawn in one pixel
+ * @samples_per_peak: (out) (allow-none): The number of samples each of the
+ * returned peaks covers
+ *
+ * Gets the waveform peaks of the audio stream of @asset between @start and
+ * @stop. The peaks of each stream are computed once in a background thread
+ * and saved on disk, at several resolutions. The returned peaks come from
+ * the lowest resolution still having at least one peak per
+ * @samples_per_pixel samples, they are not copied.
+ *
+ * If the peaks are not available yet, %NULL is returned, they start being
+ * computed and #GESUriSourceAsset::peaks-ready is emitted once they are
+ * available.
+ *
+ * Returns: (transfer full) (allow-none): The #GESAudioPeak-s of the range or
+ * %NULL
+ */
+GBytes *
+ges_uri_source_asset_get_peaks (GESUriSourceAsset * asset,
+    GstClockTime start, GstClockTime stop, guint samples_per_pixel,
+    guint * samples_per_peak)
+{
+  GESUriSourceAssetPrivate *priv;
+
+  g_return_val_if_fail (GES_IS_URI_SOURCE_ASSET (asset), NULL);
+  g_return_val_if_fail (GST_IS_DISCOVERER_AUDIO_INFO (asset->priv->sinfo),
+      NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (start), NULL);
+
+  priv = asset->priv;
+  if (priv->peaks)
+    return ges_audio_peaks_get_range (priv->peaks, start, stop,
+        samples_per_pixel, samples_per_peak);
+
+  if (!priv->peaks_requested) {
+    priv->peaks_requested = TRUE;
+    ges_audio_peaks_request (priv->uri,
+        gst_discoverer_stream_info_get_stream_id (priv->sinfo),
+        (GESAudioPeaksReadyFunc) _peaks_ready_cb, gst_object_ref (asset),
+        gst_object_unref);
+  }
+
+  return NULL;
+}
+
+static void
+_seek_index_ready_cb (GBytes * index, GESUriSourceAsset * asset)
+{
+  if (index == NULL) {
+    GST_INFO_OBJECT (asset, "Could not build a seek index");
+
+    return;
+  }
+
+  g_atomic_pointer_set (&asset->priv->seek_index, g_bytes_ref (index));
+  g_signal_emit (asset, ges_uri_source_asset_signals[SEEK_INDEX_READY], 0);
+}
+
+/**
+ * ges_uri_source_asset_get_keyframe:
+ * @asset: A #GESUriSourceAsset of a video stream
+ * @position: A position in the stream
+ * @keyframe: (out) (allow-none): The position of the last keyframe at or
+ * before @position
+ * @n_skip_frames: (out) (allow-none): The number of frames that need to be
+ * decoded starting from @keyframe before getting the frame at @position
+ *
+ * Looks up the keyframe decoding has to start from to get the frame at
+ * @position. The keyframes and frames of each video stream are indexed once
+ * in a background thread, without decoding the stream, and the index saved
+ * on disk.
+ *
+ * If the index is not available yet, it starts being built and
+ * #GESUriSourceAsset::seek-index-ready is emitted once it is available.
+ *
+ * This function can be called from any thread.
+ *
+ * Returns: %TRUE if the keyframe could be found, %FALSE if the index is not
+ * available yet or @position is not in the stream
+ */
+gboolean
+ges_uri_source_asset_get_keyframe (GESUriSourceAsset * asset,
+    GstClockTime position, GstClockTime * keyframe, guint * n_skip_frames)
+{
+  GBytes *index;
+  GESUriSourceAssetPrivate *priv;
+
+  g_return_val_if_fail (GES_IS_URI_SOURCE_ASSET (asset), FALSE);
+  g_return_val_if_fail (GST_IS_DISCOVERER_VIDEO_INFO (asset->priv->sinfo),
+      FALSE);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (position), FALSE);
+
+  priv = asset->priv;
+  index = g_atomic_pointer_get (&priv->seek_index);
+  if (index)
+    return ges_seek_index_lookup (index, position, keyframe, n_skip_frames);
+
+  if (g_atomic_int_compare_and_exchange (&priv->seek_index_requested, FALSE,
+          TRUE)) {
+    ges_seek_index_request (priv->uri,
+        gst_discoverer_stream_info_get_stream_id (priv->sinfo),
+        (GESSeekIndexReadyFunc) _seek_index_ready_cb, gst_object_ref (asset),
+        gst_object_unref);
+  }
+
+  return FALSE;
+}
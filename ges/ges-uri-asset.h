@@ -78,6 +78,16 @@ GESUriClipAsset* ges_uri_clip_asset_request_sync    (const gchar *uri, GError **
 void ges_uri_clip_asset_class_set_timeout           (GESUriClipAssetClass *klass,
                                                      GstClockTime timeout);
 const GList * ges_uri_clip_asset_get_stream_assets  (GESUriClipAsset *self);
+void ges_uri_clip_asset_analyze_async               (GESUriClipAsset *self,
+                                                     GCancellable *cancellable,
+                                                     GAsyncReadyCallback callback,
+                                                     gpointer user_data);
+gboolean ges_uri_clip_asset_analyze_finish          (GESUriClipAsset *self,
+                                                     GAsyncResult *res,
+                                                     GError **error);
+gboolean ges_uri_clip_asset_analyze_sync            (GESUriClipAsset *self,
+                                                     GCancellable *cancellable,
+                                                     GError **error);
 
 #define GES_TYPE_URI_SOURCE_ASSET ges_uri_source_asset_get_type()
 #define GES_URI_SOURCE_ASSET(obj) \
@@ -116,5 +126,29 @@ GstDiscovererStreamInfo * ges_uri_source_asset_get_stream_info     (GESUriSource
 const gchar * ges_uri_source_asset_get_stream_uri                  (GESUriSourceAsset *asset);
 const GESUriClipAsset *ges_uri_source_asset_get_filesource_asset (GESUriSourceAsset *asset);
 
+/**
+ * GESAudioPeak:
+ * @min: The smallest sample value, -32767 being the minimum
+ * @max: The biggest sample value, 32767 being the maximum
+ *
+ * The extent of the samples of all the channels of an audio stream during
+ * a period of time.
+ */
+typedef struct
+{
+  gint16 min;
+  gint16 max;
+} GESAudioPeak;
+
+GBytes * ges_uri_source_asset_get_peaks (GESUriSourceAsset *asset,
+                                         GstClockTime start,
+                                         GstClockTime stop,
+                                         guint samples_per_pixel,
+                                         guint *samples_per_peak);
+gboolean ges_uri_source_asset_get_keyframe (GESUriSourceAsset *asset,
+                                            GstClockTime position,
+                                            GstClockTime *keyframe,
+                                            guint *n_skip_frames);
+
 G_END_DECLS
 #endif /* _GES_URI_CLIP_ASSET */
@@ -37,6 +37,7 @@
 #include "ges-image-source.h"
 #include "ges-audio-test-source.h"
 #include "ges-multi-file-source.h"
+#include "ges-source.h"
 
 static void ges_extractable_interface_init (GESExtractableInterface * iface);
 
@@ -260,12 +261,54 @@ extractable_get_id (GESExtractable * self)
   return g_strdup (GES_URI_CLIP (self)->priv->uri);
 }
 
+/* Replaces our sources with ones reading our new uri, keeping their
+ * properties and keyframes */
+static void
+_relink_sources (GESUriClip * self)
+{
+  GList *tmp, *children;
+  GESContainer *container = GES_CONTAINER (self);
+
+  children = ges_container_get_children (container, FALSE);
+  for (tmp = children; tmp; tmp = tmp->next) {
+    GESTrackElement *new_source, *source = tmp->data;
+
+    if (!GES_IS_SOURCE (source))
+      continue;
+
+    new_source = ges_clip_create_track_element (GES_CLIP (self),
+        ges_track_element_get_track_type (source));
+
+    /* The timeline puts back the new source in a track, the old one has to
+     * be removed first */
+    ges_container_remove (container, GES_TIMELINE_ELEMENT (source));
+    if (new_source == NULL) {
+      GST_INFO_OBJECT (self, "Nothing to replace %" GST_PTR_FORMAT " with",
+          source);
+      continue;
+    }
+
+    /* The timeline removes it from us if it can not be put in a track */
+    gst_object_ref (new_source);
+    if (ges_container_add (container, GES_TIMELINE_ELEMENT (new_source))) {
+      ges_track_element_copy_properties (GES_TIMELINE_ELEMENT (source),
+          GES_TIMELINE_ELEMENT (new_source));
+      ges_track_element_copy_bindings (source, new_source);
+      ges_track_element_set_active (new_source,
+          ges_track_element_is_active (source));
+    }
+    gst_object_unref (new_source);
+  }
+  g_list_free_full (children, gst_object_unref);
+}
+
 static void
 extractable_set_asset (GESExtractable * self, GESAsset * asset)
 {
   GESUriClip *uriclip = GES_URI_CLIP (self);
   GESUriClipAsset *filesource_asset = GES_URI_CLIP_ASSET (asset);
   GESClip *clip = GES_CLIP (self);
+  GESAsset *previous_asset = GES_TIMELINE_ELEMENT (uriclip)->asset;
 
   if (GST_CLOCK_TIME_IS_VALID (GES_TIMELINE_ELEMENT_DURATION (clip)) == FALSE)
     _set_duration0 (GES_TIMELINE_ELEMENT (uriclip),
@@ -276,6 +319,13 @@ extractable_set_asset (GESExtractable * self, GESAsset * asset)
   ges_uri_clip_set_is_image (uriclip,
       ges_uri_clip_asset_is_image (filesource_asset));
 
+  /* We are being moved to another media, see ges_asset_move_extractables */
+  if (previous_asset && previous_asset != asset) {
+    g_free (uriclip->priv->uri);
+    uriclip->priv->uri = g_strdup (ges_asset_get_id (asset));
+    _relink_sources (uriclip);
+  }
+
   if (ges_clip_get_supported_formats (clip) == GES_TRACK_TYPE_UNKNOWN) {
 
     ges_clip_set_supported_formats (clip,
@@ -294,6 +344,7 @@ ges_extractable_interface_init (GESExtractableInterface * iface)
   iface->get_parameters_from_id = extractable_get_parameters_from_id;
   iface->get_id = extractable_get_id;
   iface->set_asset = extractable_set_asset;
+  iface->can_update_asset = TRUE;
 }
 
 static void
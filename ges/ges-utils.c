@@ -24,6 +24,7 @@
  */
 
 #include <string.h>
+#include <glib/gstdio.h>
 
 #include "ges-internal.h"
 #include "ges-timeline.h"
@@ -122,3 +123,119 @@ ges_pspec_hash (gconstpointer key_spec)
 
   return h;
 }
+
+/* Returns the location of a file in the @subdir of the GES cache directory
+ * storing data computed from the media at @uri. @extra is hashed along with
+ * the uri, size and modification time of the file, so the location changes
+ * whenever the media or @extra changes. */
+gchar *
+ges_get_media_cache_location (const gchar * uri, const gchar * subdir,
+    const gchar * extra)
+{
+  GFile *file;
+  GFileInfo *info;
+  gchar *key, *location, *data;
+
+  file = g_file_new_for_uri (uri);
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+      G_FILE_ATTRIBUTE_TIME_MODIFIED, G_FILE_QUERY_INFO_NONE, NULL, NULL);
+
+  if (info) {
+    data = g_strdup_printf ("%s\n%" G_GUINT64_FORMAT "\n%" G_GUINT64_FORMAT
+        "\n%s", uri, (guint64) g_file_info_get_size (info),
+        g_file_info_get_attribute_uint64 (info,
+            G_FILE_ATTRIBUTE_TIME_MODIFIED), GST_STR_NULL (extra));
+    g_object_unref (info);
+  } else {
+    data = g_strdup_printf ("%s\n%s", uri, GST_STR_NULL (extra));
+  }
+  g_object_unref (file);
+
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, data, -1);
+  location = g_build_filename (g_get_user_cache_dir (),
+      "gstreamer-editing-services", subdir, key, NULL);
+  g_free (data);
+  g_free (key);
+
+  return location;
+}
+
+/* Maps the file at @location in memory */
+GBytes *
+ges_media_cache_load (const gchar * location)
+{
+  GMappedFile *file;
+
+  file = g_mapped_file_new (location, FALSE, NULL);
+  if (file == NULL)
+    return NULL;
+
+  return g_bytes_new_with_free_func (g_mapped_file_get_contents (file),
+      g_mapped_file_get_length (file), (GDestroyNotify) g_mapped_file_unref,
+      file);
+}
+
+gboolean
+ges_media_cache_save (const gchar * location, GBytes * data)
+{
+  gsize size;
+  gchar *dir;
+  gconstpointer contents;
+  GError *error = NULL;
+
+  dir = g_path_get_dirname (location);
+  g_mkdir_with_parents (dir, 0755);
+  g_free (dir);
+
+  contents = g_bytes_get_data (data, &size);
+  if (!g_file_set_contents (location, contents, size, &error)) {
+    GST_WARNING ("Could not save %s: %s", location, error->message);
+    g_error_free (error);
+
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* How often ges_wait_for_eos checks whether the pipeline is still running */
+#define EOS_POLL_INTERVAL (100 * GST_MSECOND)
+
+/* Waits for @pipeline, already set to PLAYING, to reach EOS. @progress has
+ * to be increased each time data reaches the sinks: when it has not
+ * changed for @stall_timeout, decoding is considered stuck and we give up.
+ * Returns %TRUE if EOS was reached */
+gboolean
+ges_wait_for_eos (GstElement * pipeline, volatile gint * progress,
+    GstClockTime stall_timeout)
+{
+  GstBus *bus;
+  GstMessage *msg;
+  gboolean res = FALSE;
+  GstClockTime stalled = 0;
+  gint last_progress = g_atomic_int_get (progress);
+
+  bus = gst_element_get_bus (pipeline);
+  while (TRUE) {
+    msg = gst_bus_timed_pop_filtered (bus, EOS_POLL_INTERVAL,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+
+    if (msg) {
+      res = GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS;
+      gst_message_unref (msg);
+      break;
+    }
+
+    if (g_atomic_int_get (progress) != last_progress) {
+      last_progress = g_atomic_int_get (progress);
+      stalled = 0;
+    } else if ((stalled += EOS_POLL_INTERVAL) >= stall_timeout) {
+      GST_WARNING_OBJECT (pipeline, "No data for %" GST_TIME_FORMAT
+          ", giving up", GST_TIME_ARGS (stall_timeout));
+      break;
+    }
+  }
+  gst_object_unref (bus);
+
+  return res;
+}
@@ -31,6 +31,7 @@
 #include "ges-video-source.h"
 #include "ges-layer.h"
 #include "gstframepositionner.h"
+#include "gstvideoconform.h"
 
 G_DEFINE_ABSTRACT_TYPE (GESVideoSource, ges_video_source, GES_TYPE_SOURCE);
 
@@ -92,8 +93,7 @@ ges_video_source_create_element (GESTrackElement * trksrc)
   GstElement *sub_element;
   GESVideoSourceClass *source_class = GES_VIDEO_SOURCE_GET_CLASS (trksrc);
   GESVideoSource *self;
-  GstElement *positionner, *videoscale, *videorate, *capsfilter, *videoconvert,
-      *deinterlace;
+  GstElement *positionner, *capsfilter, *conform;
   const gchar *props[] = { "alpha", "posx", "posy", "width", "height", NULL };
   GESTimelineElement *parent;
 
@@ -108,15 +108,9 @@ ges_video_source_create_element (GESTrackElement * trksrc)
      properties, acting like a proxy for our smart-mixer dynamic pads. */
   positionner = gst_element_factory_make ("framepositionner", "frame_tagger");
 
-  videoscale =
-      gst_element_factory_make ("videoscale", "track-element-videoscale");
-  videoconvert =
-      gst_element_factory_make ("videoconvert", "track-element-videoconvert");
-  videorate = gst_element_factory_make ("videorate", "track-element-videorate");
-  deinterlace = gst_element_factory_make ("deinterlace", "deinterlace");
-  if (deinterlace == NULL) {
-    deinterlace = gst_element_factory_make ("avdeinterlace", "deinterlace");
-  }
+  /* Converts, deinterlaces, scales and adapts the framerate, only where
+   * needed */
+  conform = gst_element_factory_make ("videoconform", "track-element-conform");
   capsfilter =
       gst_element_factory_make ("capsfilter", "track-element-capsfilter");
 
@@ -125,21 +119,17 @@ ges_video_source_create_element (GESTrackElement * trksrc)
 
   ges_track_element_add_children_props (trksrc, positionner, NULL, NULL, props);
 
-  if (deinterlace == NULL) {
+  if (GST_VIDEO_CONFORM (conform)->deinterlace == NULL) {
     post_missing_element_message (sub_element, "deinterlace");
 
     GST_ELEMENT_WARNING (sub_element, CORE, MISSING_PLUGIN,
         ("Missing element '%s' - check your GStreamer installation.",
             "deinterlace"), ("deinterlacing won't work"));
-    topbin =
-        ges_source_create_topbin ("videosrcbin", sub_element, videoconvert,
-        positionner, videoscale, videorate, capsfilter, NULL);
-  } else {
-    topbin =
-        ges_source_create_topbin ("videosrcbin", sub_element, videoconvert,
-        deinterlace, positionner, videoscale, videorate, capsfilter, NULL);
   }
 
+  topbin = ges_source_create_topbin ("videosrcbin", sub_element, conform,
+      positionner, capsfilter, NULL);
+
   parent = ges_timeline_element_get_parent (GES_TIMELINE_ELEMENT (trksrc));
   if (parent) {
     self->priv->positionner = GST_FRAME_POSITIONNER (positionner);
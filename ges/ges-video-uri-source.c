@@ -23,7 +23,7 @@
  * @short_description: outputs a single video stream from a given file
  */
 
-#include <gst/pbutils/missing-plugins.h>
+#include <gst/pbutils/pbutils.h>
 
 #include "ges-utils.h"
 #include "ges-internal.h"
@@ -44,12 +44,169 @@ enum
 };
 
 /* GESSource VMethod */
+/* Accurate seeks are turned into seeks to the keyframe found in the seek
+ * index of the asset, the frames decoded before the seek target are then
+ * dropped here and the segment moved to the target, so demuxers do not have
+ * to look for the keyframe themselves. */
+typedef struct
+{
+  GESUriSourceAsset *asset;
+
+  /* Protected by the object lock of the pad */
+  GstClockTime target;
+
+  /* The target of the last seek, only used once its flush is over so that
+   * buffers from before the seek do not clear it */
+  gboolean seek_pending;
+  guint32 seek_seqnum;
+  GstClockTime seek_target;
+} KeyframeSeekData;
+
+static void
+_keyframe_seek_data_free (KeyframeSeekData * data)
+{
+  gst_object_unref (data->asset);
+  g_slice_free (KeyframeSeekData, data);
+}
+
+static GstPadProbeReturn
+_seek_probe (GstPad * pad, GstPadProbeInfo * info, KeyframeSeekData * data)
+{
+  gdouble rate;
+  guint n_skip_frames;
+  GstFormat format;
+  GstSeekFlags flags;
+  GstSeekType start_type, stop_type;
+  gint64 start, stop;
+  GstClockTime keyframe;
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info), *new_event;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_SEEK)
+    return GST_PAD_PROBE_OK;
+
+  gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
+      &stop_type, &stop);
+
+  if (rate != 1.0 || format != GST_FORMAT_TIME ||
+      start_type != GST_SEEK_TYPE_SET || start < 0 ||
+      !(flags & GST_SEEK_FLAG_FLUSH) || !(flags & GST_SEEK_FLAG_ACCURATE) ||
+      !ges_uri_source_asset_get_keyframe (data->asset, start, &keyframe,
+          &n_skip_frames)) {
+    /* The target of a previous seek does not apply anymore */
+    if (flags & GST_SEEK_FLAG_FLUSH) {
+      GST_OBJECT_LOCK (pad);
+      data->seek_pending = TRUE;
+      data->seek_seqnum = gst_event_get_seqnum (event);
+      data->seek_target = GST_CLOCK_TIME_NONE;
+      GST_OBJECT_UNLOCK (pad);
+    }
+
+    return GST_PAD_PROBE_OK;
+  }
+
+  GST_DEBUG_OBJECT (pad, "Seeking to keyframe %" GST_TIME_FORMAT
+      " and skipping %u frames to get to %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (keyframe), n_skip_frames, GST_TIME_ARGS (start));
+
+  GST_OBJECT_LOCK (pad);
+  data->seek_pending = TRUE;
+  data->seek_seqnum = gst_event_get_seqnum (event);
+  data->seek_target = n_skip_frames ? start : GST_CLOCK_TIME_NONE;
+  GST_OBJECT_UNLOCK (pad);
+
+  flags = (flags & ~GST_SEEK_FLAG_ACCURATE) | GST_SEEK_FLAG_KEY_UNIT;
+  new_event = gst_event_new_seek (rate, format, flags, start_type, keyframe,
+      stop_type, stop);
+  gst_event_set_seqnum (new_event, gst_event_get_seqnum (event));
+  gst_event_unref (event);
+  GST_PAD_PROBE_INFO_DATA (info) = new_event;
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+_skip_probe (GstPad * pad, GstPadProbeInfo * info, KeyframeSeekData * data)
+{
+  GstClockTime target;
+  GstPadProbeReturn ret = GST_PAD_PROBE_OK;
+
+  GST_OBJECT_LOCK (pad);
+  if (data->seek_pending &&
+      (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM)) {
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+    /* Everything from before the seek has been flushed by now */
+    if ((GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP ||
+            GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT) &&
+        gst_event_get_seqnum (event) == data->seek_seqnum) {
+      data->target = data->seek_target;
+      data->seek_pending = FALSE;
+    }
+  }
+  target = data->target;
+
+  if (!GST_CLOCK_TIME_IS_VALID (target)) {
+    GST_OBJECT_UNLOCK (pad);
+
+    return GST_PAD_PROBE_OK;
+  }
+
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+    GstClockTime end = GST_BUFFER_PTS (buffer);
+
+    if (GST_CLOCK_TIME_IS_VALID (end) && GST_BUFFER_DURATION_IS_VALID (buffer))
+      end += GST_BUFFER_DURATION (buffer);
+
+    /* Frames before the target are only decoded to get to it */
+    if (GST_CLOCK_TIME_IS_VALID (end) && end <= target) {
+      ret = GST_PAD_PROBE_DROP;
+    } else {
+      data->target = GST_CLOCK_TIME_NONE;
+    }
+  } else if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+      GST_EVENT_SEGMENT) {
+    const GstSegment *segment;
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info), *new_event;
+
+    gst_event_parse_segment (event, &segment);
+    if (segment->format == GST_FORMAT_TIME && segment->start < target) {
+      GstSegment new_segment;
+
+      gst_segment_copy_into (segment, &new_segment);
+      new_segment.time += target - new_segment.start;
+      new_segment.start = new_segment.position = target;
+
+      new_event = gst_event_new_segment (&new_segment);
+      gst_event_set_seqnum (new_event, gst_event_get_seqnum (event));
+      gst_event_unref (event);
+      GST_PAD_PROBE_INFO_DATA (info) = new_event;
+    }
+  }
+  GST_OBJECT_UNLOCK (pad);
+
+  return ret;
+}
+
+static void
+_decodebin_pad_added_cb (GstElement * decodebin, GstPad * pad,
+    KeyframeSeekData * data)
+{
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      (GstPadProbeCallback) _seek_probe, data, NULL);
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, (GstPadProbeCallback) _skip_probe,
+      data, NULL);
+}
+
 static GstElement *
 ges_video_uri_source_create_source (GESTrackElement * trksrc)
 {
   GESVideoUriSource *self;
   GESTrack *track;
+  GESAsset *asset;
   GstElement *decodebin;
+  KeyframeSeekData *data;
 
   self = (GESVideoUriSource *) trksrc;
 
@@ -60,6 +217,24 @@ ges_video_uri_source_create_source (GESTrackElement * trksrc)
   g_object_set (decodebin, "caps", ges_track_get_caps (track),
       "expose-all-streams", FALSE, "uri", self->uri, NULL);
 
+  asset = ges_extractable_get_asset (GES_EXTRACTABLE (self));
+  if (GES_IS_URI_SOURCE_ASSET (asset) &&
+      GST_IS_DISCOVERER_VIDEO_INFO (ges_uri_source_asset_get_stream_info
+          (GES_URI_SOURCE_ASSET (asset)))) {
+    data = g_slice_new0 (KeyframeSeekData);
+    data->asset = gst_object_ref (asset);
+    data->target = GST_CLOCK_TIME_NONE;
+    data->seek_target = GST_CLOCK_TIME_NONE;
+    g_object_set_data_full (G_OBJECT (decodebin), "ges-keyframe-seek", data,
+        (GDestroyNotify) _keyframe_seek_data_free);
+    g_signal_connect (decodebin, "pad-added",
+        G_CALLBACK (_decodebin_pad_added_cb), data);
+
+    /* Start building the index in the background */
+    ges_uri_source_asset_get_keyframe (GES_URI_SOURCE_ASSET (asset), 0, NULL,
+        NULL);
+  }
+
   return decodebin;
 }
 
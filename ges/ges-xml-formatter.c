@@ -625,6 +625,61 @@ wrong_type:
       "element '%s', %s not a GESBaseEffect'", element_name, strtype);
 }
 
+static inline void
+_parse_marker (GMarkupParseContext * context, const gchar * element_name,
+    const gchar ** attribute_names, const gchar ** attribute_values,
+    GESXmlFormatter * self, GError ** error)
+{
+  GType owner_type;
+  guint64 position;
+  const GSList *stack;
+  const gchar *strposition, *metadatas = NULL, *owner;
+
+  if (!g_markup_collect_attributes (element_name, attribute_names,
+          attribute_values, error,
+          G_MARKUP_COLLECT_STRING, "position", &strposition,
+          COLLECT_STR_OPT, "metadatas", &metadatas, G_MARKUP_COLLECT_INVALID))
+    return;
+
+  /* marker < markers < timeline, layer or clip */
+  stack = g_markup_parse_context_get_element_stack (context);
+  if (g_slist_length ((GSList *) stack) < 3 ||
+      g_strcmp0 (stack->next->data, "markers"))
+    goto wrong_parent;
+
+  owner = stack->next->next->data;
+  if (!g_strcmp0 (owner, "timeline"))
+    owner_type = GES_TYPE_TIMELINE;
+  else if (!g_strcmp0 (owner, "layer"))
+    owner_type = GES_TYPE_LAYER;
+  else if (!g_strcmp0 (owner, "clip"))
+    owner_type = GES_TYPE_CLIP;
+  else
+    goto wrong_parent;
+
+  errno = 0;
+  position = g_ascii_strtoull (strposition, NULL, 10);
+  if (errno)
+    goto convertion_failed;
+
+  ges_base_xml_formatter_add_marker (GES_BASE_XML_FORMATTER (self),
+      owner_type, position, metadatas, error);
+
+  return;
+
+wrong_parent:
+  g_set_error (error, G_MARKUP_ERROR,
+      G_MARKUP_ERROR_INVALID_CONTENT,
+      "element '%s' should be in the markers of a timeline, layer or clip",
+      element_name);
+  return;
+
+convertion_failed:
+  g_set_error (error, G_MARKUP_ERROR,
+      G_MARKUP_ERROR_INVALID_CONTENT,
+      "element '%s', Wrong position '%s'", element_name, strposition);
+}
+
 static void
 _parse_element_start (GMarkupParseContext * context, const gchar * element_name,
     const gchar ** attribute_names, const gchar ** attribute_values,
@@ -665,6 +720,9 @@ _parse_element_start (GMarkupParseContext * context, const gchar * element_name,
   else if (g_strcmp0 (element_name, "binding") == 0)
     _parse_binding (context, element_name, attribute_names,
         attribute_values, self, error);
+  else if (g_strcmp0 (element_name, "marker") == 0)
+    _parse_marker (context, element_name, attribute_names,
+        attribute_values, self, error);
   else
     GST_LOG_OBJECT (self, "Element %s not handled", element_name);
 }
@@ -932,6 +990,32 @@ _save_effect (GString * str, guint clip_id, GESTrackElement * trackelement,
   gst_structure_free (structure);
 }
 
+static void
+_save_markers (GString * str, GESMarkerList * markers, guint depth)
+{
+  gchar *metas;
+  GList *tmp, *list;
+
+  if (ges_marker_list_size (markers) == 0)
+    return;
+
+  g_string_append_printf (str, "%*s<markers>\n", depth * 2, "");
+
+  list = ges_marker_list_get_markers (markers);
+  for (tmp = list; tmp; tmp = tmp->next) {
+    metas = ges_meta_container_metas_to_string (tmp->data);
+    g_string_append_printf (str, "%*s", depth * 2 + 2, "");
+    append_escaped (str,
+        g_markup_printf_escaped ("<marker position='%" G_GUINT64_FORMAT
+            "' metadatas='%s'/>\n", ges_marker_get_position (tmp->data),
+            metas));
+    g_free (metas);
+  }
+  g_list_free_full (list, g_object_unref);
+
+  g_string_append_printf (str, "%*s</markers>\n", depth * 2, "");
+}
+
 static inline void
 _save_layers (GString * str, GESTimeline * timeline)
 {
@@ -956,6 +1040,8 @@ _save_layers (GString * str, GESTimeline * timeline)
     g_free (properties);
     g_free (metas);
 
+    _save_markers (str, ges_layer_get_marker_list (layer), 4);
+
     clips = ges_layer_get_clips (layer);
     for (tmpclip = clips; tmpclip; tmpclip = tmpclip->next) {
       GList *effects, *tmpeffect;
@@ -981,6 +1067,8 @@ _save_layers (GString * str, GESTimeline * timeline)
               _DURATION (clip), _INPOINT (clip), 0, properties));
       g_free (properties);
 
+      _save_markers (str, ges_clip_get_marker_list (clip), 5);
+
       for (tmpeffect = effects; tmpeffect; tmpeffect = tmpeffect->next)
         _save_effect (str, nbclips, GES_TRACK_ELEMENT (tmpeffect->data),
             timeline);
@@ -1026,6 +1114,7 @@ _save_timeline (GString * str, GESTimeline * timeline)
       g_markup_printf_escaped
       ("    <timeline properties='%s' metadatas='%s'>\n", properties, metas));
 
+  _save_markers (str, ges_timeline_get_marker_list (timeline), 3);
   _save_tracks (str, timeline);
   _save_layers (str, timeline);
 
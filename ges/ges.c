@@ -20,6 +20,7 @@
 
 #include <ges/ges.h>
 #include "ges/gstframepositionner.h"
+#include "ges/gstvideoconform.h"
 #include "ges-internal.h"
 
 #define GES_GNONLIN_VERSION_NEEDED_MAJOR 1
@@ -91,6 +92,9 @@ ges_init (void)
   GES_TYPE_META_CONTAINER;
 
   ges_asset_cache_init ();
+  ges_frame_cache_init ();
+  ges_audio_peaks_init ();
+  ges_seek_index_init ();
 
   /* check the gnonlin elements are available */
   if (!ges_check_gnonlin_availability ())
@@ -98,6 +102,7 @@ ges_init (void)
 
   gst_element_register (NULL, "framepositionner", 0,
       GST_TYPE_FRAME_POSITIONNER);
+  gst_element_register (NULL, "videoconform", 0, GST_TYPE_VIDEO_CONFORM);
   gst_element_register (NULL, "gespipeline", 0, GES_TYPE_PIPELINE);
 
   /* TODO: user-defined types? */
@@ -44,6 +44,7 @@
 #include <ges/ges-base-effect-clip.h>
 #include <ges/ges-uri-clip.h>
 #include <ges/ges-group.h>
+#include <ges/ges-marker-list.h>
 #include <ges/ges-screenshot.h>
 #include <ges/ges-asset.h>
 #include <ges/ges-clip-asset.h>
@@ -0,0 +1,366 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Fades audio in or out following a gain curve that is sampled once in a
+ * table, each sample is then only interpolated between two table entries,
+ * instead of evaluating a controller for every buffer.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#include "gstaudiofade.h"
+
+GST_DEBUG_CATEGORY_STATIC (audio_fade_debug);
+#define GST_CAT_DEFAULT audio_fade_debug
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define AUDIO_FADE_FORMAT "F32LE"
+#else
+#define AUDIO_FADE_FORMAT "F32BE"
+#endif
+
+#define AUDIO_FADE_CAPS "audio/x-raw, format = (string) " AUDIO_FADE_FORMAT \
+  ", rate = (int) [ 1, MAX ], channels = (int) [ 1, MAX ], " \
+  "layout = (string) interleaved"
+
+static void gst_audio_fade_set_property (GObject * object,
+    guint property_id, const GValue * value, GParamSpec * pspec);
+static void gst_audio_fade_get_property (GObject * object,
+    guint property_id, GValue * value, GParamSpec * pspec);
+static gboolean gst_audio_fade_set_caps (GstBaseTransform * trans,
+    GstCaps * incaps, GstCaps * outcaps);
+static GstFlowReturn gst_audio_fade_transform_ip (GstBaseTransform *
+    trans, GstBuffer * buf);
+
+enum
+{
+  PROP_0,
+  PROP_DURATION,
+  PROP_FADE_IN,
+  PROP_CURVE
+};
+
+static GstStaticPadTemplate gst_audio_fade_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (AUDIO_FADE_CAPS)
+    );
+
+static GstStaticPadTemplate gst_audio_fade_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (AUDIO_FADE_CAPS)
+    );
+
+G_DEFINE_TYPE (GstAudioFade, gst_audio_fade, GST_TYPE_BASE_TRANSFORM);
+
+/* Gain of a fade in at @x, between 0 and 1 */
+static gdouble
+_curve_value (GstAudioFade * fade, gdouble x)
+{
+  gdouble pos, frac;
+  guint index;
+
+  switch (fade->curve) {
+    case GES_AUDIO_FADE_CURVE_EQUAL_POWER:
+      return sin (x * G_PI / 2);
+    case GES_AUDIO_FADE_CURVE_CUSTOM:
+      if (fade->n_custom_values < 2)
+        break;
+
+      pos = x * (fade->n_custom_values - 1);
+      index = MIN ((guint) pos, fade->n_custom_values - 2);
+      frac = pos - index;
+
+      return fade->custom_values[index] * (1 - frac) +
+          fade->custom_values[index + 1] * frac;
+    case GES_AUDIO_FADE_CURVE_LINEAR:
+    default:
+      break;
+  }
+
+  return x;
+}
+
+/* Must be called with the object lock taken */
+static void
+gst_audio_fade_update_gains (GstAudioFade * fade)
+{
+  guint i;
+  gdouble x;
+
+  for (i = 0; i <= GST_AUDIO_FADE_TABLE_SIZE; i++) {
+    x = (gdouble) i / GST_AUDIO_FADE_TABLE_SIZE;
+    fade->gains[i] = _curve_value (fade, fade->fade_in ? x : 1 - x);
+  }
+}
+
+/* Sets the curve used for GES_AUDIO_FADE_CURVE_CUSTOM, @values are the gains
+ * of a fade in, evenly spread over the fade duration. Fade outs use the same
+ * curve reversed. */
+void
+gst_audio_fade_set_custom_curve (GstAudioFade * fade, const gdouble * values,
+    guint n_values)
+{
+  GST_OBJECT_LOCK (fade);
+  g_free (fade->custom_values);
+  fade->custom_values = g_memdup (values, n_values * sizeof (gdouble));
+  fade->n_custom_values = n_values;
+  gst_audio_fade_update_gains (fade);
+  GST_OBJECT_UNLOCK (fade);
+}
+
+static void
+gst_audio_fade_finalize (GObject * object)
+{
+  g_free (GST_AUDIO_FADE (object)->custom_values);
+
+  G_OBJECT_CLASS (gst_audio_fade_parent_class)->finalize (object);
+}
+
+static void
+gst_audio_fade_class_init (GstAudioFadeClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstBaseTransformClass *base_transform_class =
+      GST_BASE_TRANSFORM_CLASS (klass);
+
+  GST_DEBUG_CATEGORY_INIT (audio_fade_debug, "audiofade",
+      GST_DEBUG_FG_YELLOW, "audio fade");
+
+  gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
+      gst_static_pad_template_get (&gst_audio_fade_src_template));
+  gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
+      gst_static_pad_template_get (&gst_audio_fade_sink_template));
+
+  gobject_class->set_property = gst_audio_fade_set_property;
+  gobject_class->get_property = gst_audio_fade_get_property;
+  gobject_class->finalize = gst_audio_fade_finalize;
+  base_transform_class->set_caps = GST_DEBUG_FUNCPTR (gst_audio_fade_set_caps);
+  base_transform_class->transform_ip =
+      GST_DEBUG_FUNCPTR (gst_audio_fade_transform_ip);
+
+  /**
+   * gstaudiofade:duration:
+   *
+   * The duration of the fade, in stream time.
+   */
+  g_object_class_install_property (gobject_class, PROP_DURATION,
+      g_param_spec_uint64 ("duration", "Duration", "Duration of the fade",
+          0, G_MAXUINT64, 0, G_PARAM_READWRITE));
+
+  /**
+   * gstaudiofade:fade-in:
+   *
+   * Whether to fade in or out.
+   */
+  g_object_class_install_property (gobject_class, PROP_FADE_IN,
+      g_param_spec_boolean ("fade-in", "Fade in",
+          "Whether to fade in or out", TRUE, G_PARAM_READWRITE));
+
+  /**
+   * gstaudiofade:curve:
+   *
+   * The shape of the gain curve.
+   */
+  g_object_class_install_property (gobject_class, PROP_CURVE,
+      g_param_spec_enum ("curve", "Curve", "The shape of the gain curve",
+          GES_TYPE_AUDIO_FADE_CURVE, GES_AUDIO_FADE_CURVE_LINEAR,
+          G_PARAM_READWRITE));
+
+  gst_element_class_set_static_metadata (GST_ELEMENT_CLASS (klass),
+      "audio fade", "Filter/Effect/Audio",
+      "Fades audio following a precomputed gain curve",
+      "The GStreamer Editing Services developers");
+}
+
+static void
+gst_audio_fade_init (GstAudioFade * fade)
+{
+  fade->duration = 0;
+  fade->fade_in = TRUE;
+  fade->curve = GES_AUDIO_FADE_CURVE_LINEAR;
+  fade->custom_values = NULL;
+  fade->n_custom_values = 0;
+  fade->rate = 0;
+  fade->channels = 0;
+
+  gst_audio_fade_update_gains (fade);
+  gst_base_transform_set_in_place (GST_BASE_TRANSFORM (fade), TRUE);
+}
+
+static void
+gst_audio_fade_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstAudioFade *fade = GST_AUDIO_FADE (object);
+
+  GST_OBJECT_LOCK (fade);
+  switch (property_id) {
+    case PROP_DURATION:
+      fade->duration = g_value_get_uint64 (value);
+      break;
+    case PROP_FADE_IN:
+      fade->fade_in = g_value_get_boolean (value);
+      gst_audio_fade_update_gains (fade);
+      break;
+    case PROP_CURVE:
+      fade->curve = g_value_get_enum (value);
+      gst_audio_fade_update_gains (fade);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (fade);
+}
+
+static void
+gst_audio_fade_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstAudioFade *fade = GST_AUDIO_FADE (object);
+
+  GST_OBJECT_LOCK (fade);
+  switch (property_id) {
+    case PROP_DURATION:
+      g_value_set_uint64 (value, fade->duration);
+      break;
+    case PROP_FADE_IN:
+      g_value_set_boolean (value, fade->fade_in);
+      break;
+    case PROP_CURVE:
+      g_value_set_enum (value, fade->curve);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (fade);
+}
+
+static gboolean
+gst_audio_fade_set_caps (GstBaseTransform * trans, GstCaps * incaps,
+    GstCaps * outcaps)
+{
+  GstAudioFade *fade = GST_AUDIO_FADE (trans);
+  GstStructure *structure = gst_caps_get_structure (incaps, 0);
+
+  if (!gst_structure_get_int (structure, "rate", &fade->rate) ||
+      !gst_structure_get_int (structure, "channels", &fade->channels)) {
+    GST_WARNING_OBJECT (fade, "Invalid caps %" GST_PTR_FORMAT, incaps);
+
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+_apply_constant_gain (gfloat * data, guint n_samples, gfloat gain)
+{
+  guint i;
+
+  if (gain == 1.0)
+    return;
+
+  if (gain == 0.0) {
+    memset (data, 0, n_samples * sizeof (gfloat));
+
+    return;
+  }
+
+  /* Simple enough for the compiler to vectorize it */
+  for (i = 0; i < n_samples; i++)
+    data[i] *= gain;
+}
+
+static GstFlowReturn
+gst_audio_fade_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
+{
+  GstMapInfo map;
+  GstClockTime stream_time;
+  gdouble pos, step, frac;
+  guint i, c, index, n_frames, channels;
+  gfloat *data, gain;
+  GstAudioFade *fade = GST_AUDIO_FADE (trans);
+
+  if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_GAP) ||
+      fade->channels == 0)
+    return GST_FLOW_OK;
+
+  stream_time = gst_segment_to_stream_time (&trans->segment, GST_FORMAT_TIME,
+      GST_BUFFER_PTS (buf));
+  if (!GST_CLOCK_TIME_IS_VALID (stream_time))
+    stream_time = 0;
+
+  if (!gst_buffer_map (buf, &map, GST_MAP_READWRITE)) {
+    GST_ELEMENT_ERROR (fade, STREAM, FAILED, (NULL),
+        ("Could not map buffer"));
+
+    return GST_FLOW_ERROR;
+  }
+
+  data = (gfloat *) map.data;
+  channels = fade->channels;
+  n_frames = map.size / (sizeof (gfloat) * channels);
+
+  GST_OBJECT_LOCK (fade);
+  if (fade->duration == 0 || stream_time >= fade->duration) {
+    _apply_constant_gain (data, n_frames * channels,
+        fade->gains[GST_AUDIO_FADE_TABLE_SIZE]);
+
+    goto done;
+  }
+
+  /* Position in the gain table, and how much it moves for each frame */
+  pos = (gdouble) stream_time * GST_AUDIO_FADE_TABLE_SIZE / fade->duration;
+  step = (gdouble) GST_SECOND * GST_AUDIO_FADE_TABLE_SIZE /
+      ((gdouble) fade->rate * fade->duration);
+
+  for (i = 0; i < n_frames; i++, pos += step) {
+    if (pos >= GST_AUDIO_FADE_TABLE_SIZE) {
+      _apply_constant_gain (data, (n_frames - i) * channels,
+          fade->gains[GST_AUDIO_FADE_TABLE_SIZE]);
+
+      break;
+    }
+
+    index = (guint) pos;
+    frac = pos - index;
+    gain = fade->gains[index] +
+        frac * (fade->gains[index + 1] - fade->gains[index]);
+
+    for (c = 0; c < channels; c++)
+      *data++ *= gain;
+  }
+
+done:
+  GST_OBJECT_UNLOCK (fade);
+  gst_buffer_unmap (buf, &map);
+
+  return GST_FLOW_OK;
+}
@@ -0,0 +1,73 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _GST_AUDIO_FADE_H_
+#define _GST_AUDIO_FADE_H_
+
+#include <gst/base/gstbasetransform.h>
+#include <ges/ges-enums.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_AUDIO_FADE   (gst_audio_fade_get_type())
+#define GST_AUDIO_FADE(obj)   (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_AUDIO_FADE,GstAudioFade))
+#define GST_AUDIO_FADE_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_AUDIO_FADE,GstAudioFadeClass))
+#define GST_IS_AUDIO_FADE(obj)   (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_AUDIO_FADE))
+#define GST_IS_AUDIO_FADE_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_AUDIO_FADE))
+
+/* Number of intervals the gain curves are sampled on */
+#define GST_AUDIO_FADE_TABLE_SIZE 1024
+
+typedef struct _GstAudioFade GstAudioFade;
+typedef struct _GstAudioFadeClass GstAudioFadeClass;
+
+struct _GstAudioFade
+{
+  GstBaseTransform parent;
+
+  /* Protected by the object lock */
+  GstClockTime duration;
+  gboolean fade_in;
+  GESAudioFadeCurve curve;
+  gdouble *custom_values;
+  guint n_custom_values;
+
+  /* GST_AUDIO_FADE_TABLE_SIZE + 1 gains, from the start to the end of the
+   * fade */
+  gfloat gains[GST_AUDIO_FADE_TABLE_SIZE + 1];
+
+  gint rate;
+  gint channels;
+
+  /*  This should never be made public, no padding needed */
+};
+
+struct _GstAudioFadeClass
+{
+  GstBaseTransformClass parent_class;
+};
+
+void gst_audio_fade_set_custom_curve (GstAudioFade *fade,
+                                      const gdouble *values,
+                                      guint n_values);
+GType gst_audio_fade_get_type (void);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,202 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Conforms the output of video sources to the format of the track: format
+ * conversion, deinterlacing, scaling and framerate adaptation.
+ *
+ * Every stage is only active when the stream needs it, when the incoming
+ * caps already match what downstream (the track restriction caps) accepts,
+ * the whole element is a passthrough and buffers are not touched.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstvideoconform.h"
+
+GST_DEBUG_CATEGORY_STATIC (video_conform_debug);
+#define GST_CAT_DEFAULT video_conform_debug
+
+enum
+{
+  PROP_0,
+  PROP_PASSTHROUGH
+};
+
+static GstStaticPadTemplate gst_video_conform_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw")
+    );
+
+static GstStaticPadTemplate gst_video_conform_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw")
+    );
+
+G_DEFINE_TYPE (GstVideoConform, gst_video_conform, GST_TYPE_BIN);
+
+static gboolean
+_caps_are_progressive (GstCaps * caps)
+{
+  const gchar *mode;
+
+  mode = gst_structure_get_string (gst_caps_get_structure (caps, 0),
+      "interlace-mode");
+
+  return mode == NULL || !g_strcmp0 (mode, "progressive");
+}
+
+static void
+gst_video_conform_update_stages (GstVideoConform * self, GstCaps * caps)
+{
+  GstCaps *allowed;
+  gboolean progressive, passthrough;
+
+  progressive = _caps_are_progressive (caps);
+
+  allowed = gst_pad_peer_query_caps (self->srcpad, NULL);
+  passthrough = progressive && gst_caps_can_intersect (caps, allowed);
+  gst_caps_unref (allowed);
+
+  /* videoconvert, videoscale and videorate are passthrough on their own as
+   * soon as their input and output caps are the same, the deinterlacer
+   * still needs to look at every buffer flags in auto mode though */
+  if (self->deinterlace && progressive != self->progressive) {
+    gst_util_set_object_arg (G_OBJECT (self->deinterlace), "mode",
+        progressive ? "disabled" : "auto");
+  }
+
+  GST_DEBUG_OBJECT (self, "progressive: %d, passthrough: %d, caps: %"
+      GST_PTR_FORMAT, progressive, passthrough, caps);
+
+  GST_OBJECT_LOCK (self);
+  self->progressive = progressive;
+  self->passthrough = passthrough;
+  GST_OBJECT_UNLOCK (self);
+}
+
+static GstPadProbeReturn
+_sink_event_probe (GstPad * pad, GstPadProbeInfo * info, GstVideoConform * self)
+{
+  GstCaps *caps;
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+    gst_event_parse_caps (event, &caps);
+    gst_video_conform_update_stages (self, caps);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+gst_video_conform_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstVideoConform *self = GST_VIDEO_CONFORM (object);
+
+  switch (property_id) {
+    case PROP_PASSTHROUGH:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, self->passthrough);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+  }
+}
+
+static void
+gst_video_conform_class_init (GstVideoConformClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  GST_DEBUG_CATEGORY_INIT (video_conform_debug, "videoconform",
+      GST_DEBUG_FG_YELLOW, "video conform");
+
+  gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
+      gst_static_pad_template_get (&gst_video_conform_src_template));
+  gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
+      gst_static_pad_template_get (&gst_video_conform_sink_template));
+
+  gobject_class->get_property = gst_video_conform_get_property;
+
+  /**
+   * gstvideoconform:passthrough:
+   *
+   * Whether the incoming stream already matches what downstream expects,
+   * in which case buffers go through untouched.
+   */
+  g_object_class_install_property (gobject_class, PROP_PASSTHROUGH,
+      g_param_spec_boolean ("passthrough", "Passthrough",
+          "Whether the stream is passed through untouched", FALSE,
+          G_PARAM_READABLE));
+
+  gst_element_class_set_static_metadata (GST_ELEMENT_CLASS (klass),
+      "video conform", "Filter/Converter/Video",
+      "Conforms video streams to the track format",
+      "The GStreamer Editing Services developers");
+}
+
+static void
+gst_video_conform_init (GstVideoConform * self)
+{
+  GstPad *target;
+
+  self->videoconvert = gst_element_factory_make ("videoconvert", NULL);
+  self->deinterlace = gst_element_factory_make ("deinterlace", NULL);
+  if (self->deinterlace == NULL)
+    self->deinterlace = gst_element_factory_make ("avdeinterlace", NULL);
+  self->videoscale = gst_element_factory_make ("videoscale", NULL);
+  self->videorate = gst_element_factory_make ("videorate", NULL);
+
+  /* The deinterlacer does not support all the formats, convert first */
+  gst_bin_add_many (GST_BIN (self), self->videoconvert, self->videoscale,
+      self->videorate, NULL);
+  if (self->deinterlace) {
+    gst_bin_add (GST_BIN (self), self->deinterlace);
+    gst_util_set_object_arg (G_OBJECT (self->deinterlace), "mode", "disabled");
+    gst_element_link_many (self->videoconvert, self->deinterlace,
+        self->videoscale, self->videorate, NULL);
+  } else {
+    gst_element_link_many (self->videoconvert, self->videoscale,
+        self->videorate, NULL);
+  }
+
+  target = gst_element_get_static_pad (self->videoconvert, "sink");
+  self->sinkpad = gst_ghost_pad_new ("sink", target);
+  gst_object_unref (target);
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  target = gst_element_get_static_pad (self->videorate, "src");
+  self->srcpad = gst_ghost_pad_new ("src", target);
+  gst_object_unref (target);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  gst_pad_add_probe (self->sinkpad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      (GstPadProbeCallback) _sink_event_probe, self, NULL);
+
+  self->progressive = TRUE;
+  self->passthrough = FALSE;
+}
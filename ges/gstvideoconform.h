@@ -0,0 +1,64 @@
+/* GStreamer Editing Services
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _GST_VIDEO_CONFORM_H_
+#define _GST_VIDEO_CONFORM_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_VIDEO_CONFORM   (gst_video_conform_get_type())
+#define GST_VIDEO_CONFORM(obj)   (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_VIDEO_CONFORM,GstVideoConform))
+#define GST_VIDEO_CONFORM_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_VIDEO_CONFORM,GstVideoConformClass))
+#define GST_IS_VIDEO_CONFORM(obj)   (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_VIDEO_CONFORM))
+#define GST_IS_VIDEO_CONFORM_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_VIDEO_CONFORM))
+
+typedef struct _GstVideoConform GstVideoConform;
+typedef struct _GstVideoConformClass GstVideoConformClass;
+
+struct _GstVideoConform
+{
+  GstBin parent;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  GstElement *videoconvert;
+  /* NULL if no deinterlacer is available */
+  GstElement *deinterlace;
+  GstElement *videoscale;
+  GstElement *videorate;
+
+  gboolean progressive;
+  gboolean passthrough;
+
+  /*  This should never be made public, no padding needed */
+};
+
+struct _GstVideoConformClass
+{
+  GstBinClass parent_class;
+};
+
+GType gst_video_conform_get_type (void);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,129 @@
+/* Gstreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Compares mixing many audio inputs with a converter in front of each adder
+ * pad (what GESSmartAdder used to do) and feeding adder directly in float,
+ * then times a GES timeline with as many audio layers */
+
+#include <ges/ges.h>
+
+#define NUM_INPUTS 64
+#define DURATION (10 * GST_SECOND)
+
+static GstClockTime
+run_pipeline (GstElement * pipeline)
+{
+  GstBus *bus;
+  GstMessage *msg;
+  GstClockTime start, end;
+
+  bus = gst_element_get_bus (pipeline);
+
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  end = gst_util_get_timestamp ();
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    g_printerr ("Error running %s\n", GST_OBJECT_NAME (pipeline));
+
+  gst_message_unref (msg);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+
+  return end - start;
+}
+
+static GstElement *
+make_adder_pipeline (gboolean convert)
+{
+  guint i;
+  GString *desc = g_string_new (NULL);
+  GstElement *pipeline;
+  /* 10 seconds of 1024 samples buffers at 44100Hz */
+  guint num_buffers = 10 * 44100 / 1024;
+
+  g_string_append (desc, "adder name=m caps=audio/x-raw,format=F32LE "
+      "! fakesink sync=false ");
+  for (i = 0; i < NUM_INPUTS; i++) {
+    g_string_append_printf (desc, "audiotestsrc num-buffers=%u "
+        "samplesperbuffer=1024 ! audio/x-raw,format=F32LE,rate=44100,"
+        "channels=2 ! %s m. ", num_buffers,
+        convert ? "audioconvert ! audioresample !" : "");
+  }
+
+  pipeline = gst_parse_launch (desc->str, NULL);
+  g_string_free (desc, TRUE);
+
+  return pipeline;
+}
+
+static GstElement *
+make_ges_pipeline (void)
+{
+  guint i;
+  GESAsset *asset;
+  GESTimeline *timeline;
+  GESPipeline *pipeline;
+
+  timeline = ges_timeline_new ();
+  ges_timeline_add_track (timeline, GES_TRACK (ges_audio_track_new ()));
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  for (i = 0; i < NUM_INPUTS; i++)
+    ges_layer_add_asset (ges_timeline_append_layer (timeline), asset, 0, 0,
+        DURATION, GES_TRACK_TYPE_AUDIO);
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  pipeline = ges_pipeline_new ();
+  ges_pipeline_set_timeline (pipeline, timeline);
+  ges_pipeline_preview_set_audio_sink (pipeline,
+      gst_parse_bin_from_description ("fakesink sync=false", TRUE, NULL));
+
+  return GST_ELEMENT (pipeline);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstElement *pipeline;
+
+  gst_init (&argc, &argv);
+  ges_init ();
+
+  pipeline = make_adder_pipeline (TRUE);
+  g_print ("%" GST_TIME_FORMAT " - mixing %d inputs with converters\n",
+      GST_TIME_ARGS (run_pipeline (pipeline)), NUM_INPUTS);
+  gst_object_unref (pipeline);
+
+  pipeline = make_adder_pipeline (FALSE);
+  g_print ("%" GST_TIME_FORMAT " - mixing %d inputs directly\n",
+      GST_TIME_ARGS (run_pipeline (pipeline)), NUM_INPUTS);
+  gst_object_unref (pipeline);
+
+  pipeline = make_ges_pipeline ();
+  g_print ("%" GST_TIME_FORMAT " - playing %d audio layers with GES\n",
+      GST_TIME_ARGS (run_pipeline (pipeline)), NUM_INPUTS);
+  gst_object_unref (pipeline);
+
+  return 0;
+}
@@ -0,0 +1,228 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Runs benchmarks a number of times, prints their statistics and dumps all
+ * the samples as JSON, see compare.py */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench-utils.h"
+
+#define DEFAULT_REPEATS 5
+
+struct _Bench
+{
+  gchar *suite;
+  gint repeats;
+  gchar *output;
+  gchar *filter;
+  GString *json;
+  guint n_results;
+};
+
+static gint
+_compare_times (const GstClockTime * a, const GstClockTime * b)
+{
+  return *a < *b ? -1 : *a > *b ? 1 : 0;
+}
+
+/* Nearest rank percentile of the sorted @samples */
+static GstClockTime
+_percentile (GArray * samples, guint percent)
+{
+  guint rank = (samples->len * percent + 99) / 100;
+
+  return g_array_index (samples, GstClockTime, MAX (rank, 1) - 1);
+}
+
+static GstClockTime
+_median (GArray * samples)
+{
+  guint middle = samples->len / 2;
+
+  if (samples->len % 2)
+    return g_array_index (samples, GstClockTime, middle);
+
+  return (g_array_index (samples, GstClockTime, middle - 1) +
+      g_array_index (samples, GstClockTime, middle)) / 2;
+}
+
+Bench *
+bench_new (const gchar * suite, GOptionEntry * entries, gint * argc,
+    gchar *** argv)
+{
+  GError *err = NULL;
+  GOptionContext *ctx;
+  Bench *bench = g_slice_new0 (Bench);
+  GOptionEntry options[] = {
+    {"repeats", 'r', 0, G_OPTION_ARG_INT, &bench->repeats,
+        "Number of times each benchmark is run (default: 5)", "N"},
+    {"output", 'o', 0, G_OPTION_ARG_FILENAME, &bench->output,
+        "Write the results as JSON to PATH", "PATH"},
+    {"filter", 'f', 0, G_OPTION_ARG_STRING, &bench->filter,
+        "Only run the benchmarks whose name matches PATTERN, which can "
+          "contain '*' and '?' wildcards", "PATTERN"},
+    {NULL}
+  };
+
+  bench->suite = g_strdup (suite);
+  bench->repeats = DEFAULT_REPEATS;
+
+  ctx = g_option_context_new ("- runs the GES benchmarks");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  if (entries)
+    g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+
+  if (!g_option_context_parse (ctx, argc, argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    exit (1);
+  }
+  g_option_context_free (ctx);
+
+  if (bench->repeats < 1)
+    bench->repeats = 1;
+
+  ges_init ();
+
+  bench->json = g_string_new (NULL);
+  g_string_append (bench->json, "{\n  \"suite\": \"");
+  g_string_append (bench->json, suite);
+  g_string_append_printf (bench->json, "\",\n  \"repeats\": %d,\n"
+      "  \"unit\": \"ns\",\n  \"benchmarks\": [", bench->repeats);
+
+  return bench;
+}
+
+/* Records the statistics of @samples, which gets sorted. @n_frames is the
+ * number of frames each sample is the time of, or 0 */
+static void
+_add_result (Bench * bench, const gchar * name, GArray * samples,
+    guint64 n_frames)
+{
+  guint i;
+  GstClockTime total = 0, median;
+
+  if (samples->len == 0)
+    return;
+
+  g_string_append_printf (bench->json, "%s\n    { \"name\": \"%s\", "
+      "\"samples\": [", bench->n_results ? "," : "", name);
+  for (i = 0; i < samples->len; i++) {
+    g_string_append_printf (bench->json, "%s%" G_GUINT64_FORMAT, i ? ", " : "",
+        g_array_index (samples, GstClockTime, i));
+    total += g_array_index (samples, GstClockTime, i);
+  }
+
+  g_array_sort (samples, (GCompareFunc) _compare_times);
+  median = _median (samples);
+  g_string_append_printf (bench->json, "],\n      \"min\": %" G_GUINT64_FORMAT
+      ", \"median\": %" G_GUINT64_FORMAT ", \"p95\": %" G_GUINT64_FORMAT
+      ", \"max\": %" G_GUINT64_FORMAT ", \"mean\": %" G_GUINT64_FORMAT,
+      g_array_index (samples, GstClockTime, 0), median,
+      _percentile (samples, 95),
+      g_array_index (samples, GstClockTime, samples->len - 1),
+      total / samples->len);
+  if (n_frames && median)
+    g_string_append_printf (bench->json, ",\n      \"frames\": %"
+        G_GUINT64_FORMAT ", \"fps\": %.2f", n_frames,
+        (gdouble) n_frames * GST_SECOND / median);
+  g_string_append (bench->json, " }");
+  bench->n_results++;
+
+  g_print ("%-32s median: %" GST_TIME_FORMAT " p95: %" GST_TIME_FORMAT
+      " min: %" GST_TIME_FORMAT, name, GST_TIME_ARGS (median),
+      GST_TIME_ARGS (_percentile (samples, 95)),
+      GST_TIME_ARGS (g_array_index (samples, GstClockTime, 0)));
+  if (n_frames && median)
+    g_print (" (%.2f fps)", (gdouble) n_frames * GST_SECOND / median);
+  g_print ("\n");
+}
+
+gboolean
+bench_wants (Bench * bench, const gchar * name)
+{
+  return !bench->filter || g_pattern_match_simple (bench->filter, name);
+}
+
+void
+bench_run_frames (Bench * bench, const gchar * name, BenchFunc func,
+    gpointer user_data, guint64 n_frames)
+{
+  guint i;
+  GArray *samples;
+
+  if (!bench_wants (bench, name))
+    return;
+
+  samples = g_array_sized_new (FALSE, FALSE, sizeof (GstClockTime),
+      bench->repeats);
+  for (i = 0; i < (guint) bench->repeats; i++) {
+    GstClockTime sample = func (user_data);
+
+    g_array_append_val (samples, sample);
+  }
+
+  _add_result (bench, name, samples, n_frames);
+  g_array_free (samples, TRUE);
+}
+
+void
+bench_run (Bench * bench, const gchar * name, BenchFunc func,
+    gpointer user_data)
+{
+  bench_run_frames (bench, name, func, user_data, 0);
+}
+
+/* For times measured by the benchmarks themselves, like per frame ones */
+void
+bench_add_samples (Bench * bench, const gchar * name, GArray * samples)
+{
+  if (bench_wants (bench, name))
+    _add_result (bench, name, samples, 0);
+}
+
+/* Writes the JSON output and frees @bench, returns the exit code of the
+ * program */
+gint
+bench_finish (Bench * bench)
+{
+  gint ret = 0;
+  GError *err = NULL;
+
+  g_string_append (bench->json, "\n  ]\n}\n");
+
+  if (bench->output && !g_file_set_contents (bench->output, bench->json->str,
+          bench->json->len, &err)) {
+    g_printerr ("Could not write %s: %s\n", bench->output, err->message);
+    g_clear_error (&err);
+    ret = 1;
+  }
+
+  g_string_free (bench->json, TRUE);
+  g_free (bench->suite);
+  g_free (bench->output);
+  g_free (bench->filter);
+  g_slice_free (Bench, bench);
+
+  return ret;
+}
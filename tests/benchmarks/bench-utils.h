@@ -0,0 +1,42 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef _BENCH_UTILS_H_
+#define _BENCH_UTILS_H_
+
+#include <ges/ges.h>
+
+typedef struct _Bench Bench;
+
+/* Runs one iteration of a benchmark and returns the time the measured part
+ * of it took, setting up and tearing down excluded */
+typedef GstClockTime (*BenchFunc) (gpointer user_data);
+
+Bench * bench_new      (const gchar *suite, GOptionEntry *entries,
+                        gint *argc, gchar ***argv);
+gboolean bench_wants   (Bench *bench, const gchar *name);
+void    bench_run      (Bench *bench, const gchar *name, BenchFunc func,
+                        gpointer user_data);
+void    bench_run_frames (Bench *bench, const gchar *name, BenchFunc func,
+                        gpointer user_data, guint64 n_frames);
+void    bench_add_samples (Bench *bench, const gchar *name,
+                        GArray *samples);
+gint    bench_finish   (Bench *bench);
+
+#endif /* _BENCH_UTILS_H_ */
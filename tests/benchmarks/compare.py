@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+#
+# GStreamer Editing Services
+#
+# Copyright (C) 2014 The GStreamer Editing Services developers
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Library General Public
+# License as published by the Free Software Foundation; either
+# version 2 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Library General Public License for more details.
+#
+# You should have received a copy of the GNU Library General Public
+# License along with this library; if not, write to the
+# Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+# Boston, MA 02110-1301, USA.
+
+"""Compares two runs of the benchmark suite, as written by 'suite --output'.
+
+A benchmark regressed when both its median and its p95 got slower by more
+than the threshold, so that a single noisy run is not enough. Exits with 1
+if any benchmark regressed.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return {b["name"]: b for b in json.load(f)["benchmarks"]}
+
+
+def change(old, new):
+    if old == 0:
+        return 0.0
+    return (new - old) * 100.0 / old
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("reference", help="results of the reference build")
+    parser.add_argument("candidate", help="results of the build to check")
+    parser.add_argument("-t", "--threshold", type=float, default=10.0,
+                        help="slowdown in percent tolerated (default: 10)")
+    args = parser.parse_args()
+
+    reference = load(args.reference)
+    candidate = load(args.candidate)
+    regressions = []
+
+    print("%-32s %12s %12s %8s %8s" % ("benchmark", "ref (ms)", "new (ms)",
+                                       "median", "p95"))
+    for name in sorted(set(reference) | set(candidate)):
+        if name not in reference or name not in candidate:
+            print("%-32s only in %s" % (name, args.reference if name in
+                                        reference else args.candidate))
+            continue
+
+        old, new = reference[name], candidate[name]
+        median = change(old["median"], new["median"])
+        p95 = change(old["p95"], new["p95"])
+        regressed = median > args.threshold and p95 > args.threshold
+        if regressed:
+            regressions.append(name)
+
+        print("%-32s %12.3f %12.3f %+7.1f%% %+7.1f%%%s" % (
+            name, old["median"] / 1e6, new["median"] / 1e6, median, p95,
+            "  REGRESSION" if regressed else ""))
+
+    if regressions:
+        print("\n%d benchmark(s) regressed by more than %.1f%%: %s" % (
+            len(regressions), args.threshold, ", ".join(regressions)))
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,265 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Renders timelines of stacked, animated test clips to a fakesink to measure
+ * the compositing path alone: the clips are synthetic and nothing is
+ * encoded. Each layer holds one video test clip whose alpha and position are
+ * keyframed, so that every frame goes through the GstFramePositionner
+ * metadatas and a full blend in the compositor.
+ *
+ * For each resolution and layer count, the total rendering time, and so the
+ * frame rate, are reported as "compositing/WxH/Nlayers", and the interval
+ * between the frames reaching the sink as "compositing/WxH/Nlayers/frame". */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/controller/gstinterpolationcontrolsource.h>
+
+#include "bench-utils.h"
+
+#define FRAMERATE 30
+/* The range of GstFramePositionner:posx and :posy */
+#define MIN_PIXELS -100000
+#define MAX_PIXELS 100000
+
+static gchar *layers_option = NULL;
+static gchar *resolutions_option = NULL;
+static gint duration = 5;
+
+typedef struct
+{
+  gint width;
+  gint height;
+  guint n_layers;
+
+  /* The per frame intervals of all the runs */
+  GArray *frame_times;
+  GstClockTime last_frame;
+} CompositingData;
+
+/* Maps @position in pixels to the [0, 1] value of a direct binding */
+static gdouble
+_pixels_to_control (gint position)
+{
+  return (position - MIN_PIXELS) / (gdouble) (MAX_PIXELS - MIN_PIXELS);
+}
+
+static void
+_animate (GESTrackElement * element, const gchar * property,
+    gdouble start_value, gdouble end_value, GstClockTime end)
+{
+  GstControlSource *source = gst_interpolation_control_source_new ();
+
+  g_object_set (source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+  gst_timed_value_control_source_set (GST_TIMED_VALUE_CONTROL_SOURCE (source),
+      0, start_value);
+  gst_timed_value_control_source_set (GST_TIMED_VALUE_CONTROL_SOURCE (source),
+      end, end_value);
+
+  if (!ges_track_element_set_control_source (element, source, property,
+          "direct"))
+    g_printerr ("Could not animate %s\n", property);
+
+  gst_object_unref (source);
+}
+
+/* Every layer gets a clip covering the whole timeline, fading in and
+ * sliding diagonally over the layers below it */
+static GESTimeline *
+make_timeline (CompositingData * data)
+{
+  guint i;
+  GstCaps *caps;
+  GESTrack *track;
+  GstClockTime end = duration * GST_SECOND;
+  GESTimeline *timeline = ges_timeline_new ();
+  GESAsset *asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+
+  track = GES_TRACK (ges_video_track_new ());
+  caps = gst_caps_new_simple ("video/x-raw", "width", G_TYPE_INT, data->width,
+      "height", G_TYPE_INT, data->height, "framerate", GST_TYPE_FRACTION,
+      FRAMERATE, 1, NULL);
+  ges_track_set_restriction_caps (track, caps);
+  gst_caps_unref (caps);
+  ges_timeline_add_track (timeline, track);
+
+  for (i = 0; i < data->n_layers; i++) {
+    GESTrackElement *source;
+    GESLayer *layer = ges_timeline_append_layer (timeline);
+    GESClip *clip = ges_layer_add_asset (layer, asset, 0, 0, end,
+        GES_TRACK_TYPE_VIDEO);
+
+    ges_test_clip_set_vpattern (GES_TEST_CLIP (clip),
+        i % GES_VIDEO_TEST_PATTERN_SMPTE75);
+
+    source = ges_clip_find_track_element (clip, track, GES_TYPE_VIDEO_SOURCE);
+    if (source == NULL) {
+      g_printerr ("No video source in the test clip\n");
+      continue;
+    }
+
+    _animate (source, "alpha", 0.2, 1.0, end);
+    _animate (source, "posx", _pixels_to_control (-data->width / 2),
+        _pixels_to_control (data->width / 2), end);
+    _animate (source, "posy", _pixels_to_control (-data->height / 2),
+        _pixels_to_control (data->height / 2), end);
+    gst_object_unref (source);
+  }
+
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  return timeline;
+}
+
+static GstPadProbeReturn
+_frame_probe (GstPad * pad, GstPadProbeInfo * info, CompositingData * data)
+{
+  GstClockTime now = gst_util_get_timestamp ();
+
+  if (GST_CLOCK_TIME_IS_VALID (data->last_frame)) {
+    GstClockTime interval = now - data->last_frame;
+
+    g_array_append_val (data->frame_times, interval);
+  }
+  data->last_frame = now;
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Time to play through the timeline as fast as possible, prerolling
+ * included */
+static GstClockTime
+bench_compositing (CompositingData * data)
+{
+  GstBus *bus;
+  GstPad *sinkpad;
+  GstMessage *message;
+  GESPipeline *pipeline;
+  GstClockTime start, end;
+  GESTimeline *timeline = make_timeline (data);
+  GstElement *sink = gst_element_factory_make ("fakesink", NULL);
+
+  g_object_set (sink, "sync", FALSE, NULL);
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (sinkpad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) _frame_probe, data, NULL);
+  gst_object_unref (sinkpad);
+  data->last_frame = GST_CLOCK_TIME_NONE;
+
+  pipeline = ges_pipeline_new ();
+  ges_pipeline_set_timeline (pipeline, timeline);
+  g_object_set (pipeline, "video-sink", sink, NULL);
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  end = gst_util_get_timestamp ();
+
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR)
+    g_printerr ("Error rendering the timeline\n");
+
+  gst_message_unref (message);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return end - start;
+}
+
+static void
+run_resolution (Bench * bench, gint width, gint height, gchar ** layers)
+{
+  guint i;
+  CompositingData data = { width, height, 0, NULL, GST_CLOCK_TIME_NONE };
+
+  for (i = 0; layers[i]; i++) {
+    gchar *name;
+
+    data.n_layers = strtoul (layers[i], NULL, 10);
+    if (data.n_layers == 0) {
+      g_printerr ("Invalid layer count: %s\n", layers[i]);
+      continue;
+    }
+
+    name = g_strdup_printf ("compositing/%dx%d/%ulayers", width, height,
+        data.n_layers);
+    data.frame_times = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+
+    bench_run_frames (bench, name, (BenchFunc) bench_compositing, &data,
+        (guint64) duration * FRAMERATE);
+    g_free (name);
+
+    name = g_strdup_printf ("compositing/%dx%d/%ulayers/frame", width, height,
+        data.n_layers);
+    bench_add_samples (bench, name, data.frame_times);
+    g_array_free (data.frame_times, TRUE);
+    g_free (name);
+  }
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i;
+  Bench *bench;
+  gchar **layers, **resolutions;
+  GOptionEntry options[] = {
+    {"layers", 'l', 0, G_OPTION_ARG_STRING, &layers_option,
+        "Comma separated numbers of composited layers (default: 1,4,16)",
+        "N,..."},
+    {"resolutions", 's', 0, G_OPTION_ARG_STRING, &resolutions_option,
+          "Comma separated output resolutions "
+          "(default: 320x240,1280x720,1920x1080)", "WxH,..."},
+    {"duration", 'd', 0, G_OPTION_ARG_INT, &duration,
+        "Duration of the rendered timelines in seconds (default: 5)", "S"},
+    {NULL}
+  };
+
+  bench = bench_new ("ges-compositing", options, &argc, &argv);
+
+  if (duration < 1)
+    duration = 1;
+
+  layers = g_strsplit (layers_option ? layers_option : "1,4,16", ",", -1);
+  resolutions = g_strsplit (resolutions_option ? resolutions_option :
+      "320x240,1280x720,1920x1080", ",", -1);
+
+  for (i = 0; resolutions[i]; i++) {
+    gint width, height;
+
+    if (sscanf (resolutions[i], "%dx%d", &width, &height) != 2 || width <= 0
+        || height <= 0) {
+      g_printerr ("Invalid resolution: %s\n", resolutions[i]);
+      continue;
+    }
+
+    run_resolution (bench, width, height, layers);
+  }
+
+  g_strfreev (layers);
+  g_strfreev (resolutions);
+  g_free (layers_option);
+  g_free (resolutions_option);
+
+  return bench_finish (bench);
+}
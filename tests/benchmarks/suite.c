@@ -0,0 +1,632 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The GES benchmark suite, covering timeline building, editing, groups,
+ * commits, projects, assets, metadatas, queries and rendering.
+ *
+ * 'make benchmark' runs it and writes benchmark-results.json, two of those
+ * can then be compared with:
+ *
+ *   ./compare.py reference.json benchmark-results.json
+ *
+ * which exits with 1 if some benchmark regressed. */
+
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "bench-utils.h"
+
+#define CLIP_DURATION GST_SECOND
+#define N_EDITS 100
+#define N_EDITED_CLIPS 1000
+#define N_GROUPED_CLIPS 100
+#define N_ASSETS 10
+#define N_RENDERED_CLIPS 10
+#define N_META_CLIPS 10000
+#define N_METAS 20
+#define N_SCENES 100
+#define N_QUERIES 1000
+
+static gint max_clips = 100000;
+
+/* Only the first layer is filled, the others are there to move clips to */
+static GESTimeline *
+make_timeline (guint n_clips, guint n_layers, GstClockTime spacing,
+    gboolean auto_transition, GESLayer ** first_layer)
+{
+  guint i;
+  GESLayer *layer = NULL;
+  GESAsset *asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  GESTimeline *timeline = ges_timeline_new_audio_video ();
+
+  for (i = 0; i < n_layers; i++) {
+    GESLayer *tmplayer = ges_timeline_append_layer (timeline);
+
+    ges_layer_set_auto_transition (tmplayer, auto_transition);
+    if (layer == NULL)
+      layer = tmplayer;
+  }
+
+  for (i = 0; i < n_clips; i++)
+    ges_layer_add_asset (layer, asset, i * spacing, 0, CLIP_DURATION,
+        GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+
+  if (first_layer)
+    *first_layer = layer;
+
+  return timeline;
+}
+
+/* Returns: (transfer none): the clip at @index in @layer */
+static GESClip *
+get_clip (GESLayer * layer, guint index)
+{
+  GList *clips = ges_layer_get_clips (layer);
+  GESClip *clip = g_list_nth_data (clips, index);
+
+  g_list_free_full (clips, gst_object_unref);
+
+  return clip;
+}
+
+/****************************************************
+ *              Timeline building                   *
+ ****************************************************/
+
+static GstClockTime
+bench_build (gpointer n_clips)
+{
+  guint i;
+  GstClockTime start, end;
+  GESAsset *asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  GESTimeline *timeline = ges_timeline_new_audio_video ();
+  GESLayer *layer = ges_timeline_append_layer (timeline);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < GPOINTER_TO_UINT (n_clips); i++)
+    ges_layer_add_asset (layer, asset, i * CLIP_DURATION, 0, CLIP_DURATION,
+        GES_TRACK_TYPE_UNKNOWN);
+  end = gst_util_get_timestamp ();
+
+  gst_object_unref (timeline);
+  gst_object_unref (asset);
+
+  return end - start;
+}
+
+/****************************************************
+ *                  Editing                         *
+ ****************************************************/
+
+typedef struct
+{
+  GESEditMode mode;
+  GESEdge edge;
+  gboolean change_layer;
+} EditData;
+
+static GstClockTime
+bench_edit (EditData * data)
+{
+  guint i;
+  GESClip *clip;
+  GESLayer *layer;
+  GstClockTime start, end, position;
+  GESTimeline *timeline = make_timeline (N_EDITED_CLIPS, 2, CLIP_DURATION,
+      FALSE, &layer);
+
+  clip = get_clip (layer, N_EDITED_CLIPS / 2);
+  position = GES_TIMELINE_ELEMENT_START (clip);
+  if (data->edge == GES_EDGE_END)
+    position += GES_TIMELINE_ELEMENT_DURATION (clip);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < N_EDITS; i++) {
+    gint priority = data->change_layer ? (i + 1) % 2 : -1;
+
+    /* Go back and forth so that we never run out of room */
+    ges_container_edit (GES_CONTAINER (clip), NULL, priority, data->mode,
+        data->edge, position + (i % 2 ? 0 : CLIP_DURATION / 4));
+  }
+  end = gst_util_get_timestamp ();
+
+  gst_object_unref (timeline);
+
+  return end - start;
+}
+
+/****************************************************
+ *                  Groups                          *
+ ****************************************************/
+
+/* Groups every other clip of @layer */
+static GESContainer *
+make_group (GESLayer * layer)
+{
+  guint i;
+  GESContainer *group;
+  GList *clips = ges_layer_get_clips (layer), *grouped = NULL;
+
+  for (i = 0; i < N_GROUPED_CLIPS; i++)
+    grouped = g_list_prepend (grouped, g_list_nth_data (clips, i * 2));
+
+  group = ges_container_group (grouped);
+  g_list_free (grouped);
+  g_list_free_full (clips, gst_object_unref);
+
+  return group;
+}
+
+static GstClockTime
+bench_group_create (gpointer unused)
+{
+  GESLayer *layer;
+  GstClockTime start, end;
+  GESTimeline *timeline = make_timeline (N_EDITED_CLIPS, 1, CLIP_DURATION,
+      FALSE, &layer);
+
+  start = gst_util_get_timestamp ();
+  make_group (layer);
+  end = gst_util_get_timestamp ();
+
+  gst_object_unref (timeline);
+
+  return end - start;
+}
+
+static GstClockTime
+bench_group_move (gpointer unused)
+{
+  guint i;
+  GESLayer *layer;
+  GstClockTime start, end;
+  GESTimeline *timeline = make_timeline (N_EDITED_CLIPS, 1, CLIP_DURATION,
+      FALSE, &layer);
+  GESContainer *group = make_group (layer);
+
+  /* Move past the other clips, where there is room */
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < N_EDITS; i++)
+    ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (group),
+        (N_EDITED_CLIPS + i % 2) * CLIP_DURATION);
+  end = gst_util_get_timestamp ();
+
+  gst_object_unref (timeline);
+
+  return end - start;
+}
+
+static GstClockTime
+bench_group_ungroup (gpointer unused)
+{
+  GList *clips;
+  GESLayer *layer;
+  GstClockTime start, end;
+  GESTimeline *timeline = make_timeline (N_EDITED_CLIPS, 1, CLIP_DURATION,
+      FALSE, &layer);
+  GESContainer *group = make_group (layer);
+
+  start = gst_util_get_timestamp ();
+  clips = ges_container_ungroup (group, FALSE);
+  end = gst_util_get_timestamp ();
+
+  g_list_free_full (clips, gst_object_unref);
+  gst_object_unref (timeline);
+
+  return end - start;
+}
+
+/****************************************************
+ *                  Committing                      *
+ ****************************************************/
+
+static GstClockTime
+bench_commit (gpointer auto_transition)
+{
+  GstClockTime start, end;
+  /* Clips overlap by half so that transitions get created */
+  GESTimeline *timeline = make_timeline (N_EDITED_CLIPS, 1, CLIP_DURATION / 2,
+      GPOINTER_TO_INT (auto_transition), NULL);
+
+  start = gst_util_get_timestamp ();
+  ges_timeline_commit (timeline);
+  end = gst_util_get_timestamp ();
+
+  gst_object_unref (timeline);
+
+  return end - start;
+}
+
+/****************************************************
+ *                  Projects                        *
+ ****************************************************/
+
+static gchar *
+make_temp_uri (const gchar * template)
+{
+  gint fd;
+  gchar *path, *uri;
+
+  fd = g_file_open_tmp (template, &path, NULL);
+  g_assert (fd >= 0);
+  close (fd);
+
+  uri = gst_filename_to_uri (path, NULL);
+  g_free (path);
+
+  return uri;
+}
+
+static void
+remove_uri (const gchar * uri)
+{
+  gchar *path = gst_uri_get_location (uri);
+
+  g_unlink (path);
+  g_free (path);
+}
+
+static GstClockTime
+bench_project_save (gpointer unused)
+{
+  GstClockTime start, end;
+  gchar *uri = make_temp_uri ("ges-bench-XXXXXX.xges");
+  GESTimeline *timeline = make_timeline (N_EDITED_CLIPS, 1, CLIP_DURATION,
+      FALSE, NULL);
+
+  start = gst_util_get_timestamp ();
+  if (!ges_timeline_save_to_uri (timeline, uri, NULL, TRUE, NULL))
+    g_printerr ("Could not save to %s\n", uri);
+  end = gst_util_get_timestamp ();
+
+  gst_object_unref (timeline);
+  remove_uri (uri);
+  g_free (uri);
+
+  return end - start;
+}
+
+static void
+project_loaded_cb (GESProject * project, GESTimeline * timeline,
+    GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+}
+
+static GstClockTime
+bench_project_load (gpointer unused)
+{
+  GMainLoop *loop;
+  GESProject *project;
+  GstClockTime start, end;
+  gchar *uri = make_temp_uri ("ges-bench-XXXXXX.xges");
+  GESTimeline *timeline = make_timeline (N_EDITED_CLIPS, 1, CLIP_DURATION,
+      FALSE, NULL);
+
+  ges_timeline_save_to_uri (timeline, uri, NULL, TRUE, NULL);
+  gst_object_unref (timeline);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  project = ges_project_new (uri);
+  g_signal_connect (project, "loaded", G_CALLBACK (project_loaded_cb), loop);
+
+  start = gst_util_get_timestamp ();
+  timeline = GES_TIMELINE (ges_asset_extract (GES_ASSET (project), NULL));
+  g_main_loop_run (loop);
+  end = gst_util_get_timestamp ();
+
+  gst_object_unref (timeline);
+  gst_object_unref (project);
+  g_main_loop_unref (loop);
+  remove_uri (uri);
+  g_free (uri);
+
+  return end - start;
+}
+
+/****************************************************
+ *                  Assets                          *
+ ****************************************************/
+
+/* Copies of the media so that each run discovers them again instead of
+ * hitting the asset cache */
+static GstClockTime
+bench_asset_load (gpointer unused)
+{
+  guint i;
+  GstClockTime start, end;
+  gchar *contents, *dir;
+  gsize length;
+  gchar *uris[N_ASSETS];
+
+  if (!g_file_get_contents (GES_BENCH_MEDIA, &contents, &length, NULL)) {
+    g_printerr ("Could not read %s\n", GES_BENCH_MEDIA);
+
+    return 0;
+  }
+
+  dir = g_dir_make_tmp ("ges-bench-XXXXXX", NULL);
+  for (i = 0; i < N_ASSETS; i++) {
+    gchar *name = g_strdup_printf ("%u.ogg", i);
+    gchar *path = g_build_filename (dir, name, NULL);
+
+    g_file_set_contents (path, contents, length, NULL);
+    uris[i] = gst_filename_to_uri (path, NULL);
+    g_free (path);
+    g_free (name);
+  }
+  g_free (contents);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < N_ASSETS; i++) {
+    GESUriClipAsset *asset =
+        ges_uri_clip_asset_request_sync (uris[i], NULL);
+
+    if (asset)
+      gst_object_unref (asset);
+  }
+  end = gst_util_get_timestamp ();
+
+  for (i = 0; i < N_ASSETS; i++) {
+    remove_uri (uris[i]);
+    g_free (uris[i]);
+  }
+  g_rmdir (dir);
+  g_free (dir);
+
+  return end - start;
+}
+
+/****************************************************
+ *                  Metadatas                       *
+ ****************************************************/
+
+static const gchar *meta_names[N_METAS] = {
+  "reel", "scene", "take", "camera", "color-tag", "shot", "angle", "lens",
+  "location", "operator", "rating", "keyword", "note", "day", "roll",
+  "sound-roll", "slate", "circled", "comment", "status"
+};
+
+/* Sets N_METAS metas on every clip, "scene" cycling through N_SCENES
+ * values, and returns the time it took */
+static GstClockTime
+set_metas (GESLayer * layer)
+{
+  guint i, j;
+  GList *clips, *tmp;
+  GstClockTime start, end;
+
+  clips = ges_layer_get_clips (layer);
+  start = gst_util_get_timestamp ();
+  for (tmp = clips, i = 0; tmp; tmp = tmp->next, i++) {
+    for (j = 0; j < N_METAS; j++) {
+      gchar *value = g_strdup_printf ("%u", j == 1 ? i % N_SCENES : i);
+
+      ges_meta_container_set_string (tmp->data, meta_names[j], value);
+      g_free (value);
+    }
+  }
+  end = gst_util_get_timestamp ();
+  g_list_free_full (clips, gst_object_unref);
+
+  return end - start;
+}
+
+static GstClockTime
+bench_meta_set (gpointer unused)
+{
+  GESLayer *layer;
+  GstClockTime time;
+  GESTimeline *timeline = make_timeline (N_META_CLIPS, 1, CLIP_DURATION,
+      FALSE, &layer);
+
+  time = set_metas (layer);
+  gst_object_unref (timeline);
+
+  return time;
+}
+
+/* Finds the clips of every scene, indexing included */
+static GstClockTime
+bench_meta_find (gpointer unused)
+{
+  guint i;
+  GESLayer *layer;
+  GstClockTime start, end;
+  GValue value = { 0, };
+  GESTimeline *timeline = make_timeline (N_META_CLIPS, 1, CLIP_DURATION,
+      FALSE, &layer);
+
+  set_metas (layer);
+  g_value_init (&value, G_TYPE_STRING);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < N_SCENES; i++) {
+    gchar *scene = g_strdup_printf ("%u", i);
+
+    g_value_take_string (&value, scene);
+    g_list_free_full (ges_timeline_find_elements_by_meta (timeline, "scene",
+            &value), gst_object_unref);
+  }
+  end = gst_util_get_timestamp ();
+
+  g_value_unset (&value);
+  gst_object_unref (timeline);
+
+  return end - start;
+}
+
+/****************************************************
+ *                  Queries                         *
+ ****************************************************/
+
+/* Looks for the clips under N_QUERIES playhead positions */
+static GstClockTime
+bench_query_at (gpointer unused)
+{
+  guint i;
+  GValue item = { 0, };
+  GstClockTime start, end;
+  GESTimeline *timeline = make_timeline (N_META_CLIPS, 1, CLIP_DURATION,
+      FALSE, NULL);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < N_QUERIES; i++) {
+    GstIterator *it = ges_timeline_iterate_clips_at (timeline,
+        g_random_int_range (0, N_META_CLIPS) * CLIP_DURATION + 1);
+
+    while (gst_iterator_next (it, &item) == GST_ITERATOR_OK)
+      g_value_reset (&item);
+    gst_iterator_free (it);
+  }
+  end = gst_util_get_timestamp ();
+
+  if (G_IS_VALUE (&item))
+    g_value_unset (&item);
+  gst_object_unref (timeline);
+
+  return end - start;
+}
+
+/****************************************************
+ *                  Rendering                       *
+ ****************************************************/
+
+/* Time to play as fast as possible through a timeline of synthetic clips */
+static GstClockTime
+bench_render (gpointer with_titles)
+{
+  guint i;
+  GstBus *bus;
+  GList *clips, *tmp;
+  GESLayer *layer;
+  GstMessage *message;
+  GESPipeline *pipeline;
+  GstClockTime start, end;
+  GESTimeline *timeline = make_timeline (N_RENDERED_CLIPS, 2, CLIP_DURATION,
+      FALSE, &layer);
+
+  clips = ges_layer_get_clips (layer);
+  for (tmp = clips, i = 0; tmp; tmp = tmp->next, i++)
+    ges_test_clip_set_vpattern (tmp->data, i % GES_VIDEO_TEST_PATTERN_SMPTE75);
+  g_list_free_full (clips, gst_object_unref);
+
+  if (GPOINTER_TO_INT (with_titles)) {
+    GESAsset *asset = ges_asset_request (GES_TYPE_TITLE_CLIP, NULL, NULL);
+    GList *layers = ges_timeline_get_layers (timeline);
+
+    /* Composited with the test clips */
+    layer = g_list_last (layers)->data;
+    for (i = 0; i < N_RENDERED_CLIPS; i++) {
+      GESClip *clip = ges_layer_add_asset (layer, asset, i * CLIP_DURATION, 0,
+          CLIP_DURATION, GES_TRACK_TYPE_UNKNOWN);
+
+      ges_title_clip_set_text (GES_TITLE_CLIP (clip), "GStreamer Editing "
+          "Services benchmark");
+    }
+    gst_object_unref (asset);
+    g_list_free_full (layers, gst_object_unref);
+  }
+  ges_timeline_commit (timeline);
+
+  pipeline = ges_pipeline_new ();
+  ges_pipeline_set_timeline (pipeline, timeline);
+  g_object_set (pipeline,
+      "audio-sink", gst_element_factory_make ("fakesink", NULL),
+      "video-sink", gst_element_factory_make ("fakesink", NULL), NULL);
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PLAYING);
+  message = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  end = gst_util_get_timestamp ();
+
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR)
+    g_printerr ("Error rendering the timeline\n");
+
+  gst_message_unref (message);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return end - start;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint n_clips;
+  Bench *bench;
+  static EditData normal = { GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, FALSE };
+  static EditData ripple = { GES_EDIT_MODE_RIPPLE, GES_EDGE_NONE, FALSE };
+  static EditData roll = { GES_EDIT_MODE_ROLL, GES_EDGE_END, FALSE };
+  static EditData trim = { GES_EDIT_MODE_TRIM, GES_EDGE_START, FALSE };
+  static EditData slide = { GES_EDIT_MODE_SLIDE, GES_EDGE_NONE, FALSE };
+  static EditData layers = { GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, TRUE };
+  GOptionEntry options[] = {
+    {"max-clips", 'm', 0, G_OPTION_ARG_INT, &max_clips,
+        "Largest timeline built (default: 100000)", "N"},
+    {NULL}
+  };
+
+  bench = bench_new ("ges", options, &argc, &argv);
+
+  for (n_clips = 1000; n_clips <= (guint) max_clips; n_clips *= 10) {
+    gchar *name = g_strdup_printf ("build/%u", n_clips);
+
+    bench_run (bench, name, bench_build, GUINT_TO_POINTER (n_clips));
+    g_free (name);
+  }
+
+  bench_run (bench, "edit/normal", (BenchFunc) bench_edit, &normal);
+  bench_run (bench, "edit/ripple", (BenchFunc) bench_edit, &ripple);
+  bench_run (bench, "edit/roll", (BenchFunc) bench_edit, &roll);
+  bench_run (bench, "edit/trim", (BenchFunc) bench_edit, &trim);
+  bench_run (bench, "edit/slide", (BenchFunc) bench_edit, &slide);
+  bench_run (bench, "edit/move-layer", (BenchFunc) bench_edit, &layers);
+
+  bench_run (bench, "group/create", bench_group_create, NULL);
+  bench_run (bench, "group/move", bench_group_move, NULL);
+  bench_run (bench, "group/ungroup", bench_group_ungroup, NULL);
+
+  bench_run (bench, "commit/plain", bench_commit, GINT_TO_POINTER (FALSE));
+  bench_run (bench, "commit/auto-transition", bench_commit,
+      GINT_TO_POINTER (TRUE));
+
+  bench_run (bench, "project/save", bench_project_save, NULL);
+  bench_run (bench, "project/load", bench_project_load, NULL);
+
+  bench_run (bench, "asset/load", bench_asset_load, NULL);
+
+  bench_run (bench, "meta/set", bench_meta_set, NULL);
+  bench_run (bench, "meta/find", bench_meta_find, NULL);
+
+  bench_run (bench, "query/at", bench_query_at, NULL);
+
+  bench_run (bench, "render/test-clips", bench_render,
+      GINT_TO_POINTER (FALSE));
+  bench_run (bench, "render/title-clips", bench_render,
+      GINT_TO_POINTER (TRUE));
+
+  return bench_finish (bench);
+}
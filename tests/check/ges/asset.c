@@ -96,6 +96,57 @@ GST_START_TEST (test_change_asset)
 
 GST_END_TEST;
 
+GST_START_TEST (test_move_extractables)
+{
+  GList *extractables;
+  GESAsset *box, *bar, *effect;
+  GESExtractable *first, *second;
+
+  gst_init (NULL, NULL);
+  ges_init ();
+
+  box = ges_asset_request (GES_TYPE_TRANSITION_CLIP, "box-wipe-lc", NULL);
+  bar = ges_asset_request (GES_TYPE_TRANSITION_CLIP, "bar-wipe-tb", NULL);
+  effect = ges_asset_request (GES_TYPE_EFFECT, "identity", NULL);
+  fail_unless (box && bar && effect);
+
+  fail_if (ges_asset_list_extractables (box));
+  first = gst_object_ref_sink (ges_asset_extract (box, NULL));
+  second = gst_object_ref_sink (ges_asset_extract (box, NULL));
+
+  extractables = ges_asset_list_extractables (box);
+  assert_equals_int (g_list_length (extractables), 2);
+  fail_unless (g_list_find (extractables, first));
+  fail_unless (g_list_find (extractables, second));
+  g_list_free_full (extractables, gst_object_unref);
+
+  /* Only assets extracting the same type can be used instead */
+  assert_equals_int (ges_asset_move_extractables (box, effect), 0);
+  fail_unless (ges_extractable_get_asset (first) == box);
+
+  assert_equals_int (ges_asset_move_extractables (box, bar), 2);
+  fail_if (ges_asset_list_extractables (box));
+  fail_unless (ges_extractable_get_asset (first) == bar);
+  fail_unless (ges_extractable_get_asset (second) == bar);
+  fail_unless_equals_int (GES_TRANSITION_CLIP (first)->vtype, 2);
+
+  /* Destroyed extractables are removed from the index */
+  gst_object_unref (first);
+  extractables = ges_asset_list_extractables (bar);
+  assert_equals_int (g_list_length (extractables), 1);
+  fail_unless (extractables->data == second);
+  g_list_free_full (extractables, gst_object_unref);
+
+  gst_object_unref (second);
+  fail_if (ges_asset_list_extractables (bar));
+
+  gst_object_unref (box);
+  gst_object_unref (bar);
+  gst_object_unref (effect);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_list_asset)
 {
   GList *assets;
@@ -162,6 +213,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_list_asset);
   tcase_add_test (tc_chain, test_basic);
   tcase_add_test (tc_chain, test_change_asset);
+  tcase_add_test (tc_chain, test_move_extractables);
   tcase_add_test (tc_chain, test_proxy_asset);
 
   return s;
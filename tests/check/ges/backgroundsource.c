@@ -396,6 +396,69 @@ GST_START_TEST (test_gap_filling_empty_track)
 
 GST_END_TEST;
 
+static void
+check_video_conform (const gchar * input, const gchar * output,
+    gboolean passthrough)
+{
+  gchar *desc;
+  GstPad *sinkpad;
+  GstCaps *caps, *expected;
+  gboolean conform_passthrough;
+  GstElement *pipeline, *conform, *sink;
+
+  desc = g_strdup_printf ("videotestsrc ! capsfilter caps=\"%s\" ! "
+      "videoconform name=conform ! capsfilter caps=\"%s\" ! "
+      "fakesink name=sink", input, output);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  conform = gst_bin_get_by_name (GST_BIN (pipeline), "conform");
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+
+  /* Prerolling means the conformed buffer got through to the sink */
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PAUSED) !=
+      GST_STATE_CHANGE_FAILURE);
+  fail_unless (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_SUCCESS);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  caps = gst_pad_get_current_caps (sinkpad);
+  expected = gst_caps_from_string (output);
+  fail_unless (caps != NULL);
+  fail_unless (gst_caps_is_subset (caps, expected));
+  gst_caps_unref (expected);
+  gst_caps_unref (caps);
+  gst_object_unref (sinkpad);
+
+  g_object_get (conform, "passthrough", &conform_passthrough, NULL);
+  assert_equals_int (conform_passthrough, passthrough);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (sink);
+  gst_object_unref (conform);
+  gst_object_unref (pipeline);
+}
+
+GST_START_TEST (test_video_conform)
+{
+  ges_init ();
+
+  /* Format, size and framerate all differ from what downstream wants */
+  check_video_conform ("video/x-raw,format=I420,width=320,height=240,"
+      "framerate=30/1,pixel-aspect-ratio=1/1",
+      "video/x-raw,format=RGBA,width=160,height=120,framerate=25/1,"
+      "pixel-aspect-ratio=1/1", FALSE);
+
+  /* Same caps on both sides, nothing has to be done */
+  check_video_conform ("video/x-raw,format=I420,width=320,height=240,"
+      "framerate=30/1,pixel-aspect-ratio=1/1",
+      "video/x-raw,format=I420,width=320,height=240,framerate=30/1,"
+      "pixel-aspect-ratio=1/1", TRUE);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -409,6 +472,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_test_source_in_layer);
   tcase_add_test (tc_chain, test_gap_filling_basic);
   tcase_add_test (tc_chain, test_gap_filling_empty_track);
+  tcase_add_test (tc_chain, test_video_conform);
 
   return s;
 }
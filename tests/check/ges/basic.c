@@ -706,6 +706,881 @@ GST_START_TEST (test_ges_pipeline_change_state)
 
 GST_END_TEST;
 
+GST_START_TEST (test_ges_timeline_render_cache_regions)
+{
+  gchar *directory;
+  guint64 max_size;
+  GESTimeline *timeline;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+
+  g_object_set (timeline, "render-cache-directory", "/tmp/ges-render-cache",
+      "render-cache-max-size", (guint64) 1024, NULL);
+  g_object_get (timeline, "render-cache-directory", &directory,
+      "render-cache-max-size", &max_size, NULL);
+  assert_equals_string (directory, "/tmp/ges-render-cache");
+  assert_equals_uint64 (max_size, 1024);
+  g_free (directory);
+
+  fail_unless (ges_timeline_add_render_cache_region (timeline, 10, 10));
+  fail_unless (ges_timeline_add_render_cache_region (timeline, 30, 10));
+
+  /* Overlapping regions are refused */
+  fail_if (ges_timeline_add_render_cache_region (timeline, 15, 10));
+  fail_if (ges_timeline_add_render_cache_region (timeline, 0, 40));
+
+  fail_if (ges_timeline_remove_render_cache_region (timeline, 10, 5));
+  fail_unless (ges_timeline_remove_render_cache_region (timeline, 10, 10));
+  fail_unless (ges_timeline_add_render_cache_region (timeline, 15, 10));
+
+  /* Empty regions are simply ignored when commiting */
+  ges_timeline_commit (timeline);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_timeline_render_cache_playback)
+{
+  guint i;
+  GstBus *bus;
+  gchar *tmpdir;
+  GESClip *clip;
+  GESAsset *asset;
+  GESLayer *layer;
+  GESTrack *track;
+  gboolean active = TRUE;
+  GstMessage *message;
+  GstElement *gnlobject;
+  GESPipeline *pipeline;
+  GESTimeline *timeline;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  track = GES_TRACK (ges_audio_track_new ());
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = ges_layer_add_asset (layer, asset, 0, 0, GST_SECOND,
+      GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  gnlobject = ges_track_element_get_gnlobject (GES_CONTAINER_CHILDREN
+      (clip)->data);
+
+  tmpdir = g_dir_make_tmp ("ges-render-cache-XXXXXX", NULL);
+  fail_unless (tmpdir != NULL);
+  g_object_set (timeline, "render-cache-directory", tmpdir, NULL);
+  fail_unless (ges_timeline_add_render_cache_region (timeline, 0,
+          GST_SECOND));
+  ges_timeline_commit (timeline);
+
+  /* The region is rendered in the background and the cached file replaces
+   * the clip when the timeline is commited from the main context */
+  for (i = 0; active && i < 1000; i++) {
+    while (g_main_context_iteration (NULL, FALSE));
+    g_object_get (gnlobject, "active", &active, NULL);
+    if (active)
+      g_usleep (10000);
+  }
+  fail_if (active);
+
+  /* The cached file is decoded to integer samples, it only reaches the
+   * float adder if the cache source converts it */
+  pipeline = ges_test_create_pipeline (timeline);
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+  ASSERT_SET_STATE (GST_ELEMENT (pipeline), GST_STATE_PLAYING,
+      GST_STATE_CHANGE_ASYNC);
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+  fail_unless (GST_MESSAGE_TYPE (message) == GST_MESSAGE_EOS);
+  gst_message_unref (message);
+
+  ASSERT_SET_STATE (GST_ELEMENT (pipeline), GST_STATE_NULL,
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+  g_free (tmpdir);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_timeline_content_hash)
+{
+  GArray *ranges;
+  GESLayer *layer;
+  GESTimeline *timeline;
+  GESTestClip *clip1, *clip2;
+  guint64 hash, moved_hash, pattern_hash;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+
+  clip1 = ges_test_clip_new ();
+  clip2 = ges_test_clip_new ();
+  g_object_set (clip1, "start", (guint64) 0, "duration", (guint64) 10, NULL);
+  g_object_set (clip2, "start", (guint64) 50, "duration", (guint64) 10, NULL);
+  fail_unless (ges_layer_add_clip (layer, GES_CLIP (clip1)));
+  fail_unless (ges_layer_add_clip (layer, GES_CLIP (clip2)));
+
+  hash = ges_timeline_get_content_hash (timeline);
+  assert_equals_uint64 (ges_timeline_get_content_hash (timeline), hash);
+
+  /* Moving a clip changes the hash of the clip, the layer and the timeline */
+  moved_hash = ges_timeline_element_get_content_hash (GES_TIMELINE_ELEMENT
+      (clip1));
+  ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip1), 100);
+  fail_if (ges_timeline_element_get_content_hash (GES_TIMELINE_ELEMENT
+          (clip1)) == moved_hash);
+  moved_hash = ges_timeline_get_content_hash (timeline);
+  fail_if (moved_hash == hash);
+
+  ranges = ges_timeline_get_changed_ranges (timeline, hash, moved_hash);
+  fail_unless (ranges != NULL);
+  assert_equals_int (ranges->len, 2);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 0).start, 0);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 0).stop, 10);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 1).start,
+      100);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 1).stop, 110);
+  g_array_free (ranges, TRUE);
+
+  /* Changing a property only invalidates the clip range */
+  ges_test_clip_set_vpattern (clip2, GES_VIDEO_TEST_PATTERN_BLACK);
+  pattern_hash = ges_timeline_get_content_hash (timeline);
+  fail_if (pattern_hash == moved_hash);
+  ranges = ges_timeline_get_changed_ranges (timeline, moved_hash,
+      pattern_hash);
+  assert_equals_int (ranges->len, 1);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 0).start, 50);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 0).stop, 60);
+  g_array_free (ranges, TRUE);
+
+  ranges = ges_timeline_get_changed_ranges (timeline, pattern_hash,
+      pattern_hash);
+  assert_equals_int (ranges->len, 0);
+  g_array_free (ranges, TRUE);
+
+  /* A clip changed and then changed back is not reported */
+  ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip1), 200);
+  ges_timeline_get_content_hash (timeline);
+  ges_test_clip_set_vpattern (clip2, GES_VIDEO_TEST_PATTERN_SMPTE);
+  ranges = ges_timeline_get_changed_ranges (timeline,
+      ges_timeline_get_content_hash (timeline), moved_hash);
+  assert_equals_int (ranges->len, 2);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 0).start,
+      100);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 1).start,
+      200);
+  g_array_free (ranges, TRUE);
+
+  /* Going back to a previous state gives back the same hash */
+  ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip1), 0);
+  assert_equals_uint64 (ges_timeline_get_content_hash (timeline), hash);
+
+  /* Compared to the most recent state having that hash */
+  ranges = ges_timeline_get_changed_ranges (timeline, pattern_hash, hash);
+  assert_equals_int (ranges->len, 3);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 0).start, 0);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 1).start, 50);
+  assert_equals_uint64 (g_array_index (ranges, GESTimelineRange, 2).start,
+      100);
+  g_array_free (ranges, TRUE);
+
+  fail_unless (ges_timeline_get_changed_ranges (timeline, hash, 42) == NULL);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_pipeline_incremental_no_settings)
+{
+  GError *error = NULL;
+  GESTimeline *timeline;
+  GESPipeline *pipeline;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  pipeline = ges_test_create_pipeline (timeline);
+
+  /* No render settings have been set */
+  fail_if (ges_pipeline_render_incremental (pipeline, GST_SECOND, &error));
+  fail_unless (g_error_matches (error, GES_ERROR, GES_ERROR_RENDERING));
+  g_error_free (error);
+
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+/* Returns the segment files of an incremental render in @directory */
+static GHashTable *
+_list_segments (const gchar * directory)
+{
+  GDir *dir;
+  const gchar *name;
+  GHashTable *names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      NULL);
+
+  dir = g_dir_open (directory, 0, NULL);
+  fail_unless (dir != NULL);
+  while ((name = g_dir_read_name (dir))) {
+    if (g_str_has_prefix (name, "segment-"))
+      g_hash_table_add (names, g_strdup (name));
+  }
+  g_dir_close (dir);
+
+  return names;
+}
+
+static gint n_encoded_frames = 0;
+
+static GstPadProbeReturn
+_count_encoded_frame_cb (GstPad * pad, GstPadProbeInfo * info,
+    gpointer udata)
+{
+  g_atomic_int_inc (&n_encoded_frames);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+_counting_encoder_init (GTypeInstance * instance, gpointer klass)
+{
+  GstPad *sinkpad = gst_element_get_static_pad (GST_ELEMENT (instance),
+      "sink");
+
+  gst_pad_add_probe (sinkpad, GST_PAD_PROBE_TYPE_BUFFER,
+      _count_encoded_frame_cb, NULL, NULL);
+  gst_object_unref (sinkpad);
+}
+
+/* Makes encodebin pick a @factory_name subclass counting the frames it
+ * is given in n_encoded_frames */
+static void
+_register_counting_encoder (const gchar * factory_name)
+{
+  GType type;
+  GTypeQuery query;
+  GstPluginFeature *feature, *loaded;
+  gchar *type_name = g_strdup_printf ("GESTestCounting%s", factory_name);
+  gchar *name = g_strdup_printf ("gestestcounting%s", factory_name);
+
+  if (!(type = g_type_from_name (type_name))) {
+    feature = GST_PLUGIN_FEATURE (gst_element_factory_find (factory_name));
+    fail_unless (feature != NULL);
+    loaded = gst_plugin_feature_load (feature);
+    fail_unless (loaded != NULL);
+
+    type = gst_element_factory_get_element_type (GST_ELEMENT_FACTORY
+        (loaded));
+    g_type_query (type, &query);
+    type = g_type_register_static_simple (type, type_name, query.class_size,
+        NULL, query.instance_size, _counting_encoder_init, 0);
+    gst_object_unref (loaded);
+    gst_object_unref (feature);
+  }
+  g_free (type_name);
+
+  fail_unless (gst_element_register (NULL, name, GST_RANK_PRIMARY + 1, type));
+  g_free (name);
+}
+
+GST_START_TEST (test_ges_pipeline_incremental_ripple)
+{
+  guint i, n_kept = 0;
+  GList *tmp, *clips = NULL;
+  GESTrack *track;
+  GESLayer *layer;
+  GESAsset *asset;
+  GESTimeline *timeline;
+  GESPipeline *pipeline;
+  GstCaps *caps;
+  GstEncodingContainerProfile *profile;
+  GHashTable *before, *after;
+  GError *error = NULL;
+  gchar *tmpdir, *location, *directory, *uri, *contents;
+  GESVideoTestPattern patterns[] = { GES_VIDEO_TEST_PATTERN_BLACK,
+    GES_VIDEO_TEST_PATTERN_WHITE, GES_VIDEO_TEST_PATTERN_RED
+  };
+
+  ges_init ();
+
+  if (!gst_registry_check_feature_version (gst_registry_get (), "theoraenc",
+          1, 0, 0) || !gst_registry_check_feature_version (gst_registry_get (),
+          "oggmux", 1, 0, 0)) {
+    GST_WARNING ("theoraenc or oggmux missing, can not test rendering");
+
+    return;
+  }
+  _register_counting_encoder ("theoraenc");
+
+  timeline = ges_timeline_new ();
+  track = GES_TRACK (ges_video_track_new ());
+  caps = gst_caps_from_string ("video/x-raw,width=160,height=120,"
+      "framerate=25/1");
+  ges_track_set_restriction_caps (track, caps);
+  gst_caps_unref (caps);
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  for (i = 0; i < G_N_ELEMENTS (patterns); i++) {
+    GESClip *clip = ges_layer_add_asset (layer, asset, i * GST_SECOND, 0,
+        GST_SECOND, GES_TRACK_TYPE_UNKNOWN);
+
+    ges_test_clip_set_vpattern (GES_TEST_CLIP (clip), patterns[i]);
+    clips = g_list_append (clips, clip);
+  }
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  tmpdir = g_dir_make_tmp ("ges-incremental-XXXXXX", NULL);
+  fail_unless (tmpdir != NULL);
+  location = g_build_filename (tmpdir, "output.ogg", NULL);
+  directory = g_strconcat (location, ".segments", NULL);
+  uri = gst_filename_to_uri (location, NULL);
+
+  profile = gst_encoding_container_profile_new ("ogg", NULL,
+      (caps = gst_caps_from_string ("application/ogg")), NULL);
+  gst_caps_unref (caps);
+  gst_encoding_container_profile_add_profile (profile,
+      (GstEncodingProfile *) gst_encoding_video_profile_new ((caps =
+              gst_caps_from_string ("video/x-theora")), NULL, NULL, 0));
+  gst_caps_unref (caps);
+
+  pipeline = ges_pipeline_new ();
+  fail_unless (ges_pipeline_set_timeline (pipeline, timeline));
+  fail_unless (ges_pipeline_set_render_settings (pipeline, uri,
+          (GstEncodingProfile *) profile));
+
+  /* One segment per clip, the segment duration is longer than them */
+  g_atomic_int_set (&n_encoded_frames, 0);
+  fail_unless (ges_pipeline_render_incremental (pipeline, 10 * GST_SECOND,
+          &error));
+  fail_unless (error == NULL);
+  before = _list_segments (directory);
+  assert_equals_int (g_hash_table_size (before), 3);
+
+  /* The 3 seconds were encoded once, concatenating did not encode them
+   * again */
+  fail_unless (g_atomic_int_get (&n_encoded_frames) > 0);
+  fail_unless (g_atomic_int_get (&n_encoded_frames) < 2 * 3 * 25);
+
+  /* The output is the concatenation of the segments, not a playlist */
+  fail_unless (g_file_get_contents (location, &contents, NULL, NULL));
+  fail_if (g_str_has_prefix (contents, "#EXTM3U"));
+  g_free (contents);
+
+  /* Making the first clip longer moves the other ones, which are not
+   * rendered again */
+  fail_unless (ges_container_edit (GES_CONTAINER (clips->data), NULL, -1,
+          GES_EDIT_MODE_RIPPLE, GES_EDGE_END, 3 * GST_SECOND / 2));
+  assert_equals_uint64 (_START (clips->next->data), 3 * GST_SECOND / 2);
+  ges_timeline_commit (timeline);
+
+  g_atomic_int_set (&n_encoded_frames, 0);
+  fail_unless (ges_pipeline_render_incremental (pipeline, 10 * GST_SECOND,
+          &error));
+  fail_unless (error == NULL);
+  /* Only the frames of the longer first clip were encoded */
+  fail_unless (g_atomic_int_get (&n_encoded_frames) > 0);
+  fail_unless (g_atomic_int_get (&n_encoded_frames) < 2 * 25);
+  after = _list_segments (directory);
+  assert_equals_int (g_hash_table_size (after), 3);
+  for (tmp = g_hash_table_get_keys (after); tmp;
+      tmp = g_list_delete_link (tmp, tmp)) {
+    if (g_hash_table_contains (before, tmp->data))
+      n_kept++;
+  }
+  assert_equals_int (n_kept, 2);
+
+  g_hash_table_unref (before);
+  g_hash_table_unref (after);
+  g_list_free (clips);
+  gst_object_unref (pipeline);
+  gst_encoding_profile_unref (profile);
+  g_free (uri);
+  g_free (directory);
+  g_free (location);
+  g_free (tmpdir);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  guint n_frames;
+  GstClockTime position;
+} ScrubData;
+
+static void
+scrub_frame_cb (GESPipeline * pipeline, GstSample * sample,
+    guint64 position, ScrubData * data)
+{
+  fail_unless (GST_IS_SAMPLE (sample));
+
+  g_mutex_lock (&data->lock);
+  data->n_frames++;
+  data->position = position;
+  g_cond_signal (&data->cond);
+  g_mutex_unlock (&data->lock);
+}
+
+static void
+wait_scrub_frames (ScrubData * data, guint n_frames)
+{
+  gint64 end_time = g_get_monotonic_time () + 10 * G_TIME_SPAN_SECOND;
+
+  g_mutex_lock (&data->lock);
+  while (data->n_frames < n_frames)
+    fail_unless (g_cond_wait_until (&data->cond, &data->lock, end_time));
+  g_mutex_unlock (&data->lock);
+}
+
+GST_START_TEST (test_ges_pipeline_scrub)
+{
+  GESClip *clip;
+  GESAsset *asset;
+  GESLayer *layer;
+  GstStructure *stats;
+  GESTimeline *timeline;
+  GESPipeline *pipeline;
+  guint steps, hits;
+  ScrubData data = { {0,}, };
+
+  ges_init ();
+
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+
+  layer = ges_layer_new ();
+  timeline = ges_timeline_new_audio_video ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  pipeline = ges_test_create_pipeline (timeline);
+  fail_unless (ges_pipeline_set_mode (pipeline,
+          GES_PIPELINE_MODE_PREVIEW | GES_PIPELINE_MODE_SCRUB));
+  /* Scrubbing without previewing video is refused */
+  fail_if (ges_pipeline_set_mode (pipeline,
+          GES_PIPELINE_MODE_PREVIEW_AUDIO | GES_PIPELINE_MODE_SCRUB));
+  g_signal_connect (pipeline, "scrub-frame", G_CALLBACK (scrub_frame_cb),
+      &data);
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  clip = ges_layer_add_asset (layer, asset, 0, 0, 2 * GST_SECOND,
+      GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  ASSERT_SET_STATE (GST_ELEMENT (pipeline), GST_STATE_PAUSED,
+      GST_STATE_CHANGE_ASYNC);
+  fail_unless (gst_element_get_state (GST_ELEMENT (pipeline), NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_SUCCESS);
+
+  /* Needs decoding first */
+  fail_if (ges_pipeline_scrub_to (pipeline, GST_SECOND));
+  wait_scrub_frames (&data, 1);
+  assert_equals_uint64 (data.position, GST_SECOND);
+
+  fail_if (ges_pipeline_scrub_to (pipeline, GST_SECOND / 2));
+  wait_scrub_frames (&data, 2);
+
+  /* Going back is served from the cache right away */
+  fail_unless (ges_pipeline_scrub_to (pipeline, GST_SECOND));
+  assert_equals_int (data.n_frames, 3);
+  assert_equals_uint64 (data.position, GST_SECOND);
+
+  stats = ges_pipeline_get_scrub_stats (pipeline);
+  fail_unless (gst_structure_get_uint (stats, "steps", &steps));
+  fail_unless (gst_structure_get_uint (stats, "cache-hits", &hits));
+  assert_equals_int (steps, 3);
+  assert_equals_int (hits, 1);
+  gst_structure_free (stats);
+
+  /* The cache does not survive commits */
+  ges_timeline_element_set_duration (GES_TIMELINE_ELEMENT (clip),
+      3 * GST_SECOND);
+  fail_unless (ges_timeline_commit (timeline));
+  fail_if (ges_pipeline_scrub_to (pipeline, GST_SECOND));
+  wait_scrub_frames (&data, 4);
+
+  ASSERT_SET_STATE (GST_ELEMENT (pipeline), GST_STATE_NULL,
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (pipeline);
+
+  g_mutex_clear (&data.lock);
+  g_cond_clear (&data.cond);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_pipeline_stats)
+{
+  GstBus *bus;
+  GESAsset *asset;
+  GESLayer *layer;
+  GstMessage *message;
+  GESTimeline *timeline;
+  GESPipeline *pipeline;
+  const GValue *tracks;
+  const GstStructure *stats, *track_stats;
+  GstStructure *current;
+  guint64 frames, duration;
+
+  ges_init ();
+
+  layer = ges_layer_new ();
+  timeline = ges_timeline_new_audio_video ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  ges_layer_add_asset (layer, asset, 0, 0, 2 * GST_SECOND,
+      GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  pipeline = ges_test_create_pipeline (timeline);
+  g_object_set (pipeline, "stats-interval", 50 * GST_MSECOND, NULL);
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+
+  ASSERT_SET_STATE (GST_ELEMENT (pipeline), GST_STATE_PLAYING,
+      GST_STATE_CHANGE_ASYNC);
+
+  message = gst_bus_timed_pop_filtered (bus, 5 * GST_SECOND,
+      GST_MESSAGE_ELEMENT | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+  fail_unless (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ELEMENT);
+  fail_unless (GST_MESSAGE_SRC (message) == GST_OBJECT (pipeline));
+
+  stats = gst_message_get_structure (message);
+  fail_unless (gst_structure_has_name (stats, "ges-render-stats"));
+  fail_unless (gst_structure_get_uint64 (stats, "duration", &duration));
+  assert_equals_uint64 (duration, 2 * GST_SECOND);
+  tracks = gst_structure_get_value (stats, "tracks");
+  assert_equals_int (gst_value_array_get_size (tracks), 2);
+  gst_message_unref (message);
+
+  /* At least the preroll buffers went through both tracks */
+  current = ges_pipeline_get_stats (pipeline);
+  tracks = gst_structure_get_value (current, "tracks");
+  assert_equals_int (gst_value_array_get_size (tracks), 2);
+  track_stats =
+      gst_value_get_structure (gst_value_array_get_value (tracks, 0));
+  fail_unless (gst_structure_get_uint64 (track_stats, "frames", &frames));
+  fail_unless (frames > 0);
+  /* Not rendering, no encoder involved */
+  assert_equals_int (gst_value_array_get_size (gst_structure_get_value
+          (current, "stages")), 0);
+  gst_structure_free (current);
+
+  ASSERT_SET_STATE (GST_ELEMENT (pipeline), GST_STATE_NULL,
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_timeline_profiling)
+{
+  guint i;
+  GstBus *bus;
+  GESAsset *asset;
+  GESLayer *layer;
+  GstMessage *message;
+  GESTimeline *timeline;
+  GESPipeline *pipeline;
+  GstStructure *profile;
+  const GValue *elements;
+  guint64 buffers, time, previous_time = G_MAXUINT64;
+
+  ges_init ();
+
+  layer = ges_layer_new ();
+  timeline = ges_timeline_new_audio_video ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  ges_layer_add_asset (layer, asset, 0, 0, GST_SECOND, GES_TRACK_TYPE_UNKNOWN);
+  ges_timeline_commit (timeline);
+
+  /* Elements already in the timeline get profiled as well */
+  ges_timeline_set_profiling (timeline, TRUE);
+  fail_unless (ges_timeline_get_profiling (timeline));
+
+  pipeline = ges_test_create_pipeline (timeline);
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+  ASSERT_SET_STATE (GST_ELEMENT (pipeline), GST_STATE_PLAYING,
+      GST_STATE_CHANGE_ASYNC);
+  message = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+  fail_unless (GST_MESSAGE_TYPE (message) == GST_MESSAGE_EOS);
+  gst_message_unref (message);
+
+  profile = ges_timeline_get_profile (timeline);
+  fail_unless (gst_structure_has_name (profile, "ges-profile"));
+  elements = gst_structure_get_value (profile, "elements");
+  assert_equals_int (gst_value_array_get_size (elements), 2);
+  for (i = 0; i < 2; i++) {
+    const GstStructure *element =
+        gst_value_get_structure (gst_value_array_get_value (elements, i));
+
+    fail_unless (gst_structure_get_uint64 (element, "buffers", &buffers));
+    fail_unless (buffers > 0);
+    fail_unless (gst_structure_get_uint64 (element, "processing-time",
+            &time));
+    fail_unless (time <= previous_time);
+    previous_time = time;
+    assert_equals_string (gst_structure_get_string (element, "asset"),
+        ges_asset_get_id (asset));
+  }
+  gst_structure_free (profile);
+
+  ASSERT_SET_STATE (GST_ELEMENT (pipeline), GST_STATE_NULL,
+      GST_STATE_CHANGE_SUCCESS);
+
+  /* What was measured is dropped along with the probes */
+  ges_timeline_set_profiling (timeline, FALSE);
+  profile = ges_timeline_get_profile (timeline);
+  assert_equals_int (gst_value_array_get_size (gst_structure_get_value
+          (profile, "elements")), 0);
+  gst_structure_free (profile);
+
+  gst_object_unref (asset);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+static guint
+count_elements_by_scene (GESTimeline * timeline, const gchar * scene)
+{
+  guint n;
+  GList *found;
+  GValue value = { 0, };
+
+  g_value_init (&value, G_TYPE_STRING);
+  g_value_set_string (&value, scene);
+  found = ges_timeline_find_elements_by_meta (timeline, "scene", &value);
+  g_value_unset (&value);
+
+  n = g_list_length (found);
+  g_list_free_full (found, gst_object_unref);
+
+  return n;
+}
+
+GST_START_TEST (test_ges_timeline_find_elements_by_meta)
+{
+  GList *found;
+  GESLayer *layer;
+  GESTimeline *timeline;
+  GESClip *clip1, *clip2, *clip3;
+  GValue value = { 0, };
+
+  ges_init ();
+
+  /* Clips added before the layer is in the timeline are found too */
+  layer = ges_layer_new ();
+  clip1 = GES_CLIP (ges_test_clip_new ());
+  clip2 = GES_CLIP (ges_test_clip_new ());
+  clip3 = GES_CLIP (ges_test_clip_new ());
+  g_object_set (clip2, "start", (guint64) 10, "duration", (guint64) 10, NULL);
+  g_object_set (clip1, "start", (guint64) 20, "duration", (guint64) 10, NULL);
+  fail_unless (ges_layer_add_clip (layer, clip1));
+  fail_unless (ges_layer_add_clip (layer, clip2));
+  ges_meta_container_set_string (GES_META_CONTAINER (clip1), "scene", "1");
+
+  timeline = ges_timeline_new_audio_video ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  ges_meta_container_set_string (GES_META_CONTAINER (clip2), "scene", "1");
+
+  g_value_init (&value, G_TYPE_STRING);
+  g_value_set_string (&value, "1");
+  found = ges_timeline_find_elements_by_meta (timeline, "scene", &value);
+  assert_equals_int (g_list_length (found), 2);
+  fail_unless (found->data == clip2);
+  fail_unless (found->next->data == clip1);
+  g_list_free_full (found, gst_object_unref);
+  g_value_unset (&value);
+
+  /* Values of another type do not match */
+  g_value_init (&value, G_TYPE_INT);
+  g_value_set_int (&value, 1);
+  fail_unless (ges_timeline_find_elements_by_meta (timeline, "scene",
+          &value) == NULL);
+  fail_unless (ges_timeline_find_elements_by_meta (timeline,
+          "not-a-meta-anyone-set", &value) == NULL);
+  g_value_unset (&value);
+
+  /* The index follows the changes once built */
+  ges_meta_container_set_string (GES_META_CONTAINER (clip1), "scene", "2");
+  assert_equals_int (count_elements_by_scene (timeline, "1"), 1);
+  assert_equals_int (count_elements_by_scene (timeline, "2"), 1);
+
+  fail_unless (ges_layer_add_clip (layer, clip3));
+  ges_meta_container_set_string (GES_META_CONTAINER (clip3), "scene", "2");
+  assert_equals_int (count_elements_by_scene (timeline, "2"), 2);
+
+  gst_object_ref (clip1);
+  fail_unless (ges_layer_remove_clip (layer, clip1));
+  assert_equals_int (count_elements_by_scene (timeline, "2"), 1);
+  assert_equals_string (ges_meta_container_get_string (GES_META_CONTAINER
+          (clip1), "scene"), "2");
+  gst_object_unref (clip1);
+
+  fail_unless (ges_timeline_remove_layer (timeline, layer));
+  assert_equals_int (count_elements_by_scene (timeline, "1"), 0);
+  assert_equals_int (count_elements_by_scene (timeline, "2"), 0);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+/* Returns: The clips @it goes through, in order */
+static GList *
+iterate_clips (GstIterator * it)
+{
+  GList *clips = NULL;
+  gboolean done = FALSE;
+  GValue item = { 0, };
+
+  while (!done) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:
+        clips = g_list_append (clips, g_value_get_object (&item));
+        g_value_reset (&item);
+        break;
+      case GST_ITERATOR_RESYNC:
+        g_list_free (clips);
+        clips = NULL;
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  if (G_IS_VALUE (&item))
+    g_value_unset (&item);
+  gst_iterator_free (it);
+
+  return clips;
+}
+
+GST_START_TEST (test_ges_timeline_iterate_clips)
+{
+  GList *clips;
+  GESAsset *asset;
+  GstIterator *it;
+  GValue item = { 0, };
+  GESTimeline *timeline;
+  GESLayer *layer0, *layer1;
+  GESClip *clip1, *clip2, *clip3, *title;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer0 = ges_timeline_append_layer (timeline);
+  layer1 = ges_timeline_append_layer (timeline);
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  /* A long clip, starting way before the others */
+  clip1 = ges_layer_add_asset (layer0, asset, 0, 0, 100, GES_TRACK_TYPE_UNKNOWN);
+  clip2 = ges_layer_add_asset (layer1, asset, 50, 0, 10,
+      GES_TRACK_TYPE_UNKNOWN);
+  clip3 = ges_layer_add_asset (layer1, asset, 70, 0, 10,
+      GES_TRACK_TYPE_UNKNOWN);
+  title = GES_CLIP (ges_title_clip_new ());
+  g_object_set (title, "start", (guint64) 55, "duration", (guint64) 10, NULL);
+  fail_unless (ges_layer_add_clip (layer0, title));
+
+  clips = iterate_clips (ges_timeline_iterate_clips_at (timeline, 52));
+  assert_equals_int (g_list_length (clips), 2);
+  fail_unless (clips->data == clip1);
+  fail_unless (clips->next->data == clip2);
+  g_list_free (clips);
+
+  /* The end of clips is excluded */
+  clips = iterate_clips (ges_timeline_iterate_clips_at (timeline, 80));
+  assert_equals_int (g_list_length (clips), 1);
+  fail_unless (clips->data == clip1);
+  g_list_free (clips);
+
+  clips = iterate_clips (ges_timeline_iterate_clips_in_range (timeline, 58,
+          75, 1, 1));
+  assert_equals_int (g_list_length (clips), 2);
+  fail_unless (clips->data == clip2);
+  fail_unless (clips->next->data == clip3);
+  g_list_free (clips);
+
+  clips = iterate_clips (ges_timeline_iterate_clips_in_range (timeline, 58,
+          75, 0, 0));
+  assert_equals_int (g_list_length (clips), 2);
+  fail_unless (clips->data == clip1);
+  fail_unless (clips->next->data == title);
+  g_list_free (clips);
+
+  clips = iterate_clips (ges_timeline_iterate_clips_by_asset (timeline,
+          asset));
+  assert_equals_int (g_list_length (clips), 3);
+  fail_if (g_list_find (clips, title));
+  g_list_free (clips);
+
+  /* The indexes follow the edits */
+  fail_unless (ges_timeline_element_set_start (GES_TIMELINE_ELEMENT (clip3),
+          200));
+  fail_unless (ges_timeline_element_set_duration (GES_TIMELINE_ELEMENT
+          (clip1), 10));
+  clips = iterate_clips (ges_timeline_iterate_clips_at (timeline, 52));
+  assert_equals_int (g_list_length (clips), 1);
+  fail_unless (clips->data == clip2);
+  g_list_free (clips);
+  clips = iterate_clips (ges_timeline_iterate_clips_at (timeline, 205));
+  assert_equals_int (g_list_length (clips), 1);
+  fail_unless (clips->data == clip3);
+  g_list_free (clips);
+
+  fail_unless (ges_clip_move_to_layer (clip2, layer0));
+  clips = iterate_clips (ges_timeline_iterate_clips_in_range (timeline, 0,
+          GST_CLOCK_TIME_NONE, 1, G_MAXUINT32));
+  assert_equals_int (g_list_length (clips), 1);
+  fail_unless (clips->data == clip3);
+  g_list_free (clips);
+
+  /* Changing the timeline while iterating requires a resync */
+  it = ges_timeline_iterate_clips_by_asset (timeline, asset);
+  fail_unless (gst_iterator_next (it, &item) == GST_ITERATOR_OK);
+  g_value_reset (&item);
+  fail_unless (ges_layer_remove_clip (layer1, clip3));
+  fail_unless (gst_iterator_next (it, &item) == GST_ITERATOR_RESYNC);
+  gst_iterator_resync (it);
+  g_value_unset (&item);
+  clips = iterate_clips (it);
+  assert_equals_int (g_list_length (clips), 2);
+  g_list_free (clips);
+
+  gst_object_unref (asset);
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -721,6 +1596,16 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_ges_timeline_remove_track);
   tcase_add_test (tc_chain, test_ges_timeline_multiple_tracks);
   tcase_add_test (tc_chain, test_ges_pipeline_change_state);
+  tcase_add_test (tc_chain, test_ges_timeline_render_cache_regions);
+  tcase_add_test (tc_chain, test_ges_timeline_render_cache_playback);
+  tcase_add_test (tc_chain, test_ges_timeline_content_hash);
+  tcase_add_test (tc_chain, test_ges_pipeline_incremental_no_settings);
+  tcase_add_test (tc_chain, test_ges_pipeline_incremental_ripple);
+  tcase_add_test (tc_chain, test_ges_pipeline_scrub);
+  tcase_add_test (tc_chain, test_ges_pipeline_stats);
+  tcase_add_test (tc_chain, test_ges_timeline_profiling);
+  tcase_add_test (tc_chain, test_ges_timeline_find_elements_by_meta);
+  tcase_add_test (tc_chain, test_ges_timeline_iterate_clips);
 
   return s;
 }
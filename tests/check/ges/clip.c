@@ -191,6 +191,68 @@ GST_START_TEST (test_split_object)
 
 GST_END_TEST;
 
+GST_START_TEST (test_split_many)
+{
+  GESTimeline *timeline;
+  GESLayer *layer;
+  GESClip *clip, *piece;
+  GList *pieces, *tmp;
+  guint64 positions[] = { 80, 50, 0, 60, 50, 200 };
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+
+  clip = GES_CLIP (ges_test_clip_new ());
+  g_object_set (clip, "start", (guint64) 40, "duration", (guint64) 60,
+      "in-point", (guint64) 10, NULL);
+  ges_layer_add_clip (layer, clip);
+  ges_timeline_commit (timeline);
+
+  /* Duplicates and positions out of the clip are ignored */
+  pieces = ges_clip_split_many (clip, positions, G_N_ELEMENTS (positions));
+  assert_equals_int (g_list_length (pieces), 3);
+
+  assert_equals_uint64 (_START (clip), 40);
+  assert_equals_uint64 (_DURATION (clip), 10);
+  assert_equals_uint64 (_INPOINT (clip), 10);
+
+  piece = pieces->data;
+  assert_equals_uint64 (_START (piece), 50);
+  assert_equals_uint64 (_DURATION (piece), 10);
+  assert_equals_uint64 (_INPOINT (piece), 20);
+
+  piece = pieces->next->data;
+  assert_equals_uint64 (_START (piece), 60);
+  assert_equals_uint64 (_DURATION (piece), 20);
+  assert_equals_uint64 (_INPOINT (piece), 30);
+
+  piece = pieces->next->next->data;
+  assert_equals_uint64 (_START (piece), 80);
+  assert_equals_uint64 (_DURATION (piece), 20);
+  assert_equals_uint64 (_INPOINT (piece), 50);
+
+  for (tmp = pieces; tmp; tmp = tmp->next) {
+    piece = tmp->data;
+
+    assert_equals_int (g_list_length (GES_CONTAINER_CHILDREN (piece)), 2);
+    assert_equals_int (_PRIORITY (piece), _PRIORITY (clip));
+  }
+  g_list_free (pieces);
+
+  /* All the pieces are sorted in the layer */
+  pieces = ges_layer_get_clips (layer);
+  assert_equals_int (g_list_length (pieces), 4);
+  for (tmp = pieces->next; tmp; tmp = tmp->next)
+    fail_unless (_START (tmp->prev->data) < _START (tmp->data));
+  g_list_free_full (pieces, gst_object_unref);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_clip_group_ungroup)
 {
   GESAsset *asset;
@@ -366,6 +428,7 @@ ges_suite (void)
 
   tcase_add_test (tc_chain, test_object_properties);
   tcase_add_test (tc_chain, test_split_object);
+  tcase_add_test (tc_chain, test_split_many);
   tcase_add_test (tc_chain, test_clip_group_ungroup);
   tcase_add_test (tc_chain, test_clip_refcount_remove_child);
 
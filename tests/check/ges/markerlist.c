@@ -0,0 +1,135 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "test-utils.h"
+#include <ges/ges.h>
+#include <gst/check/gstcheck.h>
+
+static void
+check_positions (GList * markers, const guint64 * positions, guint n)
+{
+  guint i;
+  GList *tmp;
+
+  assert_equals_int (g_list_length (markers), n);
+  for (tmp = markers, i = 0; tmp; tmp = tmp->next, i++)
+    assert_equals_uint64 (ges_marker_get_position (tmp->data), positions[i]);
+
+  g_list_free_full (markers, g_object_unref);
+}
+
+GST_START_TEST (test_marker_list)
+{
+  GList *markers;
+  GESMarkerList *list;
+  GESMarker *m10, *m20, *m30, *m20bis;
+  static const guint64 all[] = { 10, 20, 20, 30 };
+  static const guint64 range[] = { 20, 20 };
+  static const guint64 moved[] = { 5, 20, 20, 20 };
+  static const guint64 removed[] = { 5, 20, 20 };
+
+  ges_init ();
+
+  list = ges_marker_list_new ();
+  assert_equals_int (ges_marker_list_size (list), 0);
+  fail_unless (ges_marker_list_get_nearest (list, 0) == NULL);
+
+  m30 = ges_marker_list_add (list, 30);
+  m10 = ges_marker_list_add (list, 10);
+  m20 = ges_marker_list_add (list, 20);
+  m20bis = ges_marker_list_add (list, 20);
+  assert_equals_int (ges_marker_list_size (list), 4);
+  check_positions (ges_marker_list_get_markers (list), all, 4);
+
+  /* Markers at the same position are kept in the order they were added */
+  check_positions (ges_marker_list_get_range (list, 15, 30), range, 2);
+  markers = ges_marker_list_get_range (list, 20, 30);
+  fail_unless (markers->data == m20);
+  fail_unless (markers->next->data == m20bis);
+  g_list_free_full (markers, g_object_unref);
+  fail_unless (ges_marker_list_get_range (list, 21, 30) == NULL);
+  check_positions (ges_marker_list_get_range (list, 0, GST_CLOCK_TIME_NONE),
+      all, 4);
+
+  fail_unless (ges_marker_list_get_nearest (list, 0) == m10);
+  fail_unless (ges_marker_list_get_nearest (list, 14) == m10);
+  /* The earliest wins when both are as close */
+  fail_unless (ges_marker_list_get_nearest (list, 15) == m10);
+  fail_unless (ges_marker_list_get_nearest (list, 16) == m20);
+  fail_unless (ges_marker_list_get_nearest (list, 100) == m30);
+
+  fail_unless (ges_marker_list_move (list, m10, 5));
+  fail_unless (ges_marker_list_move (list, m30, 20));
+  assert_equals_uint64 (ges_marker_get_position (m30), 20);
+  check_positions (ges_marker_list_get_markers (list), moved, 4);
+
+  g_object_ref (m20bis);
+  fail_unless (ges_marker_list_remove (list, m20bis));
+  fail_if (ges_marker_list_remove (list, m20bis));
+  g_object_unref (m20bis);
+  check_positions (ges_marker_list_get_markers (list), removed, 3);
+  fail_unless (ges_marker_list_get_nearest (list, 12) == m10);
+
+  g_object_unref (list);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_marker_list_owners)
+{
+  GESLayer *layer;
+  GESClip *clip;
+  GESTimeline *timeline;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  clip = GES_CLIP (ges_test_clip_new ());
+  ges_layer_add_clip (layer, clip);
+
+  fail_unless (GES_IS_MARKER_LIST (ges_timeline_get_marker_list (timeline)));
+  fail_unless (GES_IS_MARKER_LIST (ges_layer_get_marker_list (layer)));
+  fail_unless (GES_IS_MARKER_LIST (ges_clip_get_marker_list (clip)));
+  fail_unless (ges_clip_get_marker_list (clip) ==
+      ges_clip_get_marker_list (clip));
+  fail_if (ges_layer_get_marker_list (layer) ==
+      ges_timeline_get_marker_list (timeline));
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+static Suite *
+ges_suite (void)
+{
+  Suite *s = suite_create ("ges-marker-list");
+  TCase *tc_chain = tcase_create ("marker-list");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_marker_list);
+  tcase_add_test (tc_chain, test_marker_list_owners);
+
+  return s;
+}
+
+GST_CHECK_MAIN (ges);
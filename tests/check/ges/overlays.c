@@ -189,6 +189,15 @@ GST_START_TEST (test_overlay_in_layer)
   ypos = ges_text_overlay_get_ypos (GES_TEXT_OVERLAY (track_element));
   assert_equals_float (ypos, 0.33);
 
+  /* Children properties changes are seen by the setters */
+  ges_track_element_set_child_properties (track_element, "ypos", 0.75, NULL);
+  ypos = ges_text_overlay_get_ypos (GES_TEXT_OVERLAY (track_element));
+  assert_equals_float (ypos, 0.75);
+
+  ges_text_overlay_set_ypos (GES_TEXT_OVERLAY (track_element), 0.33);
+  ges_track_element_get_child_properties (track_element, "ypos", &ypos, NULL);
+  assert_equals_float (ypos, 0.33);
+
   GST_DEBUG ("removing the source");
 
   ges_layer_remove_clip (layer, (GESClip *) source);
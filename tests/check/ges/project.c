@@ -477,6 +477,105 @@ GST_START_TEST (test_project_add_keyframes)
 
 GST_END_TEST;
 
+static void
+_add_markers (GESTimeline * timeline)
+{
+  GESMarker *marker;
+  GESLayer *layer = timeline->layers->data;
+  GList *clips = ges_layer_get_clips (layer);
+
+  marker = ges_marker_list_add (ges_timeline_get_marker_list (timeline),
+      2 * GST_SECOND);
+  ges_meta_container_set_string (GES_META_CONTAINER (marker), "name", "Intro");
+  ges_marker_list_add (ges_timeline_get_marker_list (timeline), GST_SECOND);
+  ges_marker_list_add (ges_layer_get_marker_list (layer), 3 * GST_SECOND);
+  ges_marker_list_add (ges_clip_get_marker_list (clips->data), 42);
+
+  g_list_free_full (clips, gst_object_unref);
+}
+
+static void
+_check_markers (GESTimeline * timeline)
+{
+  GList *markers;
+  const gchar *name;
+  GESLayer *layer = timeline->layers->data;
+  GList *clips = ges_layer_get_clips (layer);
+
+  markers = ges_marker_list_get_markers (ges_timeline_get_marker_list
+      (timeline));
+  assert_equals_int (g_list_length (markers), 2);
+  assert_equals_uint64 (ges_marker_get_position (markers->data), GST_SECOND);
+  assert_equals_uint64 (ges_marker_get_position (markers->next->data),
+      2 * GST_SECOND);
+  name = ges_meta_container_get_string (markers->next->data, "name");
+  assert_equals_string (name, "Intro");
+  g_list_free_full (markers, g_object_unref);
+
+  markers = ges_marker_list_get_markers (ges_layer_get_marker_list (layer));
+  assert_equals_int (g_list_length (markers), 1);
+  assert_equals_uint64 (ges_marker_get_position (markers->data),
+      3 * GST_SECOND);
+  g_list_free_full (markers, g_object_unref);
+
+  markers = ges_marker_list_get_markers (ges_clip_get_marker_list
+      (clips->data));
+  assert_equals_int (g_list_length (markers), 1);
+  assert_equals_uint64 (ges_marker_get_position (markers->data), 42);
+  g_list_free_full (markers, g_object_unref);
+
+  g_list_free_full (clips, gst_object_unref);
+}
+
+GST_START_TEST (test_project_markers)
+{
+  GESProject *project;
+  GESTimeline *timeline;
+  GESAsset *formatter_asset;
+  gboolean saved;
+  gchar *uri = ges_test_file_uri ("test-keyframes.xges");
+
+  project = ges_project_new (uri);
+  mainloop = g_main_loop_new (NULL, FALSE);
+
+  g_signal_connect (project, "loaded", (GCallback) project_loaded_cb, mainloop);
+  g_signal_connect (project, "missing-uri", (GCallback) _set_new_uri, NULL);
+
+  timeline = GES_TIMELINE (ges_asset_extract (GES_ASSET (project), NULL));
+  g_main_loop_run (mainloop);
+  g_free (uri);
+
+  _add_markers (timeline);
+
+  uri = get_tmp_uri ("test-markers-save.xges");
+  formatter_asset = ges_asset_request (GES_TYPE_FORMATTER, "ges", NULL);
+  saved =
+      ges_project_save (project, timeline, uri, formatter_asset, TRUE, NULL);
+  fail_unless (saved);
+
+  gst_object_unref (timeline);
+  gst_object_unref (project);
+
+  project = ges_project_new (uri);
+  g_signal_connect (project, "loaded", (GCallback) project_loaded_cb, mainloop);
+
+  GST_LOG ("Loading saved project");
+  timeline = GES_TIMELINE (ges_asset_extract (GES_ASSET (project), NULL));
+  fail_unless (GES_IS_TIMELINE (timeline));
+
+  g_main_loop_run (mainloop);
+
+  _check_markers (timeline);
+
+  gst_object_unref (timeline);
+  gst_object_unref (project);
+  g_free (uri);
+
+  g_main_loop_unref (mainloop);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_project_load_xges)
 {
   gboolean saved;
@@ -541,6 +640,370 @@ GST_START_TEST (test_project_load_xges)
 
 GST_END_TEST;
 
+#define N_LAYERS 3
+/* More than what a single loading task builds */
+#define N_LAYER_CLIPS 300
+
+GST_START_TEST (test_project_load_many_clips)
+{
+  guint i, j;
+  gint index;
+  gchar *uri;
+  GESLayer *layer;
+  GList *layers, *clips, *tmp;
+  GESProject *project;
+  GESTimeline *timeline;
+  GESAsset *asset;
+
+  ges_init ();
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  timeline = ges_timeline_new_audio_video ();
+  for (i = 0; i < N_LAYERS; i++) {
+    layer = ges_timeline_append_layer (timeline);
+
+    /* Added in reverse order, they must be loaded sorted */
+    for (j = N_LAYER_CLIPS; j > 0; j--) {
+      GESClip *clip = ges_layer_add_asset (layer, asset, (j - 1) * GST_SECOND,
+          0, GST_SECOND, GES_TRACK_TYPE_UNKNOWN);
+
+      ges_meta_container_set_int (GES_META_CONTAINER (clip), "index", j - 1);
+    }
+  }
+
+  uri = get_tmp_uri ("test-many-clips-save.xges");
+  fail_unless (ges_timeline_save_to_uri (timeline, uri, NULL, TRUE, NULL));
+  gst_object_unref (timeline);
+  gst_object_unref (asset);
+
+  project = ges_project_new (uri);
+  mainloop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (project, "loaded", (GCallback) project_loaded_cb, mainloop);
+  timeline = GES_TIMELINE (ges_asset_extract (GES_ASSET (project), NULL));
+  fail_unless (GES_IS_TIMELINE (timeline));
+  g_main_loop_run (mainloop);
+
+  layers = ges_timeline_get_layers (timeline);
+  assert_equals_int (g_list_length (layers), N_LAYERS);
+  for (tmp = layers; tmp; tmp = tmp->next) {
+    GList *tmpclip;
+
+    clips = ges_layer_get_clips (tmp->data);
+    assert_equals_int (g_list_length (clips), N_LAYER_CLIPS);
+    for (tmpclip = clips, j = 0; tmpclip; tmpclip = tmpclip->next, j++) {
+      assert_equals_uint64 (_START (tmpclip->data), j * GST_SECOND);
+      assert_equals_uint64 (_DURATION (tmpclip->data), GST_SECOND);
+      fail_unless (ges_meta_container_get_int (tmpclip->data, "index",
+              &index));
+      assert_equals_int (index, j);
+      /* The timeline created their track elements */
+      assert_equals_int (g_list_length (GES_CONTAINER_CHILDREN
+              (tmpclip->data)), 2);
+    }
+    g_list_free_full (clips, gst_object_unref);
+  }
+  g_list_free_full (layers, gst_object_unref);
+
+  gst_object_unref (timeline);
+  gst_object_unref (project);
+  g_main_loop_unref (mainloop);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static guint
+_count_track_elements (GESTimeline * timeline)
+{
+  guint n = 0;
+  GList *tracks, *tmp, *elements;
+
+  tracks = ges_timeline_get_tracks (timeline);
+  for (tmp = tracks; tmp; tmp = tmp->next) {
+    elements = ges_track_get_elements (tmp->data);
+    n += g_list_length (elements);
+    g_list_free_full (elements, gst_object_unref);
+  }
+  g_list_free_full (tracks, gst_object_unref);
+
+  return n;
+}
+
+#define N_LAZY_CLIPS 10
+
+GST_START_TEST (test_project_lazy_loading)
+{
+  guint i, j;
+  gchar *uri;
+  GESLayer *layer;
+  GList *layers, *clips;
+  GESProject *project;
+  GESTimeline *timeline;
+  GESAsset *asset;
+
+  ges_init ();
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  timeline = ges_timeline_new_audio_video ();
+  for (i = 0; i < 2; i++) {
+    layer = ges_timeline_append_layer (timeline);
+
+    for (j = 0; j < N_LAZY_CLIPS; j++)
+      ges_layer_add_asset (layer, asset, j * GST_SECOND, 0, GST_SECOND,
+          GES_TRACK_TYPE_UNKNOWN);
+  }
+
+  uri = get_tmp_uri ("test-lazy-loading-save.xges");
+  fail_unless (ges_timeline_save_to_uri (timeline, uri, NULL, TRUE, NULL));
+  gst_object_unref (timeline);
+  gst_object_unref (asset);
+
+  project = ges_project_new (uri);
+  ges_project_set_lazy_loading (project, TRUE);
+  mainloop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (project, "loaded", (GCallback) project_loaded_cb, mainloop);
+  timeline = GES_TIMELINE (ges_asset_extract (GES_ASSET (project), NULL));
+  fail_unless (GES_IS_TIMELINE (timeline));
+  g_main_loop_run (mainloop);
+
+  /* The layers and tracks are there, but no clip was needed yet */
+  layers = ges_timeline_get_layers (timeline);
+  assert_equals_int (g_list_length (layers), 2);
+  fail_if (ges_timeline_is_fully_loaded (timeline));
+  assert_equals_int (_count_track_elements (timeline), 0);
+
+  /* The clips at 2 and 3 seconds in both layers, with 2 track elements
+   * each */
+  ges_timeline_load_range (timeline, 2 * GST_SECOND, 4 * GST_SECOND);
+  assert_equals_int (_count_track_elements (timeline), 2 * 2 * 2);
+  ges_timeline_load_range (timeline, 2 * GST_SECOND + 1, 3 * GST_SECOND);
+  assert_equals_int (_count_track_elements (timeline), 2 * 2 * 2);
+
+  /* Querying a layer loads all its clips */
+  clips = ges_layer_get_clips (layers->data);
+  assert_equals_int (g_list_length (clips), N_LAZY_CLIPS);
+  assert_equals_uint64 (_START (clips->data), 0);
+  g_list_free_full (clips, gst_object_unref);
+  assert_equals_int (_count_track_elements (timeline),
+      (N_LAZY_CLIPS + 2) * 2);
+  fail_if (ges_timeline_is_fully_loaded (timeline));
+
+  clips = ges_layer_get_clips (layers->next->data);
+  assert_equals_int (g_list_length (clips), N_LAZY_CLIPS);
+  g_list_free_full (clips, gst_object_unref);
+  fail_unless (ges_timeline_is_fully_loaded (timeline));
+  assert_equals_int (_count_track_elements (timeline), N_LAZY_CLIPS * 2 * 2);
+  g_list_free_full (layers, gst_object_unref);
+
+  gst_object_unref (timeline);
+  gst_object_unref (project);
+  g_main_loop_unref (mainloop);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_project_lazy_loading_edit)
+{
+  guint j;
+  gchar *uri;
+  GList *layers, *clips, *tmp;
+  GESLayer *layer;
+  GESProject *project;
+  GESTimeline *timeline;
+  GESAsset *asset;
+  GstIterator *it;
+  GValue item = { 0, };
+  GESClip *clip;
+
+  ges_init ();
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  for (j = 0; j < N_LAZY_CLIPS; j++)
+    ges_layer_add_asset (layer, asset, j * GST_SECOND, 0, GST_SECOND,
+        GES_TRACK_TYPE_UNKNOWN);
+
+  uri = get_tmp_uri ("test-lazy-loading-edit.xges");
+  fail_unless (ges_timeline_save_to_uri (timeline, uri, NULL, TRUE, NULL));
+  gst_object_unref (timeline);
+  gst_object_unref (asset);
+
+  project = ges_project_new (uri);
+  ges_project_set_lazy_loading (project, TRUE);
+  mainloop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (project, "loaded", (GCallback) project_loaded_cb, mainloop);
+  timeline = GES_TIMELINE (ges_asset_extract (GES_ASSET (project), NULL));
+  fail_unless (GES_IS_TIMELINE (timeline));
+  g_main_loop_run (mainloop);
+
+  /* Only the clip at 2 seconds gets created */
+  it = ges_timeline_iterate_clips_in_range (timeline, 2 * GST_SECOND,
+      3 * GST_SECOND, 0, G_MAXUINT32);
+  fail_unless (gst_iterator_next (it, &item) == GST_ITERATOR_OK);
+  clip = gst_object_ref (g_value_get_object (&item));
+  g_value_reset (&item);
+  fail_unless (gst_iterator_next (it, &item) == GST_ITERATOR_DONE);
+  gst_iterator_free (it);
+  assert_equals_int (_count_track_elements (timeline), 2);
+  fail_if (ges_timeline_is_fully_loaded (timeline));
+
+  /* Rippling it moves all the following clips, loaded or not, the ones
+   * before it are left alone */
+  fail_unless (ges_container_edit (GES_CONTAINER (clip), NULL, -1,
+          GES_EDIT_MODE_RIPPLE, GES_EDGE_NONE, 2 * GST_SECOND + GST_MSECOND));
+  fail_if (ges_timeline_is_fully_loaded (timeline));
+  assert_equals_int (_count_track_elements (timeline), (N_LAZY_CLIPS - 2) * 2);
+  assert_equals_uint64 (_START (clip), 2 * GST_SECOND + GST_MSECOND);
+  gst_object_unref (clip);
+
+  layers = ges_timeline_get_layers (timeline);
+  clips = ges_layer_get_clips (layers->data);
+  assert_equals_int (g_list_length (clips), N_LAZY_CLIPS);
+  for (tmp = clips, j = 0; tmp; tmp = tmp->next, j++)
+    assert_equals_uint64 (_START (tmp->data),
+        j * GST_SECOND + (j < 2 ? 0 : GST_MSECOND));
+  g_list_free_full (clips, gst_object_unref);
+  g_list_free_full (layers, gst_object_unref);
+  gst_object_unref (timeline);
+  gst_object_unref (project);
+
+  /* The duration accounts for the clips that are not loaded yet */
+  project = ges_project_new (uri);
+  ges_project_set_lazy_loading (project, TRUE);
+  g_signal_connect (project, "loaded", (GCallback) project_loaded_cb, mainloop);
+  timeline = GES_TIMELINE (ges_asset_extract (GES_ASSET (project), NULL));
+  fail_unless (GES_IS_TIMELINE (timeline));
+  g_main_loop_run (mainloop);
+
+  fail_if (ges_timeline_is_fully_loaded (timeline));
+  assert_equals_uint64 (ges_timeline_get_duration (timeline),
+      N_LAZY_CLIPS * GST_SECOND);
+  fail_if (ges_timeline_is_fully_loaded (timeline));
+  assert_equals_int (_count_track_elements (timeline), 0);
+
+  /* Trimming a clip only creates the ones it can reach */
+  it = ges_timeline_iterate_clips_at (timeline, 5 * GST_SECOND);
+  fail_unless (gst_iterator_next (it, &item) == GST_ITERATOR_OK);
+  clip = gst_object_ref (g_value_get_object (&item));
+  g_value_reset (&item);
+  gst_iterator_free (it);
+  fail_unless (ges_container_edit (GES_CONTAINER (clip), NULL, -1,
+          GES_EDIT_MODE_TRIM, GES_EDGE_END, 5 * GST_SECOND + GST_MSECOND));
+  assert_equals_uint64 (_DURATION (clip), GST_MSECOND);
+  gst_object_unref (clip);
+  /* The clip at 5 seconds and its neighbour at 6 seconds */
+  assert_equals_int (_count_track_elements (timeline), 2 * 2);
+  fail_if (ges_timeline_is_fully_loaded (timeline));
+  assert_equals_uint64 (ges_timeline_get_duration (timeline),
+      N_LAZY_CLIPS * GST_SECOND);
+
+  gst_object_unref (timeline);
+  gst_object_unref (project);
+  g_main_loop_unref (mainloop);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static guint
+_count_iterated_clips (GstIterator * it)
+{
+  guint n = 0;
+  gboolean done = FALSE;
+  GValue item = { 0, };
+
+  while (!done) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:
+        n++;
+        g_value_reset (&item);
+        break;
+      case GST_ITERATOR_RESYNC:
+        n = 0;
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  if (G_IS_VALUE (&item))
+    g_value_unset (&item);
+  gst_iterator_free (it);
+
+  return n;
+}
+
+GST_START_TEST (test_project_lazy_loading_iterate)
+{
+  guint j;
+  gchar *uri;
+  GESLayer *layer;
+  GESProject *project;
+  GESTimeline *timeline;
+  GESAsset *asset, *title_asset;
+
+  ges_init ();
+
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+  title_asset = ges_asset_request (GES_TYPE_TITLE_CLIP, NULL, NULL);
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  for (j = 0; j < N_LAZY_CLIPS; j++)
+    ges_layer_add_asset (layer, asset, j * GST_SECOND, 0, GST_SECOND,
+        GES_TRACK_TYPE_UNKNOWN);
+  layer = ges_timeline_append_layer (timeline);
+  for (j = 0; j < N_LAZY_CLIPS; j += 2)
+    ges_layer_add_asset (layer, title_asset, j * GST_SECOND, 0, GST_SECOND,
+        GES_TRACK_TYPE_UNKNOWN);
+
+  uri = get_tmp_uri ("test-lazy-loading-iterate.xges");
+  fail_unless (ges_timeline_save_to_uri (timeline, uri, NULL, TRUE, NULL));
+  gst_object_unref (timeline);
+
+  project = ges_project_new (uri);
+  ges_project_set_lazy_loading (project, TRUE);
+  mainloop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (project, "loaded", (GCallback) project_loaded_cb, mainloop);
+  timeline = GES_TIMELINE (ges_asset_extract (GES_ASSET (project), NULL));
+  fail_unless (GES_IS_TIMELINE (timeline));
+  g_main_loop_run (mainloop);
+  assert_equals_int (_count_track_elements (timeline), 0);
+
+  /* The iterators see the clips that were not loaded yet */
+  assert_equals_int (_count_iterated_clips (ges_timeline_iterate_clips_at
+          (timeline, 3 * GST_SECOND + GST_MSECOND)), 1);
+  /* Only the audio and video sources of that clip were created */
+  assert_equals_int (_count_track_elements (timeline), 2);
+
+  assert_equals_int (_count_iterated_clips
+      (ges_timeline_iterate_clips_in_range (timeline, 4 * GST_SECOND,
+              6 * GST_SECOND, 0, G_MAXUINT32)), 3);
+  assert_equals_int (_count_iterated_clips
+      (ges_timeline_iterate_clips_in_range (timeline, 4 * GST_SECOND,
+              6 * GST_SECOND, 1, 1)), 1);
+
+  assert_equals_int (_count_iterated_clips
+      (ges_timeline_iterate_clips_by_asset (timeline, title_asset)),
+      N_LAZY_CLIPS / 2);
+  /* The test clips out of the ranges we looked at are still to be built */
+  fail_if (ges_timeline_is_fully_loaded (timeline));
+  assert_equals_int (_count_iterated_clips
+      (ges_timeline_iterate_clips_by_asset (timeline, asset)), N_LAZY_CLIPS);
+  fail_unless (ges_timeline_is_fully_loaded (timeline));
+
+  gst_object_unref (timeline);
+  gst_object_unref (project);
+  gst_object_unref (title_asset);
+  gst_object_unref (asset);
+  g_main_loop_unref (mainloop);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_project_auto_transition)
 {
   GList *layers;
@@ -722,6 +1185,11 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_project_load_xges);
   tcase_add_test (tc_chain, test_project_add_keyframes);
   tcase_add_test (tc_chain, test_project_auto_transition);
+  tcase_add_test (tc_chain, test_project_markers);
+  tcase_add_test (tc_chain, test_project_load_many_clips);
+  tcase_add_test (tc_chain, test_project_lazy_loading);
+  tcase_add_test (tc_chain, test_project_lazy_loading_edit);
+  tcase_add_test (tc_chain, test_project_lazy_loading_iterate);
   /*tcase_add_test (tc_chain, test_load_xges_and_play); */
   tcase_add_test (tc_chain, test_project_unexistant_effect);
 
@@ -1288,6 +1288,117 @@ _set_track_element_width_height (GESTrackElement * trksrc, gint wvalue,
     ges_track_element_set_child_property (trksrc, "height", &height);
 }
 
+GST_START_TEST (test_snapping_playhead)
+{
+  GESAsset *asset;
+  GESLayer *layer;
+  GESClip *c, *c1;
+  GESTimeline *timeline;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+
+  c = ges_layer_add_asset (layer, asset, 0, 0, 10, GES_TRACK_TYPE_UNKNOWN);
+  c1 = ges_layer_add_asset (layer, asset, 50, 0, 10, GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+
+  g_object_set (timeline, "snapping-distance", (guint64) 3, NULL);
+  assert_equals_uint64 (ges_timeline_get_snapping_playhead (timeline),
+      GST_CLOCK_TIME_NONE);
+
+  /* Snaps to the end of c */
+  fail_unless (ges_container_edit (GES_CONTAINER (c1), NULL, -1,
+          GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 12));
+  DEEP_CHECK (c1, 10, 0, 10);
+
+  /* Snaps to the playhead */
+  ges_timeline_set_snapping_playhead (timeline, 30);
+  fail_unless (ges_container_edit (GES_CONTAINER (c1), NULL, -1,
+          GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 28));
+  DEEP_CHECK (c1, 30, 0, 10);
+
+  /* The playhead moved */
+  g_object_set (timeline, "snapping-playhead", (guint64) 40, NULL);
+  fail_unless (ges_container_edit (GES_CONTAINER (c1), NULL, -1,
+          GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 38));
+  DEEP_CHECK (c1, 40, 0, 10);
+
+  /* Snapping to the playhead disabled */
+  ges_timeline_set_snapping_playhead (timeline, GST_CLOCK_TIME_NONE);
+  fail_unless (ges_container_edit (GES_CONTAINER (c1), NULL, -1,
+          GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 29));
+  DEEP_CHECK (c1, 29, 0, 10);
+
+  /* The elements moved are snapped to at their new position */
+  fail_unless (ges_container_edit (GES_CONTAINER (c), NULL, -1,
+          GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 40));
+  DEEP_CHECK (c, 39, 0, 10);
+  DEEP_CHECK (c1, 29, 0, 10);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_snapping_markers)
+{
+  GESAsset *asset;
+  GESLayer *layer;
+  GESClip *c, *c1;
+  GESMarker *marker;
+  GESMarkerList *markers;
+  GESTimeline *timeline;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+  asset = ges_asset_request (GES_TYPE_TEST_CLIP, NULL, NULL);
+
+  c = ges_layer_add_asset (layer, asset, 0, 0, 10, GES_TRACK_TYPE_UNKNOWN);
+  c1 = ges_layer_add_asset (layer, asset, 50, 0, 10, GES_TRACK_TYPE_UNKNOWN);
+  gst_object_unref (asset);
+
+  g_object_set (timeline, "snapping-distance", (guint64) 3, NULL);
+  markers = ges_timeline_get_marker_list (timeline);
+  marker = ges_marker_list_add (markers, 30);
+
+  /* Snaps to the marker */
+  fail_unless (ges_container_edit (GES_CONTAINER (c1), NULL, -1,
+          GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 28));
+  DEEP_CHECK (c1, 30, 0, 10);
+
+  /* The end snaps to the marker too */
+  fail_unless (ges_container_edit (GES_CONTAINER (c1), NULL, -1,
+          GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 22));
+  DEEP_CHECK (c1, 20, 0, 10);
+
+  /* The marker moved */
+  fail_unless (ges_marker_list_move (markers, marker, 40));
+  fail_unless (ges_container_edit (GES_CONTAINER (c1), NULL, -1,
+          GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 38));
+  DEEP_CHECK (c1, 40, 0, 10);
+
+  /* The marker is gone */
+  fail_unless (ges_marker_list_remove (markers, marker));
+  fail_unless (ges_container_edit (GES_CONTAINER (c1), NULL, -1,
+          GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 29));
+  DEEP_CHECK (c1, 29, 0, 10);
+
+  /* Markers of layers are not snapped to */
+  ges_marker_list_add (ges_layer_get_marker_list (layer), 60);
+  fail_unless (ges_container_edit (GES_CONTAINER (c), NULL, -1,
+          GES_EDIT_MODE_NORMAL, GES_EDGE_NONE, 58));
+  DEEP_CHECK (c, 58, 0, 10);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static gboolean
 check_frame_positionner_size (GESClip * clip, gint width, gint height)
 {
@@ -1495,6 +1606,8 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_simple_triming);
   tcase_add_test (tc_chain, test_groups);
   tcase_add_test (tc_chain, test_snapping_groups);
+  tcase_add_test (tc_chain, test_snapping_playhead);
+  tcase_add_test (tc_chain, test_snapping_markers);
   tcase_add_test (tc_chain, test_scaling);
 
   return s;
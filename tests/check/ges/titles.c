@@ -205,6 +205,120 @@ GST_START_TEST (test_title_source_in_layer)
 
 GST_END_TEST;
 
+static void
+text_notify_cb (GObject * text, GParamSpec * pspec, guint * count)
+{
+  *count += 1;
+}
+
+GST_START_TEST (test_title_source_unchanged_properties)
+{
+  GESTrack *v;
+  GESClip *clip;
+  GESLayer *layer;
+  GstElement *text;
+  GESTimeline *timeline;
+  GESTrackElement *track_element;
+  guint n_notifies = 0;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_append_layer (timeline);
+  v = GES_TRACK (ges_video_track_new ());
+  ges_timeline_add_track (timeline, v);
+
+  clip = GES_CLIP (ges_title_clip_new ());
+  g_object_set (clip, "duration", (guint64) GST_SECOND, NULL);
+  ges_layer_add_clip (layer, clip);
+
+  track_element = ges_clip_find_track_element (clip, v, GES_TYPE_TITLE_SOURCE);
+  text = gst_bin_get_by_name (GST_BIN (ges_track_element_get_element
+          (track_element)), "titlsrc-text");
+  fail_unless (text != NULL);
+  g_signal_connect (text, "notify", G_CALLBACK (text_notify_cb), &n_notifies);
+
+  g_object_set (clip, "text", "some text", "xpos", 0.25, NULL);
+  assert_equals_int (n_notifies, 2);
+
+  /* Setting the same values should not make textoverlay render again */
+  g_object_set (clip, "text", "some text", "xpos", 0.25, NULL);
+  assert_equals_int (n_notifies, 2);
+
+  g_object_set (clip, "text", "other text", NULL);
+  assert_equals_int (n_notifies, 3);
+
+  gst_object_unref (text);
+  gst_object_unref (track_element);
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_title_source_children_properties)
+{
+  GESTrack *v;
+  GESClip *clip;
+  gchar *text_value;
+  gdouble xpos;
+  guint color;
+  GESLayer *layer;
+  GstElement *text, *background;
+  GESTimeline *timeline;
+  GESTitleSource *source;
+  GstElement *bin;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_append_layer (timeline);
+  v = GES_TRACK (ges_video_track_new ());
+  ges_timeline_add_track (timeline, v);
+
+  clip = GES_CLIP (ges_title_clip_new ());
+  g_object_set (clip, "duration", (guint64) GST_SECOND, NULL);
+  ges_layer_add_clip (layer, clip);
+
+  source = GES_TITLE_SOURCE (ges_clip_find_track_element (clip, v,
+          GES_TYPE_TITLE_SOURCE));
+  bin = ges_track_element_get_element (GES_TRACK_ELEMENT (source));
+  text = gst_bin_get_by_name (GST_BIN (bin), "titlsrc-text");
+  background = gst_bin_get_by_name (GST_BIN (bin), "titlesrc-bg");
+  fail_unless (text != NULL && background != NULL);
+
+  ges_title_source_set_text (source, "some text");
+  ges_title_source_set_xpos (source, 0.25);
+  ges_title_source_set_background_color (source, 0xff0000ff);
+
+  /* Changing the children properties directly is seen by the source */
+  ges_track_element_set_child_properties (GES_TRACK_ELEMENT (source),
+      "text", "child text", "xpos", 0.75, "foreground-color", 0xff00ff00,
+      NULL);
+  assert_equals_string (ges_title_source_get_text (source), "child text");
+  assert_equals_float (ges_title_source_get_xpos (source), 0.75);
+  assert_equals_int (ges_title_source_get_background_color (source),
+      0xff00ff00);
+
+  /* So setting back the previous values is not skipped */
+  ges_title_source_set_text (source, "some text");
+  ges_title_source_set_xpos (source, 0.25);
+  ges_title_source_set_background_color (source, 0xff0000ff);
+
+  g_object_get (text, "text", &text_value, "xpos", &xpos, NULL);
+  assert_equals_string (text_value, "some text");
+  assert_equals_float (xpos, 0.25);
+  g_free (text_value);
+  g_object_get (background, "foreground-color", &color, NULL);
+  assert_equals_int (color, 0xff0000ff);
+
+  gst_object_unref (text);
+  gst_object_unref (background);
+  gst_object_unref (source);
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -216,6 +330,8 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_title_source_basic);
   tcase_add_test (tc_chain, test_title_source_properties);
   tcase_add_test (tc_chain, test_title_source_in_layer);
+  tcase_add_test (tc_chain, test_title_source_unchanged_properties);
+  tcase_add_test (tc_chain, test_title_source_children_properties);
 
   return s;
 }
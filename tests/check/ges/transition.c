@@ -20,7 +20,9 @@
 
 #include "test-utils.h"
 #include <ges/ges.h>
+#include <ges/gstaudiofade.h>
 #include <gst/check/gstcheck.h>
+#include <math.h>
 
 /* This test uri will eventually have to be fixed */
 #define TEST_URI "blahblahblah"
@@ -172,6 +174,98 @@ GST_END_TEST;
 
 
 
+/* Checks the gain of @fade at @x, between 0 and 1, of the fade duration */
+static void
+check_fade_gain (GstAudioFade * fade, gdouble x, gdouble expected)
+{
+  gfloat gain = fade->gains[(guint) (x * GST_AUDIO_FADE_TABLE_SIZE)];
+
+  fail_unless (fabs (gain - expected) < 1e-6,
+      "Gain at %f is %f, expected %f", x, gain, expected);
+}
+
+/* Checks both fades of @trackelement follow @curve, @quarter, @half and
+ * @three_quarters being the gains of the fade in at those positions */
+static void
+check_audio_transition_fades (GESTrackElement * trackelement,
+    GESAudioFadeCurve curve, gdouble quarter, gdouble half,
+    gdouble three_quarters)
+{
+  GstIterator *it;
+  gboolean fade_in;
+  guint n_fades = 0;
+  GESAudioFadeCurve fade_curve;
+  GValue item = G_VALUE_INIT;
+
+  g_object_set (trackelement, "fade-curve", curve, NULL);
+
+  it = gst_bin_iterate_recurse (GST_BIN (ges_track_element_get_element
+          (trackelement)));
+  while (gst_iterator_next (it, &item) == GST_ITERATOR_OK) {
+    GstElement *element = g_value_get_object (&item);
+
+    if (GST_IS_AUDIO_FADE (element)) {
+      GstAudioFade *fade = GST_AUDIO_FADE (element);
+
+      g_object_get (element, "curve", &fade_curve, "fade-in", &fade_in, NULL);
+      assert_equals_int (fade_curve, curve);
+
+      /* The fade out follows the fade in curve backward */
+      check_fade_gain (fade, 0.0, fade_in ? 0.0 : 1.0);
+      check_fade_gain (fade, 0.25, fade_in ? quarter : three_quarters);
+      check_fade_gain (fade, 0.5, half);
+      check_fade_gain (fade, 0.75, fade_in ? three_quarters : quarter);
+      check_fade_gain (fade, 1.0, fade_in ? 1.0 : 0.0);
+      n_fades++;
+    }
+    g_value_reset (&item);
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+  assert_equals_int (n_fades, 2);
+}
+
+GST_START_TEST (test_audio_transition_fade_curve)
+{
+  GESTrack *track;
+  GESLayer *layer;
+  GESTimeline *timeline;
+  GESTransitionClip *tr;
+  GESTrackElement *trackelement;
+  GESAudioFadeCurve curve;
+  const gdouble custom[] = { 0.0, 0.8, 1.0 };
+
+  ges_init ();
+
+  track = GES_TRACK (ges_audio_track_new ());
+  timeline = ges_timeline_new ();
+  layer = ges_timeline_append_layer (timeline);
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  tr = ges_transition_clip_new (GES_VIDEO_STANDARD_TRANSITION_TYPE_CROSSFADE);
+  fail_unless (ges_layer_add_clip (layer, GES_CLIP (tr)));
+  assert_equals_int (g_list_length (GES_CONTAINER_CHILDREN (tr)), 1);
+  trackelement = GES_CONTAINER_CHILDREN (tr)->data;
+  fail_unless (GES_IS_AUDIO_TRANSITION (trackelement));
+
+  g_object_get (trackelement, "fade-curve", &curve, NULL);
+  assert_equals_int (curve, GES_AUDIO_FADE_CURVE_LINEAR);
+
+  ges_audio_transition_set_custom_fade_curve (GES_AUDIO_TRANSITION
+      (trackelement), custom, G_N_ELEMENTS (custom));
+
+  check_audio_transition_fades (trackelement, GES_AUDIO_FADE_CURVE_EQUAL_POWER,
+      sin (G_PI / 8), sin (G_PI / 4), sin (3 * G_PI / 8));
+  check_audio_transition_fades (trackelement, GES_AUDIO_FADE_CURVE_CUSTOM,
+      0.4, 0.8, 0.9);
+  check_audio_transition_fades (trackelement, GES_AUDIO_FADE_CURVE_LINEAR,
+      0.25, 0.5, 0.75);
+
+  gst_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -182,6 +276,7 @@ ges_suite (void)
 
   tcase_add_test (tc_chain, test_transition_basic);
   tcase_add_test (tc_chain, test_transition_properties);
+  tcase_add_test (tc_chain, test_audio_transition_fade_curve);
 
   return s;
 }
@@ -20,6 +20,8 @@
 #include "test-utils.h"
 #include <ges/ges.h>
 #include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+#include <gst/controller/gstinterpolationcontrolsource.h>
 
 /* This test uri will eventually have to be fixed */
 #define TEST_URI "http://nowhere/blahblahblah"
@@ -266,6 +268,348 @@ GST_START_TEST (test_filesource_images)
 GST_END_TEST;
 
 
+static void
+_image_preroll_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    gchar ** checksum)
+{
+  GstMapInfo map;
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  g_free (*checksum);
+  *checksum = g_compute_checksum_for_data (G_CHECKSUM_MD5, map.data,
+      map.size);
+  gst_buffer_unmap (buffer, &map);
+}
+
+/* Returns the checksum of the frame prerolled since the last call */
+static gchar *
+_preroll_image (GstElement * pipeline, gchar ** checksum)
+{
+  gchar *ret;
+
+  fail_unless (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_SUCCESS);
+  fail_unless (*checksum != NULL);
+  ret = *checksum;
+  *checksum = NULL;
+
+  return ret;
+}
+
+GST_START_TEST (test_filesource_image_replay)
+{
+  GESAsset *asset;
+  GESLayer *layer;
+  GESTimeline *timeline;
+  GESPipeline *pipeline;
+  GstElement *sink;
+  gchar *checksum = NULL, *first, *other;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline,
+          GES_TRACK (ges_video_track_new ())));
+  layer = ges_timeline_append_layer (timeline);
+  asset = GES_ASSET (ges_uri_clip_asset_request_sync (image_uri, NULL));
+  fail_unless (GES_IS_ASSET (asset));
+  fail_unless (ges_layer_add_asset (layer, asset, 0, 0, GST_SECOND,
+          GES_TRACK_TYPE_UNKNOWN));
+  gst_object_unref (asset);
+  ges_timeline_commit (timeline);
+
+  pipeline = ges_pipeline_new ();
+  fail_unless (ges_pipeline_set_timeline (pipeline, timeline));
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, "sync", FALSE, NULL);
+  g_signal_connect (sink, "preroll-handoff", G_CALLBACK (_image_preroll_cb),
+      &checksum);
+  ges_pipeline_preview_set_video_sink (pipeline, sink);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PAUSED);
+  first = _preroll_image (GST_ELEMENT (pipeline), &checksum);
+
+  /* The image is decoded again from the cache after flushing */
+  fail_unless (gst_element_seek_simple (GST_ELEMENT (pipeline),
+          GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE,
+          GST_SECOND / 2));
+  other = _preroll_image (GST_ELEMENT (pipeline), &checksum);
+  assert_equals_string (other, first);
+  g_free (other);
+
+  fail_unless (gst_element_seek_simple (GST_ELEMENT (pipeline),
+          GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, 0));
+  other = _preroll_image (GST_ELEMENT (pipeline), &checksum);
+  assert_equals_string (other, first);
+  g_free (other);
+
+  /* And once the sources restart */
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_READY);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PAUSED);
+  other = _preroll_image (GST_ELEMENT (pipeline), &checksum);
+  assert_equals_string (other, first);
+  g_free (other);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  g_free (first);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_filesource_analysis)
+{
+  GESAsset *asset;
+  GstBuffer *peaks;
+  const GValue *value;
+  gdouble loudness;
+  GError *error = NULL;
+
+  ges_init ();
+
+  asset = GES_ASSET (ges_uri_clip_asset_request_sync (av_uri, NULL));
+  fail_unless (GES_IS_URI_CLIP_ASSET (asset));
+
+  fail_unless (ges_uri_clip_asset_analyze_sync (GES_URI_CLIP_ASSET (asset),
+          NULL, &error));
+  fail_unless (error == NULL);
+
+  value = ges_meta_container_get_meta (GES_META_CONTAINER (asset),
+      GES_META_ANALYSIS_SCENE_CHANGES);
+  fail_unless (value && GST_VALUE_HOLDS_ARRAY (value));
+
+  value = ges_meta_container_get_meta (GES_META_CONTAINER (asset),
+      GES_META_ANALYSIS_LOUDNESS);
+  fail_unless (value && GST_VALUE_HOLDS_ARRAY (value));
+  fail_unless (gst_value_array_get_size (value) > 0);
+
+  fail_unless (ges_meta_container_get_double (GES_META_CONTAINER (asset),
+          GES_META_ANALYSIS_INTEGRATED_LOUDNESS, &loudness));
+  fail_unless (loudness >= -70.0 && loudness <= 0.0);
+
+  value = ges_meta_container_get_meta (GES_META_CONTAINER (asset),
+      GES_META_ANALYSIS_WAVEFORM_PEAKS);
+  fail_unless (value && GST_VALUE_HOLDS_BUFFER (value));
+  peaks = gst_value_get_buffer (value);
+  fail_unless (gst_buffer_get_size (peaks) > 0);
+
+  /* Second time the results come from the disk cache */
+  fail_unless (ges_uri_clip_asset_analyze_sync (GES_URI_CLIP_ASSET (asset),
+          NULL, NULL));
+
+  gst_object_unref (asset);
+}
+
+GST_END_TEST;
+
+static void
+ready_cb (GESUriSourceAsset * asset, GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+}
+
+GST_START_TEST (test_filesource_peaks)
+{
+  GList *tmp;
+  GBytes *peaks;
+  GESAsset *asset;
+  GMainLoop *loop;
+  guint samples_per_peak;
+  GESUriSourceAsset *audio_asset = NULL;
+
+  ges_init ();
+
+  asset = GES_ASSET (ges_uri_clip_asset_request_sync (av_uri, NULL));
+  fail_unless (GES_IS_URI_CLIP_ASSET (asset));
+
+  for (tmp = (GList *)
+      ges_uri_clip_asset_get_stream_assets (GES_URI_CLIP_ASSET (asset)); tmp;
+      tmp = tmp->next) {
+    if (GST_IS_DISCOVERER_AUDIO_INFO (ges_uri_source_asset_get_stream_info
+            (tmp->data)))
+      audio_asset = tmp->data;
+  }
+  fail_unless (audio_asset != NULL);
+
+  /* Peaks are computed in the background */
+  loop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (audio_asset, "peaks-ready", G_CALLBACK (ready_cb),
+      loop);
+  fail_unless (ges_uri_source_asset_get_peaks (audio_asset, 0, GST_SECOND,
+          512, NULL) == NULL);
+  g_main_loop_run (loop);
+  g_main_loop_unref (loop);
+
+  peaks = ges_uri_source_asset_get_peaks (audio_asset, 0, GST_SECOND, 512,
+      &samples_per_peak);
+  fail_unless (peaks != NULL);
+  assert_equals_int (samples_per_peak, 512);
+  fail_unless (g_bytes_get_size (peaks) > 0);
+  assert_equals_int (g_bytes_get_size (peaks) % sizeof (GESAudioPeak), 0);
+  g_bytes_unref (peaks);
+
+  /* Never get a resolution lower than asked for */
+  peaks = ges_uri_source_asset_get_peaks (audio_asset, 0, GST_SECOND, 300,
+      &samples_per_peak);
+  fail_unless (peaks != NULL);
+  assert_equals_int (samples_per_peak, 256);
+  g_bytes_unref (peaks);
+
+  gst_object_unref (asset);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_filesource_seek_index)
+{
+  GList *tmp;
+  GESAsset *asset;
+  GMainLoop *loop;
+  guint n_skip_frames;
+  GstClockTime keyframe;
+  GESUriSourceAsset *video_asset = NULL;
+
+  ges_init ();
+
+  asset = GES_ASSET (ges_uri_clip_asset_request_sync (av_uri, NULL));
+  fail_unless (GES_IS_URI_CLIP_ASSET (asset));
+
+  for (tmp = (GList *)
+      ges_uri_clip_asset_get_stream_assets (GES_URI_CLIP_ASSET (asset)); tmp;
+      tmp = tmp->next) {
+    if (GST_IS_DISCOVERER_VIDEO_INFO (ges_uri_source_asset_get_stream_info
+            (tmp->data)))
+      video_asset = tmp->data;
+  }
+  fail_unless (video_asset != NULL);
+
+  /* The index is built in the background */
+  loop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (video_asset, "seek-index-ready",
+      G_CALLBACK (ready_cb), loop);
+  fail_if (ges_uri_source_asset_get_keyframe (video_asset, 0, NULL, NULL));
+  g_main_loop_run (loop);
+  g_main_loop_unref (loop);
+
+  fail_unless (ges_uri_source_asset_get_keyframe (video_asset, 0, &keyframe,
+          &n_skip_frames));
+  assert_equals_uint64 (keyframe, 0);
+  assert_equals_int (n_skip_frames, 0);
+
+  fail_unless (ges_uri_source_asset_get_keyframe (video_asset,
+          GST_SECOND / 2, &keyframe, NULL));
+  fail_unless (keyframe <= GST_SECOND / 2);
+
+  gst_object_unref (asset);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_filesource_relink)
+{
+  gint posx;
+  gchar *tmpdir, *path, *moved_uri;
+  gdouble volume;
+  GESLayer *layer;
+  GESTimeline *timeline;
+  GESUriClip *clip;
+  GFile *file, *moved_file;
+  GESAsset *asset, *moved_asset;
+  GstControlSource *source, *new_source;
+  GstControlBinding *binding;
+  GESTrackElement *video, *audio, *new_video, *new_audio;
+
+  ges_init ();
+
+  /* The media is moved to another directory */
+  tmpdir = g_dir_make_tmp ("ges-relink-XXXXXX", NULL);
+  fail_unless (tmpdir != NULL);
+  file = g_file_new_for_uri (av_uri);
+  path = g_build_filename (tmpdir, "audio_video.ogg", NULL);
+  moved_file = g_file_new_for_path (path);
+  moved_uri = g_file_get_uri (moved_file);
+  g_free (path);
+  fail_unless (g_file_copy (file, moved_file, G_FILE_COPY_NONE, NULL, NULL,
+          NULL, NULL));
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+
+  asset = GES_ASSET (ges_uri_clip_asset_request_sync (av_uri, NULL));
+  fail_unless (GES_IS_URI_CLIP_ASSET (asset));
+  clip = GES_URI_CLIP (ges_layer_add_asset (layer, asset, 0, 0, GST_SECOND,
+          GES_TRACK_TYPE_UNKNOWN));
+  fail_unless (GES_IS_URI_CLIP (clip));
+
+  video = ges_clip_find_track_element (GES_CLIP (clip), NULL,
+      GES_TYPE_VIDEO_SOURCE);
+  audio = ges_clip_find_track_element (GES_CLIP (clip), NULL,
+      GES_TYPE_AUDIO_SOURCE);
+  fail_unless (video && audio);
+
+  ges_track_element_set_child_properties (video, "posx", 42, NULL);
+  ges_track_element_set_active (video, FALSE);
+  ges_track_element_set_child_properties (audio, "volume", 0.5, NULL);
+
+  source = gst_interpolation_control_source_new ();
+  g_object_set (source, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+  gst_timed_value_control_source_set (GST_TIMED_VALUE_CONTROL_SOURCE (source),
+      0, 0.0);
+  gst_timed_value_control_source_set (GST_TIMED_VALUE_CONTROL_SOURCE (source),
+      GST_SECOND, 1.0);
+  fail_unless (ges_track_element_set_control_source (audio, source, "volume",
+          "direct"));
+
+  moved_asset = GES_ASSET (ges_uri_clip_asset_request_sync (moved_uri, NULL));
+  fail_unless (GES_IS_URI_CLIP_ASSET (moved_asset));
+  assert_equals_int (ges_asset_move_extractables (asset, moved_asset), 1);
+  fail_unless (ges_extractable_get_asset (GES_EXTRACTABLE (clip)) ==
+      moved_asset);
+  fail_if (g_strcmp0 (ges_uri_clip_get_uri (clip), moved_uri));
+
+  /* The sources have been replaced, keeping their state */
+  new_video = ges_clip_find_track_element (GES_CLIP (clip), NULL,
+      GES_TYPE_VIDEO_SOURCE);
+  new_audio = ges_clip_find_track_element (GES_CLIP (clip), NULL,
+      GES_TYPE_AUDIO_SOURCE);
+  fail_unless (new_video && new_audio);
+  fail_if (new_video == video);
+  fail_if (new_audio == audio);
+  assert_equals_int (g_list_length (GES_CONTAINER_CHILDREN (clip)), 2);
+
+  ges_track_element_get_child_properties (new_video, "posx", &posx, NULL);
+  assert_equals_int (posx, 42);
+  fail_if (ges_track_element_is_active (new_video));
+
+  ges_track_element_get_child_properties (new_audio, "volume", &volume, NULL);
+  assert_equals_float (volume, 0.5);
+  fail_unless (ges_track_element_is_active (new_audio));
+
+  binding = ges_track_element_get_control_binding (new_audio, "volume");
+  fail_unless (binding != NULL);
+  g_object_get (binding, "control-source", &new_source, NULL);
+  fail_unless (new_source == source);
+  gst_object_unref (new_source);
+
+  gst_object_unref (video);
+  gst_object_unref (audio);
+  gst_object_unref (new_video);
+  gst_object_unref (new_audio);
+  gst_object_unref (source);
+  gst_object_unref (asset);
+  gst_object_unref (moved_asset);
+  gst_object_unref (timeline);
+
+  g_file_delete (moved_file, NULL, NULL);
+  g_rmdir (tmpdir);
+  g_object_unref (moved_file);
+  g_object_unref (file);
+  g_free (moved_uri);
+  g_free (tmpdir);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -276,7 +620,12 @@ ges_suite (void)
 
   tcase_add_test (tc_chain, test_filesource_basic);
   tcase_add_test (tc_chain, test_filesource_images);
+  tcase_add_test (tc_chain, test_filesource_image_replay);
   tcase_add_test (tc_chain, test_filesource_properties);
+  tcase_add_test (tc_chain, test_filesource_analysis);
+  tcase_add_test (tc_chain, test_filesource_peaks);
+  tcase_add_test (tc_chain, test_filesource_seek_index);
+  tcase_add_test (tc_chain, test_filesource_relink);
 
   return s;
 }
@@ -0,0 +1,730 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Renders a queue of projects in a single process, so that GStreamer, the
+ * registry, the discoverer and the assets already loaded are shared by all
+ * the jobs.
+ *
+ * A job is a line of the form:
+ *
+ *   <project> <output> [<format>]
+ *
+ * where <project> and <output> are URIs or file names and <format> is an
+ * encoding profile as given to --format. Empty lines and lines starting
+ * with '#' are ignored.
+ *
+ * Jobs are either read from a file (or stdin) in which case we exit once all
+ * of them are done, or received from clients connecting to a unix socket only
+ * its owner can access. In that case each client is told about the jobs it
+ * submitted with lines of the form:
+ *
+ *   queued <id>
+ *   done <id> <seconds>
+ *   failed <id> <message>
+ *
+ * and a client can send "quit" to make us exit once all the jobs are done.
+ *
+ * Only local files can be rendered to.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <ges/ges.h>
+
+#ifdef HAVE_GIO_UNIX
+#include <sys/stat.h>
+#include <gio/gunixsocketaddress.h>
+#endif
+
+#include "ges-batch.h"
+
+#define PROGRESS_INTERVAL 1000  /* ms */
+#define REPLIES_KEY "ges-batch-replies"
+
+typedef struct _BatchJob BatchJob;
+
+typedef struct
+{
+  GMainLoop *mainloop;
+  GESBatchParseProfileFunc parse_profile;
+  const gchar *default_format;
+
+  guint max_jobs;
+  guint next_id;
+  GQueue pending;
+  GList *running;
+
+  guint n_done;
+  guint n_failed;
+
+  GSocketService *service;
+  gboolean quitting;
+
+  /* ReplyQueue-s still writing */
+  guint n_replying;
+} Batch;
+
+struct _BatchJob
+{
+  Batch *batch;
+  guint id;
+
+  gchar *project_uri;
+  gchar *output_uri;
+  gchar *format;
+
+  /* Where to report to, may be NULL */
+  GOutputStream *client;
+
+  GESProject *project;
+  GESTimeline *timeline;
+  GESPipeline *pipeline;
+  guint bus_watch;
+
+  /* Set when loading failed, the job is finished from an idle */
+  gchar *error;
+  guint error_idle;
+
+  GstClockTime start_time;
+  GstClockTime load_time;
+};
+
+static void _start_jobs (Batch * batch);
+
+static gchar *
+_ensure_uri (const gchar * location)
+{
+  if (gst_uri_is_valid (location))
+    return g_strdup (location);
+  else
+    return gst_filename_to_uri (location, NULL);
+}
+
+/* The replies to a client, written one after the other without blocking
+ * the main loop. It only exists while there is something to write */
+typedef struct
+{
+  Batch *batch;
+  GOutputStream *stream;
+  GQueue lines;
+  gsize written;                /* Of the first line */
+} ReplyQueue;
+
+static void _reply_write_next (ReplyQueue * replies);
+
+static void
+_reply_queue_free (ReplyQueue * replies)
+{
+  g_object_set_data (G_OBJECT (replies->stream), REPLIES_KEY, NULL);
+  replies->batch->n_replying--;
+
+  g_queue_foreach (&replies->lines, (GFunc) g_free, NULL);
+  g_queue_clear (&replies->lines);
+  g_object_unref (replies->stream);
+  g_slice_free (ReplyQueue, replies);
+}
+
+static void
+_reply_written_cb (GOutputStream * stream, GAsyncResult * res,
+    ReplyQueue * replies)
+{
+  gssize written;
+
+  /* The client going away should not affect the jobs */
+  written = g_output_stream_write_finish (stream, res, NULL);
+  if (written < 0) {
+    _reply_queue_free (replies);
+    return;
+  }
+
+  replies->written += written;
+  if (replies->written == strlen (g_queue_peek_head (&replies->lines))) {
+    g_free (g_queue_pop_head (&replies->lines));
+    replies->written = 0;
+  }
+
+  if (g_queue_is_empty (&replies->lines))
+    _reply_queue_free (replies);
+  else
+    _reply_write_next (replies);
+}
+
+static void
+_reply_write_next (ReplyQueue * replies)
+{
+  const gchar *line = g_queue_peek_head (&replies->lines);
+
+  g_output_stream_write_async (replies->stream, line + replies->written,
+      strlen (line) - replies->written, G_PRIORITY_DEFAULT, NULL,
+      (GAsyncReadyCallback) _reply_written_cb, replies);
+}
+
+static void
+_reply (Batch * batch, GOutputStream * client, const gchar * format, ...)
+{
+  gchar *line;
+  va_list args;
+  ReplyQueue *replies;
+
+  if (client == NULL)
+    return;
+
+  va_start (args, format);
+  line = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  /* Only one write can be pending on a stream */
+  replies = g_object_get_data (G_OBJECT (client), REPLIES_KEY);
+  if (replies) {
+    g_queue_push_tail (&replies->lines, line);
+    return;
+  }
+
+  replies = g_slice_new0 (ReplyQueue);
+  replies->batch = batch;
+  replies->stream = g_object_ref (client);
+  g_queue_init (&replies->lines);
+  g_queue_push_tail (&replies->lines, line);
+  g_object_set_data (G_OBJECT (client), REPLIES_KEY, replies);
+  batch->n_replying++;
+
+  _reply_write_next (replies);
+}
+
+static void
+_job_free (BatchJob * job)
+{
+  if (job->bus_watch)
+    g_source_remove (job->bus_watch);
+
+  if (job->error_idle)
+    g_source_remove (job->error_idle);
+
+  if (job->pipeline) {
+    gst_element_set_state (GST_ELEMENT (job->pipeline), GST_STATE_NULL);
+    gst_object_unref (job->pipeline);
+  }
+
+  if (job->timeline)
+    gst_object_unref (job->timeline);
+
+  if (job->project) {
+    g_signal_handlers_disconnect_by_data (job->project, job);
+    gst_object_unref (job->project);
+  }
+
+  if (job->client)
+    g_object_unref (job->client);
+
+  g_free (job->project_uri);
+  g_free (job->output_uri);
+  g_free (job->format);
+  g_free (job->error);
+  g_slice_free (BatchJob, job);
+}
+
+static void
+_check_done (Batch * batch)
+{
+  if (batch->running || !g_queue_is_empty (&batch->pending))
+    return;
+
+  if (batch->service == NULL || batch->quitting)
+    g_main_loop_quit (batch->mainloop);
+}
+
+static void
+_job_done (BatchJob * job, const gchar * error)
+{
+  Batch *batch = job->batch;
+  GstClockTime elapsed = gst_util_get_timestamp () - job->start_time;
+
+  if (error) {
+    g_print ("[job %u] Failed after %.3fs: %s\n", job->id,
+        (gdouble) elapsed / GST_SECOND, error);
+    _reply (batch, job->client, "failed %u %s\n", job->id, error);
+    batch->n_failed++;
+  } else {
+    g_print ("[job %u] Rendered %s in %.3fs (loading: %.3fs)\n", job->id,
+        job->output_uri, (gdouble) elapsed / GST_SECOND,
+        (gdouble) job->load_time / GST_SECOND);
+    _reply (batch, job->client, "done %u %.3f\n", job->id,
+        (gdouble) elapsed / GST_SECOND);
+    batch->n_done++;
+  }
+
+  batch->running = g_list_remove (batch->running, job);
+  _job_free (job);
+
+  _start_jobs (batch);
+  _check_done (batch);
+}
+
+static gboolean
+_job_bus_cb (GstBus * bus, GstMessage * message, BatchJob * job)
+{
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_ERROR:{
+      GError *err = NULL;
+
+      gst_message_parse_error (message, &err, NULL);
+      job->bus_watch = 0;
+      _job_done (job, err->message);
+      g_error_free (err);
+
+      return FALSE;
+    }
+    case GST_MESSAGE_EOS:
+      job->bus_watch = 0;
+      _job_done (job, NULL);
+
+      return FALSE;
+    default:
+      break;
+  }
+
+  return TRUE;
+}
+
+static GstEncodingProfile *
+_job_get_profile (BatchJob * job)
+{
+  const GList *profiles;
+
+  if (job->format)
+    return job->batch->parse_profile (job->format);
+
+  profiles = ges_project_list_encoding_profiles (job->project);
+  if (profiles)
+    return gst_encoding_profile_ref (profiles->data);
+
+  return job->batch->parse_profile (job->batch->default_format);
+}
+
+static void
+_job_loaded_cb (GESProject * project, GESTimeline * timeline, BatchJob * job)
+{
+  GstBus *bus;
+  GstEncodingProfile *profile;
+
+  /* Several jobs can render the same project */
+  if (timeline != job->timeline || job->error)
+    return;
+
+  job->load_time = gst_util_get_timestamp () - job->start_time;
+  GST_INFO ("Job %u loaded in %" GST_TIME_FORMAT, job->id,
+      GST_TIME_ARGS (job->load_time));
+
+  profile = _job_get_profile (job);
+  if (profile == NULL) {
+    _job_done (job, "Could not create the encoding profile");
+    return;
+  }
+
+  job->pipeline = ges_pipeline_new ();
+  if (!ges_pipeline_set_timeline (job->pipeline, timeline)) {
+    gst_encoding_profile_unref (profile);
+    _job_done (job, "Could not set the timeline");
+    return;
+  }
+
+  if (!ges_pipeline_set_render_settings (job->pipeline, job->output_uri,
+          profile) || !ges_pipeline_set_mode (job->pipeline,
+          GES_PIPELINE_MODE_RENDER)) {
+    gst_encoding_profile_unref (profile);
+    _job_done (job, "Could not set the render settings");
+    return;
+  }
+  gst_encoding_profile_unref (profile);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (job->pipeline));
+  job->bus_watch = gst_bus_add_watch (bus, (GstBusFunc) _job_bus_cb, job);
+  gst_object_unref (bus);
+
+  if (gst_element_set_state (GST_ELEMENT (job->pipeline),
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    _job_done (job, "Failed to start the pipeline");
+}
+
+static gboolean
+_job_error_idle (BatchJob * job)
+{
+  job->error_idle = 0;
+  _job_done (job, job->error);
+
+  return FALSE;
+}
+
+/* This can be emitted from ges_asset_extract() so we can not free the job
+ * right away */
+static void
+_job_error_loading_asset_cb (GESProject * project, GError * error,
+    const gchar * failed_id, GType extractable_type, BatchJob * job)
+{
+  if (job->error)
+    return;
+
+  job->error = g_strdup_printf ("Error loading asset %s: %s", failed_id,
+      error->message);
+  job->error_idle = g_idle_add ((GSourceFunc) _job_error_idle, job);
+}
+
+static void
+_job_start (BatchJob * job)
+{
+  GError *error = NULL;
+
+  g_print ("[job %u] Loading %s\n", job->id, job->project_uri);
+  job->start_time = gst_util_get_timestamp ();
+  job->batch->running = g_list_append (job->batch->running, job);
+
+  job->project = ges_project_new (job->project_uri);
+  g_signal_connect (job->project, "loaded", G_CALLBACK (_job_loaded_cb), job);
+  g_signal_connect (job->project, "error-loading-asset",
+      G_CALLBACK (_job_error_loading_asset_cb), job);
+
+  job->timeline = GES_TIMELINE (ges_asset_extract (GES_ASSET (job->project),
+          &error));
+  if (job->timeline == NULL) {
+    _job_done (job, error ? error->message : "Could not load the project");
+    g_clear_error (&error);
+    return;
+  }
+
+  gst_object_ref_sink (job->timeline);
+}
+
+static void
+_start_jobs (Batch * batch)
+{
+  while (g_list_length (batch->running) < batch->max_jobs &&
+      !g_queue_is_empty (&batch->pending))
+    _job_start (g_queue_pop_head (&batch->pending));
+}
+
+/* Returns FALSE if @line is not a valid job */
+static gboolean
+_queue_job (Batch * batch, const gchar * line, GOutputStream * client)
+{
+  BatchJob *job;
+  gchar **tokens, **args;
+  guint n_args = 0, i;
+
+  if (*line == '\0' || *line == '#')
+    return TRUE;
+
+  /* Drop the empty tokens of consecutive spaces */
+  tokens = g_strsplit_set (line, " \t\r", 0);
+  args = g_new0 (gchar *, g_strv_length (tokens) + 1);
+  for (i = 0; tokens[i]; i++)
+    if (*tokens[i])
+      args[n_args++] = tokens[i];
+
+  if (n_args == 0) {
+    g_free (args);
+    g_strfreev (tokens);
+
+    return TRUE;
+  }
+
+  if (n_args < 2 || n_args > 3) {
+    g_printerr ("Invalid job '%s', expected: <project> <output> [<format>]\n",
+        line);
+    g_free (args);
+    g_strfreev (tokens);
+
+    return FALSE;
+  }
+
+  job = g_slice_new0 (BatchJob);
+  job->batch = batch;
+  job->project_uri = _ensure_uri (args[0]);
+  job->output_uri = _ensure_uri (args[1]);
+  job->format = g_strdup (args[2]);
+  job->client = client ? g_object_ref (client) : NULL;
+  g_free (args);
+  g_strfreev (tokens);
+
+  /* Rendering to any other kind of sink would let clients send data
+   * anywhere we can reach */
+  if (!gst_uri_has_protocol (job->output_uri, "file")) {
+    g_printerr ("Invalid job '%s', can only render to local files\n", line);
+    _job_free (job);
+
+    return FALSE;
+  }
+  job->id = batch->next_id++;
+
+  g_print ("[job %u] Queued %s -> %s\n", job->id, job->project_uri,
+      job->output_uri);
+  _reply (batch, client, "queued %u\n", job->id);
+  g_queue_push_tail (&batch->pending, job);
+
+  return TRUE;
+}
+
+static gboolean
+_print_progress (Batch * batch)
+{
+  GList *tmp;
+  gint64 position, duration;
+
+  for (tmp = batch->running; tmp; tmp = tmp->next) {
+    BatchJob *job = tmp->data;
+
+    if (job->pipeline == NULL)
+      continue;
+
+    if (!gst_element_query_position (GST_ELEMENT (job->pipeline),
+            GST_FORMAT_TIME, &position) ||
+        !gst_element_query_duration (GST_ELEMENT (job->pipeline),
+            GST_FORMAT_TIME, &duration) || duration <= 0)
+      continue;
+
+    g_print ("[job %u] %5.1f%% (%" GST_TIME_FORMAT " / %" GST_TIME_FORMAT
+        ")\n", job->id, 100.0 * position / duration, GST_TIME_ARGS (position),
+        GST_TIME_ARGS (duration));
+  }
+
+  return TRUE;
+}
+
+/* Clients */
+typedef struct
+{
+  Batch *batch;
+  GSocketConnection *connection;
+  GDataInputStream *input;
+} BatchClient;
+
+static void
+_client_free (BatchClient * client)
+{
+  g_object_unref (client->input);
+  g_object_unref (client->connection);
+  g_slice_free (BatchClient, client);
+}
+
+static void
+_client_read_line_cb (GDataInputStream * input, GAsyncResult * res,
+    BatchClient * client)
+{
+  gchar *line;
+  GOutputStream *output;
+  Batch *batch = client->batch;
+
+  line = g_data_input_stream_read_line_finish (input, res, NULL, NULL);
+  if (line == NULL) {
+    _client_free (client);
+    return;
+  }
+
+  output = g_io_stream_get_output_stream (G_IO_STREAM (client->connection));
+  if (!g_strcmp0 (g_strstrip (line), "quit")) {
+    g_print ("Exiting once all the jobs are done\n");
+    batch->quitting = TRUE;
+    _check_done (batch);
+  } else if (!_queue_job (batch, line, output)) {
+    _reply (batch, output, "failed - invalid job\n");
+  }
+  g_free (line);
+
+  _start_jobs (batch);
+
+  g_data_input_stream_read_line_async (input, G_PRIORITY_DEFAULT, NULL,
+      (GAsyncReadyCallback) _client_read_line_cb, client);
+}
+
+static gboolean
+_incoming_cb (GSocketService * service, GSocketConnection * connection,
+    GObject * source_object, Batch * batch)
+{
+  BatchClient *client = g_slice_new0 (BatchClient);
+
+  client->batch = batch;
+  client->connection = g_object_ref (connection);
+  client->input =
+      g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM
+          (connection)));
+
+  g_data_input_stream_read_line_async (client->input, G_PRIORITY_DEFAULT,
+      NULL, (GAsyncReadyCallback) _client_read_line_cb, client);
+
+  return TRUE;
+}
+
+static gboolean
+_read_jobs (Batch * batch, const gchar * location)
+{
+  gchar *line;
+  gsize terminator;
+  GIOChannel *channel;
+  GError *error = NULL;
+  gboolean ret = TRUE;
+
+  if (!g_strcmp0 (location, "-"))
+    channel = g_io_channel_unix_new (fileno (stdin));
+  else
+    channel = g_io_channel_new_file (location, "r", &error);
+
+  if (channel == NULL) {
+    g_printerr ("Could not open %s: %s\n", location, error->message);
+    g_error_free (error);
+
+    return FALSE;
+  }
+
+  while (g_io_channel_read_line (channel, &line, NULL, &terminator,
+          &error) == G_IO_STATUS_NORMAL) {
+    line[terminator] = '\0';
+    ret &= _queue_job (batch, line, NULL);
+    g_free (line);
+  }
+
+  if (error) {
+    g_printerr ("Could not read %s: %s\n", location, error->message);
+    g_error_free (error);
+    ret = FALSE;
+  }
+
+  g_io_channel_unref (channel);
+
+  return ret;
+}
+
+static gboolean
+_listen (Batch * batch, const gchar * socket_path)
+{
+#ifdef HAVE_GIO_UNIX
+  mode_t mask;
+  gboolean ret;
+  GSocketAddress *socket_address;
+  GError *error = NULL;
+
+  batch->service = g_socket_service_new ();
+
+  /* Only our user can connect and submit jobs, the umask makes bind()
+   * create the socket as 0600 so nobody else can connect in between */
+  socket_address = g_unix_socket_address_new (socket_path);
+  mask = umask (0177);
+  ret = g_socket_listener_add_address (G_SOCKET_LISTENER (batch->service),
+      socket_address, G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_DEFAULT, NULL,
+      NULL, &error);
+  umask (mask);
+  g_object_unref (socket_address);
+
+  if (!ret) {
+    g_printerr ("Could not listen on %s: %s\n", socket_path, error->message);
+    g_error_free (error);
+
+    return FALSE;
+  }
+
+  g_signal_connect (batch->service, "incoming", G_CALLBACK (_incoming_cb),
+      batch);
+  g_socket_service_start (batch->service);
+  g_print ("Waiting for jobs on %s\n", socket_path);
+
+  return TRUE;
+#else
+  g_printerr ("Receiving jobs on a socket is not supported on this "
+      "platform\n");
+
+  return FALSE;
+#endif
+}
+
+/**
+ * ges_batch_run:
+ * @jobs_location: The file to read the jobs from, "-" for stdin, or %NULL
+ * @socket_path: The unix socket to receive jobs on, or %NULL
+ * @n_jobs: The number of jobs to run at the same time
+ * @default_format: The format of the jobs that specify none and the project
+ * of which has no encoding profile
+ * @parse_profile: The function to parse formats with
+ *
+ * Runs the jobs read from @jobs_location, then if @socket_path is not %NULL,
+ * the ones received on it until a client asks us to quit.
+ *
+ * Returns: The number of jobs that failed, or -1 if the jobs could not be
+ * read at all
+ */
+gint
+ges_batch_run (const gchar * jobs_location, const gchar * socket_path,
+    guint n_jobs, const gchar * default_format,
+    GESBatchParseProfileFunc parse_profile)
+{
+  guint progress;
+  gboolean valid = TRUE;
+  GstClockTime start = gst_util_get_timestamp ();
+  Batch batch = { 0, };
+
+  batch.mainloop = g_main_loop_new (NULL, FALSE);
+  batch.parse_profile = parse_profile;
+  batch.default_format = default_format;
+  batch.max_jobs = MAX (n_jobs, 1);
+  g_queue_init (&batch.pending);
+
+  if (jobs_location)
+    valid = _read_jobs (&batch, jobs_location);
+
+  if (valid && socket_path)
+    valid = _listen (&batch, socket_path);
+
+  if (!valid) {
+    g_queue_foreach (&batch.pending, (GFunc) _job_free, NULL);
+    g_queue_clear (&batch.pending);
+    g_clear_object (&batch.service);
+    g_main_loop_unref (batch.mainloop);
+
+    return -1;
+  }
+
+  progress = g_timeout_add (PROGRESS_INTERVAL, (GSourceFunc) _print_progress,
+      &batch);
+
+  _start_jobs (&batch);
+  if (batch.running || batch.service)
+    g_main_loop_run (batch.mainloop);
+
+  g_source_remove (progress);
+  if (batch.service) {
+    g_socket_service_stop (batch.service);
+    g_object_unref (batch.service);
+    g_unlink (socket_path);
+  }
+
+  /* Let the clients know about the last jobs */
+  while (batch.n_replying)
+    g_main_context_iteration (NULL, TRUE);
+  g_main_loop_unref (batch.mainloop);
+
+  g_print ("%u jobs rendered, %u failed in %.3fs\n", batch.n_done,
+      batch.n_failed, (gdouble) (gst_util_get_timestamp () - start) /
+      GST_SECOND);
+
+  return batch.n_failed;
+}
@@ -0,0 +1,38 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef _GES_BATCH_
+#define _GES_BATCH_
+
+#include <glib.h>
+#include <gst/gst.h>
+#include <gst/pbutils/encoding-profile.h>
+
+G_BEGIN_DECLS
+
+typedef GstEncodingProfile * (*GESBatchParseProfileFunc) (const gchar *format);
+
+gint
+ges_batch_run (const gchar *jobs_location, const gchar *socket_path,
+               guint n_jobs, const gchar *default_format,
+               GESBatchParseProfileFunc parse_profile);
+
+G_END_DECLS
+
+#endif  /* _GES_BATCH_ */
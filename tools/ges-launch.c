@@ -31,6 +31,8 @@
 
 #include <locale.h>             /* for LC_ALL */
 #include "ges-validate.h"
+#include "ges-batch.h"
+#include "ges-profile.h"
 
 /* GLOBAL VARIABLE */
 static guint repeat = 0;
@@ -43,6 +45,7 @@ static GMainLoop *mainloop;
 static GHashTable *tried_uris;
 static GESTrackType track_types = GES_TRACK_TYPE_AUDIO | GES_TRACK_TYPE_VIDEO;
 static GESTimeline *timeline;
+static gdouble incremental = 0;
 
 static gchar *
 ensure_uri (gchar * location)
@@ -134,6 +137,24 @@ error_loading_asset_cb (GESProject * project, GError * error,
   g_main_loop_quit (mainloop);
 }
 
+static gboolean
+render_incremental (gpointer unused)
+{
+  GError *error = NULL;
+
+  g_print ("Rendering changed segments of %f seconds\n", incremental);
+  if (!ges_pipeline_render_incremental (pipeline, incremental * GST_SECOND,
+          &error)) {
+    g_printerr ("Error rendering: %s\n", error->message);
+    g_error_free (error);
+    seenerrors = TRUE;
+  }
+
+  g_main_loop_quit (mainloop);
+
+  return FALSE;
+}
+
 static void
 project_loaded_cb (GESProject * project, GESTimeline * timeline)
 {
@@ -163,6 +184,11 @@ project_loaded_cb (GESProject * project, GESTimeline * timeline)
     }
   }
 
+  if (incremental > 0) {
+    render_incremental (NULL);
+    return;
+  }
+
   if (gst_element_set_state (GST_ELEMENT (pipeline),
           GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
     g_error ("Failed to start the pipeline\n");
@@ -510,7 +536,22 @@ _print_position (void)
 {
   gint64 position, duration;
 
-  if (pipeline) {
+  if (pipeline && ges_pipeline_get_mode (pipeline) &
+      (GES_PIPELINE_MODE_RENDER | GES_PIPELINE_MODE_SMART_RENDER)) {
+    GstStructure *stats = ges_pipeline_get_stats (pipeline);
+    guint64 eta = GST_CLOCK_TIME_NONE;
+    gdouble speed = 0;
+
+    gst_structure_get (stats, "position", G_TYPE_UINT64, &position,
+        "duration", G_TYPE_UINT64, &duration, "speed", G_TYPE_DOUBLE, &speed,
+        "eta", G_TYPE_UINT64, &eta, NULL);
+    gst_structure_free (stats);
+
+    g_print ("<position: %" GST_TIME_FORMAT " duration: %" GST_TIME_FORMAT
+        " speed: %.2fx eta: %" GST_TIME_FORMAT "/>\r",
+        GST_TIME_ARGS (position), GST_TIME_ARGS (duration), speed,
+        GST_TIME_ARGS (eta));
+  } else if (pipeline) {
     gst_element_query_position (GST_ELEMENT (pipeline), GST_FORMAT_TIME,
         &position);
     gst_element_query_duration (GST_ELEMENT (pipeline), GST_FORMAT_TIME,
@@ -663,6 +704,10 @@ main (int argc, gchar ** argv)
   static gboolean verbose = FALSE;
   gchar *load_path = NULL;
   const gchar *scenario = NULL;
+  gchar *batch_path = NULL;
+  gchar *profile_path = NULL;
+  gchar *serve_path = NULL;
+  static gint n_jobs = 1;
   GOptionEntry options[] = {
     {"thumbnail", 'm', 0.0, G_OPTION_ARG_DOUBLE, &thumbinterval,
         "Take thumbnails every n seconds (saved in current directory)", "N"},
@@ -670,6 +715,10 @@ main (int argc, gchar ** argv)
         "Render to outputuri, and avoid decoding/reencoding", NULL},
     {"outputuri", 'o', 0, G_OPTION_ARG_STRING, &outputuri,
         "URI to encode to", "URI (<protocol>://<location>)"},
+    {"incremental", 'i', 0, G_OPTION_ARG_DOUBLE, &incremental,
+          "Render to outputuri through segments of at most N seconds, "
+          "only encoding again the segments that changed since the previous "
+          "render", "N"},
     {"format", 'f', 0, G_OPTION_ARG_STRING, &format,
           "Set the properties to use for the encoding profile "
           "(in case of transcoding.) For example:\n"
@@ -702,6 +751,22 @@ main (int argc, gchar ** argv)
     {"set-scenario", 0, 0, G_OPTION_ARG_STRING, &scenario,
         "Specify a GstValidate scenario to run, 'none' means load gst-validate"
           " but run no scenario on it", "<scenario_name>"},
+    {"batch", 'b', 0, G_OPTION_ARG_FILENAME, &batch_path,
+          "Render the jobs listed in a file ('-' for stdin), one per line as:\n"
+          "<project> <output> [<format>]\n"
+          "Without a format, the encoding profile of the project or the one "
+          "given with --format is used", "<path>"},
+    {"serve", 0, 0, G_OPTION_ARG_FILENAME, &serve_path,
+          "Keep running and render the jobs, formatted as for --batch, sent "
+          "to a unix socket created at <path>, only accessible to the "
+          "current user. Send 'quit' to exit", "<path>"},
+    {"jobs", 'j', 0, G_OPTION_ARG_INT, &n_jobs,
+        "Number of jobs rendered at the same time with --batch or --serve",
+        "N"},
+    {"profile", 0, 0, G_OPTION_ARG_FILENAME, &profile_path,
+          "Measure the processing time of each clip, effect and transition, "
+          "print them ranked when done and dump the measurements as JSON to "
+          "<path>", "<path>"},
     {NULL}
   };
 
@@ -753,6 +818,19 @@ main (int argc, gchar ** argv)
     exit (0);
   }
 
+  if (batch_path || serve_path) {
+    gint failed;
+
+    g_option_context_free (ctx);
+    failed = ges_batch_run (batch_path, serve_path, MAX (n_jobs, 1),
+        format ? format : "application/ogg:video/x-theora:audio/x-vorbis",
+        _parse_encoding_profile);
+    g_free (batch_path);
+    g_free (serve_path);
+
+    return failed != 0;
+  }
+
   tried_uris = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
   if (((!load_path && (argc < 4)))) {
     g_printf ("%s", g_option_context_get_help (ctx, TRUE, NULL));
@@ -767,11 +845,19 @@ main (int argc, gchar ** argv)
   if (!pipeline)
     exit (1);
 
+  if (profile_path)
+    ges_timeline_set_profiling (timeline, TRUE);
+
   if (ges_validate_activate (GST_PIPELINE (pipeline), scenario) == FALSE) {
     g_error ("Could not activate scenario %s", scenario);
     return 1;
   }
 
+  if (incremental > 0 && !outputuri) {
+    g_printerr ("Incremental rendering needs an output URI\n");
+    exit (1);
+  }
+
   /* Setup profile/encoding if needed */
   if (smartrender || outputuri) {
     GstEncodingProfile *prof = NULL;
@@ -794,10 +880,11 @@ main (int argc, gchar ** argv)
     if (outputuri)
       outputuri = ensure_uri (outputuri);
 
+    /* Incremental rendering does not use the pipeline itself */
     if (!prof || !ges_pipeline_set_render_settings (pipeline, outputuri, prof)
-        || !ges_pipeline_set_mode (pipeline,
-            smartrender ? GES_PIPELINE_MODE_SMART_RENDER :
-            GES_PIPELINE_MODE_RENDER)) {
+        || (incremental <= 0 && !ges_pipeline_set_mode (pipeline,
+                smartrender ? GES_PIPELINE_MODE_SMART_RENDER :
+                GES_PIPELINE_MODE_RENDER))) {
       g_free (outputuri);
       exit (1);
     }
@@ -827,7 +914,9 @@ main (int argc, gchar ** argv)
   gst_bus_add_signal_watch (bus);
   g_signal_connect (bus, "message", G_CALLBACK (bus_message_cb), mainloop);
 
-  if (load_path == NULL && gst_element_set_state (GST_ELEMENT (pipeline),
+  if (load_path == NULL && incremental > 0) {
+    g_idle_add (render_incremental, NULL);
+  } else if (load_path == NULL && gst_element_set_state (GST_ELEMENT (pipeline),
           GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
     g_error ("Failed to start the pipeline\n");
     return 1;
@@ -837,6 +926,9 @@ main (int argc, gchar ** argv)
 
   gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
 
+  if (profile_path && !ges_profile_report (timeline, profile_path))
+    seenerrors = TRUE;
+
   validate_res = ges_validate_clean (GST_PIPELINE (pipeline));
   if (seenerrors == FALSE)
     seenerrors = validate_res;
@@ -0,0 +1,193 @@
+/* GStreamer Editing Services
+ *
+ * Copyright (C) 2014 The GStreamer Editing Services developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Reports what GESTimeline:profiling measured: the track elements ranked by
+ * processing time are printed out, and all the measurements are dumped as
+ * JSON of the form:
+ *
+ *   {
+ *     "elements": [
+ *       { "type": "GESVideoUriSource", "track-type": "video", "start": 0,
+ *         "element": "gnlsource3", "layer": 0, "asset": "file:///a.ogv",
+ *         "buffers": 250, "processing-time": 1234567,
+ *         "latency": null, "startup-latency": 45678 },
+ *       ...
+ *     ]
+ *   }
+ *
+ * with all the times in nanoseconds, null when nothing was measured.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ges-profile.h"
+
+static void
+_append_json_string (GString * json, const gchar * string)
+{
+  const gchar *c;
+
+  if (string == NULL) {
+    g_string_append (json, "null");
+
+    return;
+  }
+
+  g_string_append_c (json, '"');
+  for (c = string; *c; c++) {
+    switch (*c) {
+      case '"':
+        g_string_append (json, "\\\"");
+        break;
+      case '\\':
+        g_string_append (json, "\\\\");
+        break;
+      case '\n':
+        g_string_append (json, "\\n");
+        break;
+      case '\t':
+        g_string_append (json, "\\t");
+        break;
+      default:
+        if ((guchar) * c < 0x20)
+          g_string_append_printf (json, "\\u%04x", (guchar) * c);
+        else
+          g_string_append_c (json, *c);
+    }
+  }
+  g_string_append_c (json, '"');
+}
+
+static void
+_append_json_time (GString * json, const gchar * name, GstClockTime time)
+{
+  g_string_append_printf (json, ", \"%s\": ", name);
+  if (GST_CLOCK_TIME_IS_VALID (time))
+    g_string_append_printf (json, "%" G_GUINT64_FORMAT, time);
+  else
+    g_string_append (json, "null");
+}
+
+static void
+_append_json_element (GString * json, const GstStructure * element)
+{
+  GESTrackType track_type = GES_TRACK_TYPE_UNKNOWN;
+  guint64 start = 0, buffers = 0, time = 0, latency = GST_CLOCK_TIME_NONE,
+      startup = GST_CLOCK_TIME_NONE;
+  gint layer = -1;
+
+  gst_structure_get (element, "track-type", GES_TYPE_TRACK_TYPE, &track_type,
+      "start", G_TYPE_UINT64, &start, "layer", G_TYPE_INT, &layer,
+      "buffers", G_TYPE_UINT64, &buffers,
+      "processing-time", G_TYPE_UINT64, &time,
+      "latency", G_TYPE_UINT64, &latency,
+      "startup-latency", G_TYPE_UINT64, &startup, NULL);
+
+  g_string_append (json, "{ \"type\": ");
+  _append_json_string (json, gst_structure_get_string (element, "type"));
+  g_string_append (json, ", \"track-type\": ");
+  _append_json_string (json, ges_track_type_name (track_type));
+  g_string_append_printf (json, ", \"start\": %" G_GUINT64_FORMAT, start);
+  g_string_append (json, ", \"element\": ");
+  _append_json_string (json, gst_structure_get_string (element, "element"));
+  g_string_append_printf (json, ", \"layer\": %d, \"asset\": ", layer);
+  _append_json_string (json, gst_structure_get_string (element, "asset"));
+  g_string_append_printf (json, ", \"buffers\": %" G_GUINT64_FORMAT, buffers);
+  _append_json_time (json, "processing-time", time);
+  _append_json_time (json, "latency", latency);
+  _append_json_time (json, "startup-latency", startup);
+  g_string_append (json, " }");
+}
+
+static void
+_print_element (guint rank, const GstStructure * element)
+{
+  GESTrackType track_type = GES_TRACK_TYPE_UNKNOWN;
+  guint64 buffers = 0, time = 0, latency = GST_CLOCK_TIME_NONE;
+  gint layer = -1;
+  const gchar *asset = gst_structure_get_string (element, "asset");
+
+  gst_structure_get (element, "track-type", GES_TYPE_TRACK_TYPE, &track_type,
+      "layer", G_TYPE_INT, &layer, "buffers", G_TYPE_UINT64, &buffers,
+      "processing-time", G_TYPE_UINT64, &time,
+      "latency", G_TYPE_UINT64, &latency, NULL);
+
+  g_print ("%4u %12.3f %8" G_GUINT64_FORMAT " %10.3f %5d %-6s %-24s %s\n",
+      rank, (gdouble) time / GST_MSECOND, buffers,
+      GST_CLOCK_TIME_IS_VALID (latency) ? (gdouble) latency / GST_MSECOND : 0,
+      layer, ges_track_type_name (track_type),
+      gst_structure_get_string (element, "type"), asset ? asset : "");
+}
+
+/**
+ * ges_profile_report:
+ * @timeline: A #GESTimeline that was profiling
+ * @json_location: The file to dump the measurements to, or %NULL
+ *
+ * Prints the track elements of @timeline from the one that took the most
+ * processing time to the one that took the least, and dumps all the
+ * measurements as JSON to @json_location.
+ *
+ * Returns: %FALSE if the JSON could not be written
+ */
+gboolean
+ges_profile_report (GESTimeline * timeline, const gchar * json_location)
+{
+  guint i, n;
+  GError *err = NULL;
+  const GValue *elements;
+  GstStructure *profile = ges_timeline_get_profile (timeline);
+  GString *json = g_string_new ("{\n  \"elements\": [");
+  gboolean ret = TRUE;
+
+  elements = gst_structure_get_value (profile, "elements");
+  n = gst_value_array_get_size (elements);
+
+  g_print ("\n%4s %12s %8s %10s %5s %-6s %-24s %s\n", "rank", "time (ms)",
+      "buffers", "lat. (ms)", "layer", "track", "type", "asset");
+  for (i = 0; i < n; i++) {
+    const GstStructure *element =
+        gst_value_get_structure (gst_value_array_get_value (elements, i));
+
+    _print_element (i + 1, element);
+
+    g_string_append (json, i ? ",\n    " : "\n    ");
+    _append_json_element (json, element);
+  }
+  g_string_append (json, "\n  ]\n}\n");
+
+  if (json_location &&
+      !g_file_set_contents (json_location, json->str, json->len, &err)) {
+    g_printerr ("Could not write the profile to %s: %s\n", json_location,
+        err->message);
+    g_clear_error (&err);
+    ret = FALSE;
+  }
+
+  g_string_free (json, TRUE);
+  gst_structure_free (profile);
+
+  return ret;
+}